@@ -0,0 +1,125 @@
+// Packing small generated textures (checkerboards, gradients, dots, noise
+// of 16^2 to 128^2) into one atlas: build time, atlas size, how much of it
+// the images cover, and texture binds for drawing every image once with
+// and without the atlas. Also checks that no level has a texel of one image
+// bleeding into another's padded area.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/ProceduralTextures.h"
+#include "Textures/Effects/TextureAtlas.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+void Generate(const ImageView& image, int kind, D3DCOLOR color)
+{
+    switch (kind % 4)
+    {
+    case 0:
+        for (int y = 0; y < image.height; y++)
+        {
+            for (int x = 0; x < image.width; x++)
+                image.At(x, y) = ((x / 8 + y / 8) & 1) ? color : D3DCOLOR_XRGB(255, 255, 255);
+        }
+        break;
+    case 1:
+        for (int y = 0; y < image.height; y++)
+        {
+            for (int x = 0; x < image.width; x++)
+                image.At(x, y) = D3DCOLOR_ARGB(255, x * 255 / image.width, y * 255 / image.height, color & 255);
+        }
+        break;
+    case 2:
+        for (int y = 0; y < image.height; y++)
+        {
+            for (int x = 0; x < image.width; x++)
+            {
+                int dx = x % 8 - 4;
+                int dy = y % 8 - 4;
+                image.At(x, y) = dx * dx + dy * dy < 6 ? color : D3DCOLOR_ARGB(0, 0, 0, 0);
+            }
+        }
+        break;
+    default:
+        ProceduralTextures::GeneratePerlinNoise(image, 4.0f, 3);
+        break;
+    }
+}
+
+// Count of padded-area texels at each level that differ from the image's
+// own clamped texels
+int CountBleeding(const TextureAtlas& atlas, const std::vector<PixelBuffer>& images, const AtlasOptions& options)
+{
+    int bad = 0;
+    int padding = options.padding;
+    for (int level = 1; level < atlas.GetLevelCount(); level++)
+    {
+        ImageView view = atlas.GetLevel(level);
+        int border = padding >> level;
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            const AtlasRegion& region = atlas.GetRegion(static_cast<int>(i));
+            int x0 = region.x >> level;
+            int y0 = region.y >> level;
+            int width = std::max(1, region.width >> level);
+            int height = std::max(1, region.height >> level);
+            for (int y = std::max(0, y0 - border); y < std::min(view.height, y0 + height + border); y++)
+            {
+                for (int x = std::max(0, x0 - border); x < std::min(view.width, x0 + width + border); x++)
+                {
+                    bool inside = x >= x0 && x < x0 + width && y >= y0 && y < y0 + height;
+                    int cx = std::clamp(x, x0, x0 + width - 1);
+                    int cy = std::clamp(y, y0, y0 + height - 1);
+                    if (!inside && view.At(x, y) != view.At(cx, cy))
+                        bad++;
+                }
+            }
+        }
+    }
+    return bad;
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 random(7);
+    const int sizes[] = { 16, 32, 64, 128 };
+
+    for (int count : { 32, 128, 512 })
+    {
+        std::vector<PixelBuffer> images;
+        TextureAtlas atlas;
+        for (int i = 0; i < count; i++)
+        {
+            int width = sizes[random() % 4];
+            int height = sizes[random() % 4];
+            images.emplace_back(width, height);
+            Generate(images.back().GetView(), static_cast<int>(random() % 4), D3DCOLOR_XRGB(random() & 255, 64, 128));
+            atlas.Add(images.back().GetView());
+        }
+
+        AtlasOptions options;
+        options.maxSize = 4096;
+        auto start = std::chrono::high_resolution_clock::now();
+        bool built = atlas.Build(options);
+        auto end = std::chrono::high_resolution_clock::now();
+        if (!built)
+        {
+            printf("%4d images: did not fit\n", count);
+            continue;
+        }
+
+        printf("%4d images: %8.2f ms, %4dx%-4d with %d levels, %.0f%% covered, %d binds -> 1, %d bleeding texels\n",
+               count, std::chrono::duration<double, std::milli>(end - start).count(), atlas.GetWidth(),
+               atlas.GetHeight(), atlas.GetLevelCount(), atlas.GetOccupancy() * 100.0f, count,
+               CountBleeding(atlas, images, options));
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+// Block compression (BlockCompressor) of 2048^2 procedural textures: encode
+// time of the fast and high quality modes on the pool and on one thread, and
+// PSNR of the decoded result. A bounding-box BC1 encoder (endpoints at the
+// corners of the color box, nearest-color indices) is the quality baseline.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Core/ThreadPool.h"
+#include "Textures/Effects/EffectThreads.h"
+#include "Textures/Effects/BlockCompression.h"
+#include "Textures/Effects/NoiseCore.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+double MeasureMs(const std::function<void()>& func)
+{
+    double best = 0.0;
+    for (int run = 0; run < 3; run++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+int Clamp(float value)
+{
+    return std::max(0, std::min(255, static_cast<int>(value)));
+}
+
+// Rock-like albedo: two noise layers tinting brown and grey, with a cutout
+// alpha for the BC3 rows
+void FillAlbedo(const ImageView& image)
+{
+    NoiseCore noise(11);
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            float large = noise.Perlin(x * 0.01f, y * 0.01f) * 0.5f + 0.5f;
+            float detail = noise.Perlin(x * 0.15f, y * 0.15f) * 0.5f + 0.5f;
+            float mix = large * 0.7f + detail * 0.3f;
+            int alpha = Clamp((noise.Perlin(x * 0.03f + 5.0f, y * 0.03f) + 0.2f) * 600.0f + 128.0f);
+            image.At(x, y) = D3DCOLOR_ARGB(alpha, Clamp(90 + mix * 110), Clamp(70 + mix * 90 + detail * 20),
+                                           Clamp(50 + large * 60));
+        }
+    }
+}
+
+// Height field in red, its normal's X and Y in red and green for BC5
+void FillHeightAndNormals(const ImageView& height, const ImageView& normals)
+{
+    NoiseCore noise(4);
+    for (int y = 0; y < height.height; y++)
+    {
+        for (int x = 0; x < height.width; x++)
+        {
+            float h = noise.Perlin(x * 0.02f, y * 0.02f) * 0.5f + 0.5f;
+            int value = Clamp(h * 255.0f);
+            height.At(x, y) = D3DCOLOR_ARGB(255, value, value, value);
+
+            float dx = noise.Perlin(x * 0.08f, y * 0.08f);
+            float dy = noise.Perlin(x * 0.08f + 31.0f, y * 0.08f);
+            float length = sqrtf(dx * dx + dy * dy + 1.0f);
+            normals.At(x, y) = D3DCOLOR_ARGB(255, Clamp((dx / length + 1.0f) * 127.5f + 0.5f),
+                                             Clamp((dy / length + 1.0f) * 127.5f + 0.5f),
+                                             Clamp((1.0f / length + 1.0f) * 127.5f + 0.5f));
+        }
+    }
+}
+
+int Channel(D3DCOLOR color, int shift)
+{
+    return (color >> shift) & 0xFF;
+}
+
+// BC1 with the color bounding box corners as endpoints
+void CompressBoundingBox(const ImageView& image, std::vector<BYTE>& blocks)
+{
+    int blocksWide = (image.width + 3) / 4;
+    for (int by = 0; by < (image.height + 3) / 4; by++)
+    {
+        for (int bx = 0; bx < blocksWide; bx++)
+        {
+            int low[3] = { 255, 255, 255 };
+            int high[3] = { 0, 0, 0 };
+            for (int i = 0; i < 16; i++)
+            {
+                D3DCOLOR color = image.GetClamped(bx * 4 + (i & 3), by * 4 + (i >> 2));
+                for (int c = 0; c < 3; c++)
+                {
+                    low[c] = std::min(low[c], Channel(color, 16 - 8 * c));
+                    high[c] = std::max(high[c], Channel(color, 16 - 8 * c));
+                }
+            }
+
+            int c0 = ((high[0] >> 3) << 11) | ((high[1] >> 2) << 5) | (high[2] >> 3);
+            int c1 = ((low[0] >> 3) << 11) | ((low[1] >> 2) << 5) | (low[2] >> 3);
+            if (c0 < c1)
+                std::swap(c0, c1);
+
+            // Decode the palette the same way the compressor does, then pick nearest
+            BYTE probe[8] = { static_cast<BYTE>(c0), static_cast<BYTE>(c0 >> 8), static_cast<BYTE>(c1),
+                              static_cast<BYTE>(c1 >> 8), 0xE4, 0, 0, 0 };
+            D3DCOLOR palette[16];
+            BlockCompressor::DecompressBlock(probe, BlockFormat::BC1, palette);
+
+            unsigned bits = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                D3DCOLOR color = image.GetClamped(bx * 4 + (i & 3), by * 4 + (i >> 2));
+                int best = 0;
+                int bestError = 1 << 30;
+                for (int k = 0; k < 4; k++)
+                {
+                    int error = 0;
+                    for (int shift = 0; shift < 24; shift += 8)
+                    {
+                        int d = Channel(color, shift) - Channel(palette[k], shift);
+                        error += d * d;
+                    }
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        best = c0 == c1 ? 0 : k;
+                    }
+                }
+                bits |= static_cast<unsigned>(best) << (2 * i);
+            }
+
+            BYTE* block = blocks.data() + (static_cast<size_t>(by) * blocksWide + bx) * 8;
+            std::copy(probe, probe + 4, block);
+            for (int i = 0; i < 4; i++)
+                block[4 + i] = static_cast<BYTE>(bits >> (8 * i));
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    const int size = 2048;
+    PixelBuffer albedo(size, size);
+    PixelBuffer opaque(size, size, PixelFormat::X8R8G8B8);
+    PixelBuffer height(size, size);
+    PixelBuffer normals(size, size);
+    FillAlbedo(albedo.GetView());
+    albedo.GetView().CopyTo(opaque.GetView());
+    FillHeightAndNormals(height.GetView(), normals.GetView());
+
+    PixelBuffer decoded(size, size);
+    std::vector<BYTE> blocks(BlockCompressor::GetCompressedSize(BlockFormat::BC3, size, size));
+    ThreadPool serial(0);
+
+    printf("%d^2, ms, %d worker threads\n", size, ThreadPool::Default().GetThreadCount());
+    printf("  %-22s %8s %8s %10s %8s\n", "encoder", "pool", "1 thread", "MPixel/s", "PSNR dB");
+
+    double boxMs = MeasureMs([&]() { CompressBoundingBox(opaque.GetView(), blocks); });
+    BlockCompressor::Decompress(blocks.data(), 0, BlockFormat::BC1, decoded.GetView());
+    printf("  %-22s %8.1f %8s %10.1f %8.2f\n", "BC1 bounding box", boxMs, "-", size * size / (boxMs * 1000.0),
+           BlockCompressor::ComputePSNR(opaque.GetView(), decoded.GetView(), BlockFormat::BC1));
+
+    struct Case {
+        const char* name;
+        BlockFormat format;
+        const PixelBuffer* source;
+    };
+    const Case cases[] = {
+        { "BC1 albedo", BlockFormat::BC1, &opaque },
+        { "BC3 albedo + cutout", BlockFormat::BC3, &albedo },
+        { "BC4 height", BlockFormat::BC4, &height },
+        { "BC5 normal XY", BlockFormat::BC5, &normals },
+    };
+
+    for (const Case& test : cases)
+    {
+        const BlockQuality qualities[] = { BlockQuality::Fast, BlockQuality::High };
+        for (BlockQuality quality : qualities)
+        {
+            ImageView source = test.source->GetView();
+            double pooled = MeasureMs([&]() { BlockCompressor::Compress(source, test.format, blocks.data(), 0, quality); });
+
+            SetEffectThreadPool(&serial);
+            double single = MeasureMs([&]() { BlockCompressor::Compress(source, test.format, blocks.data(), 0, quality); });
+            SetEffectThreadPool(nullptr);
+
+            BlockCompressor::Decompress(blocks.data(), 0, test.format, decoded.GetView());
+            char name[64];
+            snprintf(name, sizeof(name), "%s, %s", test.name, quality == BlockQuality::Fast ? "fast" : "high");
+            printf("  %-22s %8.1f %8.1f %10.1f %8.2f\n", name, pooled, single, size * size / (pooled * 1000.0),
+                   BlockCompressor::ComputePSNR(source, decoded.GetView(), test.format));
+        }
+    }
+
+    printf("\nmemory: A8R8G8B8 %zu KB, BC1/BC4 %zu KB, BC3/BC5 %zu KB\n", albedo.GetMemoryUsage() / 1024,
+           BlockCompressor::GetCompressedSize(BlockFormat::BC1, size, size) / 1024,
+           BlockCompressor::GetCompressedSize(BlockFormat::BC3, size, size) / 1024);
+    return 0;
+}
@@ -0,0 +1,196 @@
+// Blur cost versus radius: the previous full 2D kernel of ApplyBlur, the
+// separable two-pass Gaussian and three running-sum box passes, plus
+// ApplyBlur as shipped (separable up to Blur::kMaxSeparableRadius, boxes
+// above) and how far its output is from the 2D kernel. Then how close
+// ApplyGaussianBlur's box passes get to an exact separable Gaussian.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/Blur.h"
+#include "Textures/Effects/PostEffects.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+template <typename Func>
+double MeasureMs(Func&& func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Best of three runs, each on a fresh copy of the source
+template <typename Func>
+double MeasureBlurMs(const PixelBuffer& source, PixelBuffer& work, Func&& func)
+{
+    double best = 0.0;
+    for (int run = 0; run < 3; run++)
+    {
+        source.GetView().CopyTo(work.GetView());
+        double ms = MeasureMs(func);
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+// ApplyBlur before the separable rewrite: (2r+1)^2 taps per pixel
+void Blur2D(const ImageView& image, float radius)
+{
+    int kernelSize = static_cast<int>(radius * 2) + 1;
+    if (kernelSize % 2 == 0) kernelSize++;
+    int center = kernelSize / 2;
+
+    std::vector<float> kernel(kernelSize * kernelSize);
+    float sum = 0.0f;
+    for (int y = 0; y < kernelSize; y++)
+    {
+        for (int x = 0; x < kernelSize; x++)
+        {
+            float d2 = static_cast<float>((x - center) * (x - center) + (y - center) * (y - center));
+            kernel[y * kernelSize + x] = expf(-d2 / (2.0f * radius * radius));
+            sum += kernel[y * kernelSize + x];
+        }
+    }
+    for (float& value : kernel)
+        value /= sum;
+
+    PixelBuffer original(image.width, image.height);
+    image.CopyTo(original.GetView());
+    ImageView source = original.GetView();
+
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            float r = 0.0f, g = 0.0f, b = 0.0f;
+            for (int ky = 0; ky < kernelSize; ky++)
+            {
+                for (int kx = 0; kx < kernelSize; kx++)
+                {
+                    D3DCOLOR color = source.GetClamped(x + kx - center, y + ky - center);
+                    float weight = kernel[ky * kernelSize + kx];
+                    r += ((color >> 16) & 0xFF) * weight;
+                    g += ((color >> 8) & 0xFF) * weight;
+                    b += (color & 0xFF) * weight;
+                }
+            }
+            image.At(x, y) = D3DCOLOR_ARGB(source.At(x, y) >> 24, static_cast<int>(r), static_cast<int>(g),
+                                           static_cast<int>(b));
+        }
+    }
+}
+
+void Compare(const ImageView& a, const ImageView& b, int& maxDiff, double& meanDiff)
+{
+    maxDiff = 0;
+    long long total = 0;
+    for (int y = 0; y < a.height; y++)
+    {
+        for (int x = 0; x < a.width; x++)
+        {
+            for (int shift = 0; shift < 24; shift += 8)
+            {
+                int diff = std::abs(static_cast<int>((a.At(x, y) >> shift) & 0xFF) -
+                                    static_cast<int>((b.At(x, y) >> shift) & 0xFF));
+                maxDiff = std::max(maxDiff, diff);
+                total += diff;
+            }
+        }
+    }
+    meanDiff = static_cast<double>(total) / (3.0 * a.width * a.height);
+}
+
+} // namespace
+
+int main()
+{
+    const int size = 512;
+
+    // Smooth noise with some hard edges, so blurs have something to do
+    PixelBuffer source(size, size);
+    std::mt19937 rng(1234);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            int base = ((x / 32 + y / 32) & 1) ? 200 : 40;
+            int r = std::min(255, base + static_cast<int>(rng() % 56));
+            int g = std::min(255, base / 2 + static_cast<int>(rng() % 56));
+            int b = std::min(255, 255 - base + static_cast<int>(rng() % 56) - 55);
+            source.GetView().At(x, y) = D3DCOLOR_ARGB(255, r, g, std::max(0, b));
+        }
+    }
+
+    PixelBuffer work(size, size);
+    PixelBuffer reference(size, size);
+
+    printf("%d^2, ms per blur (2D kernel only up to radius 16)\n", size);
+    printf("  radius  2D kernel  separable   3 x box  ApplyBlur   vs 2D: max  mean\n");
+
+    for (int radius : { 1, 2, 4, 8, 16, 32, 64 })
+    {
+        double kernel2DMs = -1.0;
+        if (radius <= 16)
+        {
+            source.GetView().CopyTo(reference.GetView());
+            kernel2DMs = MeasureMs([&]() { Blur2D(reference.GetView(), static_cast<float>(radius)); });
+        }
+
+        std::vector<float> kernel = Blur::GaussianKernel(static_cast<float>(radius), radius);
+        double separableMs = MeasureBlurMs(source, work, [&]() {
+            Blur::Separable(work.GetView(), kernel.data(), radius);
+        });
+
+        int radii[3];
+        Blur::BoxRadiiForGaussian(Blur::KernelSigma(kernel.data(), radius), 3, radii);
+        double boxMs = MeasureBlurMs(source, work, [&]() {
+            Blur::Box(work.GetView(), std::max(1, radii[2]), 3);
+        });
+
+        double applyMs = MeasureBlurMs(source, work, [&]() {
+            PostEffects::ApplyBlur(work.GetView(), static_cast<float>(radius));
+        });
+
+        if (kernel2DMs >= 0.0)
+        {
+            int maxDiff;
+            double meanDiff;
+            Compare(work.GetView(), reference.GetView(), maxDiff, meanDiff);
+            printf("  %6d %10.2f %10.2f %9.2f %10.2f %10d %5.2f\n", radius, kernel2DMs, separableMs, boxMs,
+                   applyMs, maxDiff, meanDiff);
+        }
+        else
+        {
+            printf("  %6d %10s %10.2f %9.2f %10.2f\n", radius, "-", separableMs, boxMs, applyMs);
+        }
+    }
+
+    printf("\nGaussian, 3 x box against exact separable (3 sigma kernel)\n");
+    printf("   sigma  separable   3 x box   max  mean\n");
+
+    for (float sigma : { 4.0f, 8.0f, 16.0f })
+    {
+        int radius = static_cast<int>(ceilf(3.0f * sigma));
+        std::vector<float> kernel = Blur::GaussianKernel(sigma, radius);
+        double separableMs = MeasureBlurMs(source, reference, [&]() {
+            Blur::Separable(reference.GetView(), kernel.data(), radius);
+        });
+        double boxMs = MeasureBlurMs(source, work, [&]() { PostEffects::ApplyGaussianBlur(work.GetView(), sigma); });
+
+        int maxDiff;
+        double meanDiff;
+        Compare(work.GetView(), reference.GetView(), maxDiff, meanDiff);
+        printf("  %6.1f %10.2f %9.2f %5d %5.2f\n", sigma, separableMs, boxMs, maxDiff, meanDiff);
+    }
+
+    return 0;
+}
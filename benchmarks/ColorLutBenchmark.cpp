@@ -0,0 +1,143 @@
+// Color op stacks run directly (PostEffectChain, exact) against the same
+// chain baked into a ColorLut3D, on a 4096^2 image holding every 24-bit
+// color once. Reports apply time, bake time and the error of each lattice
+// size and interpolation against the direct result over all colors.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/PostEffectChain.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+using namespace TextureEffects;
+
+namespace {
+
+double MeasureMs(const std::function<void()>& func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Best of two runs, each on a fresh copy of the source
+double MeasureApplyMs(const PixelBuffer& source, PixelBuffer& work, const PostEffectChain& chain)
+{
+    double best = 0.0;
+    for (int run = 0; run < 2; run++)
+    {
+        source.GetView().CopyTo(work.GetView());
+        double ms = MeasureMs([&]() { chain.Apply(work.GetView()); });
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+struct Error {
+    int max = 0;
+    double mean = 0.0;
+    double exact = 0.0;  // Fraction of pixels with all channels equal
+};
+
+Error Compare(const ImageView& a, const ImageView& b)
+{
+    Error error;
+    long long total = 0;
+    long long exact = 0;
+    for (int y = 0; y < a.height; y++)
+    {
+        const D3DCOLOR* rowA = a.Row(y);
+        const D3DCOLOR* rowB = b.Row(y);
+        for (int x = 0; x < a.width; x++)
+        {
+            int pixelMax = 0;
+            for (int shift = 0; shift < 24; shift += 8)
+            {
+                int diff = std::abs(static_cast<int>((rowA[x] >> shift) & 0xFF) -
+                                    static_cast<int>((rowB[x] >> shift) & 0xFF));
+                pixelMax = std::max(pixelMax, diff);
+                total += diff;
+            }
+            error.max = std::max(error.max, pixelMax);
+            exact += pixelMax == 0;
+        }
+    }
+    double pixels = static_cast<double>(a.width) * a.height;
+    error.mean = total / (3.0 * pixels);
+    error.exact = exact / pixels;
+    return error;
+}
+
+struct Case {
+    const char* name;
+    std::function<void(PostEffectChain&)> record;
+};
+
+} // namespace
+
+int main()
+{
+    const int size = 4096;
+
+    // Every 24-bit color exactly once
+    PixelBuffer source(size, size);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            source.GetView().At(x, y) = 0xFF000000 | static_cast<D3DCOLOR>(y * size + x);
+        }
+    }
+
+    PixelBuffer reference(size, size);
+    PixelBuffer work(size, size);
+
+    const Case cases[] = {
+        { "grade", [](PostEffectChain& chain) {
+              chain.AdjustBrightness(0.05f).AdjustContrast(15.0f).AdjustSaturation(1.3f).AdjustHue(10.0f)
+                  .AdjustGamma(1.2f).ColorBalance(1.05f, 1.0f, 0.92f).Sepia(0.3f);
+          } },
+        { "saturate+hue", [](PostEffectChain& chain) { chain.AdjustSaturation(0.7f).AdjustHue(-25.0f); } },
+        { "posterize", [](PostEffectChain& chain) { chain.AdjustSaturation(1.2f).Posterize(6); } },
+        { "per-channel", [](PostEffectChain& chain) {
+              chain.AdjustBrightness(0.1f).AdjustContrast(25.0f).AdjustGamma(1.3f).ColorBalance(1.0f, 0.9f, 1.1f);
+          } },
+    };
+
+    const LutInterpolation interpolations[] = { LutInterpolation::Trilinear, LutInterpolation::Tetrahedral };
+
+    printf("%d^2 (all 24-bit colors), ms; error against the direct path in levels\n", size);
+    printf("  %-13s %-12s %4s %8s %8s %7s %5s %6s %7s\n", "stack", "mode", "size", "bake", "apply", "speedup", "max",
+           "mean", "exact");
+
+    for (const Case& test : cases)
+    {
+        PostEffectChain direct;
+        test.record(direct);
+        double directMs = MeasureApplyMs(source, reference, direct);
+        printf("  %-13s %-12s %4s %8s %8.1f\n", test.name, "direct", "-", "-", directMs);
+
+        for (LutInterpolation interpolation : interpolations)
+        {
+            for (int lutSize : { 17, 33, 65 })
+            {
+                PostEffectChain baked;
+                double bakeMs = MeasureMs([&]() {
+                    baked.UseColorLut(interpolation, lutSize);
+                    test.record(baked);
+                });
+                double applyMs = MeasureApplyMs(source, work, baked);
+                Error error = Compare(work.GetView(), reference.GetView());
+
+                printf("  %-13s %-12s %4d %8.1f %8.1f %6.1fx %5d %6.3f %6.1f%%\n", "",
+                       interpolation == LutInterpolation::Trilinear ? "trilinear" : "tetrahedral", lutSize, bakeMs,
+                       applyMs, directMs / applyMs, error.max, error.mean, 100.0 * error.exact);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,186 @@
+// RGB <-> HSV/HSL/Lab over spans (ColorSpace) against the previous per-color
+// HSV conversion, and the hue and saturation point ops built on them, on a
+// 4096^2 image holding every 24-bit color once. Also checks that every
+// color survives each round trip unchanged.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/ColorSpace.h"
+#include "Textures/Effects/PointOps.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+double MeasureMs(const std::function<void()>& func)
+{
+    double best = 0.0;
+    for (int run = 0; run < 2; run++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+// The per-color conversions ColorSpace replaced (branch per hue sector)
+void ReferenceRGBToHSV(D3DCOLOR color, float& h, float& s, float& v)
+{
+    float r = ((color >> 16) & 0xFF) / 255.0f;
+    float g = ((color >> 8) & 0xFF) / 255.0f;
+    float b = (color & 0xFF) / 255.0f;
+
+    float maxValue = std::max({ r, g, b });
+    float delta = maxValue - std::min({ r, g, b });
+
+    v = maxValue;
+    s = maxValue == 0.0f ? 0.0f : delta / maxValue;
+    if (delta == 0.0f)
+        h = 0.0f;
+    else if (maxValue == r)
+        h = 60.0f * fmodf((g - b) / delta, 6.0f);
+    else if (maxValue == g)
+        h = 60.0f * ((b - r) / delta + 2.0f);
+    else
+        h = 60.0f * ((r - g) / delta + 4.0f);
+    if (h < 0.0f) h += 360.0f;
+}
+
+D3DCOLOR ReferenceHSVToRGB(float h, float s, float v)
+{
+    float c = v * s;
+    float x = c * (1.0f - fabsf(fmodf(h / 60.0f, 2.0f) - 1.0f));
+    float m = v - c;
+
+    float r, g, b;
+    if (h < 60.0f)       { r = c; g = x; b = 0.0f; }
+    else if (h < 120.0f) { r = x; g = c; b = 0.0f; }
+    else if (h < 180.0f) { r = 0.0f; g = c; b = x; }
+    else if (h < 240.0f) { r = 0.0f; g = x; b = c; }
+    else if (h < 300.0f) { r = x; g = 0.0f; b = c; }
+    else                 { r = c; g = 0.0f; b = x; }
+
+    return D3DCOLOR_ARGB(255, static_cast<BYTE>((r + m) * 255.0f), static_cast<BYTE>((g + m) * 255.0f),
+                         static_cast<BYTE>((b + m) * 255.0f));
+}
+
+// Per-pixel op the way PointOps built hue and saturation before
+template <typename Func>
+PointOp ReferenceOp(Func func)
+{
+    PointOp op;
+    op.apply = [func](const PixelSpan& span) {
+        for (int i = 0; i < span.count; i++)
+        {
+            D3DCOLOR color = span.pixels[i];
+            span.pixels[i] = (color & 0xFF000000) | (func(color) & 0x00FFFFFF);
+        }
+    };
+    return op;
+}
+
+typedef void (*FromColors)(const D3DCOLOR*, float*, float*, float*, int);
+typedef void (*ToColors)(const float*, const float*, const float*, D3DCOLOR*, int);
+
+int CountChanged(const std::vector<D3DCOLOR>& a, const std::vector<D3DCOLOR>& b)
+{
+    int changed = 0;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        changed += a[i] != b[i];
+    }
+    return changed;
+}
+
+} // namespace
+
+int main()
+{
+    const int size = 4096;
+    const int count = size * size;
+
+    std::vector<D3DCOLOR> colors(count);
+    for (int i = 0; i < count; i++)
+    {
+        colors[i] = 0xFF000000 | static_cast<D3DCOLOR>(i);
+    }
+
+    std::vector<float> c0(count), c1(count), c2(count);
+    std::vector<D3DCOLOR> result(count);
+
+    printf("%d^2 (all 24-bit colors), ms\n", size);
+    printf("  %-26s %8s %8s %10s\n", "conversion", "to", "from", "changed");
+
+    double referenceTo = MeasureMs([&]() {
+        for (int i = 0; i < count; i++)
+            ReferenceRGBToHSV(colors[i], c0[i], c1[i], c2[i]);
+    });
+    double referenceFrom = MeasureMs([&]() {
+        for (int i = 0; i < count; i++)
+            result[i] = ReferenceHSVToRGB(c0[i], c1[i], c2[i]);
+    });
+    printf("  %-26s %8.1f %8.1f %10d\n", "HSV per color (previous)", referenceTo, referenceFrom,
+           CountChanged(colors, result));
+
+    struct Space {
+        const char* name;
+        FromColors from;
+        ToColors to;
+    };
+    const Space spaces[] = {
+        { "HSV spans", ColorSpace::RGBToHSV, ColorSpace::HSVToRGB },
+        { "HSL spans", ColorSpace::RGBToHSL, ColorSpace::HSLToRGB },
+        { "Lab spans", ColorSpace::RGBToLab, ColorSpace::LabToRGB },
+    };
+
+    for (const Space& space : spaces)
+    {
+        double to = MeasureMs([&]() { space.from(colors.data(), c0.data(), c1.data(), c2.data(), count); });
+        double from = MeasureMs([&]() { space.to(c0.data(), c1.data(), c2.data(), result.data(), count); });
+        printf("  %-26s %8.1f %8.1f %10d\n", space.name, to, from, CountChanged(colors, result));
+    }
+
+    // Point ops as PostEffects runs them
+    PixelBuffer image(size, size);
+    ImageView view = image.GetView();
+    auto reset = [&]() {
+        for (int y = 0; y < size; y++)
+            std::copy(colors.begin() + y * size, colors.begin() + (y + 1) * size, view.Row(y));
+    };
+
+    printf("\n  %-26s %8s %8s\n", "point op", "previous", "spans");
+    struct Op {
+        const char* name;
+        PointOp op;
+        PointOp reference;
+    };
+    const Op ops[] = {
+        { "AdjustHue(25)", PointOps::Hue(25.0f), ReferenceOp([](D3DCOLOR color) {
+              float h, s, v;
+              ReferenceRGBToHSV(color, h, s, v);
+              return ReferenceHSVToRGB(fmodf(h + 25.0f, 360.0f), s, v);
+          }) },
+        { "AdjustSaturation(1.3)", PointOps::Saturation(1.3f), ReferenceOp([](D3DCOLOR color) {
+              float h, s, v;
+              ReferenceRGBToHSV(color, h, s, v);
+              return ReferenceHSVToRGB(h, std::min(1.0f, s * 1.3f), v);
+          }) },
+    };
+
+    for (const Op& op : ops)
+    {
+        double previous = MeasureMs([&]() { reset(); PointOps::Run(view, op.reference); });
+        double spans = MeasureMs([&]() { reset(); PointOps::Run(view, op.op); });
+        printf("  %-26s %8.1f %8.1f\n", op.name, previous, spans);
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+// ApplyKernel cost on a 2048^2 bake: the float path (one clamped fetch per
+// tap) against the fixed point path at each instruction set, for the 3x3
+// kernels PostEffects uses plus a 5x5 one with a divisor. Reports how far
+// the fixed point output is from the float one and checks that every
+// instruction set gives the same bytes.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/Convolution.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+struct KernelCase {
+    const char* name;
+    std::vector<float> weights;
+    int size;
+    float divisor;
+};
+
+template <typename Func>
+double MeasureMs(const PixelBuffer& source, PixelBuffer& work, Func&& func)
+{
+    double best = 0.0;
+    for (int run = 0; run < 3; run++)
+    {
+        source.GetView().CopyTo(work.GetView());
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+int MaxDiff(const ImageView& a, const ImageView& b)
+{
+    int maxDiff = 0;
+    for (int y = 0; y < a.height; y++)
+    {
+        for (int x = 0; x < a.width; x++)
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                int diff = std::abs(static_cast<int>((a.At(x, y) >> shift) & 0xFF) -
+                                    static_cast<int>((b.At(x, y) >> shift) & 0xFF));
+                maxDiff = std::max(maxDiff, diff);
+            }
+        }
+    }
+    return maxDiff;
+}
+
+bool SameBytes(const ImageView& a, const ImageView& b)
+{
+    for (int y = 0; y < a.height; y++)
+    {
+        if (memcmp(a.Row(y), b.Row(y), a.width * sizeof(D3DCOLOR)) != 0)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    const int size = 2048;
+
+    // Noise over soft gradients and hard edges, with varying alpha
+    PixelBuffer source(size, size);
+    std::mt19937 rng(1234);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            int base = ((x / 64 + y / 64) & 1) ? 180 : 50;
+            int r = std::min(255, base + static_cast<int>(rng() % 64));
+            int g = std::min(255, (x * 255) / size + static_cast<int>(rng() % 16));
+            int b = std::min(255, (y * 255) / size + static_cast<int>(rng() % 16));
+            source.GetView().At(x, y) = D3DCOLOR_ARGB(rng() % 256, r, g, b);
+        }
+    }
+
+    float angle = 45.0f * 3.14159f / 180.0f;
+    float cosA = cosf(angle);
+    float sinA = sinf(angle);
+
+    std::vector<KernelCase> cases = {
+        { "sharpen 0.5", { 0, -0.5f, 0, -0.5f, 3.0f, -0.5f, 0, -0.5f, 0 }, 3, 1.0f },
+        { "emboss", { -cosA - sinA, -sinA, cosA - sinA, -cosA, 1.0f, cosA, sinA - cosA, sinA, cosA + sinA }, 3, 1.0f },
+        { "laplacian", { 0, -1, 0, -1, 4, -1, 0, -1, 0 }, 3, 1.0f },
+        { "sobel", { -1, -1, -1, -1, 8, -1, -1, -1, -1 }, 3, 1.0f },
+        { "5x5 binomial", { 1, 4, 6, 4, 1, 4, 16, 24, 16, 4, 6, 24, 36, 24, 6, 4, 16, 24, 16, 4, 1, 4, 6, 4, 1 },
+          5, 256.0f },
+    };
+
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+    SimdLevel maxLevel = CpuFeatures::GetMaxSimdLevel();
+
+    PixelBuffer reference(size, size);
+    PixelBuffer work(size, size);
+    PixelBuffer scalar(size, size);
+    bool allMatch = true;
+
+    printf("%d^2, ms per kernel (best of 3), max difference to float in levels\n", size);
+    printf("  %-13s %8s %8s %8s %8s %8s %5s\n", "kernel", "float", "scalar", "SSE2", "AVX2", "speedup", "diff");
+
+    for (const KernelCase& kernel : cases)
+    {
+        double floatMs = MeasureMs(source, reference, [&]() {
+            Convolution::ApplyFloat(reference.GetView(), kernel.weights.data(), kernel.size, kernel.divisor);
+        });
+
+        printf("  %-13s %8.1f", kernel.name, floatMs);
+
+        double bestMs = floatMs;
+        int maxDiff = 0;
+        for (SimdLevel level : levels)
+        {
+            if (level > maxLevel)
+            {
+                printf(" %8s", "-");
+                continue;
+            }
+
+            Convolution::SetSimdLevel(level);
+            double ms = MeasureMs(source, work, [&]() {
+                Convolution::Apply(work.GetView(), kernel.weights.data(), kernel.size, kernel.divisor);
+            });
+            printf(" %8.1f", ms);
+            bestMs = std::min(bestMs, ms);
+
+            maxDiff = std::max(maxDiff, MaxDiff(work.GetView(), reference.GetView()));
+            if (level == SimdLevel::Scalar)
+                work.GetView().CopyTo(scalar.GetView());
+            else if (!SameBytes(work.GetView(), scalar.GetView()))
+                allMatch = false;
+        }
+
+        printf(" %7.1fx %5d%s\n", floatMs / bestMs, maxDiff,
+               Convolution::IsFixedPoint(kernel.weights.data(), kernel.size, kernel.divisor) ? "" : " (float)");
+        if (maxDiff > 1)
+            allMatch = false;
+    }
+
+    Convolution::SetSimdLevel(maxLevel);
+    printf("\ninstruction sets identical, within 1 LSB of float: %s\n", allMatch ? "yes" : "NO");
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+// Compares regenerating a looping noise animation every frame against
+// sampling a baked flipbook (plain copy and cross-fade).
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/Flipbook.h"
+#include "Textures/Effects/NoiseCore.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+template <typename Func>
+double MeasureMs(Func&& func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Stand-in for an animated effect: looping 4D turbulence mapped to a ramp
+bool RenderFrame(const NoiseCore& noise, const NoiseParams& params, int size, float period,
+                 float time, const ImageView& frame)
+{
+    std::vector<float> row(size);
+    float step = 1.0f / size;
+
+    for (int y = 0; y < size; y++)
+    {
+        noise.EvaluateLoopGrid(params, 0.0f, y * step, step, step, size, 1, time / period, 0.5f, row.data(), size);
+        for (int x = 0; x < size; x++)
+        {
+            uint32_t v = static_cast<uint32_t>(row[x] * 255.0f);
+            frame.At(x, y) = 0xFF000000u | (v << 16) | ((v / 2) << 8);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    NoiseCore noise(1337);
+    NoiseParams params;
+    params.fractal = NoiseFractal::Turbulence;
+    params.frequency = 4.0f;
+    params.octaves = 4;
+
+    const int size = 256;
+    const int frameCount = 64;
+    const float period = 4.0f;
+    const int updates = 120;
+
+    PixelBuffer target(size, size);
+
+    Flipbook flipbook;
+    double bakeMs = MeasureMs([&]() {
+        flipbook.Bake(size, size, frameCount, period, [&](float time, const ImageView& frame) {
+            return RenderFrame(noise, params, size, period, time, frame);
+        });
+    });
+
+    double regenerateMs = MeasureMs([&]() {
+        for (int i = 0; i < updates; i++)
+            RenderFrame(noise, params, size, period, i / 60.0f, target.GetView());
+    });
+
+    double copyMs = MeasureMs([&]() {
+        for (int i = 0; i < updates; i++)
+            flipbook.Sample(i / 60.0f, false, target.GetView());
+    });
+
+    double fadeMs = MeasureMs([&]() {
+        for (int i = 0; i < updates; i++)
+            flipbook.Sample(i / 60.0f + 0.01f, true, target.GetView());
+    });
+
+    printf("%d^2, %d frames over %.1f s (%.1f MB cached), bake %.1f ms\n", size, frameCount, period,
+           flipbook.GetMemoryUsage() / (1024.0 * 1024.0), bakeMs);
+    printf("  regenerate  %8.3f ms/update\n", regenerateMs / updates);
+    printf("  copy        %8.3f ms/update  x%.0f\n", copyMs / updates, regenerateMs / copyMs);
+    printf("  cross-fade  %8.3f ms/update  x%.0f\n", fadeMs / updates, regenerateMs / fadeMs);
+
+    return 0;
+}
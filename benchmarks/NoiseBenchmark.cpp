@@ -0,0 +1,254 @@
+// Compares per-pixel scalar noise against batched row evaluation, and the
+// batched path across instruction sets (results must be bit-identical).
+// Also times the 64x64 tiled fill used by ProceduralTextures with different
+// worker counts; the output must not depend on the thread count, and the
+// hashed cellular noise against the old sinf-based Voronoi.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/NoiseCore.h"
+#include "Core/ThreadPool.h"
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+template <typename Func>
+double MeasureMs(Func&& func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void RunSize(const NoiseCore& noise, const NoiseParams& params, int size)
+{
+    std::vector<float> scalar(static_cast<size_t>(size) * size);
+    std::vector<float> batched(scalar.size());
+    float step = 1.0f / size;
+
+    double scalarMs = MeasureMs([&]() {
+        for (int y = 0; y < size; y++)
+        {
+            float fy = static_cast<float>(y) * step;
+            for (int x = 0; x < size; x++)
+            {
+                float fx = 0.0f + static_cast<float>(x) * step;
+                scalar[static_cast<size_t>(y) * size + x] = noise.Evaluate(params, fx, fy);
+            }
+        }
+    });
+
+    float maxError = 0.0f;
+    std::vector<float> reference;
+
+    printf("  %5d^2  per-pixel %9.2f ms (%7.1f MP/s)\n", size, scalarMs,
+           static_cast<double>(size) * size / 1.0e6 / (scalarMs / 1000.0));
+
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+    for (SimdLevel level : levels)
+    {
+        if (level > CpuFeatures::GetMaxSimdLevel())
+            break;
+
+        NoiseCore::SetSimdLevel(level);
+        double batchedMs = MeasureMs([&]() {
+            noise.EvaluateGrid(params, 0.0f, 0.0f, step, step, size, size, batched.data(), size);
+        });
+
+        if (reference.empty())
+        {
+            reference = batched;
+            for (size_t i = 0; i < scalar.size(); i++)
+            {
+                maxError = std::max(maxError, fabsf(scalar[i] - batched[i]));
+            }
+        }
+
+        bool identical = memcmp(reference.data(), batched.data(), batched.size() * sizeof(float)) == 0;
+        double megaPixels = static_cast<double>(size) * size / 1.0e6;
+        printf("           %-6s    %9.2f ms (%7.1f MP/s)  x%.2f  %s\n",
+               CpuFeatures::GetSimdLevelName(level), batchedMs, megaPixels / (batchedMs / 1000.0),
+               scalarMs / batchedMs, identical ? "bit-identical" : "MISMATCH");
+    }
+
+    NoiseCore::SetSimdLevel(CpuFeatures::GetMaxSimdLevel());
+    printf("           max|diff| per-pixel vs row: %g\n", maxError);
+}
+
+// The sinf/cosf feature points VoronoiNoise2D used before cellular noise
+float LegacyVoronoi(float x, float y)
+{
+    int cellX = static_cast<int>(floorf(x));
+    int cellY = static_cast<int>(floorf(y));
+    float minDistance = 999999.0f;
+
+    for (int offsetY = -1; offsetY <= 1; offsetY++)
+    {
+        for (int offsetX = -1; offsetX <= 1; offsetX++)
+        {
+            int neighborX = cellX + offsetX;
+            int neighborY = cellY + offsetY;
+            float pointX = neighborX + sinf(neighborX * 23.1f + neighborY * 19.7f) * 0.5f + 0.5f;
+            float pointY = neighborY + cosf(neighborX * 31.3f + neighborY * 17.5f) * 0.5f + 0.5f;
+            float dx = x - pointX;
+            float dy = y - pointY;
+            minDistance = std::min(minDistance, sqrtf(dx * dx + dy * dy));
+        }
+    }
+
+    return std::min(1.0f, minDistance);
+}
+
+void RunCellular(const NoiseCore& noise, int size, float frequency)
+{
+    std::vector<float> legacy(static_cast<size_t>(size) * size);
+    std::vector<CellularResult> single(legacy.size());
+    std::vector<CellularResult> rows(legacy.size());
+    float step = frequency / size;
+
+    double legacyMs = MeasureMs([&]() {
+        for (int y = 0; y < size; y++)
+            for (int x = 0; x < size; x++)
+                legacy[static_cast<size_t>(y) * size + x] = LegacyVoronoi(x * step, y * step);
+    });
+
+    const CellularMetric metrics[] = { CellularMetric::Euclidean, CellularMetric::Manhattan, CellularMetric::Chebyshev };
+    const char* metricNames[] = { "Euclidean", "Manhattan", "Chebyshev" };
+
+    printf("  %5d^2  legacy sinf F1       %9.2f ms\n", size, legacyMs);
+    for (int m = 0; m < 3; m++)
+    {
+        double singleMs = MeasureMs([&]() {
+            for (int y = 0; y < size; y++)
+                for (int x = 0; x < size; x++)
+                    single[static_cast<size_t>(y) * size + x] = noise.Cellular(x * step, y * step, metrics[m]);
+        });
+
+        double rowMs = MeasureMs([&]() {
+            for (int y = 0; y < size; y++)
+                noise.CellularRow(0.0f, y * step, step, size, metrics[m], rows.data() + static_cast<size_t>(y) * size);
+        });
+
+        float maxDiff = 0.0f;
+        double meanF1 = 0.0;
+        double meanEdge = 0.0;
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            maxDiff = std::max(maxDiff, fabsf(rows[i].f1 - single[i].f1));
+            meanF1 += rows[i].f1;
+            meanEdge += rows[i].Edge();
+        }
+
+        printf("           %-9s per-pixel %9.2f ms  row %9.2f ms  x%.2f vs legacy  mean F1 %.3f  mean F2-F1 %.3f  max|row-pixel| %g\n",
+               metricNames[m], singleMs, rowMs, legacyMs / rowMs, meanF1 / rows.size(), meanEdge / rows.size(), maxDiff);
+    }
+}
+
+void RunSimplex3D4D(const NoiseCore& noise)
+{
+    NoiseParams params;
+    params.frequency = 4.0f;
+    params.octaves = 4;
+
+    const int volumeSize = 64;
+    std::vector<float> volume(static_cast<size_t>(volumeSize) * volumeSize * volumeSize);
+    float step = 1.0f / volumeSize;
+    double volumeMs = MeasureMs([&]() {
+        noise.EvaluateVolume(params, 0.0f, 0.0f, 0.0f, step, step, step, volumeSize, volumeSize, volumeSize, volume.data());
+    });
+
+    const int loopSize = 512;
+    std::vector<float> first(static_cast<size_t>(loopSize) * loopSize);
+    std::vector<float> last(first.size());
+    float loopStep = 1.0f / loopSize;
+    double loopMs = MeasureMs([&]() {
+        noise.EvaluateLoopGrid(params, 0.0f, 0.0f, loopStep, loopStep, loopSize, loopSize, 0.0f, 0.5f, first.data(), loopSize);
+    });
+    noise.EvaluateLoopGrid(params, 0.0f, 0.0f, loopStep, loopStep, loopSize, loopSize, 1.0f, 0.5f, last.data(), loopSize);
+
+    bool seamless = memcmp(first.data(), last.data(), first.size() * sizeof(float)) == 0;
+    printf("  3D volume %d^3   %9.2f ms (%7.1f MS/s)\n", volumeSize, volumeMs,
+           volume.size() / 1.0e6 / (volumeMs / 1000.0));
+    printf("  4D loop   %d^2  %9.2f ms (%7.1f MS/s)  phase 0 == phase 1: %s\n", loopSize, loopMs,
+           first.size() / 1.0e6 / (loopMs / 1000.0), seamless ? "yes" : "NO");
+}
+
+void RunTiled(const NoiseCore& noise, const NoiseParams& params, int size)
+{
+    const int tileSize = 64;
+    int tiles = (size + tileSize - 1) / tileSize;
+    std::vector<float> reference;
+    std::vector<float> image(static_cast<size_t>(size) * size);
+
+    unsigned hardware = std::thread::hardware_concurrency();
+    const int workerCounts[] = { 0, 1, 3, static_cast<int>(hardware > 1 ? hardware - 1 : 0) };
+
+    for (int workers : workerCounts)
+    {
+        ThreadPool pool(workers);
+
+        double ms = MeasureMs([&]() {
+            pool.ParallelFor(tiles * tiles, [&](int index) {
+                int x0 = (index % tiles) * tileSize;
+                int y0 = (index / tiles) * tileSize;
+                int w = std::min(tileSize, size - x0);
+                int h = std::min(tileSize, size - y0);
+                float step = 1.0f / size;
+                noise.EvaluateGrid(params, x0 * step, y0 * step, step, step, w, h,
+                                   image.data() + static_cast<size_t>(y0) * size + x0, size);
+            });
+        });
+
+        if (reference.empty())
+            reference = image;
+
+        bool identical = memcmp(reference.data(), image.data(), image.size() * sizeof(float)) == 0;
+        printf("  %5d^2  tiled, %2d workers %9.2f ms (%7.1f MP/s)  %s\n", size, workers, ms,
+               static_cast<double>(size) * size / 1.0e6 / (ms / 1000.0), identical ? "identical" : "MISMATCH");
+    }
+}
+
+} // namespace
+
+int main()
+{
+    NoiseCore noise(1337);
+
+    const NoiseFractal fractals[] = { NoiseFractal::FBM, NoiseFractal::Ridged, NoiseFractal::Billow, NoiseFractal::Turbulence };
+    const char* names[] = { "FBM", "Ridged", "Billow", "Turbulence" };
+    const int sizes[] = { 256, 1024, 4096 };
+
+    for (int f = 0; f < 4; f++)
+    {
+        NoiseParams params;
+        params.fractal = fractals[f];
+        params.frequency = 8.0f;
+        params.octaves = 4;
+
+        printf("%s, %d octaves\n", names[f], params.octaves);
+        for (int size : sizes)
+        {
+            RunSize(noise, params, size);
+        }
+    }
+
+    printf("Cellular, frequency 8\n");
+    RunCellular(noise, 1024, 8.0f);
+
+    printf("Simplex 3D/4D FBM, 4 octaves\n");
+    RunSimplex3D4D(noise);
+
+    NoiseParams tiledParams;
+    tiledParams.frequency = 8.0f;
+    tiledParams.octaves = 6;
+    printf("Tiled FBM, %d octaves (%u hardware threads)\n", tiledParams.octaves, std::thread::hardware_concurrency());
+    RunTiled(noise, tiledParams, 4096);
+
+    return 0;
+}
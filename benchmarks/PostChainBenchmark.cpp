@@ -0,0 +1,129 @@
+// PostEffects one call after another (one pass over memory each) against
+// the same sequence recorded in a PostEffectChain, on a 2048^2 image. The
+// outputs must match byte for byte.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/PostEffectChain.h"
+#include "Textures/Effects/PostEffects.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+
+using namespace TextureEffects;
+
+namespace {
+
+double MeasureMs(const PixelBuffer& source, PixelBuffer& work, const std::function<void(const ImageView&)>& func)
+{
+    double best = 0.0;
+    for (int run = 0; run < 3; run++)
+    {
+        source.GetView().CopyTo(work.GetView());
+        auto start = std::chrono::high_resolution_clock::now();
+        func(work.GetView());
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+bool SameBytes(const ImageView& a, const ImageView& b)
+{
+    for (int y = 0; y < a.height; y++)
+    {
+        if (memcmp(a.Row(y), b.Row(y), a.width * sizeof(D3DCOLOR)) != 0)
+            return false;
+    }
+    return true;
+}
+
+struct Case {
+    const char* name;
+    std::function<void(const ImageView&)> separate;
+    PostEffectChain chain;
+};
+
+} // namespace
+
+int main()
+{
+    const int size = 2048;
+
+    PixelBuffer source(size, size);
+    std::mt19937 rng(99);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            source.GetView().At(x, y) = D3DCOLOR_ARGB(rng() % 256, (x * 255) / size + rng() % 8,
+                                                      (y * 255) / size, rng() % 256);
+        }
+    }
+
+    std::vector<Case> cases;
+
+    {
+        Case grade{ "grade + vignette", nullptr, {} };
+        grade.separate = [](const ImageView& image) {
+            PostEffects::AdjustBrightness(image, 0.1f);
+            PostEffects::AdjustContrast(image, 20.0f);
+            PostEffects::AdjustSaturation(image, 1.2f);
+            PostEffects::AdjustGamma(image, 1.4f);
+            PostEffects::AddVignette(image, 0.6f, 0.5f);
+        };
+        grade.chain.AdjustBrightness(0.1f).AdjustContrast(20.0f).AdjustSaturation(1.2f).AdjustGamma(1.4f)
+            .AddVignette(0.6f, 0.5f);
+        cases.push_back(std::move(grade));
+    }
+
+    {
+        Case tables{ "channel tables", nullptr, {} };
+        tables.separate = [](const ImageView& image) {
+            PostEffects::AdjustBrightness(image, -0.2f);
+            PostEffects::AdjustContrast(image, 40.0f);
+            PostEffects::ColorBalance(image, 1.1f, 1.0f, 0.9f);
+            PostEffects::AdjustGamma(image, 0.8f);
+            PostEffects::Posterize(image, 8);
+        };
+        tables.chain.AdjustBrightness(-0.2f).AdjustContrast(40.0f).ColorBalance(1.1f, 1.0f, 0.9f).AdjustGamma(0.8f)
+            .Posterize(8);
+        cases.push_back(std::move(tables));
+    }
+
+    {
+        Case mixed{ "with sharpen", nullptr, {} };
+        mixed.separate = [](const ImageView& image) {
+            PostEffects::AdjustContrast(image, 15.0f);
+            PostEffects::Sepia(image, 0.5f);
+            PostEffects::ApplySharpen(image, 0.5f);
+            PostEffects::AdjustGamma(image, 1.1f);
+            PostEffects::AddVignette(image, 0.4f, 0.6f);
+        };
+        mixed.chain.AdjustContrast(15.0f).Sepia(0.5f).ApplySharpen(0.5f).AdjustGamma(1.1f).AddVignette(0.4f, 0.6f);
+        cases.push_back(std::move(mixed));
+    }
+
+    PixelBuffer separate(size, size);
+    PixelBuffer chained(size, size);
+    bool allMatch = true;
+
+    printf("%d^2, 5 effects, ms (best of 3)\n", size);
+    printf("  %-18s %9s %9s %8s %7s %s\n", "sequence", "separate", "chain", "speedup", "passes", "same");
+
+    for (Case& test : cases)
+    {
+        double separateMs = MeasureMs(source, separate, test.separate);
+        double chainMs = MeasureMs(source, chained, [&](const ImageView& image) { test.chain.Apply(image); });
+        bool same = SameBytes(separate.GetView(), chained.GetView());
+        allMatch = allMatch && same;
+
+        printf("  %-18s %9.1f %9.1f %7.1fx %7d %s\n", test.name, separateMs, chainMs, separateMs / chainMs,
+               test.chain.GetPassCount(), same ? "yes" : "NO");
+    }
+
+    return allMatch ? 0 : 1;
+}
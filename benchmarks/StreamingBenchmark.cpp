@@ -0,0 +1,178 @@
+// Time a scene's texture loads block the calling thread: opening, checking
+// and copying every baked .etex file in a row (what a synchronous
+// LoadTexture loop costs at startup) against the streaming queue, where
+// workers open and check the files and the calling thread only commits the
+// copies under a per-frame byte budget. A few requests get a higher priority
+// and a few are cancelled, to check both. Destinations are CPU buffers
+// standing in for locked textures.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/StreamingQueue.h"
+#include "Textures/Effects/TextureFile.h"
+#include "Core/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+double ElapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Every level of one texture, as the locked texture would be
+struct Destination {
+    std::vector<std::vector<uint8_t>> levels;
+    bool committed = false;
+};
+
+bool CopyLevels(const TextureFile& file, Destination& destination)
+{
+    destination.levels.resize(file.GetLevelCount());
+    for (int i = 0; i < file.GetLevelCount(); i++)
+    {
+        size_t size = static_cast<size_t>(file.GetLevel(i).size);
+        destination.levels[i].resize(size);
+        memcpy(destination.levels[i].data(), file.GetLevelData(i), size);
+    }
+    destination.committed = true;
+    return true;
+}
+
+bool LoadSynchronous(const std::string& filename, Destination& destination)
+{
+    TextureFile file;
+    return file.Open(filename) && file.VerifyContentHash() && CopyLevels(file, destination);
+}
+
+StreamRequest MakeRequest(const std::string& filename, Destination& destination, int priority)
+{
+    auto file = std::make_shared<TextureFile>();
+
+    StreamRequest request;
+    request.priority = priority;
+    request.load = [file, filename](size_t& uploadBytes) {
+        if (!file->Open(filename) || !file->VerifyContentHash())
+            return false;
+
+        uploadBytes = 0;
+        for (int i = 0; i < file->GetLevelCount(); i++)
+            uploadBytes += static_cast<size_t>(file->GetLevel(i).size);
+        return true;
+    };
+    request.commit = [file, &destination]() { return CopyLevels(*file, destination); };
+    return request;
+}
+
+} // namespace
+
+int main()
+{
+    const int textureCount = 200;
+    const int size = 256;
+    const int important = 10;               // Loaded first
+    const int cancelled = 20;               // Cancelled right after submitting
+    const size_t budget = 2 * 1024 * 1024;  // Bytes committed per frame
+
+    PixelBuffer source(size, size);
+    ImageView view = source.GetView();
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+            view.At(x, y) = D3DCOLOR_ARGB(255, x & 255, y & 255, (x ^ y) & 255);
+    }
+
+    MipChain chain;
+    chain.Build(view);
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::vector<std::string> filenames;
+    for (int i = 0; i < textureCount; i++)
+    {
+        filenames.push_back((directory / ("StreamingBenchmark_" + std::to_string(i) + ".etex")).string());
+        if (!TextureFile::WriteMipChain(filenames.back(), chain, TextureFileFormat::A8R8G8B8))
+        {
+            printf("failed to write %s\n", filenames.back().c_str());
+            return 1;
+        }
+    }
+
+    printf("%d textures of %d^2 (32-bit, %d levels), budget %zu KB per frame\n", textureCount, size,
+           chain.GetLevelCount(), budget / 1024);
+
+    // Synchronous: everything on the calling thread before the first frame
+    {
+        std::vector<Destination> destinations(textureCount);
+        auto start = std::chrono::high_resolution_clock::now();
+        int loaded = 0;
+        for (int i = 0; i < textureCount; i++)
+            loaded += LoadSynchronous(filenames[i], destinations[i]) ? 1 : 0;
+        printf("  synchronous   %8.2f ms blocked, %d loaded\n", ElapsedMs(start), loaded);
+    }
+
+    // Streaming: submit everything, then one budgeted Update per frame
+    ThreadPool pool(2);
+    StreamingQueue::SetThreadPool(&pool);
+    {
+        std::vector<Destination> destinations(textureCount);
+        StreamingQueue queue;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<StreamHandle> handles;
+        for (int i = 0; i < textureCount; i++)
+        {
+            // The last ones submitted are the ones the camera looks at
+            int priority = i >= textureCount - important ? 1 : 0;
+            handles.push_back(queue.Submit(MakeRequest(filenames[i], destinations[i], priority)));
+        }
+        for (int i = 0; i < cancelled; i++)
+            queue.Cancel(handles[textureCount / 2 + i]);
+        double submitMs = ElapsedMs(start);
+
+        int frames = 0;
+        int importantFrame = -1;
+        double worstMs = 0.0;
+        double totalMs = 0.0;
+        while (queue.GetPendingCount() > 0)
+        {
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            queue.Update(budget);
+            double ms = ElapsedMs(frameStart);
+            worstMs = std::max(worstMs, ms);
+            totalMs += ms;
+            frames++;
+
+            bool importantDone = std::all_of(destinations.end() - important, destinations.end(),
+                                             [](const Destination& d) { return d.committed; });
+            if (importantDone && importantFrame < 0)
+                importantFrame = frames;
+
+            // The rest of the frame
+            std::this_thread::sleep_for(std::chrono::milliseconds(8));
+        }
+
+        StreamingQueue::Stats stats = queue.GetStats();
+        printf("  streaming     %8.2f ms blocked submitting, %.3f ms per frame on average, %.3f ms worst\n",
+               submitMs, frames > 0 ? totalMs / frames : 0.0, worstMs);
+        printf("                %d frames, %zu committed (%.1f MB), %zu cancelled, %zu failed,"
+               " high priority done by frame %d\n",
+               frames, stats.committed, stats.committedBytes / (1024.0 * 1024.0), stats.cancelled, stats.failed,
+               importantFrame);
+    }
+    StreamingQueue::SetThreadPool(nullptr);
+
+    for (const std::string& filename : filenames)
+        std::filesystem::remove(filename);
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+// Loading baked .etex texture files (TextureFile) for a 2048^2 mip chain:
+// memory-mapping the file and copying each level into its destination (what
+// Texture::CreateFromTextureFile does with the locked levels) against reading
+// the file into a buffer first, for 32-bit and block-compressed data, plus
+// the cost of checking the content hash. The files were just written, so
+// this measures a warm page cache: the CPU side of loading, not the disk.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/TextureFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+double MeasureMs(const std::function<void()>& func)
+{
+    double best = 0.0;
+    for (int run = 0; run < 5; run++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+void FillSource(const ImageView& image)
+{
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            float detail = 0.5f + 0.5f * sinf(x * 0.05f) * cosf(y * 0.07f);
+            image.At(x, y) = D3DCOLOR_ARGB(255, x & 255, y & 255, static_cast<int>(detail * 255.0f));
+        }
+    }
+}
+
+// Destination of every level, as the locked texture would be
+struct Destination {
+    std::vector<std::vector<uint8_t>> levels;
+
+    void Allocate(const TextureFile& file)
+    {
+        levels.resize(file.GetLevelCount());
+        for (int i = 0; i < file.GetLevelCount(); i++)
+            levels[i].resize(static_cast<size_t>(file.GetLevel(i).size));
+    }
+};
+
+// The file read into memory, then each level copied from the buffer
+void LoadBuffered(const std::string& filename, const TextureFile& layout, Destination& destination)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), buffer.size());
+
+    for (int i = 0; i < layout.GetLevelCount(); i++)
+    {
+        const TextureFileLevel& level = layout.GetLevel(i);
+        memcpy(destination.levels[i].data(), buffer.data() + level.offset, static_cast<size_t>(level.size));
+    }
+}
+
+// The file mapped, each level copied once from the mapping
+void LoadMapped(const std::string& filename, bool verify, Destination& destination)
+{
+    TextureFile file;
+    if (!file.Open(filename) || (verify && !file.VerifyContentHash()))
+    {
+        printf("failed to load %s\n", filename.c_str());
+        return;
+    }
+
+    for (int i = 0; i < file.GetLevelCount(); i++)
+        memcpy(destination.levels[i].data(), file.GetLevelData(i), static_cast<size_t>(file.GetLevel(i).size));
+}
+
+} // namespace
+
+int main()
+{
+    const int size = 2048;
+    PixelBuffer source(size, size);
+    FillSource(source.GetView());
+
+    MipChain chain;
+    MipOptions options;
+    options.filter = ResampleFilter::Box;
+    chain.Build(source.GetView(), options);
+
+    struct Case {
+        const char* name;
+        TextureFileFormat format;
+    };
+    const Case cases[] = {
+        { "A8R8G8B8", TextureFileFormat::A8R8G8B8 },
+        { "BC1", TextureFileFormat::BC1 },
+        { "BC3", TextureFileFormat::BC3 },
+    };
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+
+    printf("%d^2 with %d levels, ms (MB/s)\n", size, chain.GetLevelCount());
+    printf("  %-10s %8s %18s %18s %18s\n", "format", "MB", "read + copy", "mapped + copy", "mapped + hash");
+
+    for (const Case& test : cases)
+    {
+        std::string filename = (directory / (std::string("TextureFileBenchmark_") + test.name + ".etex")).string();
+        if (!TextureFile::WriteMipChain(filename, chain, test.format))
+        {
+            printf("failed to write %s\n", filename.c_str());
+            return 1;
+        }
+
+        TextureFile layout;
+        layout.Open(filename);
+        Destination destination;
+        destination.Allocate(layout);
+        double megabytes = layout.GetFileSize() / (1024.0 * 1024.0);
+
+        double buffered = MeasureMs([&]() { LoadBuffered(filename, layout, destination); });
+        double mapped = MeasureMs([&]() { LoadMapped(filename, false, destination); });
+        double verified = MeasureMs([&]() { LoadMapped(filename, true, destination); });
+
+        printf("  %-10s %8.1f %8.2f (%7.0f) %8.2f (%7.0f) %8.2f (%7.0f)\n", test.name, megabytes, buffered,
+               megabytes / (buffered / 1000.0), mapped, megabytes / (mapped / 1000.0), verified,
+               megabytes / (verified / 1000.0));
+
+        layout.Close();
+        std::filesystem::remove(filename);
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Texture memory with LOD streaming: a camera flies over a grid of objects,
+// each with its own 1024^2 32-bit texture. Every frame the visible ones
+// report their screen size and each TextureLod says which levels it wants;
+// loads are applied at once. Compares resident bytes with keeping every
+// level, and counts the bytes loaded and the level changes, with and
+// without the drop delay.
+// Build with -DDX9ENGINE_BUILD_BENCHMARKS=ON; runs without Direct3D.
+
+#include "Textures/Effects/TextureLod.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+struct Object {
+    float x;
+    float z;
+    TextureLod lod;
+};
+
+struct Result {
+    double averageBytes = 0.0;
+    size_t peakBytes = 0;
+    size_t loadedBytes = 0;
+    int changes = 0;
+    double updateMs = 0.0;
+};
+
+Result Run(int gridSize, float spacing, int frames, int dropDelay)
+{
+    const float radius = 4.0f;
+    const float fovY = 3.14159265f / 4.0f;
+    const float aspect = 16.0f / 9.0f;
+    const int viewportHeight = 720;
+    const float halfFovX = std::atan(std::tan(fovY * 0.5f) * aspect);
+
+    std::vector<Object> objects;
+    for (int z = 0; z < gridSize; z++)
+    {
+        for (int x = 0; x < gridSize; x++)
+            objects.push_back({ x * spacing, z * spacing,
+                                TextureLod(TextureFileFormat::A8R8G8B8, 1024, 1024, 11, 64, dropDelay) });
+    }
+
+    Result result;
+    double totalBytes = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        // Down the middle of the grid, turning slowly, with a little shake
+        // that moves objects in and out at the edges of the view
+        float t = static_cast<float>(frame) / frames;
+        float cameraX = gridSize * spacing * 0.5f + std::sin(t * 6.2831853f) * spacing * 3.0f;
+        float cameraZ = -spacing + t * (gridSize + 1) * spacing;
+        float heading = std::sin(t * 12.566371f) * 0.6f + std::sin(frame * 0.9f) * 0.05f;
+
+        size_t resident = 0;
+        for (Object& object : objects)
+        {
+            float dx = object.x - cameraX;
+            float dz = object.z - cameraZ;
+            float forward = dx * std::sin(heading) + dz * std::cos(heading);
+            float side = dx * std::cos(heading) - dz * std::sin(heading);
+            float distance = std::sqrt(dx * dx + dz * dz + 4.0f);
+
+            bool visible = forward > -radius && std::fabs(std::atan2(side, std::max(forward, 0.001f))) < halfFovX;
+            if (visible)
+                object.lod.RequestSize(GetProjectedSize(radius, distance, fovY, viewportHeight));
+
+            int level = object.lod.Update();
+            if (level != object.lod.GetResidentLevel())
+            {
+                if (level < object.lod.GetResidentLevel())
+                    result.loadedBytes += object.lod.GetBytes(level);
+                object.lod.SetResidentLevel(level);
+                result.changes++;
+            }
+            resident += object.lod.GetResidentBytes();
+        }
+
+        totalBytes += static_cast<double>(resident);
+        result.peakBytes = std::max(result.peakBytes, resident);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    result.averageBytes = totalBytes / frames;
+    result.updateMs = std::chrono::duration<double, std::milli>(end - start).count() / frames;
+    return result;
+}
+
+} // namespace
+
+int main()
+{
+    const int gridSize = 16;
+    const float spacing = 10.0f;
+    const int frames = 3000;
+    const double megabyte = 1024.0 * 1024.0;
+
+    size_t fullBytes = GetLevelRangeBytes(TextureFileFormat::A8R8G8B8, 1024, 1024, 0, 11) * gridSize * gridSize;
+    printf("%d textures of 1024^2 (32-bit, 11 levels), %d frames\n", gridSize * gridSize, frames);
+    printf("  every level       %8.1f MB resident, %8.1f MB loaded\n", fullBytes / megabyte, fullBytes / megabyte);
+
+    for (int dropDelay : { 0, 30 })
+    {
+        Result result = Run(gridSize, spacing, frames, dropDelay);
+        printf("  LOD, delay %2d     %8.1f MB resident on average, %.1f MB peak, %8.1f MB loaded,"
+               " %d level changes, %.3f ms per frame\n",
+               dropDelay, result.averageBytes / megabyte, result.peakBytes / megabyte, result.loadedBytes / megabyte,
+               result.changes, result.updateMs);
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "CpuFeatures.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_FEATURES_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+#if defined(CPU_FEATURES_X86) && defined(_MSC_VER)
+bool DetectAVX2()
+{
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // OSXSAVE + AVX, and the OS must save YMM state on context switches
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx)
+        return false;
+
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+#endif
+
+} // namespace
+
+bool CpuFeatures::HasSSE2()
+{
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool CpuFeatures::HasAVX2()
+{
+#if defined(CPU_FEATURES_X86) && defined(_MSC_VER)
+    static const bool hasAVX2 = DetectAVX2();
+    return hasAVX2;
+#elif defined(CPU_FEATURES_X86) && (defined(__GNUC__) || defined(__clang__))
+    // May run during static initialisation, before libgcc has probed the CPU
+    static const bool hasAVX2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+    return hasAVX2;
+#else
+    return false;
+#endif
+}
+
+SimdLevel CpuFeatures::GetMaxSimdLevel()
+{
+    if (HasAVX2())
+        return SimdLevel::AVX2;
+    if (HasSSE2())
+        return SimdLevel::SSE2;
+    return SimdLevel::Scalar;
+}
+
+const char* CpuFeatures::GetSimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::SSE2:
+        return "SSE2";
+    case SimdLevel::Scalar:
+    default:
+        return "Scalar";
+    }
+}
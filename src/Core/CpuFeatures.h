@@ -0,0 +1,19 @@
+#pragma once
+
+// Runtime CPU feature detection. Platform-neutral: no windows.h dependency.
+
+enum class SimdLevel {
+    Scalar = 0,
+    SSE2,
+    AVX2
+};
+
+class CpuFeatures {
+public:
+    static bool HasSSE2();
+    static bool HasAVX2();
+
+    // Highest instruction set usable by the compiled kernels on this CPU
+    static SimdLevel GetMaxSimdLevel();
+    static const char* GetSimdLevelName(SimdLevel level);
+};
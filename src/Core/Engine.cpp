@@ -58,6 +58,11 @@ bool Engine::Initialize(int width, int height, const std::string& title)
         return false;
     }
 
+    // Las texturas de efectos son dinámicas y se recrean en cada reset
+    m_renderer->SetDeviceResetCallbacks(
+        [] { g_effectManager.OnLostDevice(); },
+        [] { g_effectManager.OnResetDevice(); });
+
     // Crear texture manager
     m_textureManager = std::make_unique<TextureManager>();
     if (!m_textureManager->Initialize(m_renderer->GetDevice()))
@@ -163,6 +168,10 @@ void Engine::Update(float deltaTime)
     // Actualizar efectos de texturas
     g_effectManager.Update(deltaTime);
 
+    // Nuevo frame de texturas: confirmar las cargas en segundo plano y
+    // expulsar las menos usadas si se pasa del presupuesto
+    m_textureManager->BeginFrame();
+
     // Actualizar materiales animados
     if (m_cube && m_cube->GetMaterial())
     {
@@ -289,6 +298,13 @@ void Engine::Render()
         rotation += m_timer->GetDeltaTime() * 0.5f;
         D3DXMatrixRotationYawPitchRoll(&worldMatrix, rotation, rotation * 0.7f, 0.0f);
 
+        // Tamaño en pantalla: decide qué niveles de sus texturas se cargan
+        D3DXVECTOR3 center = m_cube->GetBoundsCenter();
+        D3DXVec3TransformCoord(&center, &center, &worldMatrix);
+        float screenSize = m_camera->GetScreenSize(center, m_cube->GetBoundsRadius(),
+                                                   static_cast<int>(m_renderer->GetViewport().Height));
+        m_textureManager->RequestMaterialSize(*m_cube->GetMaterial(), screenSize);
+
         m_renderer->RenderMesh(m_cube.get(), m_cube->GetMaterial().get(), worldMatrix);
     }
 
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory-mapped file. Pages are loaded by the OS on first touch,
+// so opening is cheap and the data is never copied into a buffer.
+// Platform-neutral: file mapping on Windows, mmap elsewhere.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Fails for missing or empty files
+    bool Open(const std::string& filename);
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+    const uint8_t* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+
+#if defined(_WIN32)
+    void* m_file;
+    void* m_mapping;
+#endif
+};
@@ -0,0 +1,166 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace {
+
+// Shared by the caller and the helpers of one ParallelFor call. Helpers that
+// start after every index was claimed only touch this block, which they keep
+// alive through their shared_ptr.
+struct ParallelForState {
+    std::function<void(int)> func;
+    int count = 0;
+    std::atomic<int> next{ 0 };
+    std::atomic<bool> failed{ false };
+    int completed = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable done;
+
+    void Run()
+    {
+        int finished = 0;
+        for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+        {
+            // Once an index throws, the rest are only counted, so the caller
+            // still wakes up and rethrows
+            if (!failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    func(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                    failed = true;
+                }
+            }
+            finished++;
+        }
+
+        if (finished > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            completed += finished;
+            if (completed == count)
+                done.notify_all();
+        }
+    }
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(int threadCount)
+    : m_stopping(false)
+{
+    if (threadCount < 0)
+    {
+        int hardware = static_cast<int>(std::thread::hardware_concurrency());
+        threadCount = std::max(0, hardware - 1);
+    }
+
+    m_threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; i++)
+    {
+        m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task)
+{
+    std::packaged_task<void()> packaged(std::move(task));
+    std::future<void> result = packaged.get_future();
+
+    if (m_threads.empty())
+    {
+        packaged();
+        return result;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(packaged));
+    }
+    m_condition.notify_one();
+    return result;
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)>& func)
+{
+    if (count <= 0)
+        return;
+
+    if (count == 1 || m_threads.empty())
+    {
+        for (int i = 0; i < count; i++)
+        {
+            func(i);
+        }
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->func = func;
+    state->count = count;
+
+    int helpers = std::min(GetThreadCount(), count - 1);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int i = 0; i < helpers; i++)
+        {
+            m_tasks.push(std::packaged_task<void()>([state]() { state->Run(); }));
+        }
+    }
+    m_condition.notify_all();
+
+    state->Run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]() { return state->completed == count; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+ThreadPool& ThreadPool::Default()
+{
+    static ThreadPool instance;
+    return instance;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    for (;;)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+            if (m_stopping && m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
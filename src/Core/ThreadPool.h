@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool. Platform-neutral: only uses std::thread.
+class ThreadPool {
+public:
+    // threadCount < 0 uses one worker per hardware thread minus one, since
+    // the thread calling ParallelFor also does work. 0 runs everything on
+    // the calling thread.
+    explicit ThreadPool(int threadCount = -1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int GetThreadCount() const { return static_cast<int>(m_threads.size()); }
+
+    // Queue a task for any worker
+    std::future<void> Submit(std::function<void()> task);
+
+    // Run func(i) for every i in [0, count) and wait for completion. The
+    // calling thread takes part, so this is safe to call from a worker and
+    // runs inline on a pool without workers. If func throws, the indices not
+    // yet started are skipped and the first exception is rethrown here once
+    // every thread has left func.
+    void ParallelFor(int count, const std::function<void(int)>& func);
+
+    // Shared pool used by the texture generators
+    static ThreadPool& Default();
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_threads;
+    std::queue<std::packaged_task<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+};
@@ -1,4 +1,5 @@
 #include "Camera.h"
+#include "../Textures/Effects/TextureLod.h"
 #include <algorithm>
 
 Camera::Camera()
@@ -399,6 +400,16 @@ bool Camera::IsSphereInFrustum(const D3DXVECTOR3& center, float radius) const
     return true;
 }
 
+float Camera::GetScreenSize(const D3DXVECTOR3& center, float radius, int viewportHeight) const
+{
+    // Sin el tamaño de la vista ortográfica no hay estimación: todo el alto
+    if (m_orthographic)
+        return static_cast<float>(viewportHeight);
+
+    D3DXVECTOR3 offset = center - m_position;
+    return TextureEffects::GetProjectedSize(radius, D3DXVec3Length(&offset), m_fov, viewportHeight);
+}
+
 void Camera::Reset()
 {
     m_position = D3DXVECTOR3(0.0f, 0.0f, -5.0f);
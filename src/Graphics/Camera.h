@@ -87,6 +87,8 @@ public:
     void Reset();
     D3DXVECTOR3 ScreenToWorld(int screenX, int screenY, int screenWidth, int screenHeight, float depth = 1.0f) const;
     D3DXVECTOR3 WorldToScreen(const D3DXVECTOR3& worldPos, int screenWidth, int screenHeight) const;
+    // Pixels across a bounding sphere covers (texture LOD streaming)
+    float GetScreenSize(const D3DXVECTOR3& center, float radius, int viewportHeight) const;
 
     // Frustum culling
     bool IsPointInFrustum(const D3DXVECTOR3& point) const;
@@ -279,6 +279,10 @@ bool Renderer::ResetDevice()
     if (!m_device)
         return false;
 
+    // Los recursos en D3DPOOL_DEFAULT deben liberarse antes del reset
+    if (m_onLostDevice)
+        m_onLostDevice();
+
     HRESULT hr = m_device->Reset(&m_presentParams);
 
     if (SUCCEEDED(hr))
@@ -286,12 +290,21 @@ bool Renderer::ResetDevice()
         m_deviceLost = false;
         SetupDefaultStates();
         CreateMatrices();
+
+        if (m_onResetDevice)
+            m_onResetDevice();
         return true;
     }
 
     return false;
 }
 
+void Renderer::SetDeviceResetCallbacks(std::function<void()> onLost, std::function<void()> onReset)
+{
+    m_onLostDevice = std::move(onLost);
+    m_onResetDevice = std::move(onReset);
+}
+
 void Renderer::HandleDeviceLost()
 {
     // Esperar hasta que el dispositivo pueda ser reseteado
@@ -3,6 +3,7 @@
 #include <d3d9.h>
 #include <d3dx9.h>
 #include <windows.h>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -42,6 +43,10 @@ public:
     bool ResetDevice();
     void HandleDeviceLost();
 
+    // Called right before and after a successful IDirect3DDevice9::Reset,
+    // to release and recreate D3DPOOL_DEFAULT resources
+    void SetDeviceResetCallbacks(std::function<void()> onLost, std::function<void()> onReset);
+
     // Rendering
     void SetupMatrices(const Camera* camera);
     void RenderMesh(const Mesh* mesh, const Material* material, const D3DXMATRIX& worldMatrix);
@@ -82,6 +87,8 @@ private:
 
     // Device state
     bool m_deviceLost;
+    std::function<void()> m_onLostDevice;
+    std::function<void()> m_onResetDevice;
     HWND m_hwnd;
     int m_width;
     int m_height;
@@ -1,94 +1,163 @@
 #include "AnimatedEffects.h"
 #include "NoiseGenerator.h"
-#include "../Texture.h"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 namespace TextureEffects {
 
-void AnimatedEffects::UpdateLavaTexture(std::shared_ptr<Texture> texture, const LavaParams& params)
+void AnimatedEffects::RenderLava(const LavaParams& params, const ImageView& image)
 {
-    if (!texture)
+    if (!image.IsValid())
         return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
-
-    for (int y = 0; y < height; y++)
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
+
+    // Generar noise para lava con múltiples octavas, por bandas de filas
+    NoiseParams noiseParams;
+    noiseParams.fractal = NoiseFractal::Turbulence;
+    noiseParams.frequency = params.noiseScale;
+    noiseParams.octaves = 4;
+
+    const int bandRows = 64;
+    std::vector<float> band(static_cast<size_t>(width) * bandRows);
+    float dx = 1.0f / width;
+    float dy = 1.0f / height;
+
+    const float twoPi = 6.28318530718f;
+    bool looping = params.loopPeriod > 0.0f;
+
+    // Animación con offset temporal. En bucle no hay desplazamiento: el tiempo
+    // recorre un círculo en 4D con la misma velocidad que el scroll
+    float offsetU = looping ? 0.0f : params.scrollSpeedU * params.time;
+    float offsetV = looping ? 0.0f : params.scrollSpeedV * params.time;
+    float loopPhase = looping ? params.time / params.loopPeriod : 0.0f;
+    float loopRadius = std::max(0.05f, sqrtf(params.scrollSpeedU * params.scrollSpeedU +
+                                             params.scrollSpeedV * params.scrollSpeedV) * params.loopPeriod / twoPi);
+
+    // Añadir pulsación (constante para todo el frame)
+    float pulseCycles = LoopCycles(params.time, params.pulseFrequency / twoPi, params.loopPeriod);
+    float pulse = sinf(pulseCycles * twoPi) * 0.1f + 0.9f;
+    float flowPhase = LoopCycles(params.time, 3.0f / twoPi, params.loopPeriod) * twoPi;
+
+    for (int y0 = 0; y0 < height; y0 += bandRows)
     {
-        for (int x = 0; x < width; x++)
+        int rows = std::min(bandRows, height - y0);
+        if (looping)
         {
-            float fx = static_cast<float>(x) / width;
-            float fy = static_cast<float>(y) / height;
-
-            // Animación con offset temporal
-            float animX = fx + params.scrollSpeedU * params.time;
-            float animY = fy + params.scrollSpeedV * params.time;
-
-            // Generar noise para lava con múltiples octavas
-            float noise = NoiseGenerator::Turbulence2D(animX, animY, params.noiseScale, 4);
+            NoiseGenerator::EvaluateLoopGrid(noiseParams, 0.0f, static_cast<float>(y0) * dy, dx, dy,
+                                             width, rows, loopPhase, loopRadius, band.data(), width);
+        }
+        else
+        {
+            NoiseGenerator::EvaluateGrid(noiseParams, offsetU, static_cast<float>(y0) * dy + offsetV, dx, dy,
+                                         width, rows, band.data(), width);
+        }
 
-            // Añadir pulsación
-            float pulse = sinf(params.time * params.pulseFrequency) * 0.1f + 0.9f;
-            noise *= pulse;
+        for (int row = 0; row < rows; row++)
+        {
+            int y = y0 + row;
+            float animY = static_cast<float>(y) / height + offsetV;
+            const float* turbulence = band.data() + static_cast<size_t>(row) * width;
 
             // Crear efecto de flujo vertical
-            float flow = sinf(animY * 8.0f + params.time * 3.0f) * 0.1f;
-            noise += flow;
+            float flow = sinf(animY * 8.0f + flowPhase) * 0.1f;
 
-            noise = std::max(0.0f, std::min(1.0f, noise));
+            for (int x = 0; x < width; x++)
+            {
+                float noise = turbulence[x] * pulse + flow;
+                noise = std::max(0.0f, std::min(1.0f, noise));
 
-            // Interpolar colores
-            D3DCOLOR color = NoiseGenerator::NoiseToColor(noise, params.baseColor, params.hotColor);
+                // Interpolar colores
+                D3DCOLOR color = NoiseGenerator::NoiseToColor(noise, params.baseColor, params.hotColor);
 
-            // Añadir emisión para las zonas más calientes
-            if (noise > 0.7f)
-            {
-                color = ApplyGlow(color, params.glowIntensity * (noise - 0.7f) / 0.3f);
-            }
+                // Añadir emisión para las zonas más calientes
+                if (noise > 0.7f)
+                {
+                    color = ApplyGlow(color, params.glowIntensity * (noise - 0.7f) / 0.3f);
+                }
 
-            pixels[y * pitch + x] = color;
+                pixels[y * pitch + x] = color;
+            }
         }
     }
-
-    texture->Unlock();
 }
 
-void AnimatedEffects::UpdateWaterTexture(std::shared_ptr<Texture> texture, const WaterParams& params)
+void AnimatedEffects::RenderWater(const WaterParams& params, const ImageView& image)
 {
-    if (!texture)
+    if (!image.IsValid())
         return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
+
+    // Efecto de profundidad, evaluado por bandas de filas
+    NoiseParams depthParams;
+    depthParams.frequency = 2.0f;
+    depthParams.octaves = 3;
+
+    const int bandRows = 64;
+    std::vector<float> band(static_cast<size_t>(width) * bandRows);
+    float dx = 1.0f / width;
+    float dy = 1.0f / height;
+
+    std::vector<CellularResult> causticRow(width);
+
+    // Fases de las ondas en ciclos; en bucle se redondean a ciclos enteros
+    float phase1X = LoopCycles(params.time, params.waveSpeed, params.loopPeriod);
+    float phase1Y = LoopCycles(params.time, params.waveSpeed * 0.7f, params.loopPeriod);
+    float phase2X = LoopCycles(params.time, params.waveSpeed * 0.96f, params.loopPeriod);
+    float phase2Y = LoopCycles(params.time, params.waveSpeed * 0.96f * 0.7f, params.loopPeriod);
+
+    // Los cáusticos se desplazan en línea recta, o en círculo si hay bucle
+    float causticU = params.time * 0.1f;
+    float causticV = params.time * 0.15f;
+    if (params.loopPeriod > 0.0f)
+    {
+        float angle = LoopCycles(params.time, 1.0f / params.loopPeriod, params.loopPeriod) * 6.28318530718f;
+        float radius = 0.15f * params.loopPeriod / 6.28318530718f;
+        causticU = cosf(angle) * radius;
+        causticV = sinf(angle) * radius;
+    }
 
     for (int y = 0; y < height; y++)
     {
+        int bandRow = y % bandRows;
+        if (bandRow == 0)
+        {
+            int rows = std::min(bandRows, height - y);
+            NoiseGenerator::EvaluateGrid(depthParams, 0.0f, static_cast<float>(y) * dy, dx, dy,
+                                         width, rows, band.data(), width);
+        }
+
+        const float* depthRow = band.data() + static_cast<size_t>(bandRow) * width;
+        float fy = static_cast<float>(y) / height;
+
+        // Cáusticos de la fila completa en una sola pasada celular
+        if (params.causticStrength > 0.0f)
+        {
+            const float causticFrequency = 8.0f;
+            NoiseGenerator::CellularRow(causticU * causticFrequency,
+                                        (fy + causticV) * causticFrequency,
+                                        causticFrequency / width, width, CellularMetric::Euclidean, causticRow.data());
+        }
+
         for (int x = 0; x < width; x++)
         {
             float fx = static_cast<float>(x) / width;
-            float fy = static_cast<float>(y) / height;
 
             // Calcular ondas de agua
-            float wave1 = CalculateWaveHeight(fx, fy, params.time, params.waveSpeed, params.waveScale);
-            float wave2 = CalculateWaveHeight(fx * 1.3f, fy * 0.7f, params.time * 1.2f, params.waveSpeed * 0.8f, params.waveScale * 1.5f);
+            float wave1 = CalculateWaveHeight(fx, fy, phase1X, phase1Y, params.waveScale);
+            float wave2 = CalculateWaveHeight(fx * 1.3f, fy * 0.7f, phase2X, phase2Y, params.waveScale * 1.5f);
 
             float combinedWaves = (wave1 + wave2) * 0.5f;
 
-            // Efecto de profundidad
-            float depth = NoiseGenerator::Perlin2D(fx, fy, 2.0f, 3) * 0.3f + 0.7f;
+            float depth = depthRow[x] * 0.3f + 0.7f;
 
             // Combinar profundidad con ondas
             float waterLevel = depth + combinedWaves * 0.2f;
@@ -107,7 +176,7 @@ void AnimatedEffects::UpdateWaterTexture(std::shared_ptr<Texture> texture, const
             // Añadir cáusticos
             if (params.causticStrength > 0.0f)
             {
-                float caustics = NoiseGenerator::VoronoiNoise2D(fx + params.time * 0.1f, fy + params.time * 0.15f, 8.0f);
+                float caustics = std::min(1.0f, causticRow[x].f1);
                 caustics = NoiseGenerator::ThresholdNoise(caustics, 0.2f, 0.1f) * params.causticStrength;
 
                 if (caustics > 0.0f)
@@ -119,23 +188,17 @@ void AnimatedEffects::UpdateWaterTexture(std::shared_ptr<Texture> texture, const
             pixels[y * pitch + x] = waterColor;
         }
     }
-
-    texture->Unlock();
 }
 
-void AnimatedEffects::UpdateFireTexture(std::shared_ptr<Texture> texture, const FireParams& params)
+void AnimatedEffects::RenderFire(const FireParams& params, const ImageView& image)
 {
-    if (!texture)
+    if (!image.IsValid())
         return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
     for (int y = 0; y < height; y++)
     {
@@ -184,23 +247,17 @@ void AnimatedEffects::UpdateFireTexture(std::shared_ptr<Texture> texture, const
             pixels[y * pitch + x] = color;
         }
     }
-
-    texture->Unlock();
 }
 
-void AnimatedEffects::UpdatePlasmaTexture(std::shared_ptr<Texture> texture, const PlasmaParams& params)
+void AnimatedEffects::RenderPlasma(const PlasmaParams& params, const ImageView& image)
 {
-    if (!texture)
+    if (!image.IsValid())
         return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
     for (int y = 0; y < height; y++)
     {
@@ -231,23 +288,17 @@ void AnimatedEffects::UpdatePlasmaTexture(std::shared_ptr<Texture> texture, cons
             pixels[y * pitch + x] = D3DCOLOR_ARGB(255, red, green, blue);
         }
     }
-
-    texture->Unlock();
 }
 
-void AnimatedEffects::UpdateElectricTexture(std::shared_ptr<Texture> texture, const ElectricParams& params)
+void AnimatedEffects::RenderElectric(const ElectricParams& params, const ImageView& image)
 {
-    if (!texture)
+    if (!image.IsValid())
         return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
     for (int y = 0; y < height; y++)
     {
@@ -294,8 +345,6 @@ void AnimatedEffects::UpdateElectricTexture(std::shared_ptr<Texture> texture, co
             pixels[y * pitch + x] = color;
         }
     }
-
-    texture->Unlock();
 }
 
 // Helper functions
@@ -318,14 +367,28 @@ float AnimatedEffects::CalculateFlameShape(float x, float y, float height, float
     return heightFactor * centerFactor;
 }
 
-float AnimatedEffects::CalculateWaveHeight(float x, float y, float time, float speed, float scale)
+float AnimatedEffects::CalculateWaveHeight(float x, float y, float phaseX, float phaseY, float scale)
 {
-    float wave1 = sinf((x * scale + time * speed) * 2.0f * 3.14159f);
-    float wave2 = cosf((y * scale * 1.3f + time * speed * 0.7f) * 2.0f * 3.14159f);
+    float wave1 = sinf((x * scale + phaseX) * 2.0f * 3.14159f);
+    float wave2 = cosf((y * scale * 1.3f + phaseY) * 2.0f * 3.14159f);
 
     return (wave1 + wave2) * 0.5f;
 }
 
+float AnimatedEffects::LoopCycles(float time, float cyclesPerSecond, float loopPeriod)
+{
+    if (loopPeriod <= 0.0f)
+        return time * cyclesPerSecond;
+
+    // Número entero de ciclos por periodo, lo más cerca posible de la velocidad pedida
+    float cycles = std::max(1.0f, roundf(fabsf(cyclesPerSecond) * loopPeriod));
+    if (cyclesPerSecond < 0.0f)
+        cycles = -cycles;
+
+    float phase = time / loopPeriod;
+    return (phase - floorf(phase)) * cycles;
+}
+
 D3DCOLOR AnimatedEffects::ApplyGlow(D3DCOLOR baseColor, float glowIntensity)
 {
     glowIntensity = std::max(0.0f, std::min(2.0f, glowIntensity));
@@ -342,19 +405,15 @@ D3DCOLOR AnimatedEffects::ApplyGlow(D3DCOLOR baseColor, float glowIntensity)
     return D3DCOLOR_ARGB(a, r, g, b);
 }
 
-void AnimatedEffects::UpdateEnergyTexture(std::shared_ptr<Texture> texture, const EnergyParams& params)
+void AnimatedEffects::RenderEnergy(const EnergyParams& params, const ImageView& image)
 {
-    if (!texture)
+    if (!image.IsValid())
         return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
     float centerX = 0.5f;
     float centerY = 0.5f;
@@ -405,23 +464,17 @@ void AnimatedEffects::UpdateEnergyTexture(std::shared_ptr<Texture> texture, cons
             pixels[y * pitch + x] = color;
         }
     }
-
-    texture->Unlock();
 }
 
-void AnimatedEffects::UpdateSwirlTexture(std::shared_ptr<Texture> texture, const SwirlParams& params)
+void AnimatedEffects::RenderSwirl(const SwirlParams& params, const ImageView& image)
 {
-    if (!texture)
+    if (!image.IsValid())
         return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
     for (int y = 0; y < height; y++)
     {
@@ -466,8 +519,6 @@ void AnimatedEffects::UpdateSwirlTexture(std::shared_ptr<Texture> texture, const
             pixels[y * pitch + x] = color;
         }
     }
-
-    texture->Unlock();
 }
 
 } // namespace TextureEffects
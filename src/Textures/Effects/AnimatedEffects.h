@@ -1,12 +1,15 @@
 #pragma once
 
-#include <d3d9.h>
 #include <memory>
+#include "PixelBuffer.h"
 
 class Texture;
 
 namespace TextureEffects {
 
+    // Every effect renders one frame into an ImageView with Render*. It
+    // touches no device state, so it can run on any thread. Update*Texture
+    // (engine build) locks the texture and renders straight into it.
     class AnimatedEffects {
     public:
         // Lava effect
@@ -18,10 +21,12 @@ namespace TextureEffects {
             float noiseScale = 2.0f;
             float glowIntensity = 2.0f;
             float pulseFrequency = 1.0f;
+            float loopPeriod = 0.0f;     // > 0: la animación se repite exactamente cada loopPeriod segundos
             float time = 0.0f;
         };
 
         static void UpdateLavaTexture(std::shared_ptr<Texture> texture, const LavaParams& params);
+        static void RenderLava(const LavaParams& params, const ImageView& image);
 
         // Water effect
         struct WaterParams {
@@ -32,10 +37,12 @@ namespace TextureEffects {
             float waveScale = 4.0f;
             float foamAmount = 0.3f;
             float causticStrength = 0.5f;
+            float loopPeriod = 0.0f;     // > 0: la animación se repite exactamente cada loopPeriod segundos
             float time = 0.0f;
         };
 
         static void UpdateWaterTexture(std::shared_ptr<Texture> texture, const WaterParams& params);
+        static void RenderWater(const WaterParams& params, const ImageView& image);
 
         // Fire effect
         struct FireParams {
@@ -50,6 +57,7 @@ namespace TextureEffects {
         };
 
         static void UpdateFireTexture(std::shared_ptr<Texture> texture, const FireParams& params);
+        static void RenderFire(const FireParams& params, const ImageView& image);
 
         // Plasma effect
         struct PlasmaParams {
@@ -65,6 +73,7 @@ namespace TextureEffects {
         };
 
         static void UpdatePlasmaTexture(std::shared_ptr<Texture> texture, const PlasmaParams& params);
+        static void RenderPlasma(const PlasmaParams& params, const ImageView& image);
 
         // Electric effect
         struct ElectricParams {
@@ -78,6 +87,7 @@ namespace TextureEffects {
         };
 
         static void UpdateElectricTexture(std::shared_ptr<Texture> texture, const ElectricParams& params);
+        static void RenderElectric(const ElectricParams& params, const ImageView& image);
 
         // Energy field effect
         struct EnergyParams {
@@ -91,6 +101,7 @@ namespace TextureEffects {
         };
 
         static void UpdateEnergyTexture(std::shared_ptr<Texture> texture, const EnergyParams& params);
+        static void RenderEnergy(const EnergyParams& params, const ImageView& image);
 
         // Swirl effect
         struct SwirlParams {
@@ -104,11 +115,13 @@ namespace TextureEffects {
         };
 
         static void UpdateSwirlTexture(std::shared_ptr<Texture> texture, const SwirlParams& params);
+        static void RenderSwirl(const SwirlParams& params, const ImageView& image);
 
     private:
         // Helper functions
         static float CalculateFlameShape(float x, float y, float height, float time);
-        static float CalculateWaveHeight(float x, float y, float time, float speed, float scale);
+        static float CalculateWaveHeight(float x, float y, float phaseX, float phaseY, float scale);
+        static float LoopCycles(float time, float cyclesPerSecond, float loopPeriod);
         static D3DCOLOR ApplyGlow(D3DCOLOR baseColor, float glowIntensity);
     };
 
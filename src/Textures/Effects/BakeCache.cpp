@@ -0,0 +1,235 @@
+#include "BakeCache.h"
+#include <cmath>
+#include <cstdio>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+namespace TextureEffects {
+
+namespace {
+
+// Tags keep differently typed parameters with the same bytes apart
+enum KeyTag : uint8_t {
+    kTagInt = 1,
+    kTagFloat,
+    kTagBool,
+    kTagColor,
+    kTagString,
+    kTagMipOptions
+};
+
+std::string FormatHash(uint64_t hash)
+{
+    char text[17];
+    snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+// Name for a file written aside before being renamed into place. The
+// random token is drawn once per process and the counter tells this
+// process's writes apart, so neither another thread nor another process
+// sharing the cache directory picks the same name.
+std::string MakeTemporaryPath(const std::string& path)
+{
+    static const uint64_t processToken = [] {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) ^ device();
+    }();
+    static std::atomic<uint64_t> counter{0};
+
+    return path + ".tmp" + FormatHash(processToken) + "-" + std::to_string(counter.fetch_add(1));
+}
+
+} // namespace
+
+BakeKey::BakeKey(const std::string& generator, int version, int width, int height)
+    : m_generator(generator)
+    , m_width(width)
+    , m_height(height)
+{
+    Add(generator);
+    Add(version);
+    Add(width);
+    Add(height);
+}
+
+BakeKey& BakeKey::Add(int value)
+{
+    Append(kTagInt, static_cast<uint32_t>(value));
+    return *this;
+}
+
+BakeKey& BakeKey::Add(float value)
+{
+    // -0 and 0 generate the same texture, and every NaN is the same NaN
+    if (value == 0.0f)
+        value = 0.0f;
+    else if (std::isnan(value))
+        value = std::nanf("");
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    Append(kTagFloat, bits);
+    return *this;
+}
+
+BakeKey& BakeKey::Add(bool value)
+{
+    Append(kTagBool, value ? 1 : 0);
+    return *this;
+}
+
+BakeKey& BakeKey::Add(D3DCOLOR value)
+{
+    Append(kTagColor, static_cast<uint32_t>(value));
+    return *this;
+}
+
+BakeKey& BakeKey::Add(const std::string& value)
+{
+    // Length first, so ("ab", "c") and ("a", "bc") differ
+    Append(kTagString, static_cast<uint32_t>(value.size()));
+    m_bytes.insert(m_bytes.end(), value.begin(), value.end());
+    return *this;
+}
+
+BakeKey& BakeKey::Add(const MipOptions& options)
+{
+    Append(kTagMipOptions, 5);
+    Add(static_cast<int>(options.filter));
+    Add(options.srgb);
+    Add(options.normalMap);
+    Add(options.alphaCutoff);
+    Add(options.maxLevels);
+    return *this;
+}
+
+uint64_t BakeKey::GetHash() const
+{
+    return TextureFile::HashBytes(m_bytes.data(), m_bytes.size());
+}
+
+void BakeKey::Append(uint8_t tag, uint32_t value)
+{
+    // Little-endian whatever the platform
+    m_bytes.push_back(tag);
+    for (int i = 0; i < 4; i++)
+    {
+        m_bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+bool BakeCache::SetDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!directory.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error)
+        {
+            std::cerr << "Failed to create bake cache directory: " << directory << std::endl;
+            m_directory.clear();
+            return false;
+        }
+    }
+
+    m_directory = directory;
+    return true;
+}
+
+bool BakeCache::Load(const BakeKey& key, TextureFile& file)
+{
+    if (!IsEnabled())
+        return false;
+
+    std::string path = GetPath(key);
+    bool hit = file.Open(path);
+    if (hit && (file.GetFormat() != TextureFileFormat::A8R8G8B8 || file.GetWidth() != key.GetWidth() ||
+                file.GetHeight() != key.GetHeight() || !file.VerifyContentHash()))
+    {
+        // Stale or damaged: the next Store replaces it
+        std::cerr << "Damaged texture bake, regenerating: " << path << std::endl;
+        file.Close();
+        hit = false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (hit)
+        m_stats.hits++;
+    else
+        m_stats.misses++;
+    return hit;
+}
+
+bool BakeCache::Store(const BakeKey& key, const MipChain& chain)
+{
+    if (!IsEnabled())
+        return false;
+
+    if (chain.IsEmpty() || chain.GetLevel(0).width != key.GetWidth() || chain.GetLevel(0).height != key.GetHeight())
+    {
+        std::cerr << "Bake does not match its key: " << key.GetGenerator() << std::endl;
+        return false;
+    }
+
+    // Written aside and renamed into place, so readers only see whole files
+    std::string path = GetPath(key);
+    std::string temporary = MakeTemporaryPath(path);
+
+    bool stored = TextureFile::WriteMipChain(temporary, chain, TextureFileFormat::A8R8G8B8);
+    if (stored)
+    {
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        stored = !error;
+    }
+    if (!stored)
+    {
+        std::error_code error;
+        std::filesystem::remove(temporary, error);
+        std::cerr << "Failed to store texture bake: " << path << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (stored)
+        m_stats.stores++;
+    else
+        m_stats.failedStores++;
+    return stored;
+}
+
+void BakeCache::Clear()
+{
+    if (!IsEnabled())
+        return;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(m_directory, error))
+    {
+        std::string name = entry.path().filename().string();
+        if (TextureFile::IsTextureFile(name) || name.find(".etex.tmp") != std::string::npos)
+        {
+            std::error_code removeError;
+            std::filesystem::remove(entry.path(), removeError);
+        }
+    }
+}
+
+std::string BakeCache::GetPath(const BakeKey& key) const
+{
+    std::string name = key.GetGenerator() + "_" + FormatHash(key.GetHash()) + ".etex";
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+BakeCache::Stats BakeCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace TextureEffects
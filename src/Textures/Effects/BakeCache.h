@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MipChain.h"
+#include "TextureFile.h"
+
+namespace TextureEffects {
+
+    // Everything a bake depends on, serialized in a fixed order so the hash
+    // is the same on every run and platform: generator name and version,
+    // resolution, then each parameter as added.
+    class BakeKey {
+    public:
+        // version: bump it whenever the generator's output changes, so bakes
+        // made by the old code are never loaded again
+        BakeKey(const std::string& generator, int version, int width, int height);
+
+        BakeKey& Add(int value);
+        BakeKey& Add(float value);
+        BakeKey& Add(bool value);
+        BakeKey& Add(D3DCOLOR value);
+        BakeKey& Add(const std::string& value);
+        BakeKey& Add(const MipOptions& options);
+
+        const std::string& GetGenerator() const { return m_generator; }
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        uint64_t GetHash() const;
+
+    private:
+        void Append(uint8_t tag, uint32_t value);
+
+        std::string m_generator;
+        int m_width;
+        int m_height;
+        std::vector<uint8_t> m_bytes;
+    };
+
+    // Content-addressed cache of generated textures on disk: one .etex file
+    // per key, named after the key's hash and holding the whole mip chain.
+    // A hit is a memory-mapped file instead of running the generator again.
+    // Files are written under a temporary name and renamed, so a crash or a
+    // second process never leaves a half-written bake behind.
+    class BakeCache {
+    public:
+        struct Stats {
+            size_t hits = 0;
+            size_t misses = 0;
+            size_t stores = 0;
+            size_t failedStores = 0;
+        };
+
+        BakeCache() = default;
+
+        // Creates the directory if needed. An empty directory disables the
+        // cache: Load always misses and Store does nothing. Call it before
+        // the cache is used from other threads.
+        bool SetDirectory(const std::string& directory);
+        const std::string& GetDirectory() const { return m_directory; }
+        bool IsEnabled() const { return !m_directory.empty(); }
+
+        // Maps the bake of key. Misses if there is none, or if it does not
+        // match the key's size or fails its content hash.
+        bool Load(const BakeKey& key, TextureFile& file);
+
+        // Writes every level of chain (32-bit) as the bake of key
+        bool Store(const BakeKey& key, const MipChain& chain);
+
+        // Deletes every bake in the directory
+        void Clear();
+
+        std::string GetPath(const BakeKey& key) const;
+        Stats GetStats() const;
+
+    private:
+        std::string m_directory;
+        Stats m_stats;
+        mutable std::mutex m_mutex;
+    };
+
+}
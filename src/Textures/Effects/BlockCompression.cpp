@@ -0,0 +1,1087 @@
+#include "BlockCompression.h"
+#include "EffectThreads.h"
+#include "../../Core/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCKCOMPRESSION_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TextureEffects {
+
+SimdLevel BlockCompressor::s_simdLevel = CpuFeatures::GetMaxSimdLevel();
+
+namespace {
+
+bool UseSSE2()
+{
+    return BlockCompressor::GetSimdLevel() >= SimdLevel::SSE2;
+}
+
+struct Color {
+    int r, g, b;
+};
+
+int Red(D3DCOLOR color) { return (color >> 16) & 0xFF; }
+int Green(D3DCOLOR color) { return (color >> 8) & 0xFF; }
+int Blue(D3DCOLOR color) { return color & 0xFF; }
+
+int ColorError(const Color& color, D3DCOLOR pixel)
+{
+    int dr = color.r - Red(pixel);
+    int dg = color.g - Green(pixel);
+    int db = color.b - Blue(pixel);
+    return dr * dr + dg * dg + db * db;
+}
+
+// 5:6:5 endpoints expand to 8 bits by repeating their top bits
+Color Unpack565(int packed)
+{
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+}
+
+int QuantizeChannel(float value, int maxValue)
+{
+    int quantized = static_cast<int>(value * maxValue / 255.0f + 0.5f);
+    return std::max(0, std::min(maxValue, quantized));
+}
+
+int Pack565(const float color[3])
+{
+    return (QuantizeChannel(color[0], 31) << 11) | (QuantizeChannel(color[1], 63) << 5) | QuantizeChannel(color[2], 31);
+}
+
+// Colors an endpoint pair decodes to. Four-color mode interpolates thirds;
+// three-color mode has the midpoint and transparent black.
+void ColorPalette(int c0, int c1, bool fourColor, Color palette[4])
+{
+    Color a = Unpack565(c0);
+    Color b = Unpack565(c1);
+    palette[0] = a;
+    palette[1] = b;
+    if (fourColor)
+    {
+        palette[2] = { (2 * a.r + b.r + 1) / 3, (2 * a.g + b.g + 1) / 3, (2 * a.b + b.b + 1) / 3 };
+        palette[3] = { (a.r + 2 * b.r + 1) / 3, (a.g + 2 * b.g + 1) / 3, (a.b + 2 * b.b + 1) / 3 };
+    }
+    else
+    {
+        palette[2] = { (a.r + b.r + 1) / 2, (a.g + b.g + 1) / 2, (a.b + b.b + 1) / 2 };
+        palette[3] = { 0, 0, 0 };
+    }
+}
+
+// Values an alpha endpoint pair decodes to: eight interpolated steps when
+// a0 > a1, otherwise six plus 0 and 255
+void AlphaPalette(int a0, int a1, int palette[8])
+{
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1)
+    {
+        for (int i = 2; i < 8; i++)
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+    }
+    else
+    {
+        for (int i = 2; i < 6; i++)
+            palette[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+void WriteColorBlock(int c0, int c1, const int* indices, BYTE* block)
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++)
+        bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+
+    block[0] = static_cast<BYTE>(c0);
+    block[1] = static_cast<BYTE>(c0 >> 8);
+    block[2] = static_cast<BYTE>(c1);
+    block[3] = static_cast<BYTE>(c1 >> 8);
+    for (int i = 0; i < 4; i++)
+        block[4 + i] = static_cast<BYTE>(bits >> (8 * i));
+}
+
+void WriteAlphaBlock(int a0, int a1, const int* indices, BYTE* block)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++)
+        bits |= static_cast<uint64_t>(indices[i]) << (3 * i);
+
+    block[0] = static_cast<BYTE>(a0);
+    block[1] = static_cast<BYTE>(a1);
+    for (int i = 0; i < 6; i++)
+        block[2 + i] = static_cast<BYTE>(bits >> (8 * i));
+}
+
+// ---------------------------------------------------------------------------
+// Color blocks (BC1, and the color half of BC3)
+// ---------------------------------------------------------------------------
+
+// Endpoint pairs that reproduce one 8-bit value as closely as possible at
+// 2/3 of the way from the first endpoint to the second, for 5- and 6-bit
+// channels. Solid blocks use these instead of plain rounding.
+struct SolidColorTables {
+    BYTE match5[256][2];
+    BYTE match6[256][2];
+
+    SolidColorTables()
+    {
+        Build(match5, 5);
+        Build(match6, 6);
+    }
+
+    static void Build(BYTE table[256][2], int bits)
+    {
+        int levels = 1 << bits;
+        for (int value = 0; value < 256; value++)
+        {
+            int bestError = std::numeric_limits<int>::max();
+            for (int a = 0; a < levels; a++)
+            {
+                int ea = (a << (8 - bits)) | (a >> (2 * bits - 8));
+                for (int b = 0; b < levels; b++)
+                {
+                    int eb = (b << (8 - bits)) | (b >> (2 * bits - 8));
+                    int error = std::abs((2 * ea + eb + 1) / 3 - value);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        table[value][0] = static_cast<BYTE>(a);
+                        table[value][1] = static_cast<BYTE>(b);
+                    }
+                }
+            }
+        }
+    }
+};
+
+const SolidColorTables& GetSolidColorTables()
+{
+    static const SolidColorTables tables;
+    return tables;
+}
+
+// Index of the palette entry each pixel projects closest to along the
+// endpoint axis. A 1D approximation of nearest color: exact for colors on
+// the axis and very close otherwise, at a fraction of the cost.
+void MatchProjected(const D3DCOLOR* pixels, const Color palette[4], int* indices)
+{
+    int dr = palette[0].r - palette[1].r;
+    int dg = palette[0].g - palette[1].g;
+    int db = palette[0].b - palette[1].b;
+
+    int stops[4];
+    for (int i = 0; i < 4; i++)
+        stops[i] = palette[i].r * dr + palette[i].g * dg + palette[i].b * db;
+
+    // Crossover points between neighboring entries, doubled. Along the axis
+    // the order is 1, 3, 2, 0.
+    int lowPoint = stops[1] + stops[3];
+    int halfPoint = stops[3] + stops[2];
+    int highPoint = stops[2] + stops[0];
+
+#if defined(BLOCKCOMPRESSION_SSE2)
+    if (UseSSE2())
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i direction = _mm_setr_epi16(static_cast<short>(db), static_cast<short>(dg), static_cast<short>(dr), 0,
+                                                 static_cast<short>(db), static_cast<short>(dg), static_cast<short>(dr), 0);
+        const __m128i low = _mm_set1_epi32(lowPoint);
+        const __m128i half = _mm_set1_epi32(halfPoint);
+        const __m128i high = _mm_set1_epi32(highPoint);
+        const __m128i two = _mm_set1_epi32(2);
+        const __m128i three = _mm_set1_epi32(3);
+
+        for (int i = 0; i < 16; i += 4)
+        {
+            // Bytes are B, G, R, A: madd gives b*db + g*dg and r*dr per pixel
+            __m128i colors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+            __m128 first = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(colors, zero), direction));
+            __m128 second = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(colors, zero), direction));
+            __m128i dots = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0))),
+                                         _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1))));
+            dots = _mm_add_epi32(dots, dots);
+
+            __m128i belowHalf = _mm_cmplt_epi32(dots, half);
+            __m128i lower = _mm_sub_epi32(three, _mm_and_si128(_mm_cmplt_epi32(dots, low), two));
+            __m128i upper = _mm_and_si128(_mm_cmplt_epi32(dots, high), two);
+            __m128i result = _mm_or_si128(_mm_and_si128(belowHalf, lower), _mm_andnot_si128(belowHalf, upper));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i), result);
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < 16; i++)
+    {
+        int dot = 2 * (Red(pixels[i]) * dr + Green(pixels[i]) * dg + Blue(pixels[i]) * db);
+        if (dot < halfPoint)
+            indices[i] = (dot < lowPoint) ? 1 : 3;
+        else
+            indices[i] = (dot < highPoint) ? 2 : 0;
+    }
+}
+
+// Nearest palette entry for each pixel; pixels not in include get index 3
+// (transparent in three-color mode). Returns the summed squared error.
+int MatchNearest(const D3DCOLOR* pixels, const bool* include, const Color palette[4], int entries, int* indices)
+{
+    int total = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (!include[i])
+        {
+            indices[i] = 3;
+            continue;
+        }
+
+        int best = 0;
+        int bestError = ColorError(palette[0], pixels[i]);
+        for (int k = 1; k < entries; k++)
+        {
+            int error = ColorError(palette[k], pixels[i]);
+            if (error < bestError)
+            {
+                bestError = error;
+                best = k;
+            }
+        }
+        indices[i] = best;
+        total += bestError;
+    }
+    return total;
+}
+
+int BlockError(const D3DCOLOR* pixels, const bool* include, const Color palette[4], const int* indices)
+{
+    int total = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (include[i])
+            total += ColorError(palette[indices[i]], pixels[i]);
+    }
+    return total;
+}
+
+// Extreme pixels along the principal axis of the included colors
+void PrincipalEndpoints(const D3DCOLOR* pixels, const bool* include, float end0[3], float end1[3])
+{
+    // Sums, bounds and products (rr, rg, rb, gg, gb, bb) in one pass
+    int sum[3] = { 0, 0, 0 };
+    int minimum[3] = { 255, 255, 255 };
+    int maximum[3] = { 0, 0, 0 };
+    int products[6] = {};
+    int count = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (!include[i])
+            continue;
+        int r = Red(pixels[i]);
+        int g = Green(pixels[i]);
+        int b = Blue(pixels[i]);
+        sum[0] += r;
+        sum[1] += g;
+        sum[2] += b;
+        minimum[0] = std::min(minimum[0], r);
+        minimum[1] = std::min(minimum[1], g);
+        minimum[2] = std::min(minimum[2], b);
+        maximum[0] = std::max(maximum[0], r);
+        maximum[1] = std::max(maximum[1], g);
+        maximum[2] = std::max(maximum[2], b);
+        products[0] += r * r;
+        products[1] += r * g;
+        products[2] += r * b;
+        products[3] += g * g;
+        products[4] += g * b;
+        products[5] += b * b;
+        count++;
+    }
+
+    float mean[3] = { static_cast<float>(sum[0]) / count, static_cast<float>(sum[1]) / count,
+                      static_cast<float>(sum[2]) / count };
+    float cov[6] = {
+        products[0] - mean[0] * sum[0], products[1] - mean[0] * sum[1], products[2] - mean[0] * sum[2],
+        products[3] - mean[1] * sum[1], products[4] - mean[1] * sum[2], products[5] - mean[2] * sum[2],
+    };
+
+    // Power iteration from the bounding box diagonal
+    float axis[3] = { static_cast<float>(maximum[0] - minimum[0]), static_cast<float>(maximum[1] - minimum[1]),
+                      static_cast<float>(maximum[2] - minimum[2]) };
+    for (int iteration = 0; iteration < 4; iteration++)
+    {
+        float r = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+        float g = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+        float b = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+        float largest = std::max(fabsf(r), std::max(fabsf(g), fabsf(b)));
+        if (largest < 1e-4f)
+            break;
+        axis[0] = r / largest;
+        axis[1] = g / largest;
+        axis[2] = b / largest;
+    }
+    if (fabsf(axis[0]) + fabsf(axis[1]) + fabsf(axis[2]) < 1e-4f)
+    {
+        axis[0] = 0.299f;
+        axis[1] = 0.587f;
+        axis[2] = 0.114f;
+    }
+
+    float lowest = std::numeric_limits<float>::max();
+    float highest = -std::numeric_limits<float>::max();
+    int lowIndex = 0;
+    int highIndex = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (!include[i])
+            continue;
+        float dot = Red(pixels[i]) * axis[0] + Green(pixels[i]) * axis[1] + Blue(pixels[i]) * axis[2];
+        if (dot < lowest)
+        {
+            lowest = dot;
+            lowIndex = i;
+        }
+        if (dot > highest)
+        {
+            highest = dot;
+            highIndex = i;
+        }
+    }
+
+    end0[0] = static_cast<float>(Red(pixels[highIndex]));
+    end0[1] = static_cast<float>(Green(pixels[highIndex]));
+    end0[2] = static_cast<float>(Blue(pixels[highIndex]));
+    end1[0] = static_cast<float>(Red(pixels[lowIndex]));
+    end1[1] = static_cast<float>(Green(pixels[lowIndex]));
+    end1[2] = static_cast<float>(Blue(pixels[lowIndex]));
+}
+
+// Least-squares endpoints for the given indices. Returns false when every
+// pixel uses the same weight and the system has no unique solution.
+bool RefineEndpoints(const D3DCOLOR* pixels, const bool* include, const int* indices, bool fourColor,
+                     float end0[3], float end1[3])
+{
+    static const float kFourColorWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    static const float kThreeColorWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+    const float* weights = fourColor ? kFourColorWeights : kThreeColorWeights;
+
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[3] = {}, bx[3] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        if (!include[i])
+            continue;
+        float a = weights[indices[i]];
+        float b = 1.0f - a;
+        float c[3] = { static_cast<float>(Red(pixels[i])), static_cast<float>(Green(pixels[i])),
+                       static_cast<float>(Blue(pixels[i])) };
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int k = 0; k < 3; k++)
+        {
+            ax[k] += a * c[k];
+            bx[k] += b * c[k];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) < 1e-6f)
+        return false;
+
+    float inverse = 1.0f / determinant;
+    for (int k = 0; k < 3; k++)
+    {
+        end0[k] = std::max(0.0f, std::min(255.0f, (ax[k] * bb - bx[k] * ab) * inverse));
+        end1[k] = std::max(0.0f, std::min(255.0f, (bx[k] * aa - ax[k] * ab) * inverse));
+    }
+    return true;
+}
+
+struct ColorEncoding {
+    int c0 = 0;
+    int c1 = 0;
+    int indices[16] = {};
+    int error = std::numeric_limits<int>::max();
+};
+
+// Indices and error of an endpoint pair, nearest color or projected
+void EvaluateEndpoints(const D3DCOLOR* pixels, const bool* include, bool fourColor, bool nearest, ColorEncoding& encoding)
+{
+    Color palette[4];
+    ColorPalette(encoding.c0, encoding.c1, fourColor, palette);
+    if (nearest || !fourColor)
+    {
+        encoding.error = MatchNearest(pixels, include, palette, fourColor ? 4 : 3, encoding.indices);
+    }
+    else
+    {
+        MatchProjected(pixels, palette, encoding.indices);
+        encoding.error = BlockError(pixels, include, palette, encoding.indices);
+    }
+}
+
+// Moves one 5:6:5 endpoint channel at a time by one step while that lowers
+// the error
+void SearchEndpoints(const D3DCOLOR* pixels, const bool* include, bool fourColor, ColorEncoding& best)
+{
+    static const int kShifts[3] = { 11, 5, 0 };
+    static const int kMasks[3] = { 31, 63, 31 };
+
+    for (int pass = 0; pass < 8; pass++)
+    {
+        bool improved = false;
+        for (int endpoint = 0; endpoint < 2; endpoint++)
+        {
+            for (int channel = 0; channel < 3; channel++)
+            {
+                for (int step = -1; step <= 1; step += 2)
+                {
+                    ColorEncoding candidate;
+                    candidate.c0 = best.c0;
+                    candidate.c1 = best.c1;
+                    int& packed = endpoint == 0 ? candidate.c0 : candidate.c1;
+                    int value = ((packed >> kShifts[channel]) & kMasks[channel]) + step;
+                    if (value < 0 || value > kMasks[channel])
+                        continue;
+                    packed = (packed & ~(kMasks[channel] << kShifts[channel])) | (value << kShifts[channel]);
+
+                    EvaluateEndpoints(pixels, include, fourColor, true, candidate);
+                    if (candidate.error < best.error)
+                    {
+                        best = candidate;
+                        improved = true;
+                    }
+                }
+            }
+        }
+        if (!improved)
+            break;
+    }
+}
+
+void EncodeSolidColor(D3DCOLOR color, BYTE* block)
+{
+    const SolidColorTables& tables = GetSolidColorTables();
+    int r = Red(color);
+    int g = Green(color);
+    int b = Blue(color);
+    int c0 = (tables.match5[r][0] << 11) | (tables.match6[g][0] << 5) | tables.match5[b][0];
+    int c1 = (tables.match5[r][1] << 11) | (tables.match6[g][1] << 5) | tables.match5[b][1];
+
+    // Every pixel at 2/3 from c0 to c1; swapped endpoints swap the index
+    int index = 2;
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        index = 3;
+    }
+    else if (c0 == c1)
+    {
+        index = 0;
+    }
+
+    int indices[16];
+    std::fill(indices, indices + 16, index);
+    WriteColorBlock(c0, c1, indices, block);
+}
+
+// transparency: pixels with alpha < 128 are encoded as transparent black in
+// three-color mode (BC1 only; BC3 color blocks are always four-color)
+void EncodeColorBlock(const D3DCOLOR* pixels, bool transparency, BlockQuality quality, BYTE* block)
+{
+    bool include[16];
+    bool anyTransparent = false;
+    for (int i = 0; i < 16; i++)
+    {
+        include[i] = !transparency || (pixels[i] >> 24) >= 128;
+        anyTransparent |= !include[i];
+    }
+
+    if (!anyTransparent)
+    {
+        bool solid = true;
+        for (int i = 1; i < 16 && solid; i++)
+            solid = ((pixels[i] ^ pixels[0]) & 0x00FFFFFF) == 0;
+        if (solid)
+        {
+            EncodeSolidColor(pixels[0], block);
+            return;
+        }
+    }
+
+    int included = 0;
+    for (int i = 0; i < 16; i++)
+        included += include[i];
+
+    bool fourColor = !anyTransparent;
+    bool nearest = quality == BlockQuality::High;
+    ColorEncoding best;
+
+    if (included > 0)
+    {
+        float end0[3], end1[3];
+        PrincipalEndpoints(pixels, include, end0, end1);
+        best.c0 = Pack565(end0);
+        best.c1 = Pack565(end1);
+        EvaluateEndpoints(pixels, include, fourColor, nearest, best);
+
+        // Fast refines once; High keeps refining while it helps, then
+        // searches the neighboring endpoints
+        int refinements = nearest ? 4 : 1;
+        for (int iteration = 0; iteration < refinements; iteration++)
+        {
+            if (!RefineEndpoints(pixels, include, best.indices, fourColor, end0, end1))
+                break;
+
+            ColorEncoding candidate;
+            candidate.c0 = Pack565(end0);
+            candidate.c1 = Pack565(end1);
+            if (candidate.c0 == best.c0 && candidate.c1 == best.c1)
+                break;
+            EvaluateEndpoints(pixels, include, fourColor, nearest, candidate);
+            if (candidate.error >= best.error)
+                break;
+            best = candidate;
+        }
+
+        if (nearest)
+            SearchEndpoints(pixels, include, fourColor, best);
+    }
+    else
+    {
+        best.c0 = best.c1 = 0;
+        std::fill(best.indices, best.indices + 16, 3);
+    }
+
+    // Four-color mode needs c0 > c1, three-color mode c0 <= c1. Swapping
+    // exchanges indices 0 and 1, and in four-color mode also 2 and 3.
+    if (fourColor)
+    {
+        if (best.c0 < best.c1)
+        {
+            std::swap(best.c0, best.c1);
+            for (int& index : best.indices)
+                index ^= 1;
+        }
+        else if (best.c0 == best.c1)
+        {
+            std::fill(best.indices, best.indices + 16, 0);
+        }
+    }
+    else if (best.c0 > best.c1)
+    {
+        std::swap(best.c0, best.c1);
+        for (int& index : best.indices)
+        {
+            if (index < 2)
+                index ^= 1;
+        }
+    }
+
+    WriteColorBlock(best.c0, best.c1, best.indices, block);
+}
+
+void DecodeColorBlock(const BYTE* block, bool allowThreeColor, D3DCOLOR* pixels)
+{
+    int c0 = block[0] | (block[1] << 8);
+    int c1 = block[2] | (block[3] << 8);
+    uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+
+    bool fourColor = !allowThreeColor || c0 > c1;
+    Color palette[4];
+    ColorPalette(c0, c1, fourColor, palette);
+
+    for (int i = 0; i < 16; i++)
+    {
+        int index = (bits >> (2 * i)) & 3;
+        int alpha = (!fourColor && index == 3) ? 0 : 255;
+        pixels[i] = D3DCOLOR_ARGB(alpha, palette[index].r, palette[index].g, palette[index].b);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Single-channel blocks (BC3 alpha, BC4, each half of BC5)
+// ---------------------------------------------------------------------------
+
+void ValueRange(const BYTE* values, int& minimum, int& maximum)
+{
+#if defined(BLOCKCOMPRESSION_SSE2)
+    if (UseSSE2())
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+        __m128i low = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+        __m128i high = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+        low = _mm_min_epu8(low, _mm_srli_si128(low, 4));
+        high = _mm_max_epu8(high, _mm_srli_si128(high, 4));
+        low = _mm_min_epu8(low, _mm_srli_si128(low, 2));
+        high = _mm_max_epu8(high, _mm_srli_si128(high, 2));
+        low = _mm_min_epu8(low, _mm_srli_si128(low, 1));
+        high = _mm_max_epu8(high, _mm_srli_si128(high, 1));
+        minimum = _mm_cvtsi128_si32(low) & 0xFF;
+        maximum = _mm_cvtsi128_si32(high) & 0xFF;
+        return;
+    }
+#endif
+    minimum = 255;
+    maximum = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        minimum = std::min(minimum, static_cast<int>(values[i]));
+        maximum = std::max(maximum, static_cast<int>(values[i]));
+    }
+}
+
+// Eight-value mode indices for endpoints maximum > minimum, by arithmetic on
+// the value's position in the range rather than by searching the palette
+void MatchAlphaRange(const BYTE* values, int minimum, int maximum, int* indices)
+{
+    int range = maximum - minimum;
+    int range4 = range * 4;
+    int range2 = range * 2;
+    int bias = (range < 8) ? (range - 1) : (range / 2 + 2);
+    bias -= minimum * 7;
+
+#if defined(BLOCKCOMPRESSION_SSE2)
+    if (UseSSE2())
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i seven = _mm_set1_epi16(7);
+        const __m128i biasVector = _mm_set1_epi16(static_cast<short>(bias));
+        const __m128i limit4 = _mm_set1_epi16(static_cast<short>(range4 - 1));
+        const __m128i limit2 = _mm_set1_epi16(static_cast<short>(range2 - 1));
+        const __m128i limit1 = _mm_set1_epi16(static_cast<short>(range - 1));
+        const __m128i step4 = _mm_set1_epi16(static_cast<short>(range4));
+        const __m128i step2 = _mm_set1_epi16(static_cast<short>(range2));
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i two = _mm_set1_epi16(2);
+        const __m128i four = _mm_set1_epi16(4);
+
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+        __m128i halves[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+        for (int h = 0; h < 2; h++)
+        {
+            __m128i a = _mm_add_epi16(_mm_mullo_epi16(halves[h], seven), biasVector);
+            __m128i t = _mm_cmpgt_epi16(a, limit4);
+            __m128i index = _mm_and_si128(t, four);
+            a = _mm_sub_epi16(a, _mm_and_si128(t, step4));
+            t = _mm_cmpgt_epi16(a, limit2);
+            index = _mm_add_epi16(index, _mm_and_si128(t, two));
+            a = _mm_sub_epi16(a, _mm_and_si128(t, step2));
+            index = _mm_add_epi16(index, _mm_and_si128(_mm_cmpgt_epi16(a, limit1), one));
+
+            // Position 0..7 from minimum up to palette order (0 = maximum, 1 = minimum)
+            index = _mm_and_si128(_mm_sub_epi16(zero, index), seven);
+            index = _mm_xor_si128(index, _mm_and_si128(_mm_cmpgt_epi16(two, index), one));
+
+            alignas(16) short lanes[8];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), index);
+            for (int i = 0; i < 8; i++)
+                indices[h * 8 + i] = lanes[i];
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < 16; i++)
+    {
+        int a = values[i] * 7 + bias;
+        int t = (a >= range4) ? -1 : 0;
+        int index = t & 4;
+        a -= range4 & t;
+        t = (a >= range2) ? -1 : 0;
+        index += t & 2;
+        a -= range2 & t;
+        index += (a >= range) ? 1 : 0;
+
+        index = -index & 7;
+        index ^= (2 > index) ? 1 : 0;
+        indices[i] = index;
+    }
+}
+
+struct AlphaEncoding {
+    int a0 = 0;
+    int a1 = 0;
+    int indices[16] = {};
+    int error = std::numeric_limits<int>::max();
+};
+
+void EvaluateAlpha(const BYTE* values, AlphaEncoding& encoding)
+{
+    int palette[8];
+    AlphaPalette(encoding.a0, encoding.a1, palette);
+    encoding.error = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int best = 0;
+        int bestError = std::numeric_limits<int>::max();
+        for (int k = 0; k < 8; k++)
+        {
+            int d = palette[k] - values[i];
+            if (d * d < bestError)
+            {
+                bestError = d * d;
+                best = k;
+            }
+        }
+        encoding.indices[i] = best;
+        encoding.error += bestError;
+    }
+}
+
+// Moves each endpoint by one step while that lowers the error, keeping the
+// mode (eightValue: a0 > a1)
+void SearchAlpha(const BYTE* values, bool eightValue, AlphaEncoding& best)
+{
+    for (int pass = 0; pass < 16; pass++)
+    {
+        bool improved = false;
+        for (int endpoint = 0; endpoint < 2; endpoint++)
+        {
+            for (int step = -1; step <= 1; step += 2)
+            {
+                AlphaEncoding candidate;
+                candidate.a0 = best.a0 + (endpoint == 0 ? step : 0);
+                candidate.a1 = best.a1 + (endpoint == 1 ? step : 0);
+                if (candidate.a0 < 0 || candidate.a0 > 255 || candidate.a1 < 0 || candidate.a1 > 255)
+                    continue;
+                if ((candidate.a0 > candidate.a1) != eightValue)
+                    continue;
+
+                EvaluateAlpha(values, candidate);
+                if (candidate.error < best.error)
+                {
+                    best = candidate;
+                    improved = true;
+                }
+            }
+        }
+        if (!improved)
+            break;
+    }
+}
+
+// Least-squares eight-value endpoints for the current indices
+void RefineAlpha(const BYTE* values, AlphaEncoding& best)
+{
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax = 0.0f, bx = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        int index = best.indices[i];
+        float a = index == 0 ? 1.0f : index == 1 ? 0.0f : (8 - index) / 7.0f;
+        float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        ax += a * values[i];
+        bx += b * values[i];
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) < 1e-6f)
+        return;
+
+    AlphaEncoding candidate;
+    candidate.a0 = std::max(0, std::min(255, static_cast<int>((ax * bb - bx * ab) / determinant + 0.5f)));
+    candidate.a1 = std::max(0, std::min(255, static_cast<int>((bx * aa - ax * ab) / determinant + 0.5f)));
+    if (candidate.a0 <= candidate.a1)
+        return;
+
+    EvaluateAlpha(values, candidate);
+    if (candidate.error < best.error)
+        best = candidate;
+}
+
+void EncodeValueBlock(const BYTE* values, BlockQuality quality, BYTE* block)
+{
+    int minimum, maximum;
+    ValueRange(values, minimum, maximum);
+
+    int indices[16];
+    if (minimum == maximum)
+    {
+        std::fill(indices, indices + 16, 0);
+        WriteAlphaBlock(minimum, maximum, indices, block);
+        return;
+    }
+
+    if (quality == BlockQuality::Fast)
+    {
+        MatchAlphaRange(values, minimum, maximum, indices);
+        WriteAlphaBlock(maximum, minimum, indices, block);
+        return;
+    }
+
+    // Eight interpolated values across the range
+    AlphaEncoding best;
+    best.a0 = maximum;
+    best.a1 = minimum;
+    EvaluateAlpha(values, best);
+    RefineAlpha(values, best);
+    SearchAlpha(values, true, best);
+
+    // Six values across the range without the 0 and 255 texels, which the
+    // mode stores exactly
+    int innerMin = 255;
+    int innerMax = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (values[i] != 0 && values[i] != 255)
+        {
+            innerMin = std::min(innerMin, static_cast<int>(values[i]));
+            innerMax = std::max(innerMax, static_cast<int>(values[i]));
+        }
+    }
+    if (innerMin > innerMax)
+    {
+        innerMin = innerMax = 0;
+    }
+
+    AlphaEncoding six;
+    six.a0 = innerMin;
+    six.a1 = innerMax;
+    EvaluateAlpha(values, six);
+    SearchAlpha(values, false, six);
+    if (six.error < best.error)
+        best = six;
+
+    WriteAlphaBlock(best.a0, best.a1, best.indices, block);
+}
+
+void DecodeValueBlock(const BYTE* block, BYTE* values)
+{
+    int palette[8];
+    AlphaPalette(block[0], block[1], palette);
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++)
+        bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+
+    for (int i = 0; i < 16; i++)
+        values[i] = static_cast<BYTE>(palette[(bits >> (3 * i)) & 7]);
+}
+
+void ExtractChannel(const D3DCOLOR* pixels, int shift, BYTE* values)
+{
+    for (int i = 0; i < 16; i++)
+        values[i] = static_cast<BYTE>(pixels[i] >> shift);
+}
+
+// The 4x4 block at (x, y), repeating the edge pixels past the image
+void FetchBlock(const ImageView& image, int x, int y, D3DCOLOR* pixels)
+{
+    if (x + 4 <= image.width && y + 4 <= image.height)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            const D3DCOLOR* source = image.Row(y + row) + x;
+            std::copy(source, source + 4, pixels + row * 4);
+        }
+        return;
+    }
+
+    for (int row = 0; row < 4; row++)
+    {
+        for (int column = 0; column < 4; column++)
+            pixels[row * 4 + column] = image.GetClamped(x + column, y + row);
+    }
+}
+
+} // namespace
+
+int BlockCompressor::GetBlockSize(BlockFormat format)
+{
+    return (format == BlockFormat::BC1 || format == BlockFormat::BC4) ? 8 : 16;
+}
+
+size_t BlockCompressor::GetCompressedSize(BlockFormat format, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return 0;
+    size_t blocks = static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4);
+    return blocks * GetBlockSize(format);
+}
+
+bool BlockCompressor::Compress(const ImageView& image, BlockFormat format, void* blocks, int rowPitch,
+                               BlockQuality quality)
+{
+    if (!image.IsValid() || !blocks)
+        return false;
+
+    int blocksWide = (image.width + 3) / 4;
+    int blocksHigh = (image.height + 3) / 4;
+    int blockSize = GetBlockSize(format);
+    if (rowPitch == 0)
+        rowPitch = blocksWide * blockSize;
+
+    bool transparency = format == BlockFormat::BC1 && image.format == PixelFormat::A8R8G8B8;
+    BYTE* output = static_cast<BYTE*>(blocks);
+
+    int bands = (blocksHigh + kBlockRowsPerTask - 1) / kBlockRowsPerTask;
+    GetEffectThreadPool().ParallelFor(bands, [&](int band) {
+        int by1 = std::min((band + 1) * kBlockRowsPerTask, blocksHigh);
+        for (int by = band * kBlockRowsPerTask; by < by1; by++)
+        {
+            BYTE* row = output + static_cast<ptrdiff_t>(by) * rowPitch;
+            for (int bx = 0; bx < blocksWide; bx++)
+            {
+                D3DCOLOR pixels[16];
+                FetchBlock(image, bx * 4, by * 4, pixels);
+                CompressBlock(pixels, format, quality, transparency, row + bx * blockSize);
+            }
+        }
+    });
+    return true;
+}
+
+bool BlockCompressor::Decompress(const void* blocks, int rowPitch, BlockFormat format, const ImageView& image)
+{
+    if (!image.IsValid() || !blocks)
+        return false;
+
+    int blocksWide = (image.width + 3) / 4;
+    int blocksHigh = (image.height + 3) / 4;
+    int blockSize = GetBlockSize(format);
+    if (rowPitch == 0)
+        rowPitch = blocksWide * blockSize;
+
+    const BYTE* input = static_cast<const BYTE*>(blocks);
+
+    int bands = (blocksHigh + kBlockRowsPerTask - 1) / kBlockRowsPerTask;
+    GetEffectThreadPool().ParallelFor(bands, [&](int band) {
+        int by1 = std::min((band + 1) * kBlockRowsPerTask, blocksHigh);
+        for (int by = band * kBlockRowsPerTask; by < by1; by++)
+        {
+            const BYTE* row = input + static_cast<ptrdiff_t>(by) * rowPitch;
+            int rows = std::min(4, image.height - by * 4);
+            for (int bx = 0; bx < blocksWide; bx++)
+            {
+                D3DCOLOR pixels[16];
+                DecompressBlock(row + bx * blockSize, format, pixels);
+
+                int columns = std::min(4, image.width - bx * 4);
+                for (int y = 0; y < rows; y++)
+                {
+                    D3DCOLOR* destination = image.Row(by * 4 + y) + bx * 4;
+                    std::copy(pixels + y * 4, pixels + y * 4 + columns, destination);
+                }
+            }
+        }
+    });
+    return true;
+}
+
+void BlockCompressor::CompressBlock(const D3DCOLOR* pixels, BlockFormat format, BlockQuality quality,
+                                    bool transparency, BYTE* block)
+{
+    BYTE values[16];
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        EncodeColorBlock(pixels, transparency, quality, block);
+        break;
+    case BlockFormat::BC3:
+        ExtractChannel(pixels, 24, values);
+        EncodeValueBlock(values, quality, block);
+        EncodeColorBlock(pixels, false, quality, block + 8);
+        break;
+    case BlockFormat::BC4:
+        ExtractChannel(pixels, 16, values);
+        EncodeValueBlock(values, quality, block);
+        break;
+    case BlockFormat::BC5:
+        ExtractChannel(pixels, 16, values);
+        EncodeValueBlock(values, quality, block);
+        ExtractChannel(pixels, 8, values);
+        EncodeValueBlock(values, quality, block + 8);
+        break;
+    }
+}
+
+void BlockCompressor::DecompressBlock(const BYTE* block, BlockFormat format, D3DCOLOR* pixels)
+{
+    BYTE first[16];
+    BYTE second[16];
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        DecodeColorBlock(block, true, pixels);
+        break;
+    case BlockFormat::BC3:
+        DecodeColorBlock(block + 8, false, pixels);
+        DecodeValueBlock(block, first);
+        for (int i = 0; i < 16; i++)
+            pixels[i] = (pixels[i] & 0x00FFFFFF) | (static_cast<D3DCOLOR>(first[i]) << 24);
+        break;
+    case BlockFormat::BC4:
+        DecodeValueBlock(block, first);
+        for (int i = 0; i < 16; i++)
+            pixels[i] = D3DCOLOR_ARGB(255, first[i], first[i], first[i]);
+        break;
+    case BlockFormat::BC5:
+        DecodeValueBlock(block, first);
+        DecodeValueBlock(block + 8, second);
+        for (int i = 0; i < 16; i++)
+            pixels[i] = D3DCOLOR_ARGB(255, first[i], second[i], 0);
+        break;
+    }
+}
+
+float BlockCompressor::ComputePSNR(const ImageView& original, const ImageView& decoded, BlockFormat format)
+{
+    if (!original.IsValid() || !decoded.IsValid())
+        return 0.0f;
+
+    static const int kColorShifts[] = { 16, 8, 0, 24 };
+    int channels = 3;
+    switch (format)
+    {
+    case BlockFormat::BC1: channels = 3; break;
+    case BlockFormat::BC3: channels = 4; break;
+    case BlockFormat::BC4: channels = 1; break;
+    case BlockFormat::BC5: channels = 2; break;
+    }
+
+    int width = std::min(original.width, decoded.width);
+    int height = std::min(original.height, decoded.height);
+    double total = 0.0;
+    for (int y = 0; y < height; y++)
+    {
+        const D3DCOLOR* a = original.Row(y);
+        const D3DCOLOR* b = decoded.Row(y);
+        for (int x = 0; x < width; x++)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                int d = static_cast<int>((a[x] >> kColorShifts[c]) & 0xFF) - static_cast<int>((b[x] >> kColorShifts[c]) & 0xFF);
+                total += d * d;
+            }
+        }
+    }
+
+    double mse = total / (static_cast<double>(width) * height * channels);
+    if (mse == 0.0)
+        return std::numeric_limits<float>::infinity();
+    return static_cast<float>(10.0 * log10(255.0 * 255.0 / mse));
+}
+
+void BlockCompressor::SetSimdLevel(SimdLevel level)
+{
+    s_simdLevel = std::min(level, CpuFeatures::GetMaxSimdLevel());
+}
+
+SimdLevel BlockCompressor::GetSimdLevel()
+{
+    return s_simdLevel;
+}
+
+} // namespace TextureEffects
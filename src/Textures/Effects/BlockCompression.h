@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include "PixelBuffer.h"
+#include "../../Core/CpuFeatures.h"
+
+namespace TextureEffects {
+
+    // GPU block formats: every 4x4 block of pixels is stored in 8 or 16 bytes
+    enum class BlockFormat {
+        BC1,    // DXT1: RGB 5:6:5 endpoints, 8 bytes; alpha < 128 becomes transparent black
+        BC3,    // DXT5: BC1 colors plus an interpolated alpha block, 16 bytes
+        BC4,    // ATI1: red only, 8 bytes (masks, heights, roughness)
+        BC5     // ATI2: red and green, 16 bytes (normal map X and Y)
+    };
+
+    enum class BlockQuality {
+        Fast,   // Principal axis endpoints, one least-squares refinement: runtime bakes
+        High    // Nearest-color indices, iterated refinement and endpoint search: offline bakes
+    };
+
+    // Block compression encoder and decoder for 32-bit images. Blocks are
+    // encoded independently, in bands of block rows on the thread pool, so
+    // the output does not depend on the thread count. Index selection uses
+    // SSE2 where available and gives the same bytes as the scalar path.
+    class BlockCompressor {
+    public:
+        // Bytes per 4x4 block: 8 for BC1 and BC4, 16 for BC3 and BC5
+        static int GetBlockSize(BlockFormat format);
+
+        // Bytes of width x height pixels with packed rows of blocks
+        static size_t GetCompressedSize(BlockFormat format, int width, int height);
+
+        // Encodes image into rows of blocks rowPitch bytes apart (0 packs
+        // them). Partial blocks at the right and bottom edges repeat the edge
+        // pixels. BC1 only makes pixels transparent for A8R8G8B8 images.
+        // Returns false if the image is invalid or blocks is null.
+        static bool Compress(const ImageView& image, BlockFormat format, void* blocks, int rowPitch = 0,
+                             BlockQuality quality = BlockQuality::Fast);
+
+        // Decodes blocks into image. BC4 comes out as gray, BC5 as red and
+        // green with blue 0; both are opaque.
+        static bool Decompress(const void* blocks, int rowPitch, BlockFormat format, const ImageView& image);
+
+        // One block of 16 pixels in row order. transparency lets BC1 encode
+        // pixels with alpha < 128 as transparent black.
+        static void CompressBlock(const D3DCOLOR* pixels, BlockFormat format, BlockQuality quality,
+                                  bool transparency, BYTE* block);
+        static void DecompressBlock(const BYTE* block, BlockFormat format, D3DCOLOR* pixels);
+
+        // Peak signal-to-noise ratio in dB of decoded against original, over
+        // the channels the format stores (RGB for BC1). Infinite when equal.
+        static float ComputePSNR(const ImageView& original, const ImageView& decoded, BlockFormat format);
+
+        // Instruction set of index selection. Defaults to the best one the
+        // CPU supports; requests above that are clamped. AVX2 uses the SSE2
+        // code. Every level produces the same bytes.
+        static void SetSimdLevel(SimdLevel level);
+        static SimdLevel GetSimdLevel();
+
+        // Block rows per band
+        static const int kBlockRowsPerTask = 4;
+
+    private:
+        static SimdLevel s_simdLevel;
+    };
+
+}
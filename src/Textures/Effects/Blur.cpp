@@ -0,0 +1,340 @@
+#include "Blur.h"
+#include "EffectThreads.h"
+#include "../../Core/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TextureEffects {
+
+namespace {
+
+// Horizontal passes are split into bands of rows, vertical passes into
+// strips of columns so every row segment a task touches is contiguous
+const int kRowsPerTask = 16;
+const int kColumnsPerTask = 64;
+
+// Color channels as interleaved floats, three per pixel
+void LoadRow(const D3DCOLOR* source, float* destination, int count)
+{
+    for (int x = 0; x < count; x++)
+    {
+        D3DCOLOR color = source[x];
+        destination[x * 3 + 0] = static_cast<float>((color >> 16) & 0xFF);
+        destination[x * 3 + 1] = static_cast<float>((color >> 8) & 0xFF);
+        destination[x * 3 + 2] = static_cast<float>(color & 0xFF);
+    }
+}
+
+BYTE ToByte(float value)
+{
+    return static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(value + 0.5f))));
+}
+
+// Writes count pixels back, keeping the destination's alpha
+void StoreRow(const float* source, D3DCOLOR* destination, int count)
+{
+    for (int x = 0; x < count; x++)
+    {
+        BYTE a = (destination[x] >> 24) & 0xFF;
+        destination[x] = D3DCOLOR_ARGB(a, ToByte(source[x * 3 + 0]), ToByte(source[x * 3 + 1]),
+                                       ToByte(source[x * 3 + 2]));
+    }
+}
+
+// Sliding window sum over one row of interleaved channels. The running sum
+// is kept in double so long rows do not drift.
+void BoxRow(const float* source, float* destination, int width, int radius)
+{
+    double scale = 1.0 / (2 * radius + 1);
+    double r = source[0] * static_cast<double>(radius + 1);
+    double g = source[1] * static_cast<double>(radius + 1);
+    double b = source[2] * static_cast<double>(radius + 1);
+
+    for (int i = 1; i <= radius; i++)
+    {
+        const float* pixel = source + std::min(i, width - 1) * 3;
+        r += pixel[0];
+        g += pixel[1];
+        b += pixel[2];
+    }
+
+    for (int x = 0; x < width; x++)
+    {
+        destination[x * 3 + 0] = static_cast<float>(r * scale);
+        destination[x * 3 + 1] = static_cast<float>(g * scale);
+        destination[x * 3 + 2] = static_cast<float>(b * scale);
+
+        const float* add = source + std::min(x + radius + 1, width - 1) * 3;
+        const float* remove = source + std::max(x - radius, 0) * 3;
+        r += add[0] - remove[0];
+        g += add[1] - remove[1];
+        b += add[2] - remove[2];
+    }
+}
+
+// Same window along columns, for the columns [x0, x1) of a float image.
+// One running sum per channel, advanced a whole row segment at a time.
+void BoxColumns(const float* source, float* destination, int width, int height, int x0, int x1, int radius)
+{
+    int count = (x1 - x0) * 3;
+    size_t stride = static_cast<size_t>(width) * 3;
+    const float* base = source + x0 * 3;
+    double scale = 1.0 / (2 * radius + 1);
+
+    std::vector<double> sum(count);
+    for (int i = 0; i < count; i++)
+    {
+        sum[i] = base[i] * static_cast<double>(radius + 1);
+    }
+    for (int k = 1; k <= radius; k++)
+    {
+        const float* row = base + std::min(k, height - 1) * stride;
+        for (int i = 0; i < count; i++)
+        {
+            sum[i] += row[i];
+        }
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        float* out = destination + y * stride + x0 * 3;
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = static_cast<float>(sum[i] * scale);
+        }
+
+        const float* add = base + std::min(y + radius + 1, height - 1) * stride;
+        const float* remove = base + std::max(y - radius, 0) * stride;
+        for (int i = 0; i < count; i++)
+        {
+            sum[i] += add[i] - remove[i];
+        }
+    }
+}
+
+} // namespace
+
+void Blur::Separable(const ImageView& image, const float* kernel, int radius)
+{
+    if (!image.IsValid() || !kernel || radius < 0)
+        return;
+
+    int width = image.width;
+    int height = image.height;
+    int taps = 2 * radius + 1;
+    size_t stride = static_cast<size_t>(width) * 3;
+    std::vector<float> horizontal(stride * height);
+
+    int bands = (height + kRowsPerTask - 1) / kRowsPerTask;
+    GetEffectThreadPool().ParallelFor(bands, [&](int band) {
+        // Row with radius clamped pixels on each side
+        std::vector<float> padded((width + 2 * radius) * 3);
+        float* inner = padded.data() + radius * 3;
+
+        int y1 = std::min((band + 1) * kRowsPerTask, height);
+        for (int y = band * kRowsPerTask; y < y1; y++)
+        {
+            LoadRow(image.Row(y), inner, width);
+            for (int i = 0; i < radius; i++)
+            {
+                std::copy(inner, inner + 3, padded.data() + i * 3);
+                std::copy(inner + (width - 1) * 3, inner + width * 3, inner + (width + i) * 3);
+            }
+
+            float* out = horizontal.data() + y * stride;
+            std::fill(out, out + stride, 0.0f);
+            for (int k = 0; k < taps; k++)
+            {
+                float weight = kernel[k];
+                const float* source = padded.data() + k * 3;
+                for (size_t i = 0; i < stride; i++)
+                {
+                    out[i] += weight * source[i];
+                }
+            }
+        }
+    });
+
+    int strips = (width + kColumnsPerTask - 1) / kColumnsPerTask;
+    GetEffectThreadPool().ParallelFor(strips, [&](int strip) {
+        int x0 = strip * kColumnsPerTask;
+        int x1 = std::min(x0 + kColumnsPerTask, width);
+        int count = (x1 - x0) * 3;
+        std::vector<float> sum(count);
+
+        for (int y = 0; y < height; y++)
+        {
+            std::fill(sum.begin(), sum.end(), 0.0f);
+            for (int k = 0; k < taps; k++)
+            {
+                int sy = std::max(0, std::min(height - 1, y + k - radius));
+                const float* row = horizontal.data() + sy * stride + x0 * 3;
+                float weight = kernel[k];
+                for (int i = 0; i < count; i++)
+                {
+                    sum[i] += weight * row[i];
+                }
+            }
+
+            StoreRow(sum.data(), image.Row(y) + x0, x1 - x0);
+        }
+    });
+}
+
+void Blur::Box(const ImageView& image, int radius, int passes)
+{
+    if (!image.IsValid() || radius <= 0 || passes <= 0)
+        return;
+
+    std::vector<int> radii(passes, radius);
+    BoxPasses(image, radii.data(), passes);
+}
+
+void Blur::Gaussian(const ImageView& image, float sigma)
+{
+    if (!image.IsValid() || sigma <= 0.0f)
+        return;
+
+    int radius = static_cast<int>(ceilf(3.0f * sigma));
+    if (radius <= kMaxSeparableRadius)
+    {
+        std::vector<float> kernel = GaussianKernel(sigma, radius);
+        Separable(image, kernel.data(), radius);
+        return;
+    }
+
+    int radii[3];
+    BoxRadiiForGaussian(sigma, 3, radii);
+    BoxPasses(image, radii, 3);
+}
+
+void Blur::Smooth(const ImageView& image, const std::vector<float>& kernel)
+{
+    if (!image.IsValid() || kernel.size() % 2 == 0)
+        return;
+
+    int radius = static_cast<int>(kernel.size() / 2);
+    if (radius <= kMaxSeparableRadius)
+    {
+        Separable(image, kernel.data(), radius);
+        return;
+    }
+
+    int radii[3];
+    BoxRadiiForGaussian(KernelSigma(kernel.data(), radius), 3, radii);
+    BoxPasses(image, radii, 3);
+}
+
+std::vector<float> Blur::GaussianKernel(float sigma, int radius)
+{
+    std::vector<float> kernel(2 * radius + 1);
+    float sum = 0.0f;
+
+    for (int i = -radius; i <= radius; i++)
+    {
+        float value = expf(-static_cast<float>(i * i) / (2.0f * sigma * sigma));
+        kernel[i + radius] = value;
+        sum += value;
+    }
+
+    for (float& value : kernel)
+    {
+        value /= sum;
+    }
+    return kernel;
+}
+
+void Blur::BoxRadiiForGaussian(float sigma, int passes, int* radii)
+{
+    // n boxes of widths w have a combined variance of sum((w^2 - 1) / 12).
+    // Take the odd widths just below and above the ideal one and pick how
+    // many of each get closest to sigma^2.
+    float variance12 = 12.0f * sigma * sigma;
+    float ideal = sqrtf(variance12 / passes + 1.0f);
+
+    int lower = static_cast<int>(floorf(ideal));
+    if (lower % 2 == 0)
+        lower--;
+    lower = std::max(1, lower);
+    int upper = lower + 2;
+
+    float lowerCount = (variance12 - passes * lower * lower - 4.0f * passes * lower - 3.0f * passes) /
+                       (-4.0f * lower - 4.0f);
+    int m = std::max(0, std::min(passes, static_cast<int>(lroundf(lowerCount))));
+
+    for (int i = 0; i < passes; i++)
+    {
+        int boxWidth = i < m ? lower : upper;
+        radii[i] = (boxWidth - 1) / 2;
+    }
+}
+
+float Blur::KernelSigma(const float* kernel, int radius)
+{
+    float sum = 0.0f;
+    float moment = 0.0f;
+
+    for (int i = -radius; i <= radius; i++)
+    {
+        sum += kernel[i + radius];
+        moment += kernel[i + radius] * static_cast<float>(i * i);
+    }
+
+    return sum > 0.0f ? sqrtf(moment / sum) : 0.0f;
+}
+
+void Blur::BoxPasses(const ImageView& image, const int* radii, int passes)
+{
+    int width = image.width;
+    int height = image.height;
+    size_t stride = static_cast<size_t>(width) * 3;
+    std::vector<float> front(stride * height);
+    std::vector<float> back(stride * height);
+
+    // Every horizontal pass of a row in one go, while the row is in cache
+    int bands = (height + kRowsPerTask - 1) / kRowsPerTask;
+    GetEffectThreadPool().ParallelFor(bands, [&](int band) {
+        std::vector<float> a(stride);
+        std::vector<float> b(stride);
+
+        int y1 = std::min((band + 1) * kRowsPerTask, height);
+        for (int y = band * kRowsPerTask; y < y1; y++)
+        {
+            LoadRow(image.Row(y), a.data(), width);
+            for (int pass = 0; pass < passes; pass++)
+            {
+                if (radii[pass] > 0)
+                {
+                    BoxRow(a.data(), b.data(), width, radii[pass]);
+                    a.swap(b);
+                }
+            }
+            std::copy(a.begin(), a.end(), front.begin() + y * stride);
+        }
+    });
+
+    int strips = (width + kColumnsPerTask - 1) / kColumnsPerTask;
+    GetEffectThreadPool().ParallelFor(strips, [&](int strip) {
+        int x0 = strip * kColumnsPerTask;
+        int x1 = std::min(x0 + kColumnsPerTask, width);
+
+        // Ping-pong between the buffers; strips never overlap
+        float* source = front.data();
+        float* destination = back.data();
+        for (int pass = 0; pass < passes; pass++)
+        {
+            if (radii[pass] > 0)
+            {
+                BoxColumns(source, destination, width, height, x0, x1, radii[pass]);
+                std::swap(source, destination);
+            }
+        }
+
+        for (int y = 0; y < height; y++)
+        {
+            StoreRow(source + y * stride + x0 * 3, image.Row(y) + x0, x1 - x0);
+        }
+    });
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include "PixelBuffer.h"
+
+namespace TextureEffects {
+
+    // Separable blurs on 32-bit ARGB images. Color channels are filtered in
+    // float with clamp-to-edge borders and rounded once at the end; alpha is
+    // kept. Rows and column strips are spread over the thread pool and the
+    // result does not depend on the thread count.
+    class Blur {
+    public:
+        // Gaussians whose kernel reaches further than this many pixels run as
+        // three box passes instead of a direct separable convolution
+        static const int kMaxSeparableRadius = 8;
+
+        // Horizontal then vertical pass of a symmetric kernel of 2 * radius + 1
+        // taps (kernel[radius] is the center). Cost grows with the radius.
+        static void Separable(const ImageView& image, const float* kernel, int radius);
+
+        // Running-sum box filter of 2 * radius + 1 pixels, repeated passes
+        // times in each direction. Cost does not depend on the radius.
+        static void Box(const ImageView& image, int radius, int passes = 1);
+
+        // Gaussian of the given standard deviation: separable up to
+        // kMaxSeparableRadius, three box passes of matching variance above.
+        static void Gaussian(const ImageView& image, float sigma);
+
+        // Blurs with an explicit symmetric kernel, switching to box passes of
+        // the same variance when it is wider than kMaxSeparableRadius
+        static void Smooth(const ImageView& image, const std::vector<float>& kernel);
+
+        // Normalized Gaussian taps for offsets -radius..radius
+        static std::vector<float> GaussianKernel(float sigma, int radius);
+
+        // Box radii whose repeated convolution has the variance of a Gaussian
+        // of this sigma (the widths differ by at most two pixels)
+        static void BoxRadiiForGaussian(float sigma, int passes, int* radii);
+
+        // Standard deviation of a symmetric kernel (2 * radius + 1 taps)
+        static float KernelSigma(const float* kernel, int radius);
+
+    private:
+        static void BoxPasses(const ImageView& image, const int* radii, int passes);
+    };
+
+}
@@ -0,0 +1,228 @@
+#include "ColorLut.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLOR_LUT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TextureEffects {
+
+namespace {
+
+// Lattice entries around one color and their interpolation weights
+struct Corners {
+    size_t offsets[8];
+    float weights[8];
+    int count;
+};
+
+} // namespace
+
+ColorLut3D::ColorLut3D(int size)
+    : m_size(std::max(2, std::min(256, size)))
+{
+    // Grid points on whole byte values, spread evenly over 0..255
+    std::vector<int> grid(m_size);
+    for (int i = 0; i < m_size; i++)
+    {
+        grid[i] = (i * 255 + (m_size - 1) / 2) / (m_size - 1);
+    }
+
+    int cell = 0;
+    for (int v = 0; v < 256; v++)
+    {
+        while (cell < m_size - 2 && v >= grid[cell + 1])
+            cell++;
+        m_index[v] = cell;
+        m_fraction[v] = static_cast<float>(v - grid[cell]) / static_cast<float>(grid[cell + 1] - grid[cell]);
+    }
+
+    size_t count = static_cast<size_t>(m_size) * m_size * m_size;
+    m_entries.resize(count);
+    m_cells.resize(count * 4);
+
+    size_t index = 0;
+    for (int r = 0; r < m_size; r++)
+    {
+        for (int g = 0; g < m_size; g++)
+        {
+            for (int b = 0; b < m_size; b++, index++)
+            {
+                m_entries[index] = D3DCOLOR_ARGB(255, grid[r], grid[g], grid[b]);
+                UpdateCell(index);
+            }
+        }
+    }
+}
+
+void ColorLut3D::Transform(const PointOp& op)
+{
+    if (!op.apply) return;
+
+    PixelSpan span;
+    span.pixels = m_entries.data();
+    span.count = static_cast<int>(m_entries.size());
+    span.width = span.count;
+    span.height = 1;
+    op.apply(span);
+
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        UpdateCell(i);
+    }
+}
+
+void ColorLut3D::UpdateCell(size_t index)
+{
+    D3DCOLOR color = m_entries[index];
+    float* cell = &m_cells[index * 4];
+    cell[0] = static_cast<float>(color & 0xFF);
+    cell[1] = static_cast<float>((color >> 8) & 0xFF);
+    cell[2] = static_cast<float>((color >> 16) & 0xFF);
+    cell[3] = 0.0f;
+}
+
+size_t ColorLut3D::GetMemoryUsage() const
+{
+    return m_entries.size() * sizeof(D3DCOLOR) + m_cells.size() * sizeof(float);
+}
+
+namespace {
+
+inline void FindCorners(D3DCOLOR color, int size, const int* index, const float* fraction,
+                        LutInterpolation interpolation, Corners& corners)
+{
+    int r = (color >> 16) & 0xFF;
+    int g = (color >> 8) & 0xFF;
+    int b = color & 0xFF;
+
+    size_t strideR = static_cast<size_t>(size) * size;
+    size_t strideG = static_cast<size_t>(size);
+    size_t base = index[r] * strideR + index[g] * strideG + index[b];
+    float fr = fraction[r];
+    float fg = fraction[g];
+    float fb = fraction[b];
+
+    if (interpolation == LutInterpolation::Trilinear)
+    {
+        corners.count = 8;
+        for (int i = 0; i < 8; i++)
+        {
+            int dr = (i >> 2) & 1;
+            int dg = (i >> 1) & 1;
+            int db = i & 1;
+            corners.offsets[i] = base + dr * strideR + dg * strideG + db;
+            corners.weights[i] = (dr ? fr : 1.0f - fr) * (dg ? fg : 1.0f - fg) * (db ? fb : 1.0f - fb);
+        }
+        return;
+    }
+
+    // The cube splits into six tetrahedra along its gray diagonal; the order
+    // of the three fractions picks one. Walk from the base corner towards the
+    // opposite one, adding the channel with the largest fraction first.
+    size_t first, second;
+    float high, middle, low;
+    if (fr > fg)
+    {
+        if (fg > fb)      { first = strideR; second = strideR + strideG; high = fr; middle = fg; low = fb; }
+        else if (fr > fb) { first = strideR; second = strideR + 1;       high = fr; middle = fb; low = fg; }
+        else              { first = 1;       second = strideR + 1;       high = fb; middle = fr; low = fg; }
+    }
+    else
+    {
+        if (fb > fg)      { first = 1;       second = strideG + 1;       high = fb; middle = fg; low = fr; }
+        else if (fb > fr) { first = strideG; second = strideG + 1;       high = fg; middle = fb; low = fr; }
+        else              { first = strideG; second = strideR + strideG; high = fg; middle = fr; low = fb; }
+    }
+
+    corners.count = 4;
+    corners.offsets[0] = base;
+    corners.offsets[1] = base + first;
+    corners.offsets[2] = base + second;
+    corners.offsets[3] = base + strideR + strideG + 1;
+    corners.weights[0] = 1.0f - high;
+    corners.weights[1] = high - middle;
+    corners.weights[2] = middle - low;
+    corners.weights[3] = low;
+}
+
+// Weighted sum of the corner cells, rounded; alpha comes from the source.
+// The scalar version adds in the same order, so both give the same bytes.
+inline D3DCOLOR Blend(const float* cells, const Corners& corners, D3DCOLOR source)
+{
+#if defined(COLOR_LUT_SSE2)
+    __m128 sum = _mm_mul_ps(_mm_loadu_ps(cells + corners.offsets[0] * 4), _mm_set1_ps(corners.weights[0]));
+    for (int i = 1; i < corners.count; i++)
+    {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(cells + corners.offsets[i] * 4), _mm_set1_ps(corners.weights[i])));
+    }
+
+    __m128i value = _mm_cvttps_epi32(_mm_add_ps(sum, _mm_set1_ps(0.5f)));
+    value = _mm_packs_epi32(value, value);
+    value = _mm_packus_epi16(value, value);
+    return (source & 0xFF000000) | (static_cast<D3DCOLOR>(_mm_cvtsi128_si32(value)) & 0x00FFFFFF);
+#else
+    float sum[3];
+    const float* cell = cells + corners.offsets[0] * 4;
+    for (int c = 0; c < 3; c++)
+    {
+        sum[c] = cell[c] * corners.weights[0];
+    }
+    for (int i = 1; i < corners.count; i++)
+    {
+        cell = cells + corners.offsets[i] * 4;
+        for (int c = 0; c < 3; c++)
+        {
+            sum[c] = sum[c] + cell[c] * corners.weights[i];
+        }
+    }
+
+    BYTE b = static_cast<BYTE>(std::min(255, static_cast<int>(sum[0] + 0.5f)));
+    BYTE g = static_cast<BYTE>(std::min(255, static_cast<int>(sum[1] + 0.5f)));
+    BYTE r = static_cast<BYTE>(std::min(255, static_cast<int>(sum[2] + 0.5f)));
+    return D3DCOLOR_ARGB((source >> 24) & 0xFF, r, g, b);
+#endif
+}
+
+} // namespace
+
+D3DCOLOR ColorLut3D::Lookup(D3DCOLOR color, LutInterpolation interpolation) const
+{
+    Corners corners;
+    FindCorners(color, m_size, m_index, m_fraction, interpolation, corners);
+    return Blend(m_cells.data(), corners, color);
+}
+
+void ColorLut3D::Apply(D3DCOLOR* pixels, int count, LutInterpolation interpolation) const
+{
+    const float* cells = m_cells.data();
+    Corners corners;
+
+    // One loop per mode so the corner count is a constant inside each
+    if (interpolation == LutInterpolation::Trilinear)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            FindCorners(pixels[i], m_size, m_index, m_fraction, LutInterpolation::Trilinear, corners);
+            pixels[i] = Blend(cells, corners, pixels[i]);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+        {
+            FindCorners(pixels[i], m_size, m_index, m_fraction, LutInterpolation::Tetrahedral, corners);
+            pixels[i] = Blend(cells, corners, pixels[i]);
+        }
+    }
+}
+
+void ColorLut3D::Apply(const ImageView& image, LutInterpolation interpolation) const
+{
+    PointOp op;
+    op.apply = [this, interpolation](const PixelSpan& span) { Apply(span.pixels, span.count, interpolation); };
+    PointOps::Run(image, op);
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include "PointOps.h"
+
+namespace TextureEffects {
+
+    enum class LutInterpolation {
+        Trilinear,      // 8 grid entries per pixel
+        Tetrahedral     // 4 grid entries per pixel, keeps the gray axis exact
+    };
+
+    // size^3 lattice of colors sampled from a stack of color operations.
+    // Grid points sit on whole byte values, so entries are exact results of
+    // the ops; colors in between are interpolated. Suited to smooth color
+    // grading; ops with hard steps (posterize, threshold) blur at the steps.
+    class ColorLut3D {
+    public:
+        static const int kDefaultSize = 33;
+
+        // Identity lattice, size clamped to 2..256
+        explicit ColorLut3D(int size = kDefaultSize);
+
+        // Runs op over every entry, so the LUT then maps color to
+        // op(previous LUT(color)). op must not depend on pixel position.
+        void Transform(const PointOp& op);
+
+        D3DCOLOR Lookup(D3DCOLOR color, LutInterpolation interpolation) const;
+
+        // Alpha is kept
+        void Apply(D3DCOLOR* pixels, int count, LutInterpolation interpolation) const;
+        void Apply(const ImageView& image, LutInterpolation interpolation) const;
+
+        int GetSize() const { return m_size; }
+        size_t GetMemoryUsage() const;
+
+    private:
+        void UpdateCell(size_t index);
+
+        int m_size;
+        std::vector<D3DCOLOR> m_entries;    // Red major, then green, then blue
+        std::vector<float> m_cells;         // Entries as blue, green, red, 0 floats
+        int m_index[256];                   // Grid cell of each channel value
+        float m_fraction[256];              // Position inside that cell
+    };
+
+}
@@ -0,0 +1,532 @@
+#include "ColorSpace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLOR_SPACE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TextureEffects {
+
+namespace {
+
+// Four floats, one per pixel. The conversions below are written once against
+// this type; the SSE2 and scalar versions round the same way, so both give
+// the same bytes.
+#if defined(COLOR_SPACE_SSE2)
+
+struct Float4 {
+    __m128 v;
+};
+
+// All bits set in lanes where a comparison holds
+typedef Float4 Mask4;
+
+inline Float4 Set(float value) { return { _mm_set1_ps(value) }; }
+inline Float4 Load(const float* p) { return { _mm_loadu_ps(p) }; }
+inline void Store(float* p, Float4 a) { _mm_storeu_ps(p, a.v); }
+
+inline Float4 operator+(Float4 a, Float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline Float4 operator-(Float4 a, Float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline Float4 operator*(Float4 a, Float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline Float4 operator/(Float4 a, Float4 b) { return { _mm_div_ps(a.v, b.v) }; }
+inline Float4 Min(Float4 a, Float4 b) { return { _mm_min_ps(a.v, b.v) }; }
+inline Float4 Max(Float4 a, Float4 b) { return { _mm_max_ps(a.v, b.v) }; }
+inline Float4 Sqrt(Float4 a) { return { _mm_sqrt_ps(a.v) }; }
+
+inline Mask4 Equal(Float4 a, Float4 b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+inline Mask4 Less(Float4 a, Float4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline Mask4 Greater(Float4 a, Float4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+
+// mask ? a : b per lane
+inline Float4 Select(Mask4 mask, Float4 a, Float4 b)
+{
+    return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+}
+
+// Values well inside the int range
+inline Float4 Floor(Float4 a)
+{
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return { _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.0f))) };
+}
+
+// Rough cube root of positive values from the float bits
+inline Float4 CbrtEstimate(Float4 a)
+{
+    __m128i bits = _mm_castps_si128(a.v);
+    __m128 third = _mm_mul_ps(_mm_cvtepi32_ps(bits), _mm_set1_ps(1.0f / 3.0f));
+    return { _mm_castsi128_ps(_mm_add_epi32(_mm_cvttps_epi32(third), _mm_set1_epi32(0x2A5137A0))) };
+}
+
+// Red, green and blue of four pixels, in 0..255
+inline void Unpack(const D3DCOLOR* colors, Float4& r, Float4& g, Float4& b)
+{
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors));
+    __m128i mask = _mm_set1_epi32(0xFF);
+    r.v = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 16), mask));
+    g.v = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8), mask));
+    b.v = _mm_cvtepi32_ps(_mm_and_si128(pixels, mask));
+}
+
+// Writes red, green and blue (0..1, clamped and rounded) over four pixels,
+// keeping their alpha
+inline void Pack(Float4 r, Float4 g, Float4 b, D3DCOLOR* colors)
+{
+    __m128 scale = _mm_set1_ps(255.0f);
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 zero = _mm_setzero_ps();
+    __m128i ri = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(r.v, scale), half), zero), scale));
+    __m128i gi = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(g.v, scale), half), zero), scale));
+    __m128i bi = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(b.v, scale), half), zero), scale));
+
+    __m128i* target = reinterpret_cast<__m128i*>(colors);
+    __m128i alpha = _mm_and_si128(_mm_loadu_si128(target), _mm_set1_epi32(static_cast<int>(0xFF000000)));
+    __m128i rgb = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ri, 16), _mm_slli_epi32(gi, 8)), bi);
+    _mm_storeu_si128(target, _mm_or_si128(alpha, rgb));
+}
+
+#else
+
+struct Float4 {
+    float v[4];
+};
+
+struct Mask4 {
+    bool m[4];
+};
+
+template <typename Func>
+inline Float4 Map(Func func)
+{
+    Float4 result;
+    for (int i = 0; i < 4; i++)
+        result.v[i] = func(i);
+    return result;
+}
+
+template <typename Func>
+inline Mask4 Test(Func func)
+{
+    Mask4 result;
+    for (int i = 0; i < 4; i++)
+        result.m[i] = func(i);
+    return result;
+}
+
+inline Float4 Set(float value) { return { { value, value, value, value } }; }
+inline Float4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+inline void Store(float* p, Float4 a) { memcpy(p, a.v, sizeof(a.v)); }
+
+inline Float4 operator+(Float4 a, Float4 b) { return Map([&](int i) { return a.v[i] + b.v[i]; }); }
+inline Float4 operator-(Float4 a, Float4 b) { return Map([&](int i) { return a.v[i] - b.v[i]; }); }
+inline Float4 operator*(Float4 a, Float4 b) { return Map([&](int i) { return a.v[i] * b.v[i]; }); }
+inline Float4 operator/(Float4 a, Float4 b) { return Map([&](int i) { return a.v[i] / b.v[i]; }); }
+inline Float4 Min(Float4 a, Float4 b) { return Map([&](int i) { return a.v[i] < b.v[i] ? a.v[i] : b.v[i]; }); }
+inline Float4 Max(Float4 a, Float4 b) { return Map([&](int i) { return a.v[i] > b.v[i] ? a.v[i] : b.v[i]; }); }
+inline Float4 Sqrt(Float4 a) { return Map([&](int i) { return sqrtf(a.v[i]); }); }
+
+inline Mask4 Equal(Float4 a, Float4 b) { return Test([&](int i) { return a.v[i] == b.v[i]; }); }
+inline Mask4 Less(Float4 a, Float4 b) { return Test([&](int i) { return a.v[i] < b.v[i]; }); }
+inline Mask4 Greater(Float4 a, Float4 b) { return Test([&](int i) { return a.v[i] > b.v[i]; }); }
+
+inline Float4 Select(Mask4 mask, Float4 a, Float4 b)
+{
+    return Map([&](int i) { return mask.m[i] ? a.v[i] : b.v[i]; });
+}
+
+inline Float4 Floor(Float4 a)
+{
+    return Map([&](int i) {
+        float truncated = static_cast<float>(static_cast<int>(a.v[i]));
+        return truncated > a.v[i] ? truncated - 1.0f : truncated;
+    });
+}
+
+inline Float4 CbrtEstimate(Float4 a)
+{
+    return Map([&](int i) {
+        int bits;
+        memcpy(&bits, &a.v[i], sizeof(bits));
+        bits = static_cast<int>(static_cast<float>(bits) * (1.0f / 3.0f)) + 0x2A5137A0;
+        float estimate;
+        memcpy(&estimate, &bits, sizeof(estimate));
+        return estimate;
+    });
+}
+
+inline void Unpack(const D3DCOLOR* colors, Float4& r, Float4& g, Float4& b)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        r.v[i] = static_cast<float>((colors[i] >> 16) & 0xFF);
+        g.v[i] = static_cast<float>((colors[i] >> 8) & 0xFF);
+        b.v[i] = static_cast<float>(colors[i] & 0xFF);
+    }
+}
+
+inline void Pack(Float4 r, Float4 g, Float4 b, D3DCOLOR* colors)
+{
+    auto toByte = [](float value) {
+        float scaled = value * 255.0f + 0.5f;
+        scaled = scaled > 0.0f ? scaled : 0.0f;
+        scaled = scaled < 255.0f ? scaled : 255.0f;
+        return static_cast<D3DCOLOR>(static_cast<int>(scaled));
+    };
+
+    for (int i = 0; i < 4; i++)
+    {
+        colors[i] = (colors[i] & 0xFF000000) | (toByte(r.v[i]) << 16) | (toByte(g.v[i]) << 8) | toByte(b.v[i]);
+    }
+}
+
+#endif
+
+inline Float4 Clamp(Float4 value, float low, float high)
+{
+    return Min(Max(value, Set(low)), Set(high));
+}
+
+// Unpacked channels scaled to 0..1
+inline void UnpackUnit(const D3DCOLOR* colors, Float4& r, Float4& g, Float4& b)
+{
+    Unpack(colors, r, g, b);
+    Float4 scale = Set(1.0f / 255.0f);
+    r = r * scale;
+    g = g * scale;
+    b = b * scale;
+}
+
+// value - period * floor(value / period), in [0, period]
+inline Float4 Wrap(Float4 value, float period)
+{
+    return value - Set(period) * Floor(value * Set(1.0f / period));
+}
+
+// Hue in degrees shared by HSV and HSL: which channel is largest picks the
+// sector, the other two the position inside it
+inline Float4 Hue(Float4 r, Float4 g, Float4 b, Float4 max, Float4 delta)
+{
+    Float4 zero = Set(0.0f);
+    Mask4 gray = Equal(delta, zero);
+    Float4 safeDelta = Select(gray, Set(1.0f), delta);
+
+    Float4 fromRed = (g - b) / safeDelta;
+    fromRed = fromRed + Select(Less(fromRed, zero), Set(6.0f), zero);
+    Float4 fromGreen = (b - r) / safeDelta + Set(2.0f);
+    Float4 fromBlue = (r - g) / safeDelta + Set(4.0f);
+
+    Float4 sector = Select(Equal(max, r), fromRed, Select(Equal(max, g), fromGreen, fromBlue));
+    return Select(gray, zero, sector * Set(60.0f));
+}
+
+void RGBToHSV4(const D3DCOLOR* colors, float* h, float* s, float* v)
+{
+    Float4 r, g, b;
+    UnpackUnit(colors, r, g, b);
+
+    Float4 max = Max(r, Max(g, b));
+    Float4 delta = max - Min(r, Min(g, b));
+    Float4 safeMax = Select(Equal(max, Set(0.0f)), Set(1.0f), max);
+
+    Store(h, Hue(r, g, b, max, delta));
+    Store(s, delta / safeMax);
+    Store(v, max);
+}
+
+// value - value * saturation * clamp(min(k, 4 - k), 0, 1), k = (n + hue / 60) mod 6
+inline Float4 HSVChannel(float n, Float4 sector, Float4 chroma, Float4 value)
+{
+    Float4 k = Set(n) + sector;
+    k = Select(Less(k, Set(6.0f)), k, k - Set(6.0f));
+    return value - chroma * Clamp(Min(k, Set(4.0f) - k), 0.0f, 1.0f);
+}
+
+void HSVToRGB4(const float* h, const float* s, const float* v, D3DCOLOR* colors)
+{
+    Float4 sector = Wrap(Load(h) * Set(1.0f / 60.0f), 6.0f);
+    Float4 value = Clamp(Load(v), 0.0f, 1.0f);
+    Float4 chroma = value * Clamp(Load(s), 0.0f, 1.0f);
+
+    Pack(HSVChannel(5.0f, sector, chroma, value), HSVChannel(3.0f, sector, chroma, value),
+         HSVChannel(1.0f, sector, chroma, value), colors);
+}
+
+void RGBToHSL4(const D3DCOLOR* colors, float* h, float* s, float* l)
+{
+    Float4 r, g, b;
+    UnpackUnit(colors, r, g, b);
+
+    Float4 max = Max(r, Max(g, b));
+    Float4 min = Min(r, Min(g, b));
+    Float4 delta = max - min;
+    Float4 sum = max + min;
+
+    // delta / (1 - |2L - 1|), kept to 1 against rounding; the divisor is
+    // only zero for grays
+    Float4 offset = sum - Set(1.0f);
+    Float4 divisor = Set(1.0f) - Max(offset, Set(0.0f) - offset);
+    divisor = Select(Equal(delta, Set(0.0f)), Set(1.0f), divisor);
+
+    Store(h, Hue(r, g, b, max, delta));
+    Store(s, Min(delta / divisor, Set(1.0f)));
+    Store(l, sum * Set(0.5f));
+}
+
+// lightness - a * clamp(min(k - 3, 9 - k), -1, 1), k = (n + hue / 30) mod 12
+inline Float4 HSLChannel(float n, Float4 sector, Float4 a, Float4 lightness)
+{
+    Float4 k = Set(n) + sector;
+    k = Select(Less(k, Set(12.0f)), k, k - Set(12.0f));
+    return lightness - a * Clamp(Min(k - Set(3.0f), Set(9.0f) - k), -1.0f, 1.0f);
+}
+
+void HSLToRGB4(const float* h, const float* s, const float* l, D3DCOLOR* colors)
+{
+    Float4 sector = Wrap(Load(h) * Set(1.0f / 30.0f), 12.0f);
+    Float4 lightness = Clamp(Load(l), 0.0f, 1.0f);
+    Float4 a = Clamp(Load(s), 0.0f, 1.0f) * Min(lightness, Set(1.0f) - lightness);
+
+    Pack(HSLChannel(0.0f, sector, a, lightness), HSLChannel(8.0f, sector, a, lightness),
+         HSLChannel(4.0f, sector, a, lightness), colors);
+}
+
+// CIE constants: epsilon = (6/29)^3, kappa = (29/3)^3
+const float kLabEpsilon = 216.0f / 24389.0f;
+const float kLabKappa = 24389.0f / 27.0f;
+
+// Exact sRGB decoding of each byte, and encoding of linear values sampled on
+// a square-root scale, which packs the samples where the curve is steep
+const int kEncodeSamples = 4096;
+
+struct SRGBTables {
+    float decode[256];
+    BYTE encode[kEncodeSamples];
+
+    SRGBTables()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            double c = i / 255.0;
+            decode[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+        }
+        for (int i = 0; i < kEncodeSamples; i++)
+        {
+            double root = static_cast<double>(i) / (kEncodeSamples - 1);
+            double linear = root * root;
+            double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+            encode[i] = static_cast<BYTE>(c * 255.0 + 0.5);
+        }
+    }
+};
+
+const SRGBTables& GetSRGBTables()
+{
+    static const SRGBTables tables;
+    return tables;
+}
+
+// Positions of four linear values in the encoding table
+inline void EncodeIndices(Float4 linear, float* index)
+{
+    Store(index, Sqrt(Clamp(linear, 0.0f, 1.0f)) * Set(static_cast<float>(kEncodeSamples - 1)) + Set(0.5f));
+}
+
+// Lab's f(t): cube root above epsilon, a line below. Newton steps from the
+// bit estimate refine the root to float precision.
+inline Float4 LabCompress(Float4 t)
+{
+    Float4 x = Max(t, Set(kLabEpsilon));
+    Float4 root = CbrtEstimate(x);
+    Float4 third = Set(1.0f / 3.0f);
+    for (int i = 0; i < 3; i++)
+    {
+        root = (root + root + x / (root * root)) * third;
+    }
+    Float4 line = (Set(kLabKappa) * t + Set(16.0f)) * Set(1.0f / 116.0f);
+    return Select(Greater(t, Set(kLabEpsilon)), root, line);
+}
+
+inline Float4 LabExpand(Float4 f)
+{
+    Float4 cube = f * f * f;
+    Float4 line = (Set(116.0f) * f - Set(16.0f)) * Set(1.0f / kLabKappa);
+    return Select(Greater(cube, Set(kLabEpsilon)), cube, line);
+}
+
+// sRGB to XYZ (D65), rows divided by the white point
+const float kToXYZ[3][3] = {
+    { 0.4124564f / 0.95047f, 0.3575761f / 0.95047f, 0.1804375f / 0.95047f },
+    { 0.2126729f, 0.7151522f, 0.0721750f },
+    { 0.0193339f / 1.08883f, 0.1191920f / 1.08883f, 0.9503041f / 1.08883f },
+};
+
+// Inverse of the above, columns multiplied by the white point
+const float kFromXYZ[3][3] = {
+    {  3.2404542f * 0.95047f, -1.5371385f, -0.4985314f * 1.08883f },
+    { -0.9692660f * 0.95047f,  1.8760108f,  0.0415560f * 1.08883f },
+    {  0.0556434f * 0.95047f, -0.2040259f,  1.0572252f * 1.08883f },
+};
+
+inline Float4 Row(const float (&row)[3], Float4 x, Float4 y, Float4 z)
+{
+    return Set(row[0]) * x + Set(row[1]) * y + Set(row[2]) * z;
+}
+
+void RGBToLab4(const D3DCOLOR* colors, float* l, float* a, float* b)
+{
+    const float* decode = GetSRGBTables().decode;
+    float linear[3][4];
+    for (int i = 0; i < 4; i++)
+    {
+        linear[0][i] = decode[(colors[i] >> 16) & 0xFF];
+        linear[1][i] = decode[(colors[i] >> 8) & 0xFF];
+        linear[2][i] = decode[colors[i] & 0xFF];
+    }
+
+    Float4 red = Load(linear[0]);
+    Float4 green = Load(linear[1]);
+    Float4 blue = Load(linear[2]);
+
+    Float4 fx = LabCompress(Row(kToXYZ[0], red, green, blue));
+    Float4 fy = LabCompress(Row(kToXYZ[1], red, green, blue));
+    Float4 fz = LabCompress(Row(kToXYZ[2], red, green, blue));
+
+    Store(l, Set(116.0f) * fy - Set(16.0f));
+    Store(a, Set(500.0f) * (fx - fy));
+    Store(b, Set(200.0f) * (fy - fz));
+}
+
+void LabToRGB4(const float* l, const float* a, const float* b, D3DCOLOR* colors)
+{
+    Float4 fy = (Load(l) + Set(16.0f)) * Set(1.0f / 116.0f);
+    Float4 x = LabExpand(fy + Load(a) * Set(1.0f / 500.0f));
+    Float4 y = LabExpand(fy);
+    Float4 z = LabExpand(fy - Load(b) * Set(1.0f / 200.0f));
+
+    float index[3][4];
+    for (int c = 0; c < 3; c++)
+    {
+        EncodeIndices(Row(kFromXYZ[c], x, y, z), index[c]);
+    }
+
+    const BYTE* encode = GetSRGBTables().encode;
+    for (int i = 0; i < 4; i++)
+    {
+        BYTE red = encode[static_cast<int>(index[0][i])];
+        BYTE green = encode[static_cast<int>(index[1][i])];
+        BYTE blue = encode[static_cast<int>(index[2][i])];
+        colors[i] = (colors[i] & 0xFF000000) | D3DCOLOR_ARGB(0, red, green, blue);
+    }
+}
+
+// Runs a four-pixel conversion over count pixels; the last partial group goes
+// through padded copies so every pixel takes the same path
+template <typename Kernel>
+void FromColors(const D3DCOLOR* colors, float* c0, float* c1, float* c2, int count, Kernel kernel)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        kernel(colors + i, c0 + i, c1 + i, c2 + i);
+    }
+    if (i < count)
+    {
+        int rest = count - i;
+        D3DCOLOR source[4] = {};
+        float out[3][4];
+        memcpy(source, colors + i, rest * sizeof(D3DCOLOR));
+        kernel(source, out[0], out[1], out[2]);
+        memcpy(c0 + i, out[0], rest * sizeof(float));
+        memcpy(c1 + i, out[1], rest * sizeof(float));
+        memcpy(c2 + i, out[2], rest * sizeof(float));
+    }
+}
+
+template <typename Kernel>
+void ToColors(const float* c0, const float* c1, const float* c2, D3DCOLOR* colors, int count, Kernel kernel)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        kernel(c0 + i, c1 + i, c2 + i, colors + i);
+    }
+    if (i < count)
+    {
+        int rest = count - i;
+        float in[3][4] = {};
+        D3DCOLOR target[4] = {};
+        memcpy(in[0], c0 + i, rest * sizeof(float));
+        memcpy(in[1], c1 + i, rest * sizeof(float));
+        memcpy(in[2], c2 + i, rest * sizeof(float));
+        memcpy(target, colors + i, rest * sizeof(D3DCOLOR));
+        kernel(in[0], in[1], in[2], target);
+        memcpy(colors + i, target, rest * sizeof(D3DCOLOR));
+    }
+}
+
+} // namespace
+
+void ColorSpace::RGBToHSV(const D3DCOLOR* colors, float* h, float* s, float* v, int count)
+{
+    FromColors(colors, h, s, v, count, RGBToHSV4);
+}
+
+void ColorSpace::HSVToRGB(const float* h, const float* s, const float* v, D3DCOLOR* colors, int count)
+{
+    ToColors(h, s, v, colors, count, HSVToRGB4);
+}
+
+void ColorSpace::RGBToHSL(const D3DCOLOR* colors, float* h, float* s, float* l, int count)
+{
+    FromColors(colors, h, s, l, count, RGBToHSL4);
+}
+
+void ColorSpace::HSLToRGB(const float* h, const float* s, const float* l, D3DCOLOR* colors, int count)
+{
+    ToColors(h, s, l, colors, count, HSLToRGB4);
+}
+
+void ColorSpace::RGBToLab(const D3DCOLOR* colors, float* l, float* a, float* b, int count)
+{
+    FromColors(colors, l, a, b, count, RGBToLab4);
+}
+
+void ColorSpace::LabToRGB(const float* l, const float* a, const float* b, D3DCOLOR* colors, int count)
+{
+    ToColors(l, a, b, colors, count, LabToRGB4);
+}
+
+void ColorSpace::DecodeSRGB(const D3DCOLOR* colors, float* rgba, int count)
+{
+    const float* decode = GetSRGBTables().decode;
+    for (int i = 0; i < count; i++)
+    {
+        D3DCOLOR color = colors[i];
+        float* out = rgba + i * 4;
+        out[0] = decode[(color >> 16) & 0xFF];
+        out[1] = decode[(color >> 8) & 0xFF];
+        out[2] = decode[color & 0xFF];
+        out[3] = static_cast<float>(color >> 24) * (1.0f / 255.0f);
+    }
+}
+
+void ColorSpace::EncodeSRGB(const float* rgba, D3DCOLOR* colors, int count)
+{
+    const BYTE* encode = GetSRGBTables().encode;
+    for (int i = 0; i < count; i++)
+    {
+        const float* in = rgba + i * 4;
+        float index[4];
+        EncodeIndices(Load(in), index);
+
+        float alpha = std::max(0.0f, std::min(1.0f, in[3]));
+        BYTE a = static_cast<BYTE>(static_cast<int>(alpha * 255.0f + 0.5f));
+        colors[i] = D3DCOLOR_ARGB(a, encode[static_cast<int>(index[0])], encode[static_cast<int>(index[1])],
+                                  encode[static_cast<int>(index[2])]);
+    }
+}
+
+} // namespace TextureEffects
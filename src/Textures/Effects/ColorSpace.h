@@ -0,0 +1,35 @@
+#pragma once
+
+#include "EffectTypes.h"
+
+namespace TextureEffects {
+
+    // Color space conversions over runs of pixels, in structure-of-arrays form:
+    // each component goes to (or comes from) an array of its own, so the
+    // conversions run four pixels at a time without branches. Conversions back
+    // to RGB wrap the hue, clamp and round to the nearest byte, and keep the
+    // alpha already in colors, so they can write over the source pixels.
+    // Utils::RGBToHSV and friends are the single-color versions of these.
+    class ColorSpace {
+    public:
+        // Hue in degrees [0, 360), saturation and value in [0, 1]
+        static void RGBToHSV(const D3DCOLOR* colors, float* h, float* s, float* v, int count);
+        static void HSVToRGB(const float* h, const float* s, const float* v, D3DCOLOR* colors, int count);
+
+        // Hue in degrees [0, 360), saturation and lightness in [0, 1]
+        static void RGBToHSL(const D3DCOLOR* colors, float* h, float* s, float* l, int count);
+        static void HSLToRGB(const float* h, const float* s, const float* l, D3DCOLOR* colors, int count);
+
+        // CIE L*a*b* from sRGB with a D65 white point: L in [0, 100], a and b
+        // roughly [-128, 128]
+        static void RGBToLab(const D3DCOLOR* colors, float* l, float* a, float* b, int count);
+        static void LabToRGB(const float* l, const float* a, const float* b, D3DCOLOR* colors, int count);
+
+        // Pixels to four floats each (red, green, blue, alpha in [0, 1]) with
+        // the sRGB curve taken off the colors, and back. Decoding is exact per
+        // byte; encoding clamps and lands on the nearest byte.
+        static void DecodeSRGB(const D3DCOLOR* colors, float* rgba, int count);
+        static void EncodeSRGB(const float* rgba, D3DCOLOR* colors, int count);
+    };
+
+}
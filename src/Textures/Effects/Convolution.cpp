@@ -0,0 +1,261 @@
+#include "Convolution.h"
+#include "ConvolutionKernels.h"
+#include "EffectThreads.h"
+#include "../../Core/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace TextureEffects {
+
+SimdLevel Convolution::s_simdLevel = CpuFeatures::GetMaxSimdLevel();
+
+namespace {
+
+const int kRowsPerTask = 16;
+
+// Fraction bits are capped so a full 0..255 sum of |weights| fits the 32-bit
+// accumulators with room to spare
+const int kMaxShift = 24;
+
+// Largest accumulated quantization error, in output levels, for which the
+// fixed point result is still within 1 LSB of the float one
+const double kMaxQuantizationError = 0.5;
+
+struct FixedKernel {
+    std::vector<int16_t> weights; // Tap order, padded to an even count
+    int shift = 0;
+};
+
+bool Quantize(const float* kernel, int kernelSize, float divisor, FixedKernel& fixed)
+{
+    int taps = kernelSize * kernelSize;
+    std::vector<double> weights(taps);
+    double maxAbs = 0.0;
+    double sumAbs = 0.0;
+    double sum = 0.0;
+
+    for (int k = 0; k < taps; k++)
+    {
+        weights[k] = static_cast<double>(kernel[k]) / divisor;
+        if (!std::isfinite(weights[k]))
+            return false;
+
+        maxAbs = std::max(maxAbs, std::fabs(weights[k]));
+        sumAbs += std::fabs(weights[k]);
+        sum += weights[k];
+    }
+
+    // Most fraction bits that keep every weight in int16 (one unit of slack
+    // for the sum correction below) and every sum in int32
+    int shift = kMaxShift;
+    while (shift >= 0 && (std::ldexp(maxAbs, shift) + 1.0 > 32767.0 ||
+                          std::ldexp(sumAbs, shift) * 255.0 + taps * 255.0 > 2147483647.0))
+    {
+        shift--;
+    }
+    if (shift < 0)
+        return false;
+
+    std::vector<int> quantized(taps);
+    std::vector<double> residual(taps);
+    long long total = 0;
+    for (int k = 0; k < taps; k++)
+    {
+        double scaled = std::ldexp(weights[k], shift);
+        quantized[k] = static_cast<int>(std::lround(scaled));
+        residual[k] = scaled - quantized[k];
+        total += quantized[k];
+    }
+
+    // Nudge the taps that rounded furthest so the weights still add up to
+    // the rounded total; flat areas then come out exact for normalized kernels
+    long long difference = std::llround(std::ldexp(sum, shift)) - total;
+    while (difference != 0)
+    {
+        int step = difference > 0 ? 1 : -1;
+        int best = 0;
+        for (int k = 1; k < taps; k++)
+        {
+            if (residual[k] * step > residual[best] * step)
+                best = k;
+        }
+        quantized[best] += step;
+        residual[best] -= step;
+        difference -= step;
+    }
+
+    double error = 0.0;
+    for (int k = 0; k < taps; k++)
+    {
+        error += std::fabs(residual[k]);
+    }
+    if (std::ldexp(error, -shift) * 255.0 >= kMaxQuantizationError)
+        return false;
+
+    fixed.weights.assign(quantized.begin(), quantized.end());
+    if (fixed.weights.size() % 2 != 0)
+        fixed.weights.push_back(0);
+    fixed.shift = shift;
+    return true;
+}
+
+} // namespace
+
+void Convolution::Apply(const ImageView& image, const float* kernel, int kernelSize, float divisor)
+{
+    if (!image.IsValid() || !kernel || kernelSize <= 0) return;
+
+    FixedKernel fixed;
+    if (!Quantize(kernel, kernelSize, divisor, fixed))
+    {
+        ApplyFloat(image, kernel, kernelSize, divisor);
+        return;
+    }
+
+    int width = image.width;
+    int height = image.height;
+    int pad = kernelSize / 2;
+    int paddedWidth = width + 2 * pad;
+    int paddedHeight = height + 2 * pad;
+    size_t planeSize = static_cast<size_t>(paddedWidth) * paddedHeight;
+
+    // Red, green and blue planes with pad clamped pixels on every side
+    std::vector<int16_t> planes(planeSize * 3);
+
+    int paddedBands = (paddedHeight + kRowsPerTask - 1) / kRowsPerTask;
+    GetEffectThreadPool().ParallelFor(paddedBands, [&](int band) {
+        int y1 = std::min((band + 1) * kRowsPerTask, paddedHeight);
+        for (int y = band * kRowsPerTask; y < y1; y++)
+        {
+            const D3DCOLOR* source = image.Row(std::max(0, std::min(height - 1, y - pad)));
+            int16_t* r = planes.data() + y * static_cast<size_t>(paddedWidth);
+            int16_t* g = r + planeSize;
+            int16_t* b = g + planeSize;
+
+            for (int x = 0; x < width; x++)
+            {
+                D3DCOLOR color = source[x];
+                r[pad + x] = static_cast<int16_t>((color >> 16) & 0xFF);
+                g[pad + x] = static_cast<int16_t>((color >> 8) & 0xFF);
+                b[pad + x] = static_cast<int16_t>(color & 0xFF);
+            }
+
+            for (int16_t* plane : { r, g, b })
+            {
+                std::fill(plane, plane + pad, plane[pad]);
+                std::fill(plane + pad + width, plane + paddedWidth, plane[pad + width - 1]);
+            }
+        }
+    });
+
+    int taps = kernelSize * kernelSize;
+    std::vector<ptrdiff_t> offsets(fixed.weights.size(), 0);
+    for (int k = 0; k < taps; k++)
+    {
+        offsets[k] = static_cast<ptrdiff_t>(k / kernelSize) * paddedWidth + k % kernelSize;
+    }
+
+    ConvolutionRowKernel rowKernel = ConvolutionKernels::GetRowKernel(s_simdLevel);
+
+    int bands = (height + kRowsPerTask - 1) / kRowsPerTask;
+    GetEffectThreadPool().ParallelFor(bands, [&](int band) {
+        std::vector<uint8_t> channels(static_cast<size_t>(width) * 3);
+
+        ConvolutionRowArgs args;
+        args.offsets = offsets.data();
+        args.weights = fixed.weights.data();
+        args.tapCount = static_cast<int>(fixed.weights.size());
+        args.shift = fixed.shift;
+        args.count = width;
+
+        int y1 = std::min((band + 1) * kRowsPerTask, height);
+        for (int y = band * kRowsPerTask; y < y1; y++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                args.source = planes.data() + c * planeSize + y * static_cast<size_t>(paddedWidth);
+                args.out = channels.data() + c * width;
+                rowKernel(args);
+            }
+
+            const uint8_t* r = channels.data();
+            const uint8_t* g = r + width;
+            const uint8_t* b = g + width;
+            D3DCOLOR* row = image.Row(y);
+            for (int x = 0; x < width; x++)
+            {
+                row[x] = (row[x] & 0xFF000000) | (static_cast<D3DCOLOR>(r[x]) << 16) |
+                         (static_cast<D3DCOLOR>(g[x]) << 8) | b[x];
+            }
+        }
+    });
+}
+
+void Convolution::ApplyFloat(const ImageView& image, const float* kernel, int kernelSize, float divisor)
+{
+    if (!image.IsValid() || !kernel || kernelSize <= 0) return;
+
+    int width = image.width;
+    int height = image.height;
+
+    // Create a copy for sampling
+    PixelBuffer original(width, height);
+    image.CopyTo(original.GetView());
+    ImageView source = original.GetView();
+
+    int halfKernel = kernelSize / 2;
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            float r = 0.0f, g = 0.0f, b = 0.0f;
+
+            for (int ky = 0; ky < kernelSize; ky++)
+            {
+                for (int kx = 0; kx < kernelSize; kx++)
+                {
+                    D3DCOLOR color = source.GetClamped(x + kx - halfKernel, y + ky - halfKernel);
+                    float weight = kernel[ky * kernelSize + kx];
+
+                    r += ((color >> 16) & 0xFF) * weight;
+                    g += ((color >> 8) & 0xFF) * weight;
+                    b += (color & 0xFF) * weight;
+                }
+            }
+
+            r /= divisor;
+            g /= divisor;
+            b /= divisor;
+
+            BYTE nr = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(r))));
+            BYTE ng = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(g))));
+            BYTE nb = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(b))));
+            BYTE a = (source.At(x, y) >> 24) & 0xFF;
+
+            image.At(x, y) = D3DCOLOR_ARGB(a, nr, ng, nb);
+        }
+    }
+}
+
+bool Convolution::IsFixedPoint(const float* kernel, int kernelSize, float divisor)
+{
+    if (!kernel || kernelSize <= 0)
+        return false;
+
+    FixedKernel fixed;
+    return Quantize(kernel, kernelSize, divisor, fixed);
+}
+
+void Convolution::SetSimdLevel(SimdLevel level)
+{
+    s_simdLevel = std::min(level, CpuFeatures::GetMaxSimdLevel());
+}
+
+SimdLevel Convolution::GetSimdLevel()
+{
+    return s_simdLevel;
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "PixelBuffer.h"
+#include "../../Core/CpuFeatures.h"
+
+namespace TextureEffects {
+
+    // Square convolution kernels on 32-bit ARGB images, clamp-to-edge, alpha
+    // kept. Each channel value is sum(weight * color) / divisor truncated and
+    // clamped to 0..255.
+    //
+    // Apply pads the borders once into 16-bit planes and accumulates in fixed
+    // point; the weights get as many fraction bits as the 32-bit sums allow.
+    // It stays within 1 LSB of ApplyFloat, and kernels whose quantization
+    // could exceed that (very wide or very large weights) run ApplyFloat.
+    class Convolution {
+    public:
+        static void Apply(const ImageView& image, const float* kernel, int kernelSize, float divisor = 1.0f);
+
+        // Float reference, one clamped fetch per tap
+        static void ApplyFloat(const ImageView& image, const float* kernel, int kernelSize, float divisor = 1.0f);
+
+        // Whether Apply takes the fixed point path for this kernel
+        static bool IsFixedPoint(const float* kernel, int kernelSize, float divisor = 1.0f);
+
+        // Instruction set of the fixed point path. Defaults to the best one
+        // the CPU supports; requests above that are clamped. All levels
+        // produce bit-identical results.
+        static void SetSimdLevel(SimdLevel level);
+        static SimdLevel GetSimdLevel();
+
+    private:
+        static SimdLevel s_simdLevel;
+    };
+
+}
@@ -0,0 +1,103 @@
+#include "ConvolutionKernels.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONVOLUTION_KERNELS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TextureEffects {
+namespace ConvolutionKernels {
+
+void ConvolveScalar(const ConvolutionRowArgs& args, int start)
+{
+    for (int i = start; i < args.count; i++)
+    {
+        int32_t sum = 0;
+        for (int k = 0; k < args.tapCount; k++)
+        {
+            sum += static_cast<int32_t>(args.weights[k]) * args.source[args.offsets[k] + i];
+        }
+
+        // Arithmetic shift rounds toward negative infinity, like the SIMD kernels
+        int value = sum >> args.shift;
+        args.out[i] = static_cast<uint8_t>(std::max(0, std::min(255, value)));
+    }
+}
+
+namespace {
+
+void ScalarKernel(const ConvolutionRowArgs& args)
+{
+    ConvolveScalar(args, 0);
+}
+
+#if defined(CONVOLUTION_KERNELS_SSE2)
+
+// 8 pixels per iteration: each tap pair is interleaved into (a, b) lanes and
+// multiplied-accumulated into 32-bit sums with one pmaddwd per 4 pixels
+void SSE2Kernel(const ConvolutionRowArgs& args)
+{
+    const __m128i shift = _mm_cvtsi32_si128(args.shift);
+    int i = 0;
+
+    for (; i + 8 <= args.count; i += 8)
+    {
+        __m128i sumLo = _mm_setzero_si128();
+        __m128i sumHi = _mm_setzero_si128();
+
+        for (int k = 0; k < args.tapCount; k += 2)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(args.source + args.offsets[k] + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(args.source + args.offsets[k + 1] + i));
+            __m128i weights = _mm_set1_epi32(static_cast<int32_t>(
+                static_cast<uint16_t>(args.weights[k]) | (static_cast<uint32_t>(static_cast<uint16_t>(args.weights[k + 1])) << 16)));
+
+            sumLo = _mm_add_epi32(sumLo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights));
+            sumHi = _mm_add_epi32(sumHi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights));
+        }
+
+        sumLo = _mm_sra_epi32(sumLo, shift);
+        sumHi = _mm_sra_epi32(sumHi, shift);
+
+        // Signed saturation to 16 bits, then unsigned to 0..255
+        __m128i packed = _mm_packs_epi32(sumLo, sumHi);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(args.out + i), _mm_packus_epi16(packed, packed));
+    }
+
+    ConvolveScalar(args, i);
+}
+
+#endif // CONVOLUTION_KERNELS_SSE2
+
+} // namespace
+
+ConvolutionRowKernel GetScalarKernel()
+{
+    return &ScalarKernel;
+}
+
+ConvolutionRowKernel GetSSE2Kernel()
+{
+#if defined(CONVOLUTION_KERNELS_SSE2)
+    return &SSE2Kernel;
+#else
+    return nullptr;
+#endif
+}
+
+ConvolutionRowKernel GetRowKernel(SimdLevel level)
+{
+    ConvolutionRowKernel kernel = nullptr;
+
+    if (level >= SimdLevel::AVX2 && CpuFeatures::HasAVX2())
+        kernel = GetAVX2Kernel();
+
+    if (!kernel && level >= SimdLevel::SSE2 && CpuFeatures::HasSSE2())
+        kernel = GetSSE2Kernel();
+
+    return kernel ? kernel : GetScalarKernel();
+}
+
+} // namespace ConvolutionKernels
+} // namespace TextureEffects
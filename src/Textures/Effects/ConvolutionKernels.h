@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "../../Core/CpuFeatures.h"
+
+// Internal row kernels used by Convolution. Integer arithmetic only, so every
+// instruction set produces bit-identical output.
+
+namespace TextureEffects {
+
+    // One output row of one channel. Taps come in pairs so SIMD kernels can
+    // multiply-accumulate two of them per instruction (pmaddwd); odd kernels
+    // carry a zero-weight tap at the end.
+    struct ConvolutionRowArgs {
+        const int16_t* source;     // Padded plane at the first output pixel's top-left tap
+        const ptrdiff_t* offsets;  // Per tap, in elements from source
+        const int16_t* weights;    // Per tap, fixed point with 'shift' fraction bits
+        int tapCount;              // Even
+        int shift;
+        int count;                 // Output pixels
+        uint8_t* out;              // floor(sum >> shift) clamped to 0..255
+    };
+
+    using ConvolutionRowKernel = void (*)(const ConvolutionRowArgs& args);
+
+    namespace ConvolutionKernels {
+        ConvolutionRowKernel GetRowKernel(SimdLevel level);
+
+        // Per instruction set entry points; null when not compiled in
+        ConvolutionRowKernel GetScalarKernel();
+        ConvolutionRowKernel GetSSE2Kernel();
+        ConvolutionRowKernel GetAVX2Kernel();
+
+        // Scalar tail for pixels [start, args.count)
+        void ConvolveScalar(const ConvolutionRowArgs& args, int start);
+    }
+
+}
@@ -0,0 +1,70 @@
+// Built with AVX2 code generation (see CMakeLists.txt). Only the kernels in
+// this file may use AVX2; they are reached through runtime dispatch, so no
+// inline function shared with other translation units is called from here.
+#include "ConvolutionKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace TextureEffects {
+namespace ConvolutionKernels {
+
+#if defined(__AVX2__)
+
+namespace {
+
+// 16 pixels per iteration, same tap pairing as the SSE2 kernel. Unpack and
+// pack work within 128-bit lanes, so the 16-bit results come back in pixel
+// order and only the final byte pack needs a cross-lane permute.
+void AVX2Kernel(const ConvolutionRowArgs& args)
+{
+    const __m128i shift = _mm_cvtsi32_si128(args.shift);
+    int i = 0;
+
+    for (; i + 16 <= args.count; i += 16)
+    {
+        __m256i sumLo = _mm256_setzero_si256();
+        __m256i sumHi = _mm256_setzero_si256();
+
+        for (int k = 0; k < args.tapCount; k += 2)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(args.source + args.offsets[k] + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(args.source + args.offsets[k + 1] + i));
+            __m256i weights = _mm256_set1_epi32(static_cast<int32_t>(
+                static_cast<uint16_t>(args.weights[k]) | (static_cast<uint32_t>(static_cast<uint16_t>(args.weights[k + 1])) << 16)));
+
+            sumLo = _mm256_add_epi32(sumLo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), weights));
+            sumHi = _mm256_add_epi32(sumHi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), weights));
+        }
+
+        sumLo = _mm256_sra_epi32(sumLo, shift);
+        sumHi = _mm256_sra_epi32(sumHi, shift);
+
+        __m256i packed = _mm256_packs_epi32(sumLo, sumHi);
+        __m256i bytes = _mm256_packus_epi16(packed, packed);
+        bytes = _mm256_permute4x64_epi64(bytes, 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(args.out + i), _mm256_castsi256_si128(bytes));
+    }
+
+    ConvolveScalar(args, i);
+}
+
+} // namespace
+
+ConvolutionRowKernel GetAVX2Kernel()
+{
+    return &AVX2Kernel;
+}
+
+#else
+
+ConvolutionRowKernel GetAVX2Kernel()
+{
+    return nullptr;
+}
+
+#endif // __AVX2__
+
+} // namespace ConvolutionKernels
+} // namespace TextureEffects
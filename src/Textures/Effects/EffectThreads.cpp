@@ -0,0 +1,22 @@
+#include "EffectThreads.h"
+#include "../../Core/ThreadPool.h"
+
+namespace TextureEffects {
+
+namespace {
+
+ThreadPool* s_effectThreadPool = nullptr;
+
+} // namespace
+
+void SetEffectThreadPool(ThreadPool* pool)
+{
+    s_effectThreadPool = pool;
+}
+
+ThreadPool& GetEffectThreadPool()
+{
+    return s_effectThreadPool ? *s_effectThreadPool : ThreadPool::Default();
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,15 @@
+#pragma once
+
+class ThreadPool;
+
+namespace TextureEffects {
+
+    // Worker pool shared by every effect that splits its work: procedural
+    // generation, point ops, blur, convolution, resampling, mip chains, block
+    // compression and the effect manager's render-ahead. Work is cut into
+    // fixed tiles or bands, so results never depend on the thread count.
+    // nullptr, the default, selects ThreadPool::Default().
+    void SetEffectThreadPool(ThreadPool* pool);
+    ThreadPool& GetEffectThreadPool();
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// Color and vector types used by the effects library. The engine build takes
+// them from Direct3D; other platforms get layout-compatible definitions so
+// the effects can be built and run without the DirectX SDK.
+
+#if defined(_WIN32)
+
+#include <d3d9.h>
+#include <d3dx9.h>
+
+#else
+
+#include <cstdint>
+
+typedef uint32_t DWORD;
+typedef uint8_t BYTE;
+typedef DWORD D3DCOLOR;
+
+#define D3DCOLOR_ARGB(a, r, g, b) \
+    ((D3DCOLOR)((((a) & 0xff) << 24) | (((r) & 0xff) << 16) | (((g) & 0xff) << 8) | ((b) & 0xff)))
+#define D3DCOLOR_RGBA(r, g, b, a) D3DCOLOR_ARGB(a, r, g, b)
+#define D3DCOLOR_XRGB(r, g, b) D3DCOLOR_ARGB(0xff, r, g, b)
+
+struct D3DXVECTOR2 {
+    float x, y;
+
+    D3DXVECTOR2() {}
+    D3DXVECTOR2(float fx, float fy) : x(fx), y(fy) {}
+
+    D3DXVECTOR2 operator+(const D3DXVECTOR2& v) const { return D3DXVECTOR2(x + v.x, y + v.y); }
+    D3DXVECTOR2 operator-(const D3DXVECTOR2& v) const { return D3DXVECTOR2(x - v.x, y - v.y); }
+    D3DXVECTOR2 operator*(float f) const { return D3DXVECTOR2(x * f, y * f); }
+};
+
+struct D3DXVECTOR3 {
+    float x, y, z;
+
+    D3DXVECTOR3() {}
+    D3DXVECTOR3(float fx, float fy, float fz) : x(fx), y(fy), z(fz) {}
+
+    D3DXVECTOR3 operator+(const D3DXVECTOR3& v) const { return D3DXVECTOR3(x + v.x, y + v.y, z + v.z); }
+    D3DXVECTOR3 operator-(const D3DXVECTOR3& v) const { return D3DXVECTOR3(x - v.x, y - v.y, z - v.z); }
+    D3DXVECTOR3 operator*(float f) const { return D3DXVECTOR3(x * f, y * f, z * f); }
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "Flipbook.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace TextureEffects {
+
+namespace {
+
+const uint32_t kFlipbookMagic = 0x42504C46; // "FLPB"
+const uint32_t kFlipbookVersion = 1;
+
+struct FlipbookHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t frameCount;
+    float period;
+};
+
+// Blends two ARGB pixels with weight in [0, 256], two channels per multiply
+inline uint32_t BlendPixel(uint32_t a, uint32_t b, uint32_t weight)
+{
+    uint32_t inverse = 256 - weight;
+    uint32_t rb = (((a & 0x00FF00FFu) * inverse + (b & 0x00FF00FFu) * weight) >> 8) & 0x00FF00FFu;
+    uint32_t ag = (((a >> 8) & 0x00FF00FFu) * inverse + ((b >> 8) & 0x00FF00FFu) * weight) & 0xFF00FF00u;
+    return rb | ag;
+}
+
+} // namespace
+
+Flipbook::Flipbook()
+    : m_width(0)
+    , m_height(0)
+    , m_frameCount(0)
+    , m_period(0.0f)
+{
+}
+
+bool Flipbook::Bake(int width, int height, int frameCount, float period, const RenderFunc& render)
+{
+    Clear();
+
+    if (width <= 0 || height <= 0 || frameCount <= 0 || period <= 0.0f || !render)
+    {
+        std::cerr << "Invalid flipbook parameters!" << std::endl;
+        return false;
+    }
+
+    size_t frameSize = static_cast<size_t>(width) * height;
+    std::vector<D3DCOLOR> frames(frameSize * frameCount);
+
+    for (int i = 0; i < frameCount; i++)
+    {
+        float time = period * static_cast<float>(i) / static_cast<float>(frameCount);
+        if (!render(time, ImageView(frames.data() + frameSize * i, width, height, width)))
+        {
+            std::cerr << "Failed to render flipbook frame " << i << "!" << std::endl;
+            return false;
+        }
+    }
+
+    m_width = width;
+    m_height = height;
+    m_frameCount = frameCount;
+    m_period = period;
+    m_frames.swap(frames);
+    return true;
+}
+
+void Flipbook::Sample(float time, bool crossFade, const ImageView& target) const
+{
+    if (!IsValid() || !target.IsValid() || target.width < m_width || target.height < m_height)
+        return;
+
+    float phase = time / m_period;
+    float position = (phase - floorf(phase)) * static_cast<float>(m_frameCount);
+    int frame0 = std::min(static_cast<int>(position), m_frameCount - 1);
+    int frame1 = (frame0 + 1) % m_frameCount;
+    uint32_t weight = static_cast<uint32_t>((position - static_cast<float>(frame0)) * 256.0f + 0.5f);
+
+    const D3DCOLOR* src0 = GetFrame(frame0);
+    const D3DCOLOR* src1 = GetFrame(frame1);
+
+    if (!crossFade || weight == 0 || weight >= 256)
+    {
+        const D3DCOLOR* src = (crossFade && weight >= 256) ? src1 : src0;
+        for (int y = 0; y < m_height; y++)
+        {
+            memcpy(target.Row(y), src + static_cast<size_t>(y) * m_width, m_width * sizeof(D3DCOLOR));
+        }
+        return;
+    }
+
+    for (int y = 0; y < m_height; y++)
+    {
+        const D3DCOLOR* a = src0 + static_cast<size_t>(y) * m_width;
+        const D3DCOLOR* b = src1 + static_cast<size_t>(y) * m_width;
+        D3DCOLOR* dst = target.Row(y);
+
+        for (int x = 0; x < m_width; x++)
+        {
+            dst[x] = BlendPixel(a[x], b[x], weight);
+        }
+    }
+}
+
+bool Flipbook::SaveToFile(const std::string& filename) const
+{
+    if (!IsValid())
+        return false;
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Failed to open flipbook cache for writing: " << filename << std::endl;
+        return false;
+    }
+
+    FlipbookHeader header = { kFlipbookMagic, kFlipbookVersion, m_width, m_height, m_frameCount, m_period };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_frames.data()), m_frames.size() * sizeof(D3DCOLOR));
+
+    return static_cast<bool>(file);
+}
+
+bool Flipbook::LoadFromFile(const std::string& filename, int width, int height, int frameCount, float period)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+        return false;
+
+    FlipbookHeader header = {};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    if (header.magic != kFlipbookMagic || header.version != kFlipbookVersion ||
+        header.width != width || header.height != height ||
+        header.frameCount != frameCount || header.period != period)
+    {
+        return false;
+    }
+
+    std::vector<D3DCOLOR> frames(static_cast<size_t>(width) * height * frameCount);
+    if (!file.read(reinterpret_cast<char*>(frames.data()), frames.size() * sizeof(D3DCOLOR)))
+    {
+        std::cerr << "Truncated flipbook cache: " << filename << std::endl;
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_frameCount = frameCount;
+    m_period = period;
+    m_frames.swap(frames);
+    return true;
+}
+
+void Flipbook::Clear()
+{
+    m_width = 0;
+    m_height = 0;
+    m_frameCount = 0;
+    m_period = 0.0f;
+    m_frames.clear();
+    m_frames.shrink_to_fit();
+}
+
+const D3DCOLOR* Flipbook::GetFrame(int index) const
+{
+    if (index < 0 || index >= m_frameCount)
+        return nullptr;
+
+    return m_frames.data() + static_cast<size_t>(index) * m_width * m_height;
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "PixelBuffer.h"
+
+// Precomputed frames of a periodic animation. Platform-neutral: frames are
+// packed 32-bit ARGB pixels, rendered once and then only copied or blended.
+
+namespace TextureEffects {
+
+    class Flipbook {
+    public:
+        // Renders the frame for the given time into a width x height view
+        using RenderFunc = std::function<bool(float time, const ImageView& frame)>;
+
+        Flipbook();
+
+        // Frame i is rendered at time i * period / frameCount
+        bool Bake(int width, int height, int frameCount, float period, const RenderFunc& render);
+
+        // Writes the frame for any time (wrapped into the period). With
+        // crossFade the two nearest frames are blended, otherwise the
+        // nearest earlier frame is copied. target must be at least the
+        // flipbook's size.
+        void Sample(float time, bool crossFade, const ImageView& target) const;
+
+        // Binary cache. Load fails if the file is missing, damaged or was
+        // baked with different dimensions, frame count or period.
+        bool SaveToFile(const std::string& filename) const;
+        bool LoadFromFile(const std::string& filename, int width, int height, int frameCount, float period);
+
+        void Clear();
+
+        bool IsValid() const { return m_frameCount > 0; }
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        int GetFrameCount() const { return m_frameCount; }
+        float GetPeriod() const { return m_period; }
+        size_t GetMemoryUsage() const { return m_frames.size() * sizeof(D3DCOLOR); }
+        const D3DCOLOR* GetFrame(int index) const;
+
+    private:
+        int m_width;
+        int m_height;
+        int m_frameCount;
+        float m_period;
+        std::vector<D3DCOLOR> m_frames; // frameCount * width * height, tightly packed
+    };
+
+}
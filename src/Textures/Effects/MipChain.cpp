@@ -0,0 +1,207 @@
+#include "MipChain.h"
+#include "EffectThreads.h"
+#include "../../Core/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TextureEffects {
+
+namespace {
+
+const int kRowsPerTask = 16;
+
+int CutoffByte(float cutoff)
+{
+    return std::max(0, std::min(255, static_cast<int>(cutoff * 255.0f + 0.5f)));
+}
+
+// Runs func(y) for every row, in bands of rows on the pool
+template <typename Func>
+void ForEachRow(ThreadPool& pool, int height, Func&& func)
+{
+    int bands = (height + kRowsPerTask - 1) / kRowsPerTask;
+    pool.ParallelFor(bands, [&](int band) {
+        int y1 = std::min((band + 1) * kRowsPerTask, height);
+        for (int y = band * kRowsPerTask; y < y1; y++)
+        {
+            func(y);
+        }
+    });
+}
+
+BYTE EncodeComponent(float value)
+{
+    return static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>((value + 1.0f) * 127.5f + 0.5f))));
+}
+
+} // namespace
+
+bool MipChain::Build(const ImageView& source, const MipOptions& options)
+{
+    m_levels.clear();
+    if (!source.IsValid())
+        return false;
+
+    int levels = CountLevels(source.width, source.height);
+    if (options.maxLevels > 0)
+        levels = std::min(levels, options.maxLevels);
+
+    m_levels.reserve(levels);
+    m_levels.emplace_back(source.width, source.height, source.format);
+    source.CopyTo(m_levels[0].GetView());
+
+    ResampleOptions resample;
+    resample.filter = options.filter;
+    resample.srgb = options.srgb && !options.normalMap;
+    resample.alphaWeighted = !options.normalMap;
+
+    bool keepCoverage = options.alphaCutoff > 0.0f && !options.normalMap;
+    float coverage = keepCoverage ? GetAlphaCoverage(source, options.alphaCutoff) : 0.0f;
+
+    // Each level is filtered from the previous one as filtered, before its
+    // alpha was rescaled, so the rescaling does not compound down the chain
+    PixelBuffer filtered;
+    ImageView previous = source;
+
+    for (int level = 1; level < levels; level++)
+    {
+        int width = std::max(1, previous.width / 2);
+        int height = std::max(1, previous.height / 2);
+
+        PixelBuffer next(width, height, source.format);
+        Resampler::Resize(previous, next.GetView(), resample);
+        if (options.normalMap)
+            NormalizeNormals(next.GetView());
+
+        if (keepCoverage)
+        {
+            filtered = next;
+            previous = filtered.GetView();
+            ScaleAlphaToCoverage(next.GetView(), options.alphaCutoff, coverage);
+        }
+
+        m_levels.push_back(std::move(next));
+        if (!keepCoverage)
+            previous = m_levels.back().GetView();
+    }
+
+    return true;
+}
+
+size_t MipChain::GetMemoryUsage() const
+{
+    size_t total = 0;
+    for (const PixelBuffer& level : m_levels)
+    {
+        total += level.GetMemoryUsage();
+    }
+    return total;
+}
+
+int MipChain::CountLevels(int width, int height)
+{
+    int levels = 1;
+    int size = std::max(width, height);
+    while (size > 1)
+    {
+        size /= 2;
+        levels++;
+    }
+    return levels;
+}
+
+float MipChain::GetAlphaCoverage(const ImageView& image, float cutoff)
+{
+    if (!image.IsValid())
+        return 0.0f;
+
+    D3DCOLOR threshold = static_cast<D3DCOLOR>(CutoffByte(cutoff));
+    long long passing = 0;
+    for (int y = 0; y < image.height; y++)
+    {
+        const D3DCOLOR* row = image.Row(y);
+        for (int x = 0; x < image.width; x++)
+        {
+            passing += (row[x] >> 24) >= threshold;
+        }
+    }
+    return static_cast<float>(static_cast<double>(passing) / (static_cast<double>(image.width) * image.height));
+}
+
+void MipChain::ScaleAlphaToCoverage(const ImageView& image, float cutoff, float coverage)
+{
+    int threshold = CutoffByte(cutoff);
+    if (!image.IsValid() || threshold == 0)
+        return;
+
+    long long histogram[256] = {};
+    for (int y = 0; y < image.height; y++)
+    {
+        const D3DCOLOR* row = image.Row(y);
+        for (int x = 0; x < image.width; x++)
+        {
+            histogram[row[x] >> 24]++;
+        }
+    }
+
+    // Smallest alpha that should pass: the one whose count of texels at or
+    // above it is closest to the target (256 lets none pass)
+    double target = coverage * static_cast<double>(image.width) * image.height;
+    int lowest = 256;
+    double bestError = target;
+    long long above = 0;
+    for (int a = 255; a >= 1; a--)
+    {
+        above += histogram[a];
+        double error = fabs(static_cast<double>(above) - target);
+        if (error < bestError)
+        {
+            bestError = error;
+            lowest = a;
+        }
+    }
+
+    // Rounded alpha * scale reaches the threshold from lowest upwards and
+    // stays below it under lowest
+    double scale = (threshold - 0.5) / (lowest - 0.5);
+    BYTE table[256];
+    for (int a = 0; a < 256; a++)
+    {
+        table[a] = static_cast<BYTE>(std::min(255, static_cast<int>(a * scale + 0.5)));
+    }
+
+    ForEachRow(GetEffectThreadPool(), image.height, [&](int y) {
+        D3DCOLOR* row = image.Row(y);
+        for (int x = 0; x < image.width; x++)
+        {
+            row[x] = (row[x] & 0x00FFFFFF) | (static_cast<D3DCOLOR>(table[row[x] >> 24]) << 24);
+        }
+    });
+}
+
+void MipChain::NormalizeNormals(const ImageView& image)
+{
+    if (!image.IsValid())
+        return;
+
+    ForEachRow(GetEffectThreadPool(), image.height, [&](int y) {
+        D3DCOLOR* row = image.Row(y);
+        for (int x = 0; x < image.width; x++)
+        {
+            D3DCOLOR color = row[x];
+            float nx = ((color >> 16) & 0xFF) / 127.5f - 1.0f;
+            float ny = ((color >> 8) & 0xFF) / 127.5f - 1.0f;
+            float nz = (color & 0xFF) / 127.5f - 1.0f;
+
+            float length = sqrtf(nx * nx + ny * ny + nz * nz);
+            if (length < 1e-6f)
+                continue;
+
+            float scale = 1.0f / length;
+            row[x] = (color & 0xFF000000) |
+                     D3DCOLOR_ARGB(0, EncodeComponent(nx * scale), EncodeComponent(ny * scale), EncodeComponent(nz * scale));
+        }
+    });
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include "Resampler.h"
+
+namespace TextureEffects {
+
+    struct MipOptions {
+        // Box averages each 2x2 block; Kaiser keeps small levels sharper
+        ResampleFilter filter = ResampleFilter::Kaiser;
+
+        // Color data stored as sRGB, filtered in linear light. Ignored for
+        // normal maps.
+        bool srgb = true;
+
+        // Red, green and blue hold a unit vector (0..255 mapped to -1..1);
+        // every texel of the smaller levels is scaled back to unit length
+        bool normalMap = false;
+
+        // Alpha-tested (cutout) textures: alpha >= alphaCutoff * 255 passes
+        // the test. Each level's alpha is rescaled so the fraction of texels
+        // that pass matches level 0, so foliage does not thin out with
+        // distance. 0 leaves alpha as filtered.
+        float alphaCutoff = 0.0f;
+
+        // 0 builds the full chain down to 1 x 1
+        int maxLevels = 0;
+    };
+
+    // Full mip chain of a 32-bit image built on the CPU, each level filtered
+    // from the one above it with the Resampler. Levels are owned buffers, so
+    // the chain can be uploaded level by level or written out as is.
+    class MipChain {
+    public:
+        // Copies source as level 0 and builds the smaller levels. Returns
+        // false if source is invalid.
+        bool Build(const ImageView& source, const MipOptions& options = MipOptions());
+
+        int GetLevelCount() const { return static_cast<int>(m_levels.size()); }
+        ImageView GetLevel(int level) const { return m_levels[level].GetView(); }
+        bool IsEmpty() const { return m_levels.empty(); }
+        void Clear() { m_levels.clear(); }
+
+        // Bytes held by all levels
+        size_t GetMemoryUsage() const;
+
+        // Levels from width x height down to 1 x 1
+        static int CountLevels(int width, int height);
+
+        // Fraction of texels whose alpha is >= cutoff * 255
+        static float GetAlphaCoverage(const ImageView& image, float cutoff);
+
+        // Scales alpha so that GetAlphaCoverage(image, cutoff) comes as close
+        // to coverage as whole alpha values allow
+        static void ScaleAlphaToCoverage(const ImageView& image, float cutoff, float coverage);
+
+        // Scales each texel's normal (red, green, blue as -1..1) to unit length
+        static void NormalizeNormals(const ImageView& image);
+
+    private:
+        std::vector<PixelBuffer> m_levels;
+    };
+
+}
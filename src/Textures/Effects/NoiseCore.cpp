@@ -0,0 +1,832 @@
+#include "NoiseCore.h"
+#include "NoiseKernels.h"
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+namespace TextureEffects {
+
+using NoiseKernels::Fade;
+using NoiseKernels::Grad;
+using NoiseKernels::Lerp;
+
+namespace {
+
+// Skew factors for 2D simplex noise: (sqrt(3) - 1) / 2 and (3 - sqrt(3)) / 6
+const float kSkew2D = 0.36602540378f;
+const float kUnskew2D = 0.21132486540f;
+
+// 3D: 1/3 and 1/6. 4D: (sqrt(5) - 1) / 4 and (5 - sqrt(5)) / 20
+const float kSkew3D = 1.0f / 3.0f;
+const float kUnskew3D = 1.0f / 6.0f;
+const float kSkew4D = 0.30901699437f;
+const float kUnskew4D = 0.13819660113f;
+
+// Cube edge midpoints for 3D, tesseract edge midpoints for 4D
+const float kGrad3[12][3] = {
+    { 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+    { 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+    { 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 }
+};
+
+const float kGrad4[32][4] = {
+    { 0, 1, 1, 1 }, { 0, 1, 1, -1 }, { 0, 1, -1, 1 }, { 0, 1, -1, -1 },
+    { 0, -1, 1, 1 }, { 0, -1, 1, -1 }, { 0, -1, -1, 1 }, { 0, -1, -1, -1 },
+    { 1, 0, 1, 1 }, { 1, 0, 1, -1 }, { 1, 0, -1, 1 }, { 1, 0, -1, -1 },
+    { -1, 0, 1, 1 }, { -1, 0, 1, -1 }, { -1, 0, -1, 1 }, { -1, 0, -1, -1 },
+    { 1, 1, 0, 1 }, { 1, 1, 0, -1 }, { 1, -1, 0, 1 }, { 1, -1, 0, -1 },
+    { -1, 1, 0, 1 }, { -1, 1, 0, -1 }, { -1, -1, 0, 1 }, { -1, -1, 0, -1 },
+    { 1, 1, 1, 0 }, { 1, 1, -1, 0 }, { 1, -1, 1, 0 }, { 1, -1, -1, 0 },
+    { -1, 1, 1, 0 }, { -1, 1, -1, 0 }, { -1, -1, 1, 0 }, { -1, -1, -1, 0 }
+};
+
+// Radial falloff contribution of one simplex corner
+inline float Corner3(int gradient, float x, float y, float z)
+{
+    float t = 0.6f - x * x - y * y - z * z;
+    if (t <= 0.0f)
+        return 0.0f;
+
+    const float* g = kGrad3[gradient];
+    t *= t;
+    return t * t * (g[0] * x + g[1] * y + g[2] * z);
+}
+
+inline float Corner4(int gradient, float x, float y, float z, float w)
+{
+    float t = 0.6f - x * x - y * y - z * z - w * w;
+    if (t <= 0.0f)
+        return 0.0f;
+
+    const float* g = kGrad4[gradient];
+    t *= t;
+    return t * t * (g[0] * x + g[1] * y + g[2] * z + g[3] * w);
+}
+
+// Consecutive columns that fall in the same lattice cell
+struct CellRun {
+    int start;
+    int count;
+    uint8_t p0; // perm[xi]
+    uint8_t p1; // perm[xi + 1]
+};
+
+// Per-octave lattice data that only depends on the x coordinate
+struct OctaveColumns {
+    float frequency = 0.0f;
+    float amplitude = 0.0f;
+    std::vector<float> xf;
+    std::vector<float> u;
+    std::vector<CellRun> runs;
+};
+
+void BuildColumns(const uint8_t* perm, float x, float dx, float freq, int count, OctaveColumns& cols)
+{
+    cols.xf.resize(count);
+    cols.u.resize(count);
+    cols.runs.clear();
+
+    int lastCell = 0;
+    for (int i = 0; i < count; i++)
+    {
+        float px = (x + static_cast<float>(i) * dx) * freq;
+        int xi = NoiseCore::FastFloor(px);
+        float xf = px - static_cast<float>(xi);
+
+        cols.xf[i] = xf;
+        cols.u[i] = Fade(xf);
+
+        if (i == 0 || xi != lastCell)
+        {
+            cols.runs.push_back({ i, 0, perm[xi & 255], perm[(xi + 1) & 255] });
+            lastCell = xi;
+        }
+        cols.runs.back().count++;
+    }
+}
+
+// Corner hashes for one row of an octave. The lookups happen once per cell,
+// the per-column expansion is a run of byte fills.
+struct RowHashes {
+    std::vector<uint8_t> h00, h10, h01, h11;
+
+    void Resize(int count)
+    {
+        h00.resize(count);
+        h10.resize(count);
+        h01.resize(count);
+        h11.resize(count);
+    }
+
+    void Expand(const std::vector<CellRun>& runs, const uint8_t* row0, const uint8_t* row1)
+    {
+        for (const CellRun& run : runs)
+        {
+            std::fill_n(h00.data() + run.start, run.count, row0[run.p0]);
+            std::fill_n(h10.data() + run.start, run.count, row0[run.p1]);
+            std::fill_n(h01.data() + run.start, run.count, row1[run.p0]);
+            std::fill_n(h11.data() + run.start, run.count, row1[run.p1]);
+        }
+    }
+};
+
+// Feature point of a cell, as an offset inside the cell
+struct FeaturePoint {
+    float x;
+    float y;
+    uint32_t id;
+};
+
+float CellDistance(CellularMetric metric, float dx, float dy)
+{
+    switch (metric)
+    {
+    case CellularMetric::Manhattan:
+        return fabsf(dx) + fabsf(dy);
+    case CellularMetric::Chebyshev:
+        return std::max(fabsf(dx), fabsf(dy));
+    case CellularMetric::Euclidean:
+    default:
+        return dx * dx + dy * dy; // Squared until the search is done
+    }
+}
+
+// Nearest two of the 3x3 feature points. points[j][i] is cell (cx + i - 1, cy + j - 1)
+CellularResult SearchCells(const FeaturePoint (&points)[3][3], CellularMetric metric, float fx, float fy)
+{
+    CellularResult result;
+    result.f1 = 1.0e30f;
+    result.f2 = 1.0e30f;
+
+    for (int j = 0; j < 3; j++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            const FeaturePoint& point = points[j][i];
+            float d = CellDistance(metric, point.x + static_cast<float>(i - 1) - fx,
+                                   point.y + static_cast<float>(j - 1) - fy);
+
+            if (d < result.f1)
+            {
+                result.f2 = result.f1;
+                result.f1 = d;
+                result.cellId = point.id;
+            }
+            else if (d < result.f2)
+            {
+                result.f2 = d;
+            }
+        }
+    }
+
+    if (metric == CellularMetric::Euclidean)
+    {
+        result.f1 = sqrtf(result.f1);
+        result.f2 = sqrtf(result.f2);
+    }
+
+    return result;
+}
+
+// Adds one octave of noise to an accumulator, as the row kernels do
+inline void AccumulateOctave(NoiseFractal fractal, float noise, float amplitude, float& value)
+{
+    switch (fractal)
+    {
+    case NoiseFractal::Ridged:
+    {
+        float ridge = 1.0f - fabsf(noise);
+        ridge *= ridge;
+        value += ridge * amplitude;
+        break;
+    }
+    case NoiseFractal::Billow:
+    case NoiseFractal::Turbulence:
+        value += fabsf(noise) * amplitude;
+        break;
+    case NoiseFractal::FBM:
+    default:
+        value += noise * amplitude;
+        break;
+    }
+}
+
+// Final normalisation, matching the scalar fractal functions
+void NormalizeRow(NoiseFractal fractal, float maxValue, int count, float* out)
+{
+    switch (fractal)
+    {
+    case NoiseFractal::FBM:
+        if (maxValue <= 0.0f)
+        {
+            std::fill(out, out + count, 0.5f);
+            break;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = std::max(0.0f, std::min(1.0f, (out[i] / maxValue) * 0.5f + 0.5f));
+        }
+        break;
+    case NoiseFractal::Ridged:
+    case NoiseFractal::Billow:
+        if (maxValue <= 0.0f)
+            break;
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = std::min(1.0f, out[i] / maxValue);
+        }
+        break;
+    case NoiseFractal::Turbulence:
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = std::min(1.0f, out[i]);
+        }
+        break;
+    }
+}
+
+// Octave loop shared by the 3D/4D fractal functions. sample(i, frequency)
+// returns single-octave noise for sample i at the given frequency.
+template <typename Sampler>
+void FractalRow(const NoiseParams& params, int count, float* out, Sampler sample)
+{
+    std::fill(out, out + count, 0.0f);
+
+    float amplitude = 1.0f;
+    float freq = params.frequency;
+    float maxValue = 0.0f;
+
+    for (int octave = 0; octave < params.octaves; octave++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            AccumulateOctave(params.fractal, sample(i, freq), amplitude, out[i]);
+        }
+
+        maxValue += amplitude;
+        amplitude *= params.persistence;
+        freq *= params.lacunarity;
+    }
+
+    NormalizeRow(params.fractal, maxValue, count, out);
+}
+
+} // namespace
+
+SimdLevel NoiseCore::s_simdLevel = CpuFeatures::GetMaxSimdLevel();
+
+NoiseCore::NoiseCore(uint32_t seed)
+{
+    SetSeed(seed);
+}
+
+void NoiseCore::SetSimdLevel(SimdLevel level)
+{
+    s_simdLevel = std::min(level, CpuFeatures::GetMaxSimdLevel());
+}
+
+SimdLevel NoiseCore::GetSimdLevel()
+{
+    return s_simdLevel;
+}
+
+void NoiseCore::SetSeed(uint32_t seed)
+{
+    m_seed = seed;
+
+    for (int i = 0; i < 256; i++)
+    {
+        m_perm[i] = static_cast<uint8_t>(i);
+    }
+
+    // Fisher-Yates shuffle with a fixed LCG so tables match across compilers
+    uint32_t state = seed ^ 0x9E3779B9u;
+    for (int i = 255; i > 0; i--)
+    {
+        state = state * 1664525u + 1013904223u;
+        int j = static_cast<int>((static_cast<uint64_t>(state) * static_cast<uint64_t>(i + 1)) >> 32);
+        std::swap(m_perm[i], m_perm[j]);
+    }
+
+    for (int i = 0; i < 256; i++)
+    {
+        m_perm[256 + i] = m_perm[i];
+    }
+}
+
+float NoiseCore::Perlin(float x, float y) const
+{
+    int xi = FastFloor(x);
+    int yi = FastFloor(y);
+
+    float xf = x - static_cast<float>(xi);
+    float yf = y - static_cast<float>(yi);
+
+    float u = Fade(xf);
+    float v = Fade(yf);
+
+    float n00 = Grad(Hash(xi, yi), xf, yf);
+    float n10 = Grad(Hash(xi + 1, yi), xf - 1.0f, yf);
+    float n01 = Grad(Hash(xi, yi + 1), xf, yf - 1.0f);
+    float n11 = Grad(Hash(xi + 1, yi + 1), xf - 1.0f, yf - 1.0f);
+
+    return Lerp(Lerp(n00, n10, u), Lerp(n01, n11, u), v);
+}
+
+float NoiseCore::Simplex(float x, float y) const
+{
+    // Skew input space to find the containing simplex cell
+    float s = (x + y) * kSkew2D;
+    int i = FastFloor(x + s);
+    int j = FastFloor(y + s);
+
+    float t = static_cast<float>(i + j) * kUnskew2D;
+    float x0 = x - (static_cast<float>(i) - t);
+    float y0 = y - (static_cast<float>(j) - t);
+
+    // Lower or upper triangle of the cell
+    int i1 = (x0 > y0) ? 1 : 0;
+    int j1 = 1 - i1;
+
+    float x1 = x0 - static_cast<float>(i1) + kUnskew2D;
+    float y1 = y0 - static_cast<float>(j1) + kUnskew2D;
+    float x2 = x0 - 1.0f + 2.0f * kUnskew2D;
+    float y2 = y0 - 1.0f + 2.0f * kUnskew2D;
+
+    float n = 0.0f;
+
+    float t0 = 0.5f - x0 * x0 - y0 * y0;
+    if (t0 > 0.0f)
+    {
+        t0 *= t0;
+        n += t0 * t0 * Grad(Hash(i, j), x0, y0);
+    }
+
+    float t1 = 0.5f - x1 * x1 - y1 * y1;
+    if (t1 > 0.0f)
+    {
+        t1 *= t1;
+        n += t1 * t1 * Grad(Hash(i + i1, j + j1), x1, y1);
+    }
+
+    float t2 = 0.5f - x2 * x2 - y2 * y2;
+    if (t2 > 0.0f)
+    {
+        t2 *= t2;
+        n += t2 * t2 * Grad(Hash(i + 1, j + 1), x2, y2);
+    }
+
+    // Scale to roughly [-1, 1]
+    return 70.0f * n;
+}
+
+float NoiseCore::Simplex(float x, float y, float z) const
+{
+    float s = (x + y + z) * kSkew3D;
+    int i = FastFloor(x + s);
+    int j = FastFloor(y + s);
+    int k = FastFloor(z + s);
+
+    float t = static_cast<float>(i + j + k) * kUnskew3D;
+    float x0 = x - (static_cast<float>(i) - t);
+    float y0 = y - (static_cast<float>(j) - t);
+    float z0 = z - (static_cast<float>(k) - t);
+
+    // Order of the offsets picks which of the 6 tetrahedra contains the point
+    int i1, j1, k1, i2, j2, k2;
+    if (x0 >= y0)
+    {
+        if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+        else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+        else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+    }
+    else
+    {
+        if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+        else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+        else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    }
+
+    float x1 = x0 - static_cast<float>(i1) + kUnskew3D;
+    float y1 = y0 - static_cast<float>(j1) + kUnskew3D;
+    float z1 = z0 - static_cast<float>(k1) + kUnskew3D;
+    float x2 = x0 - static_cast<float>(i2) + 2.0f * kUnskew3D;
+    float y2 = y0 - static_cast<float>(j2) + 2.0f * kUnskew3D;
+    float z2 = z0 - static_cast<float>(k2) + 2.0f * kUnskew3D;
+    float x3 = x0 - 1.0f + 3.0f * kUnskew3D;
+    float y3 = y0 - 1.0f + 3.0f * kUnskew3D;
+    float z3 = z0 - 1.0f + 3.0f * kUnskew3D;
+
+    int ii = i & 255;
+    int jj = j & 255;
+    int kk = k & 255;
+    const uint8_t* p = m_perm;
+
+    float n = Corner3(p[ii + p[jj + p[kk]]] % 12, x0, y0, z0);
+    n += Corner3(p[ii + i1 + p[jj + j1 + p[kk + k1]]] % 12, x1, y1, z1);
+    n += Corner3(p[ii + i2 + p[jj + j2 + p[kk + k2]]] % 12, x2, y2, z2);
+    n += Corner3(p[ii + 1 + p[jj + 1 + p[kk + 1]]] % 12, x3, y3, z3);
+
+    // Scale to roughly [-1, 1]
+    return 32.0f * n;
+}
+
+float NoiseCore::Simplex(float x, float y, float z, float w) const
+{
+    float s = (x + y + z + w) * kSkew4D;
+    int i = FastFloor(x + s);
+    int j = FastFloor(y + s);
+    int k = FastFloor(z + s);
+    int l = FastFloor(w + s);
+
+    float t = static_cast<float>(i + j + k + l) * kUnskew4D;
+    float x0 = x - (static_cast<float>(i) - t);
+    float y0 = y - (static_cast<float>(j) - t);
+    float z0 = z - (static_cast<float>(k) - t);
+    float w0 = w - (static_cast<float>(l) - t);
+
+    // Rank the offsets to find which of the 24 simplices contains the point
+    int rankX = 0, rankY = 0, rankZ = 0, rankW = 0;
+    if (x0 > y0) rankX++; else rankY++;
+    if (x0 > z0) rankX++; else rankZ++;
+    if (x0 > w0) rankX++; else rankW++;
+    if (y0 > z0) rankY++; else rankZ++;
+    if (y0 > w0) rankY++; else rankW++;
+    if (z0 > w0) rankZ++; else rankW++;
+
+    int i1 = rankX >= 3, j1 = rankY >= 3, k1 = rankZ >= 3, l1 = rankW >= 3;
+    int i2 = rankX >= 2, j2 = rankY >= 2, k2 = rankZ >= 2, l2 = rankW >= 2;
+    int i3 = rankX >= 1, j3 = rankY >= 1, k3 = rankZ >= 1, l3 = rankW >= 1;
+
+    float x1 = x0 - static_cast<float>(i1) + kUnskew4D;
+    float y1 = y0 - static_cast<float>(j1) + kUnskew4D;
+    float z1 = z0 - static_cast<float>(k1) + kUnskew4D;
+    float w1 = w0 - static_cast<float>(l1) + kUnskew4D;
+    float x2 = x0 - static_cast<float>(i2) + 2.0f * kUnskew4D;
+    float y2 = y0 - static_cast<float>(j2) + 2.0f * kUnskew4D;
+    float z2 = z0 - static_cast<float>(k2) + 2.0f * kUnskew4D;
+    float w2 = w0 - static_cast<float>(l2) + 2.0f * kUnskew4D;
+    float x3 = x0 - static_cast<float>(i3) + 3.0f * kUnskew4D;
+    float y3 = y0 - static_cast<float>(j3) + 3.0f * kUnskew4D;
+    float z3 = z0 - static_cast<float>(k3) + 3.0f * kUnskew4D;
+    float w3 = w0 - static_cast<float>(l3) + 3.0f * kUnskew4D;
+    float x4 = x0 - 1.0f + 4.0f * kUnskew4D;
+    float y4 = y0 - 1.0f + 4.0f * kUnskew4D;
+    float z4 = z0 - 1.0f + 4.0f * kUnskew4D;
+    float w4 = w0 - 1.0f + 4.0f * kUnskew4D;
+
+    int ii = i & 255;
+    int jj = j & 255;
+    int kk = k & 255;
+    int ll = l & 255;
+    const uint8_t* p = m_perm;
+
+    float n = Corner4(p[ii + p[jj + p[kk + p[ll]]]] % 32, x0, y0, z0, w0);
+    n += Corner4(p[ii + i1 + p[jj + j1 + p[kk + k1 + p[ll + l1]]]] % 32, x1, y1, z1, w1);
+    n += Corner4(p[ii + i2 + p[jj + j2 + p[kk + k2 + p[ll + l2]]]] % 32, x2, y2, z2, w2);
+    n += Corner4(p[ii + i3 + p[jj + j3 + p[kk + k3 + p[ll + l3]]]] % 32, x3, y3, z3, w3);
+    n += Corner4(p[ii + 1 + p[jj + 1 + p[kk + 1 + p[ll + 1]]]] % 32, x4, y4, z4, w4);
+
+    // Scale to roughly [-1, 1]
+    return 27.0f * n;
+}
+
+float NoiseCore::Evaluate3D(const NoiseParams& params, float x, float y, float z) const
+{
+    float value;
+    EvaluateRow3D(params, x, y, z, 0.0f, 1, &value);
+    return value;
+}
+
+float NoiseCore::Evaluate4D(const NoiseParams& params, float x, float y, float z, float w) const
+{
+    float value;
+    EvaluateRow4D(params, x, y, z, w, 0.0f, 1, &value);
+    return value;
+}
+
+void NoiseCore::EvaluateRow3D(const NoiseParams& params, float x, float y, float z, float dx, int count, float* out) const
+{
+    if (count <= 0 || !out)
+        return;
+
+    FractalRow(params, count, out, [&](int i, float freq) {
+        float px = x + static_cast<float>(i) * dx;
+        return Simplex(px * freq, y * freq, z * freq);
+    });
+}
+
+void NoiseCore::EvaluateRow4D(const NoiseParams& params, float x, float y, float z, float w, float dx,
+                              int count, float* out) const
+{
+    if (count <= 0 || !out)
+        return;
+
+    FractalRow(params, count, out, [&](int i, float freq) {
+        float px = x + static_cast<float>(i) * dx;
+        return Simplex(px * freq, y * freq, z * freq, w * freq);
+    });
+}
+
+void NoiseCore::EvaluateVolume(const NoiseParams& params, float x, float y, float z, float dx, float dy, float dz,
+                               int width, int height, int depth, float* out) const
+{
+    if (width <= 0 || height <= 0 || depth <= 0 || !out)
+        return;
+
+    for (int slice = 0; slice < depth; slice++)
+    {
+        float pz = z + static_cast<float>(slice) * dz;
+        for (int row = 0; row < height; row++)
+        {
+            float* dst = out + (static_cast<size_t>(slice) * height + row) * width;
+            EvaluateRow3D(params, x, y + static_cast<float>(row) * dy, pz, dx, width, dst);
+        }
+    }
+}
+
+void NoiseCore::EvaluateLoopGrid(const NoiseParams& params, float x, float y, float dx, float dy, int width, int height,
+                                 float phase, float loopRadius, float* out, int stride) const
+{
+    if (width <= 0 || height <= 0 || !out)
+        return;
+
+    const float kTwoPi = 6.28318530718f;
+    float angle = (phase - floorf(phase)) * kTwoPi;
+    float z = cosf(angle) * loopRadius;
+    float w = sinf(angle) * loopRadius;
+
+    for (int row = 0; row < height; row++)
+    {
+        float* dst = out + static_cast<size_t>(row) * stride;
+        EvaluateRow4D(params, x, y + static_cast<float>(row) * dy, z, w, dx, width, dst);
+    }
+}
+
+uint32_t NoiseCore::HashCell(int x, int y) const
+{
+    // Integer mix of the cell coordinates and the seed; no trig, no period
+    uint32_t h = static_cast<uint32_t>(x) * 0x8DA6B343u;
+    h ^= static_cast<uint32_t>(y) * 0xD8163841u;
+    h ^= m_seed * 0xCB1AB31Fu;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return h;
+}
+
+CellularResult NoiseCore::Cellular(float x, float y, CellularMetric metric) const
+{
+    CellularResult result;
+    CellularRow(x, y, 0.0f, 1, metric, &result);
+    return result;
+}
+
+void NoiseCore::CellularRow(float x, float y, float dx, int count, CellularMetric metric, CellularResult* out) const
+{
+    if (count <= 0 || !out)
+        return;
+
+    const float kPointScale = 1.0f / 65536.0f;
+
+    int cy = FastFloor(y);
+    float fy = y - static_cast<float>(cy);
+
+    // Feature points of the 3x3 block around the current cell. Consecutive
+    // samples usually share a cell, so points are only hashed when it
+    // changes, and stepping one cell right only hashes the new column.
+    FeaturePoint points[3][3];
+    int cachedCell = 0;
+    bool cached = false;
+
+    auto hashColumn = [&](int column, int cellX) {
+        for (int j = 0; j < 3; j++)
+        {
+            uint32_t h = HashCell(cellX, cy + j - 1);
+            points[j][column].x = static_cast<float>(h & 0xFFFFu) * kPointScale;
+            points[j][column].y = static_cast<float>(h >> 16) * kPointScale;
+            points[j][column].id = h;
+        }
+    };
+
+    for (int i = 0; i < count; i++)
+    {
+        float px = x + static_cast<float>(i) * dx;
+        int cx = FastFloor(px);
+        float fx = px - static_cast<float>(cx);
+
+        if (cached && cx == cachedCell + 1)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                points[j][0] = points[j][1];
+                points[j][1] = points[j][2];
+            }
+            hashColumn(2, cx + 1);
+            cachedCell = cx;
+        }
+        else if (!cached || cx != cachedCell)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                hashColumn(k, cx + k - 1);
+            }
+            cachedCell = cx;
+            cached = true;
+        }
+
+        out[i] = SearchCells(points, metric, fx, fy);
+    }
+}
+
+float NoiseCore::Fractal(float x, float y, float frequency, int octaves, float persistence, float lacunarity) const
+{
+    float value = 0.0f;
+    float amplitude = 1.0f;
+    float freq = frequency;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < octaves; i++)
+    {
+        value += Perlin(x * freq, y * freq) * amplitude;
+        maxValue += amplitude;
+
+        amplitude *= persistence;
+        freq *= lacunarity;
+    }
+
+    if (maxValue <= 0.0f)
+        return 0.5f;
+
+    return std::max(0.0f, std::min(1.0f, (value / maxValue) * 0.5f + 0.5f));
+}
+
+float NoiseCore::Ridged(float x, float y, float frequency, int octaves, float persistence, float lacunarity) const
+{
+    float value = 0.0f;
+    float amplitude = 1.0f;
+    float freq = frequency;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < octaves; i++)
+    {
+        float noise = 1.0f - fabsf(Perlin(x * freq, y * freq));
+        noise *= noise; // Square for sharper ridges
+
+        value += noise * amplitude;
+        maxValue += amplitude;
+
+        amplitude *= persistence;
+        freq *= lacunarity;
+    }
+
+    if (maxValue <= 0.0f)
+        return 0.0f;
+
+    return std::min(1.0f, value / maxValue);
+}
+
+float NoiseCore::Billow(float x, float y, float frequency, int octaves, float persistence, float lacunarity) const
+{
+    float value = 0.0f;
+    float amplitude = 1.0f;
+    float freq = frequency;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < octaves; i++)
+    {
+        value += fabsf(Perlin(x * freq, y * freq)) * amplitude;
+        maxValue += amplitude;
+
+        amplitude *= persistence;
+        freq *= lacunarity;
+    }
+
+    if (maxValue <= 0.0f)
+        return 0.0f;
+
+    return std::min(1.0f, value / maxValue);
+}
+
+float NoiseCore::Turbulence(float x, float y, float frequency, int octaves, float persistence, float lacunarity) const
+{
+    float value = 0.0f;
+    float amplitude = 1.0f;
+    float freq = frequency;
+
+    for (int i = 0; i < octaves; i++)
+    {
+        value += fabsf(Perlin(x * freq, y * freq)) * amplitude;
+
+        amplitude *= persistence;
+        freq *= lacunarity;
+    }
+
+    return std::min(1.0f, value);
+}
+
+float NoiseCore::Evaluate(const NoiseParams& params, float x, float y) const
+{
+    switch (params.fractal)
+    {
+    case NoiseFractal::Ridged:
+        return Ridged(x, y, params.frequency, params.octaves, params.persistence, params.lacunarity);
+    case NoiseFractal::Billow:
+        return Billow(x, y, params.frequency, params.octaves, params.persistence, params.lacunarity);
+    case NoiseFractal::Turbulence:
+        return Turbulence(x, y, params.frequency, params.octaves, params.persistence, params.lacunarity);
+    case NoiseFractal::FBM:
+    default:
+        return Fractal(x, y, params.frequency, params.octaves, params.persistence, params.lacunarity);
+    }
+}
+
+void NoiseCore::EvaluateRow(const NoiseParams& params, float x, float y, float dx, int count, float* out) const
+{
+    EvaluateGrid(params, x, y, dx, 0.0f, count, 1, out, count);
+}
+
+void NoiseCore::EvaluateGrid(const NoiseParams& params, float x, float y, float dx, float dy,
+                             int width, int height, float* out, int stride) const
+{
+    if (width <= 0 || height <= 0 || !out)
+        return;
+
+    int octaves = std::max(0, params.octaves);
+
+    // The x half of the lattice is identical for every row, so it is built
+    // once per octave and reused by the whole grid
+    std::vector<OctaveColumns> columns(octaves);
+    float amplitude = 1.0f;
+    float freq = params.frequency;
+    float maxValue = 0.0f;
+
+    for (int octave = 0; octave < octaves; octave++)
+    {
+        OctaveColumns& cols = columns[octave];
+        cols.frequency = freq;
+        cols.amplitude = amplitude;
+        BuildColumns(m_perm, x, dx, freq, width, cols);
+
+        maxValue += amplitude;
+        amplitude *= params.persistence;
+        freq *= params.lacunarity;
+    }
+
+    NoiseKernels::Mode mode = NoiseKernels::Mode::Signed;
+    if (params.fractal == NoiseFractal::Ridged)
+        mode = NoiseKernels::Mode::Ridged;
+    else if (params.fractal == NoiseFractal::Billow || params.fractal == NoiseFractal::Turbulence)
+        mode = NoiseKernels::Mode::Absolute;
+
+    NoiseRowKernel kernel = NoiseKernels::GetRowKernel(mode, s_simdLevel);
+
+    RowHashes hashes;
+    hashes.Resize(width);
+
+    NoiseRowArgs args = {};
+    args.h00 = hashes.h00.data();
+    args.h10 = hashes.h10.data();
+    args.h01 = hashes.h01.data();
+    args.h11 = hashes.h11.data();
+    args.count = width;
+
+    for (int row = 0; row < height; row++)
+    {
+        float* dst = out + static_cast<size_t>(row) * stride;
+        float py = y + static_cast<float>(row) * dy;
+
+        std::fill(dst, dst + width, 0.0f);
+        args.out = dst;
+
+        for (int octave = 0; octave < octaves; octave++)
+        {
+            const OctaveColumns& cols = columns[octave];
+
+            // Everything that depends only on y is shared by the whole row
+            float ry = py * cols.frequency;
+            int yi = FastFloor(ry);
+
+            args.yf = ry - static_cast<float>(yi);
+            args.v = Fade(args.yf);
+            args.amplitude = cols.amplitude;
+            args.xf = cols.xf.data();
+            args.u = cols.u.data();
+            hashes.Expand(cols.runs, m_perm + (yi & 255), m_perm + ((yi + 1) & 255));
+
+            kernel(args);
+        }
+
+        NormalizeRow(params.fractal, maxValue, width, dst);
+    }
+}
+
+NoiseCore& NoiseCore::Default()
+{
+    static NoiseCore instance(0);
+    return instance;
+}
+
+} // namespace TextureEffects
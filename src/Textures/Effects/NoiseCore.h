@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include "../../Core/CpuFeatures.h"
+
+// Platform-neutral noise core. This header must not depend on d3d9.h so the
+// noise kernels can be compiled and benchmarked on any platform.
+
+namespace TextureEffects {
+
+    enum class NoiseFractal {
+        FBM,
+        Ridged,
+        Billow,
+        Turbulence
+    };
+
+    // Parameters for batched fractal evaluation
+    struct NoiseParams {
+        NoiseFractal fractal = NoiseFractal::FBM;
+        float frequency = 1.0f;
+        int octaves = 4;
+        float persistence = 0.5f;
+        float lacunarity = 2.0f;
+    };
+
+    // Distance function for cellular noise
+    enum class CellularMetric {
+        Euclidean,
+        Manhattan,
+        Chebyshev
+    };
+
+    // Nearest feature points around a sample
+    struct CellularResult {
+        float f1 = 0.0f;     // Distance to the nearest feature point
+        float f2 = 0.0f;     // Distance to the second nearest
+        uint32_t cellId = 0; // Hash of the cell owning the nearest point
+
+        float Edge() const { return f2 - f1; } // F2 - F1, zero on cell borders
+    };
+
+    // Lattice gradient noise (Perlin and Simplex) driven by a seedable
+    // permutation table. No trigonometric calls are made per sample.
+    class NoiseCore {
+    public:
+        explicit NoiseCore(uint32_t seed = 0);
+
+        // Seeding
+        void SetSeed(uint32_t seed);
+        uint32_t GetSeed() const { return m_seed; }
+
+        // Single-octave noise, range [-1, 1]
+        float Perlin(float x, float y) const;
+        float Simplex(float x, float y) const;
+        float Simplex(float x, float y, float z) const;
+        float Simplex(float x, float y, float z, float w) const;
+
+        // Fractal sums of Perlin noise, range [0, 1]
+        float Fractal(float x, float y, float frequency, int octaves, float persistence, float lacunarity) const;
+        float Ridged(float x, float y, float frequency, int octaves, float persistence, float lacunarity) const;
+        float Billow(float x, float y, float frequency, int octaves, float persistence, float lacunarity) const;
+        float Turbulence(float x, float y, float frequency, int octaves, float persistence, float lacunarity) const;
+
+        // Fractal sums of 3D/4D simplex noise, same modes and [0, 1] range as
+        // the 2D functions. Frequency scales every coordinate.
+        float Evaluate3D(const NoiseParams& params, float x, float y, float z) const;
+        float Evaluate4D(const NoiseParams& params, float x, float y, float z, float w) const;
+        void EvaluateRow3D(const NoiseParams& params, float x, float y, float z, float dx, int count, float* out) const;
+        void EvaluateRow4D(const NoiseParams& params, float x, float y, float z, float w, float dx,
+                           int count, float* out) const;
+
+        // Volume of width x height x depth samples, x fastest, slices packed
+        void EvaluateVolume(const NoiseParams& params, float x, float y, float z, float dx, float dy, float dz,
+                            int width, int height, int depth, float* out) const;
+
+        // Seamlessly looping 2D animation: time is a circle of loopRadius
+        // (before frequency) in the z/w plane, so phase 1 equals phase 0
+        void EvaluateLoopGrid(const NoiseParams& params, float x, float y, float dx, float dy, int width, int height,
+                              float phase, float loopRadius, float* out, int stride) const;
+
+        // Worley noise with one hashed feature point per unit cell, searched
+        // over the 3x3 neighbourhood in a single pass. Both distances are
+        // approximate (3x3 search): a closer point beyond the neighbourhood is
+        // missed, which rarely overestimates F1 and somewhat more often F2.
+        CellularResult Cellular(float x, float y, CellularMetric metric = CellularMetric::Euclidean) const;
+        void CellularRow(float x, float y, float dx, int count, CellularMetric metric, CellularResult* out) const;
+
+        // Batched evaluation. Sample i of a row is taken at (x + i * dx, y);
+        // grid rows advance by dy and are written stride floats apart.
+        // Results match the scalar functions above for the same coordinates.
+        float Evaluate(const NoiseParams& params, float x, float y) const;
+        void EvaluateRow(const NoiseParams& params, float x, float y, float dx, int count, float* out) const;
+        void EvaluateGrid(const NoiseParams& params, float x, float y, float dx, float dy,
+                          int width, int height, float* out, int stride) const;
+
+        // Instruction set used by the batched paths. Defaults to the best one
+        // the CPU supports; requests above that are clamped. All levels
+        // produce bit-identical results.
+        static void SetSimdLevel(SimdLevel level);
+        static SimdLevel GetSimdLevel();
+
+        // Shared instance used by NoiseGenerator's static interface
+        static NoiseCore& Default();
+
+        static int FastFloor(float value)
+        {
+            int i = static_cast<int>(value);
+            return (value < static_cast<float>(i)) ? i - 1 : i;
+        }
+
+    private:
+        int Hash(int x, int y) const { return m_perm[m_perm[x & 255] + (y & 255)]; }
+        uint32_t HashCell(int x, int y) const;
+
+        uint32_t m_seed;
+        uint8_t m_perm[512]; // Duplicated so Hash() never needs a second wrap
+
+        static SimdLevel s_simdLevel;
+    };
+
+}
@@ -1,35 +1,38 @@
 #include "NoiseGenerator.h"
+#include "NoiseCore.h"
 #include <cmath>
 #include <algorithm>
 
 namespace TextureEffects {
 
-float NoiseGenerator::Perlin2D(float x, float y, float frequency, int octaves, float persistence)
+void NoiseGenerator::SetSeed(uint32_t seed)
 {
-    float value = 0.0f;
-    float amplitude = 1.0f;
-    float freq = frequency;
-    float maxValue = 0.0f;
-
-    for (int i = 0; i < octaves; i++)
-    {
-        // Simplified Perlin noise using sin/cos
-        float noise = sinf(x * freq) * cosf(y * freq);
-        value += noise * amplitude;
-        maxValue += amplitude;
+    NoiseCore::Default().SetSeed(seed);
+}
 
-        amplitude *= persistence;
-        freq *= 2.0f;
-    }
+uint32_t NoiseGenerator::GetSeed()
+{
+    return NoiseCore::Default().GetSeed();
+}
 
-    return (value / maxValue) * 0.5f + 0.5f; // Normalize to [0, 1]
+float NoiseGenerator::Perlin2D(float x, float y, float frequency, int octaves, float persistence)
+{
+    return NoiseCore::Default().Fractal(x, y, frequency, octaves, persistence, 2.0f);
 }
 
 float NoiseGenerator::Simplex2D(float x, float y, float frequency)
 {
-    // Simplified simplex noise approximation
-    float noise = sinf(x * frequency * 6.28f) * cosf(y * frequency * 6.28f);
-    return noise * 0.5f + 0.5f;
+    return NoiseCore::Default().Simplex(x * frequency, y * frequency) * 0.5f + 0.5f;
+}
+
+float NoiseGenerator::Simplex3D(float x, float y, float z, float frequency)
+{
+    return NoiseCore::Default().Simplex(x * frequency, y * frequency, z * frequency) * 0.5f + 0.5f;
+}
+
+float NoiseGenerator::Simplex4D(float x, float y, float z, float w, float frequency)
+{
+    return NoiseCore::Default().Simplex(x * frequency, y * frequency, z * frequency, w * frequency) * 0.5f + 0.5f;
 }
 
 float NoiseGenerator::Ridge2D(float x, float y, float frequency, int octaves)
@@ -40,79 +43,22 @@ float NoiseGenerator::Ridge2D(float x, float y, float frequency, int octaves)
 
 float NoiseGenerator::Turbulence2D(float x, float y, float frequency, int octaves)
 {
-    float value = 0.0f;
-    float amplitude = 1.0f;
-    float freq = frequency;
-
-    for (int i = 0; i < octaves; i++)
-    {
-        float noise = fabsf(sinf(x * freq) * cosf(y * freq));
-        value += noise * amplitude;
-
-        amplitude *= 0.5f;
-        freq *= 2.0f;
-    }
-
-    return std::min(1.0f, value);
+    return NoiseCore::Default().Turbulence(x, y, frequency, octaves, 0.5f, 2.0f);
 }
 
 float NoiseGenerator::FractalNoise2D(float x, float y, float frequency, int octaves, float persistence, float lacunarity)
 {
-    float value = 0.0f;
-    float amplitude = 1.0f;
-    float freq = frequency;
-    float maxValue = 0.0f;
-
-    for (int i = 0; i < octaves; i++)
-    {
-        float noise = sinf(x * freq * 2.0f * 3.14159f) * cosf(y * freq * 2.0f * 3.14159f);
-        value += noise * amplitude;
-        maxValue += amplitude;
-
-        amplitude *= persistence;
-        freq *= lacunarity;
-    }
-
-    return (value / maxValue) * 0.5f + 0.5f;
+    return NoiseCore::Default().Fractal(x, y, frequency, octaves, persistence, lacunarity);
 }
 
 float NoiseGenerator::RidgedMultifractal2D(float x, float y, float frequency, int octaves, float persistence)
 {
-    float value = 0.0f;
-    float amplitude = 1.0f;
-    float freq = frequency;
-
-    for (int i = 0; i < octaves; i++)
-    {
-        float noise = sinf(x * freq * 2.0f * 3.14159f) * cosf(y * freq * 2.0f * 3.14159f);
-        noise = 1.0f - fabsf(noise);
-        noise *= noise; // Square for sharper ridges
-
-        value += noise * amplitude;
-        amplitude *= persistence;
-        freq *= 2.0f;
-    }
-
-    return std::min(1.0f, value);
+    return NoiseCore::Default().Ridged(x, y, frequency, octaves, persistence, 2.0f);
 }
 
 float NoiseGenerator::BillowNoise2D(float x, float y, float frequency, int octaves, float persistence)
 {
-    float value = 0.0f;
-    float amplitude = 1.0f;
-    float freq = frequency;
-
-    for (int i = 0; i < octaves; i++)
-    {
-        float noise = sinf(x * freq * 2.0f * 3.14159f) * cosf(y * freq * 2.0f * 3.14159f);
-        noise = fabsf(noise); // Absolute value for billowy effect
-
-        value += noise * amplitude;
-        amplitude *= persistence;
-        freq *= 2.0f;
-    }
-
-    return std::min(1.0f, value);
+    return NoiseCore::Default().Billow(x, y, frequency, octaves, persistence, 2.0f);
 }
 
 float NoiseGenerator::WarpedNoise2D(float x, float y, float warpStrength, float frequency)
@@ -127,35 +73,51 @@ float NoiseGenerator::WarpedNoise2D(float x, float y, float warpStrength, float
 
 float NoiseGenerator::VoronoiNoise2D(float x, float y, float frequency)
 {
-    // Simple Voronoi approximation using cellular noise
-    x *= frequency;
-    y *= frequency;
+    return std::min(1.0f, Cellular2D(x, y, frequency).f1);
+}
 
-    int cellX = static_cast<int>(floorf(x));
-    int cellY = static_cast<int>(floorf(y));
+CellularResult NoiseGenerator::Cellular2D(float x, float y, float frequency, CellularMetric metric)
+{
+    return NoiseCore::Default().Cellular(x * frequency, y * frequency, metric);
+}
 
-    float minDistance = 999999.0f;
+void NoiseGenerator::CellularRow(float x, float y, float dx, int count, CellularMetric metric, CellularResult* out)
+{
+    NoiseCore::Default().CellularRow(x, y, dx, count, metric, out);
+}
 
-    for (int offsetY = -1; offsetY <= 1; offsetY++)
-    {
-        for (int offsetX = -1; offsetX <= 1; offsetX++)
-        {
-            int neighborX = cellX + offsetX;
-            int neighborY = cellY + offsetY;
+void NoiseGenerator::EvaluateRow(const NoiseParams& params, float x, float y, float dx, int count, float* out)
+{
+    NoiseCore::Default().EvaluateRow(params, x, y, dx, count, out);
+}
 
-            // Generate pseudo-random point in this cell
-            float pointX = neighborX + sinf(neighborX * 23.1f + neighborY * 19.7f) * 0.5f + 0.5f;
-            float pointY = neighborY + cosf(neighborX * 31.3f + neighborY * 17.5f) * 0.5f + 0.5f;
+void NoiseGenerator::EvaluateGrid(const NoiseParams& params, float x, float y, float dx, float dy,
+                                  int width, int height, float* out, int stride)
+{
+    NoiseCore::Default().EvaluateGrid(params, x, y, dx, dy, width, height, out, stride);
+}
 
-            float dx = x - pointX;
-            float dy = y - pointY;
-            float distance = sqrtf(dx * dx + dy * dy);
+void NoiseGenerator::EvaluateRow3D(const NoiseParams& params, float x, float y, float z, float dx, int count, float* out)
+{
+    NoiseCore::Default().EvaluateRow3D(params, x, y, z, dx, count, out);
+}
 
-            minDistance = std::min(minDistance, distance);
-        }
-    }
+void NoiseGenerator::EvaluateRow4D(const NoiseParams& params, float x, float y, float z, float w, float dx,
+                                   int count, float* out)
+{
+    NoiseCore::Default().EvaluateRow4D(params, x, y, z, w, dx, count, out);
+}
+
+void NoiseGenerator::EvaluateVolume(const NoiseParams& params, float x, float y, float z, float dx, float dy, float dz,
+                                    int width, int height, int depth, float* out)
+{
+    NoiseCore::Default().EvaluateVolume(params, x, y, z, dx, dy, dz, width, height, depth, out);
+}
 
-    return std::min(1.0f, minDistance);
+void NoiseGenerator::EvaluateLoopGrid(const NoiseParams& params, float x, float y, float dx, float dy, int width, int height,
+                                      float phase, float loopRadius, float* out, int stride)
+{
+    NoiseCore::Default().EvaluateLoopGrid(params, x, y, dx, dy, width, height, phase, loopRadius, out, stride);
 }
 
 D3DCOLOR NoiseGenerator::NoiseToColor(float noise, const D3DCOLOR& color1, const D3DCOLOR& color2)
@@ -1,14 +1,22 @@
 #pragma once
 
-#include <d3d9.h>
+#include "EffectTypes.h"
+#include <cstdint>
+#include "NoiseCore.h"
 
 namespace TextureEffects {
 
     class NoiseGenerator {
     public:
+        // Seeding (shared permutation table, see NoiseCore)
+        static void SetSeed(uint32_t seed);
+        static uint32_t GetSeed();
+
         // Basic noise functions
         static float Perlin2D(float x, float y, float frequency = 1.0f, int octaves = 4, float persistence = 0.5f);
         static float Simplex2D(float x, float y, float frequency = 1.0f);
+        static float Simplex3D(float x, float y, float z, float frequency = 1.0f);
+        static float Simplex4D(float x, float y, float z, float w, float frequency = 1.0f);
         static float Ridge2D(float x, float y, float frequency = 1.0f, int octaves = 4);
         static float Turbulence2D(float x, float y, float frequency = 1.0f, int octaves = 4);
 
@@ -21,6 +29,24 @@ namespace TextureEffects {
         static float WarpedNoise2D(float x, float y, float warpStrength = 0.1f, float frequency = 1.0f);
         static float VoronoiNoise2D(float x, float y, float frequency = 1.0f);
 
+        // Cellular (Worley) noise: F1, F2, F2 - F1 and cell ID in one pass
+        static CellularResult Cellular2D(float x, float y, float frequency = 1.0f,
+                                         CellularMetric metric = CellularMetric::Euclidean);
+        // Row in noise space (frequency already applied): sample i at (x + i * dx, y)
+        static void CellularRow(float x, float y, float dx, int count, CellularMetric metric, CellularResult* out);
+
+        // Batched evaluation into caller-provided float buffers (see NoiseCore)
+        static void EvaluateRow(const NoiseParams& params, float x, float y, float dx, int count, float* out);
+        static void EvaluateGrid(const NoiseParams& params, float x, float y, float dx, float dy,
+                                 int width, int height, float* out, int stride);
+        static void EvaluateRow3D(const NoiseParams& params, float x, float y, float z, float dx, int count, float* out);
+        static void EvaluateRow4D(const NoiseParams& params, float x, float y, float z, float w, float dx,
+                                  int count, float* out);
+        static void EvaluateVolume(const NoiseParams& params, float x, float y, float z, float dx, float dy, float dz,
+                                   int width, int height, int depth, float* out);
+        static void EvaluateLoopGrid(const NoiseParams& params, float x, float y, float dx, float dy, int width, int height,
+                                     float phase, float loopRadius, float* out, int stride);
+
         // Utility functions
         static D3DCOLOR NoiseToColor(float noise, const D3DCOLOR& color1, const D3DCOLOR& color2);
         static D3DCOLOR NoiseToGrayscale(float noise);
@@ -0,0 +1,194 @@
+#include "NoiseKernels.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOISE_KERNELS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TextureEffects {
+namespace NoiseKernels {
+
+void AccumulateScalar(Mode mode, const NoiseRowArgs& args, int start)
+{
+    const float yf = args.yf;
+    const float yf1 = yf - 1.0f;
+    const float v = args.v;
+    const float amplitude = args.amplitude;
+
+    for (int i = start; i < args.count; i++)
+    {
+        float xf = args.xf[i];
+        float u = args.u[i];
+
+        float n00 = Grad(args.h00[i], xf, yf);
+        float n10 = Grad(args.h10[i], xf - 1.0f, yf);
+        float n01 = Grad(args.h01[i], xf, yf1);
+        float n11 = Grad(args.h11[i], xf - 1.0f, yf1);
+
+        float n = Lerp(Lerp(n00, n10, u), Lerp(n01, n11, u), v);
+
+        switch (mode)
+        {
+        case Mode::Signed:
+            args.out[i] += n * amplitude;
+            break;
+        case Mode::Ridged:
+        {
+            float ridge = 1.0f - fabsf(n);
+            ridge *= ridge;
+            args.out[i] += ridge * amplitude;
+            break;
+        }
+        case Mode::Absolute:
+            args.out[i] += fabsf(n) * amplitude;
+            break;
+        }
+    }
+}
+
+namespace {
+
+template <Mode M>
+void ScalarKernel(const NoiseRowArgs& args)
+{
+    AccumulateScalar(M, args, 0);
+}
+
+#if defined(NOISE_KERNELS_SSE2)
+
+// Gradient components from the low 3 hash bits, computed with integer masks
+// instead of a table gather. Yields exactly the kGradX/kGradY values.
+inline __m128 GradSSE2(__m128i hash, __m128 x, __m128 y)
+{
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(7));
+
+    __m128i bit0 = _mm_and_si128(h, one);
+    __m128i bit1 = _mm_and_si128(h, _mm_set1_epi32(2));
+    __m128 signA = _mm_cvtepi32_ps(_mm_sub_epi32(one, _mm_add_epi32(bit0, bit0)));
+    __m128 signB = _mm_cvtepi32_ps(_mm_sub_epi32(one, bit1));
+
+    __m128 lt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    __m128 lt6 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(6)));
+    __m128 ge6 = _mm_castsi128_ps(_mm_cmpgt_epi32(h, _mm_set1_epi32(5)));
+
+    __m128 gx = _mm_and_ps(lt6, signA);
+    __m128 gy = _mm_or_ps(_mm_and_ps(lt4, signB), _mm_and_ps(ge6, signA));
+
+    return _mm_add_ps(_mm_mul_ps(gx, x), _mm_mul_ps(gy, y));
+}
+
+inline __m128 LerpSSE2(__m128 a, __m128 b, __m128 t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+// Zero-extends 4 hash bytes to 32-bit lanes
+inline __m128i LoadHash4(const uint8_t* hash)
+{
+    int bytes;
+    memcpy(&bytes, hash, sizeof(bytes));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero);
+    return _mm_unpacklo_epi16(words, zero);
+}
+
+template <Mode M>
+void SSE2Kernel(const NoiseRowArgs& args)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 yf = _mm_set1_ps(args.yf);
+    const __m128 yf1 = _mm_set1_ps(args.yf - 1.0f);
+    const __m128 v = _mm_set1_ps(args.v);
+    const __m128 amplitude = _mm_set1_ps(args.amplitude);
+
+    int i = 0;
+    for (; i + 4 <= args.count; i += 4)
+    {
+        __m128 xf = _mm_loadu_ps(args.xf + i);
+        __m128 xf1 = _mm_sub_ps(xf, one);
+        __m128 u = _mm_loadu_ps(args.u + i);
+
+        __m128 n00 = GradSSE2(LoadHash4(args.h00 + i), xf, yf);
+        __m128 n10 = GradSSE2(LoadHash4(args.h10 + i), xf1, yf);
+        __m128 n01 = GradSSE2(LoadHash4(args.h01 + i), xf, yf1);
+        __m128 n11 = GradSSE2(LoadHash4(args.h11 + i), xf1, yf1);
+
+        __m128 n = LerpSSE2(LerpSSE2(n00, n10, u), LerpSSE2(n01, n11, u), v);
+
+        __m128 acc = _mm_loadu_ps(args.out + i);
+        if constexpr (M == Mode::Signed)
+        {
+            acc = _mm_add_ps(acc, _mm_mul_ps(n, amplitude));
+        }
+        else if constexpr (M == Mode::Ridged)
+        {
+            __m128 ridge = _mm_sub_ps(one, _mm_and_ps(n, absMask));
+            ridge = _mm_mul_ps(ridge, ridge);
+            acc = _mm_add_ps(acc, _mm_mul_ps(ridge, amplitude));
+        }
+        else
+        {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_and_ps(n, absMask), amplitude));
+        }
+        _mm_storeu_ps(args.out + i, acc);
+    }
+
+    AccumulateScalar(M, args, i);
+}
+
+#endif // NOISE_KERNELS_SSE2
+
+} // namespace
+
+NoiseRowKernel GetScalarKernel(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Ridged:
+        return &ScalarKernel<Mode::Ridged>;
+    case Mode::Absolute:
+        return &ScalarKernel<Mode::Absolute>;
+    case Mode::Signed:
+    default:
+        return &ScalarKernel<Mode::Signed>;
+    }
+}
+
+NoiseRowKernel GetSSE2Kernel(Mode mode)
+{
+#if defined(NOISE_KERNELS_SSE2)
+    switch (mode)
+    {
+    case Mode::Ridged:
+        return &SSE2Kernel<Mode::Ridged>;
+    case Mode::Absolute:
+        return &SSE2Kernel<Mode::Absolute>;
+    case Mode::Signed:
+    default:
+        return &SSE2Kernel<Mode::Signed>;
+    }
+#else
+    (void)mode;
+    return nullptr;
+#endif
+}
+
+NoiseRowKernel GetRowKernel(Mode mode, SimdLevel level)
+{
+    NoiseRowKernel kernel = nullptr;
+
+    if (level >= SimdLevel::AVX2 && CpuFeatures::HasAVX2())
+        kernel = GetAVX2Kernel(mode);
+
+    if (!kernel && level >= SimdLevel::SSE2 && CpuFeatures::HasSSE2())
+        kernel = GetSSE2Kernel(mode);
+
+    return kernel ? kernel : GetScalarKernel(mode);
+}
+
+} // namespace NoiseKernels
+} // namespace TextureEffects
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include "NoiseCore.h"
+#include "../../Core/CpuFeatures.h"
+
+// Internal row kernels used by NoiseCore::EvaluateGrid. Every instruction set
+// performs the same IEEE operations in the same order as the scalar kernel,
+// so all paths produce bit-identical output.
+
+namespace TextureEffects {
+
+    // One octave of Perlin noise accumulated into a row of samples
+    struct NoiseRowArgs {
+        const float* xf;       // Per-column fractional x
+        const float* u;        // Per-column fade weight
+        const uint8_t* h00;    // Per-column corner hashes, resolved by the
+        const uint8_t* h10;    // caller once per lattice cell so the kernels
+        const uint8_t* h01;    // only do contiguous loads
+        const uint8_t* h11;
+        float yf;
+        float v;
+        float amplitude;
+        int count;
+        float* out;
+    };
+
+    using NoiseRowKernel = void (*)(const NoiseRowArgs& args);
+
+    namespace NoiseKernels {
+        // Shared math. Internal linkage keeps copies compiled with wider
+        // instruction sets from being merged into the scalar code.
+        namespace {
+            // Gradient set for 2D lattice noise: 4 diagonals + 4 axes
+            const float kGradX[8] = { 1.0f, -1.0f,  1.0f, -1.0f, 1.0f, -1.0f, 0.0f,  0.0f };
+            const float kGradY[8] = { 1.0f,  1.0f, -1.0f, -1.0f, 0.0f,  0.0f, 1.0f, -1.0f };
+
+            inline float Fade(float t)
+            {
+                return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+            }
+
+            inline float Lerp(float a, float b, float t)
+            {
+                return a + t * (b - a);
+            }
+
+            inline float Grad(int hash, float x, float y)
+            {
+                int h = hash & 7;
+                return kGradX[h] * x + kGradY[h] * y;
+            }
+        }
+
+        // How an octave is folded into the accumulator
+        enum class Mode {
+            Signed,   // FBM
+            Ridged,   // (1 - |n|)^2
+            Absolute  // Billow, turbulence
+        };
+
+        NoiseRowKernel GetRowKernel(Mode mode, SimdLevel level);
+
+        // Per instruction set entry points; null when not compiled in
+        NoiseRowKernel GetScalarKernel(Mode mode);
+        NoiseRowKernel GetSSE2Kernel(Mode mode);
+        NoiseRowKernel GetAVX2Kernel(Mode mode);
+
+        // Scalar tail for columns [start, args.count)
+        void AccumulateScalar(Mode mode, const NoiseRowArgs& args, int start);
+    }
+
+}
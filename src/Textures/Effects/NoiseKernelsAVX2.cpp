@@ -0,0 +1,121 @@
+// Built with AVX2 code generation (see CMakeLists.txt). Only the kernels in
+// this file may use AVX2; they are reached through runtime dispatch, so no
+// inline function shared with other translation units is called from here.
+#include "NoiseKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace TextureEffects {
+namespace NoiseKernels {
+
+#if defined(__AVX2__)
+
+namespace {
+
+inline __m256 GradAVX2(__m256i hash, __m256 x, __m256 y)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(7));
+
+    __m256i bit0 = _mm256_and_si256(h, one);
+    __m256i bit1 = _mm256_and_si256(h, _mm256_set1_epi32(2));
+    __m256 signA = _mm256_cvtepi32_ps(_mm256_sub_epi32(one, _mm256_add_epi32(bit0, bit0)));
+    __m256 signB = _mm256_cvtepi32_ps(_mm256_sub_epi32(one, bit1));
+
+    __m256 lt4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    __m256 lt6 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(6), h));
+    __m256 ge6 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(h, _mm256_set1_epi32(5)));
+
+    __m256 gx = _mm256_and_ps(lt6, signA);
+    __m256 gy = _mm256_or_ps(_mm256_and_ps(lt4, signB), _mm256_and_ps(ge6, signA));
+
+    // Separate mul + add (no FMA) to stay bit-identical with the scalar path
+    return _mm256_add_ps(_mm256_mul_ps(gx, x), _mm256_mul_ps(gy, y));
+}
+
+inline __m256 LerpAVX2(__m256 a, __m256 b, __m256 t)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+// Zero-extends 8 hash bytes to 32-bit lanes
+inline __m256i LoadHash8(const uint8_t* hash)
+{
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(hash)));
+}
+
+template <Mode M>
+void AVX2Kernel(const NoiseRowArgs& args)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 yf = _mm256_set1_ps(args.yf);
+    const __m256 yf1 = _mm256_set1_ps(args.yf - 1.0f);
+    const __m256 v = _mm256_set1_ps(args.v);
+    const __m256 amplitude = _mm256_set1_ps(args.amplitude);
+
+    int i = 0;
+    for (; i + 8 <= args.count; i += 8)
+    {
+        __m256 xf = _mm256_loadu_ps(args.xf + i);
+        __m256 xf1 = _mm256_sub_ps(xf, one);
+        __m256 u = _mm256_loadu_ps(args.u + i);
+
+        __m256 n00 = GradAVX2(LoadHash8(args.h00 + i), xf, yf);
+        __m256 n10 = GradAVX2(LoadHash8(args.h10 + i), xf1, yf);
+        __m256 n01 = GradAVX2(LoadHash8(args.h01 + i), xf, yf1);
+        __m256 n11 = GradAVX2(LoadHash8(args.h11 + i), xf1, yf1);
+
+        __m256 n = LerpAVX2(LerpAVX2(n00, n10, u), LerpAVX2(n01, n11, u), v);
+
+        __m256 acc = _mm256_loadu_ps(args.out + i);
+        if constexpr (M == Mode::Signed)
+        {
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(n, amplitude));
+        }
+        else if constexpr (M == Mode::Ridged)
+        {
+            __m256 ridge = _mm256_sub_ps(one, _mm256_and_ps(n, absMask));
+            ridge = _mm256_mul_ps(ridge, ridge);
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(ridge, amplitude));
+        }
+        else
+        {
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_and_ps(n, absMask), amplitude));
+        }
+        _mm256_storeu_ps(args.out + i, acc);
+    }
+
+    // Tail handled by the scalar code in NoiseKernels.cpp (out of line)
+    AccumulateScalar(M, args, i);
+}
+
+} // namespace
+
+NoiseRowKernel GetAVX2Kernel(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Ridged:
+        return &AVX2Kernel<Mode::Ridged>;
+    case Mode::Absolute:
+        return &AVX2Kernel<Mode::Absolute>;
+    case Mode::Signed:
+    default:
+        return &AVX2Kernel<Mode::Signed>;
+    }
+}
+
+#else
+
+NoiseRowKernel GetAVX2Kernel(Mode)
+{
+    return nullptr;
+}
+
+#endif // __AVX2__
+
+} // namespace NoiseKernels
+} // namespace TextureEffects
@@ -0,0 +1,160 @@
+#include "PixelBuffer.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace TextureEffects {
+
+D3DCOLOR ImageView::GetClamped(int x, int y) const
+{
+    x = std::max(0, std::min(width - 1, x));
+    y = std::max(0, std::min(height - 1, y));
+    return Row(y)[x];
+}
+
+ImageView ImageView::SubView(int x, int y, int w, int h) const
+{
+    int x0 = std::max(0, x);
+    int y0 = std::max(0, y);
+    int x1 = std::min(width, x + w);
+    int y1 = std::min(height, y + h);
+
+    if (x1 <= x0 || y1 <= y0)
+        return ImageView();
+
+    return ImageView(Row(y0) + x0, x1 - x0, y1 - y0, pitch, format);
+}
+
+void ImageView::CopyTo(const ImageView& destination) const
+{
+    if (!IsValid() || !destination.IsValid())
+        return;
+
+    int copyWidth = std::min(width, destination.width);
+    int copyHeight = std::min(height, destination.height);
+
+    for (int y = 0; y < copyHeight; y++)
+    {
+        memcpy(destination.Row(y), Row(y), copyWidth * sizeof(D3DCOLOR));
+    }
+}
+
+PixelBuffer::PixelBuffer()
+    : m_pixels(nullptr)
+    , m_width(0)
+    , m_height(0)
+    , m_pitch(0)
+    , m_format(PixelFormat::A8R8G8B8)
+{
+}
+
+PixelBuffer::PixelBuffer(int width, int height, PixelFormat format)
+    : PixelBuffer()
+{
+    Allocate(width, height, format);
+}
+
+PixelBuffer::~PixelBuffer()
+{
+    Release();
+}
+
+PixelBuffer::PixelBuffer(const PixelBuffer& other)
+    : PixelBuffer()
+{
+    *this = other;
+}
+
+PixelBuffer& PixelBuffer::operator=(const PixelBuffer& other)
+{
+    if (this == &other)
+        return *this;
+
+    if (!other.IsValid())
+    {
+        Release();
+        return *this;
+    }
+
+    if (Allocate(other.m_width, other.m_height, other.m_format))
+    {
+        other.GetView().CopyTo(GetView());
+    }
+    return *this;
+}
+
+PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept
+    : PixelBuffer()
+{
+    *this = std::move(other);
+}
+
+PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        std::swap(m_pixels, other.m_pixels);
+        std::swap(m_width, other.m_width);
+        std::swap(m_height, other.m_height);
+        std::swap(m_pitch, other.m_pitch);
+        std::swap(m_format, other.m_format);
+    }
+    return *this;
+}
+
+bool PixelBuffer::Allocate(int width, int height, PixelFormat format)
+{
+    if (width <= 0 || height <= 0)
+    {
+        Release();
+        return false;
+    }
+
+    // Round the pitch up to whole cache lines
+    const int pixelsPerLine = kAlignment / static_cast<int>(sizeof(D3DCOLOR));
+    int pitch = (width + pixelsPerLine - 1) / pixelsPerLine * pixelsPerLine;
+
+    if (m_pixels && m_width == width && m_height == height && m_pitch == pitch)
+    {
+        m_format = format;
+        return true;
+    }
+
+    Release();
+
+    size_t bytes = static_cast<size_t>(pitch) * height * sizeof(D3DCOLOR);
+    m_pixels = static_cast<D3DCOLOR*>(::operator new(bytes, std::align_val_t(kAlignment), std::nothrow));
+    if (!m_pixels)
+        return false;
+
+    m_width = width;
+    m_height = height;
+    m_pitch = pitch;
+    m_format = format;
+    return true;
+}
+
+void PixelBuffer::Release()
+{
+    if (m_pixels)
+    {
+        ::operator delete(m_pixels, std::align_val_t(kAlignment));
+        m_pixels = nullptr;
+    }
+
+    m_width = 0;
+    m_height = 0;
+    m_pitch = 0;
+}
+
+void PixelBuffer::Clear(D3DCOLOR color)
+{
+    for (int y = 0; y < m_height; y++)
+    {
+        std::fill(m_pixels + static_cast<size_t>(y) * m_pitch, m_pixels + static_cast<size_t>(y + 1) * m_pitch, color);
+    }
+}
+
+} // namespace TextureEffects
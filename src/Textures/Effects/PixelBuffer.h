@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include "EffectTypes.h"
+
+namespace TextureEffects {
+
+    // 32-bit layouts the effects understand (D3DCOLOR bit order)
+    enum class PixelFormat {
+        A8R8G8B8,
+        X8R8G8B8    // Alpha is ignored by the GPU but still written
+    };
+
+    // Non-owning view of 32-bit pixels. pitch is in pixels, not bytes. Every
+    // effect reads and writes through a view; where the memory comes from (a
+    // PixelBuffer, a locked texture, a staging buffer) is up to the caller.
+    struct ImageView {
+        D3DCOLOR* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        int pitch = 0;
+        PixelFormat format = PixelFormat::A8R8G8B8;
+
+        ImageView() = default;
+        ImageView(D3DCOLOR* data, int w, int h, int rowPitch, PixelFormat fmt = PixelFormat::A8R8G8B8)
+            : pixels(data), width(w), height(h), pitch(rowPitch), format(fmt) {}
+
+        bool IsValid() const { return pixels != nullptr && width > 0 && height > 0 && pitch >= width; }
+        D3DCOLOR* Row(int y) const { return pixels + static_cast<ptrdiff_t>(y) * pitch; }
+        D3DCOLOR& At(int x, int y) const { return Row(y)[x]; }
+
+        // Coordinates outside the image are clamped to the nearest edge
+        D3DCOLOR GetClamped(int x, int y) const;
+
+        // Rectangle inside this view, clipped to its bounds
+        ImageView SubView(int x, int y, int w, int h) const;
+
+        // Copies the overlapping area into destination
+        void CopyTo(const ImageView& destination) const;
+    };
+
+    // Owning image with 64-byte aligned rows, so row kernels can use aligned
+    // vector loads from the first pixel of any row.
+    class PixelBuffer {
+    public:
+        PixelBuffer();
+        PixelBuffer(int width, int height, PixelFormat format = PixelFormat::A8R8G8B8);
+        ~PixelBuffer();
+
+        PixelBuffer(const PixelBuffer& other);
+        PixelBuffer& operator=(const PixelBuffer& other);
+        PixelBuffer(PixelBuffer&& other) noexcept;
+        PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+
+        // Keeps the current allocation when the size already matches.
+        // Contents are undefined after a reallocation.
+        bool Allocate(int width, int height, PixelFormat format = PixelFormat::A8R8G8B8);
+        void Release();
+        void Clear(D3DCOLOR color = 0);
+
+        bool IsValid() const { return m_pixels != nullptr; }
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        int GetPitch() const { return m_pitch; }
+        PixelFormat GetFormat() const { return m_format; }
+        size_t GetMemoryUsage() const { return static_cast<size_t>(m_pitch) * m_height * sizeof(D3DCOLOR); }
+
+        D3DCOLOR* GetPixels() { return m_pixels; }
+        const D3DCOLOR* GetPixels() const { return m_pixels; }
+        ImageView GetView() const { return ImageView(m_pixels, m_width, m_height, m_pitch, m_format); }
+
+        static const int kAlignment = 64;
+
+    private:
+        D3DCOLOR* m_pixels;
+        int m_width;
+        int m_height;
+        int m_pitch;
+        PixelFormat m_format;
+    };
+
+}
@@ -0,0 +1,290 @@
+#include "PointOps.h"
+#include "ColorSpace.h"
+#include "TextureUtils.h"
+#include "EffectThreads.h"
+#include "../../Core/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TextureEffects {
+
+namespace {
+
+BYTE ClampByte(int value)
+{
+    return static_cast<BYTE>(std::max(0, std::min(255, value)));
+}
+
+// Table of func(channel, value) for channel 0..2 (red, green, blue)
+template <typename Func>
+std::vector<BYTE> MakeTable(Func&& func)
+{
+    std::vector<BYTE> table(3 * 256);
+    for (int c = 0; c < 3; c++)
+    {
+        for (int v = 0; v < 256; v++)
+        {
+            table[c * 256 + v] = ClampByte(func(c, v));
+        }
+    }
+    return table;
+}
+
+// Same table for all three channels
+template <typename Func>
+std::vector<BYTE> MakeUniformTable(Func&& func)
+{
+    return MakeTable([&](int, int v) { return func(v); });
+}
+
+// Per-pixel op that keeps alpha and maps the color through func(color)
+template <typename Func>
+PointOp MakeColorOp(Func func)
+{
+    PointOp op;
+    op.apply = [func](const PixelSpan& span) {
+        for (int i = 0; i < span.count; i++)
+        {
+            D3DCOLOR color = span.pixels[i];
+            span.pixels[i] = (color & 0xFF000000) | (func(color) & 0x00FFFFFF);
+        }
+    };
+    return op;
+}
+
+// Per-pixel op that converts the span to HSV arrays, lets func(h, s, v, count)
+// adjust them and converts back, keeping alpha
+template <typename Func>
+PointOp MakeHSVOp(Func func)
+{
+    PointOp op;
+    op.apply = [func](const PixelSpan& span) {
+        const int chunk = 256;
+        float h[chunk], s[chunk], v[chunk];
+        for (int start = 0; start < span.count; start += chunk)
+        {
+            int count = std::min(chunk, span.count - start);
+            D3DCOLOR* pixels = span.pixels + start;
+            ColorSpace::RGBToHSV(pixels, h, s, v, count);
+            func(h, s, v, count);
+            ColorSpace::HSVToRGB(h, s, v, pixels, count);
+        }
+    };
+    return op;
+}
+
+} // namespace
+
+PointOp PointOps::ChannelTable(std::vector<BYTE> table)
+{
+    PointOp op;
+    op.table = std::move(table);
+    op.apply = [table = op.table](const PixelSpan& span) {
+        const BYTE* r = table.data();
+        const BYTE* g = r + 256;
+        const BYTE* b = g + 256;
+        for (int i = 0; i < span.count; i++)
+        {
+            D3DCOLOR color = span.pixels[i];
+            span.pixels[i] = (color & 0xFF000000) | (static_cast<D3DCOLOR>(r[(color >> 16) & 0xFF]) << 16) |
+                             (static_cast<D3DCOLOR>(g[(color >> 8) & 0xFF]) << 8) | b[color & 0xFF];
+        }
+    };
+    return op;
+}
+
+PointOp PointOps::Compose(const PointOp& first, const PointOp& second)
+{
+    std::vector<BYTE> table(3 * 256);
+    for (int c = 0; c < 3; c++)
+    {
+        for (int v = 0; v < 256; v++)
+        {
+            table[c * 256 + v] = second.table[c * 256 + first.table[c * 256 + v]];
+        }
+    }
+    return ChannelTable(std::move(table));
+}
+
+PointOp PointOps::Brightness(float brightness)
+{
+    brightness = std::max(-1.0f, std::min(1.0f, brightness));
+
+    return ChannelTable(MakeUniformTable([brightness](int v) {
+        BYTE value = static_cast<BYTE>(v);
+        if (brightness > 0)
+            return static_cast<int>(static_cast<BYTE>(value + (255 - value) * brightness));
+        return static_cast<int>(static_cast<BYTE>(value * (1.0f + brightness)));
+    }));
+}
+
+PointOp PointOps::Contrast(float contrast)
+{
+    float factor = (259.0f * (contrast + 255.0f)) / (255.0f * (259.0f - contrast));
+
+    return ChannelTable(MakeUniformTable([factor](int v) {
+        return static_cast<int>(factor * (v - 128) + 128);
+    }));
+}
+
+PointOp PointOps::Saturation(float saturation)
+{
+    return MakeHSVOp([saturation](float*, float* s, float*, int count) {
+        for (int i = 0; i < count; i++)
+        {
+            s[i] = std::max(0.0f, std::min(1.0f, s[i] * saturation));
+        }
+    });
+}
+
+PointOp PointOps::Hue(float hueShift)
+{
+    // HSVToRGB wraps the hue
+    return MakeHSVOp([hueShift](float* h, float*, float*, int count) {
+        for (int i = 0; i < count; i++)
+        {
+            h[i] += hueShift;
+        }
+    });
+}
+
+PointOp PointOps::Gamma(float gamma)
+{
+    float exponent = gamma > 0.0f ? 1.0f / gamma : 1.0f;
+
+    return ChannelTable(MakeUniformTable([exponent](int v) {
+        return static_cast<int>(255.0f * powf(v / 255.0f, exponent) + 0.5f);
+    }));
+}
+
+PointOp PointOps::ColorBalance(float redBalance, float greenBalance, float blueBalance)
+{
+    const float balance[3] = { redBalance, greenBalance, blueBalance };
+
+    return ChannelTable(MakeTable([&balance](int c, int v) {
+        return static_cast<int>(v * std::max(0.0f, balance[c]) + 0.5f);
+    }));
+}
+
+PointOp PointOps::Posterize(int levels)
+{
+    if (levels < 2)
+        return ChannelTable(MakeUniformTable([](int v) { return v; }));
+    levels = std::min(256, levels);
+
+    // Split 0..255 into equal bins and spread the bins back over 0..255
+    return ChannelTable(MakeUniformTable([levels](int v) {
+        int bin = v * levels / 256;
+        return (bin * 255 + (levels - 1) / 2) / (levels - 1);
+    }));
+}
+
+PointOp PointOps::Threshold(float threshold, bool binary)
+{
+    return MakeColorOp([threshold, binary](D3DCOLOR color) -> D3DCOLOR {
+        bool above = Utils::GetLuminance(color) >= threshold;
+        if (binary)
+            return above ? 0x00FFFFFF : 0x00000000;
+        return above ? color : 0x00000000;
+    });
+}
+
+PointOp PointOps::Invert()
+{
+    return ChannelTable(MakeUniformTable([](int v) { return 255 - v; }));
+}
+
+PointOp PointOps::Sepia(float intensity)
+{
+    intensity = std::max(0.0f, std::min(1.0f, intensity));
+
+    return MakeColorOp([intensity](D3DCOLOR color) {
+        float r = static_cast<float>((color >> 16) & 0xFF);
+        float g = static_cast<float>((color >> 8) & 0xFF);
+        float b = static_cast<float>(color & 0xFF);
+
+        float sepiaR = 0.393f * r + 0.769f * g + 0.189f * b;
+        float sepiaG = 0.349f * r + 0.686f * g + 0.168f * b;
+        float sepiaB = 0.272f * r + 0.534f * g + 0.131f * b;
+
+        BYTE nr = ClampByte(static_cast<int>(r + (sepiaR - r) * intensity + 0.5f));
+        BYTE ng = ClampByte(static_cast<int>(g + (sepiaG - g) * intensity + 0.5f));
+        BYTE nb = ClampByte(static_cast<int>(b + (sepiaB - b) * intensity + 0.5f));
+        return D3DCOLOR_ARGB(0, nr, ng, nb);
+    });
+}
+
+PointOp PointOps::Vignette(float strength, float radius)
+{
+    // Darkens towards the corners: untouched inside radius (a fraction of the
+    // center-to-corner distance), strength darker at the corners with a
+    // smoothstep in between
+    PointOp op;
+    op.positional = true;
+    op.apply = [strength, radius](const PixelSpan& span) {
+        if (radius >= 1.0f || strength <= 0.0f)
+            return;
+
+        float centerX = span.width * 0.5f;
+        float centerY = span.height * 0.5f;
+        float maxDistance = sqrtf(centerX * centerX + centerY * centerY);
+        float inner = std::max(0.0f, radius) * maxDistance;
+        float innerSquared = inner * inner;
+        float rampScale = 1.0f / ((1.0f - radius) * maxDistance);
+        float dy = span.y + 0.5f - centerY;
+
+        for (int i = 0; i < span.count; i++)
+        {
+            float dx = span.x + i + 0.5f - centerX;
+            float distanceSquared = dx * dx + dy * dy;
+            if (distanceSquared <= innerSquared)
+                continue;
+
+            float t = std::min(1.0f, (sqrtf(distanceSquared) - inner) * rampScale);
+            float factor = std::max(0.0f, 1.0f - strength * t * t * (3.0f - 2.0f * t));
+
+            D3DCOLOR color = span.pixels[i];
+            BYTE r = static_cast<BYTE>(((color >> 16) & 0xFF) * factor + 0.5f);
+            BYTE g = static_cast<BYTE>(((color >> 8) & 0xFF) * factor + 0.5f);
+            BYTE b = static_cast<BYTE>((color & 0xFF) * factor + 0.5f);
+            span.pixels[i] = D3DCOLOR_ARGB((color >> 24) & 0xFF, r, g, b);
+        }
+    };
+    return op;
+}
+
+void PointOps::Run(const ImageView& image, const std::vector<PointOp>& ops)
+{
+    if (!image.IsValid() || ops.empty()) return;
+
+    int tilesX = (image.width + kTileSize - 1) / kTileSize;
+    int tilesY = (image.height + kTileSize - 1) / kTileSize;
+
+    GetEffectThreadPool().ParallelFor(tilesX * tilesY, [&](int tile) {
+        PixelSpan span;
+        span.x = (tile % tilesX) * kTileSize;
+        span.count = std::min(image.width - span.x, static_cast<int>(kTileSize));
+        span.width = image.width;
+        span.height = image.height;
+
+        int y0 = (tile / tilesX) * kTileSize;
+        int y1 = std::min(y0 + kTileSize, image.height);
+
+        // Every op on one row segment before moving on, while it is in L1
+        for (span.y = y0; span.y < y1; span.y++)
+        {
+            span.pixels = image.Row(span.y) + span.x;
+            for (const PointOp& op : ops)
+            {
+                op.apply(span);
+            }
+        }
+    });
+}
+
+void PointOps::Run(const ImageView& image, const PointOp& op)
+{
+    Run(image, std::vector<PointOp>{ op });
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "PixelBuffer.h"
+
+namespace TextureEffects {
+
+    // A run of pixels of one image row, handed to point operations
+    struct PixelSpan {
+        D3DCOLOR* pixels = nullptr;
+        int count = 0;
+        int x = 0;          // Image position of pixels[0]
+        int y = 0;
+        int width = 0;      // Size of the whole image
+        int height = 0;
+    };
+
+    // Operation whose result for a pixel depends only on that pixel's color
+    // and position. Operations that treat red, green and blue independently
+    // also carry their 256-entry lookup tables, so a run of them composes
+    // into a single lookup.
+    struct PointOp {
+        std::function<void(const PixelSpan& span)> apply;
+        std::vector<BYTE> table; // Red, green, blue; empty when channels mix
+        bool positional = false; // Reads the span position, not just colors
+
+        bool IsChannelTable() const { return !table.empty(); }
+    };
+
+    // The point operations behind PostEffects' color adjustments. Alpha is
+    // kept by all of them.
+    class PointOps {
+    public:
+        static PointOp Brightness(float brightness);
+        static PointOp Contrast(float contrast);
+        static PointOp Saturation(float saturation);
+        static PointOp Hue(float hueShift);            // Degrees
+        static PointOp Gamma(float gamma);             // > 1 brightens midtones
+        static PointOp ColorBalance(float redBalance, float greenBalance, float blueBalance);
+        static PointOp Posterize(int levels);
+        static PointOp Threshold(float threshold, bool binary);
+        static PointOp Invert();
+        static PointOp Sepia(float intensity);
+        static PointOp Vignette(float strength, float radius);
+
+        // Lookup table op from 3 * 256 entries (red, green, blue)
+        static PointOp ChannelTable(std::vector<BYTE> table);
+
+        // second(first(color)) for two table ops, as one table
+        static PointOp Compose(const PointOp& first, const PointOp& second);
+
+        // Runs the ops in order over the image in one pass, tile by tile so
+        // each tile stays in cache between ops
+        static void Run(const ImageView& image, const std::vector<PointOp>& ops);
+        static void Run(const ImageView& image, const PointOp& op);
+
+        // Tile edge in pixels; 64 x 64 ARGB is 16 KB
+        static const int kTileSize = 64;
+    };
+
+}
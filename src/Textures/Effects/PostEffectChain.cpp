@@ -0,0 +1,227 @@
+#include "PostEffectChain.h"
+#include "PostEffects.h"
+
+namespace TextureEffects {
+
+PostEffectChain& PostEffectChain::AdjustBrightness(float brightness)
+{
+    return AddPointOp(PointOps::Brightness(brightness));
+}
+
+PostEffectChain& PostEffectChain::AdjustContrast(float contrast)
+{
+    return AddPointOp(PointOps::Contrast(contrast));
+}
+
+PostEffectChain& PostEffectChain::AdjustSaturation(float saturation)
+{
+    return AddPointOp(PointOps::Saturation(saturation));
+}
+
+PostEffectChain& PostEffectChain::AdjustHue(float hueShift)
+{
+    return AddPointOp(PointOps::Hue(hueShift));
+}
+
+PostEffectChain& PostEffectChain::AdjustGamma(float gamma)
+{
+    return AddPointOp(PointOps::Gamma(gamma));
+}
+
+PostEffectChain& PostEffectChain::ColorBalance(float redBalance, float greenBalance, float blueBalance)
+{
+    return AddPointOp(PointOps::ColorBalance(redBalance, greenBalance, blueBalance));
+}
+
+PostEffectChain& PostEffectChain::Posterize(int levels)
+{
+    return AddPointOp(PointOps::Posterize(levels));
+}
+
+PostEffectChain& PostEffectChain::Threshold(float threshold, bool binary)
+{
+    return AddPointOp(PointOps::Threshold(threshold, binary));
+}
+
+PostEffectChain& PostEffectChain::Invert()
+{
+    return AddPointOp(PointOps::Invert());
+}
+
+PostEffectChain& PostEffectChain::Sepia(float intensity)
+{
+    return AddPointOp(PointOps::Sepia(intensity));
+}
+
+PostEffectChain& PostEffectChain::AddVignette(float strength, float radius)
+{
+    return AddPointOp(PointOps::Vignette(strength, radius));
+}
+
+PostEffectChain& PostEffectChain::AddPointOp(PointOp op)
+{
+    if (m_stages.empty() || m_stages.back().pass)
+        m_stages.emplace_back();
+
+    Stage& stage = m_stages.back();
+    if (m_useLut)
+        BakeOp(stage, op);
+
+    std::vector<PointOp>& ops = stage.ops;
+    if (!ops.empty() && ops.back().IsChannelTable() && op.IsChannelTable())
+        ops.back() = PointOps::Compose(ops.back(), op);
+    else
+        ops.push_back(std::move(op));
+
+    return *this;
+}
+
+void PostEffectChain::BakeOp(Stage& stage, const PointOp& op) const
+{
+    std::vector<PointOp>& ops = stage.lutOps;
+
+    if (op.positional)
+    {
+        stage.lut.reset();
+        ops.push_back(op);
+        return;
+    }
+
+    if (!stage.lut)
+    {
+        if (op.IsChannelTable())
+        {
+            if (!ops.empty() && ops.back().IsChannelTable())
+                ops.back() = PointOps::Compose(ops.back(), op);
+            else
+                ops.push_back(op);
+            return;
+        }
+
+        // Start a lattice, folding in the 1D table just before it
+        stage.lut.emplace(m_lutSize);
+        if (!ops.empty() && ops.back().IsChannelTable())
+        {
+            stage.lut->Transform(ops.back());
+            ops.pop_back();
+        }
+        ops.emplace_back();
+    }
+
+    stage.lut->Transform(op);
+
+    // The op gets its own copy, so later bakes do not touch a recorded op
+    auto lut = std::make_shared<const ColorLut3D>(*stage.lut);
+    LutInterpolation interpolation = m_lutInterpolation;
+    ops.back().apply = [lut, interpolation](const PixelSpan& span) {
+        lut->Apply(span.pixels, span.count, interpolation);
+    };
+}
+
+PostEffectChain& PostEffectChain::UseColorLut(LutInterpolation interpolation, int size)
+{
+    m_useLut = true;
+    m_lutInterpolation = interpolation;
+    m_lutSize = size;
+
+    for (Stage& stage : m_stages)
+    {
+        stage.lutOps.clear();
+        stage.lut.reset();
+        for (const PointOp& op : stage.ops)
+        {
+            BakeOp(stage, op);
+        }
+    }
+    return *this;
+}
+
+PostEffectChain& PostEffectChain::UseExactColor()
+{
+    m_useLut = false;
+
+    for (Stage& stage : m_stages)
+    {
+        stage.lutOps.clear();
+        stage.lut.reset();
+    }
+    return *this;
+}
+
+PostEffectChain& PostEffectChain::ApplyBlur(float radius)
+{
+    return AddPass([radius](const ImageView& image) { PostEffects::ApplyBlur(image, radius); });
+}
+
+PostEffectChain& PostEffectChain::ApplyGaussianBlur(float sigma)
+{
+    return AddPass([sigma](const ImageView& image) { PostEffects::ApplyGaussianBlur(image, sigma); });
+}
+
+PostEffectChain& PostEffectChain::ApplySharpen(float amount)
+{
+    return AddPass([amount](const ImageView& image) { PostEffects::ApplySharpen(image, amount); });
+}
+
+PostEffectChain& PostEffectChain::ApplyUnsharpMask(float amount, float radius)
+{
+    return AddPass([amount, radius](const ImageView& image) { PostEffects::ApplyUnsharpMask(image, amount, radius); });
+}
+
+PostEffectChain& PostEffectChain::ApplyEmboss(float strength, float angle)
+{
+    return AddPass([strength, angle](const ImageView& image) { PostEffects::ApplyEmboss(image, strength, angle); });
+}
+
+PostEffectChain& PostEffectChain::ApplyEdgeDetection(float threshold)
+{
+    return AddPass([threshold](const ImageView& image) { PostEffects::ApplyEdgeDetection(image, threshold); });
+}
+
+PostEffectChain& PostEffectChain::ApplySobel()
+{
+    return AddPass([](const ImageView& image) { PostEffects::ApplySobel(image); });
+}
+
+PostEffectChain& PostEffectChain::ApplyLaplacian()
+{
+    return AddPass([](const ImageView& image) { PostEffects::ApplyLaplacian(image); });
+}
+
+PostEffectChain& PostEffectChain::AddGlow(float intensity, float radius, D3DCOLOR glowColor)
+{
+    return AddPass([intensity, radius, glowColor](const ImageView& image) {
+        PostEffects::AddGlow(image, intensity, radius, glowColor);
+    });
+}
+
+PostEffectChain& PostEffectChain::Pixelate(int pixelSize)
+{
+    return AddPass([pixelSize](const ImageView& image) { PostEffects::Pixelate(image, pixelSize); });
+}
+
+PostEffectChain& PostEffectChain::AddPass(std::function<void(const ImageView&)> effect)
+{
+    if (effect)
+    {
+        Stage stage;
+        stage.pass = std::move(effect);
+        m_stages.push_back(std::move(stage));
+    }
+    return *this;
+}
+
+void PostEffectChain::Apply(const ImageView& image) const
+{
+    if (!image.IsValid()) return;
+
+    for (const Stage& stage : m_stages)
+    {
+        if (stage.pass)
+            stage.pass(image);
+        else
+            PointOps::Run(image, m_useLut ? stage.lutOps : stage.ops);
+    }
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "ColorLut.h"
+
+class Texture;
+
+namespace TextureEffects {
+
+    // Records a sequence of PostEffects and runs it with as few passes over
+    // the image as possible. Consecutive point operations (color adjustments,
+    // vignette) fuse into a single tiled pass, and runs of per-channel ones
+    // collapse further into one lookup table. Neighbourhood effects (blurs,
+    // kernels) need the whole previous result, so each one ends the current
+    // pass. The output is the same as calling the effects one by one.
+    //
+    //   PostEffectChain chain;
+    //   chain.AdjustBrightness(0.1f).AdjustContrast(20.0f).AdjustGamma(1.2f).AddVignette(0.5f, 0.6f);
+    //   chain.Apply(texture); // One lock, one pass
+    class PostEffectChain {
+    public:
+        // Point operations
+        PostEffectChain& AdjustBrightness(float brightness);
+        PostEffectChain& AdjustContrast(float contrast);
+        PostEffectChain& AdjustSaturation(float saturation);
+        PostEffectChain& AdjustHue(float hueShift);
+        PostEffectChain& AdjustGamma(float gamma);
+        PostEffectChain& ColorBalance(float redBalance, float greenBalance, float blueBalance);
+        PostEffectChain& Posterize(int levels);
+        PostEffectChain& Threshold(float threshold, bool binary = true);
+        PostEffectChain& Invert();
+        PostEffectChain& Sepia(float intensity = 1.0f);
+        PostEffectChain& AddVignette(float strength, float radius);
+
+        // Custom op; set op.positional if it reads the pixel position
+        PostEffectChain& AddPointOp(PointOp op);
+
+        // Neighbourhood operations, each a pass of its own
+        PostEffectChain& ApplyBlur(float radius);
+        PostEffectChain& ApplyGaussianBlur(float sigma);
+        PostEffectChain& ApplySharpen(float amount);
+        PostEffectChain& ApplyUnsharpMask(float amount, float radius);
+        PostEffectChain& ApplyEmboss(float strength, float angle = 45.0f);
+        PostEffectChain& ApplyEdgeDetection(float threshold = 0.1f);
+        PostEffectChain& ApplySobel();
+        PostEffectChain& ApplyLaplacian();
+        PostEffectChain& AddGlow(float intensity, float radius, D3DCOLOR glowColor);
+        PostEffectChain& Pixelate(int pixelSize);
+        PostEffectChain& AddPass(std::function<void(const ImageView&)> effect);
+
+        // Bakes every run of color ops between positional ops and pass
+        // boundaries into a ColorLut3D, so each pixel costs one lookup however
+        // many ops the run holds. Results become approximate (see ColorLut3D):
+        // with the default 33^3 lattice a grading stack (saturation, hue,
+        // contrast, sepia) is off by up to about 12 levels per channel, and a
+        // run with posterize by about 45-50 levels at its steps. Keep
+        // posterize, threshold and other step functions out of LUT runs; the
+        // exact mode (the default) is the safe choice for them. Runs made
+        // only of per-channel ops stay exact 1D tables. Can be switched
+        // before or after recording.
+        PostEffectChain& UseColorLut(LutInterpolation interpolation = LutInterpolation::Tetrahedral,
+                                     int size = ColorLut3D::kDefaultSize);
+
+        // Runs every op as recorded (the default)
+        PostEffectChain& UseExactColor();
+
+        void Apply(const ImageView& image) const;
+
+        // Engine build: locks the texture once for the whole chain
+        void Apply(std::shared_ptr<Texture> texture) const;
+
+        // Passes over the image Apply will make
+        int GetPassCount() const { return static_cast<int>(m_stages.size()); }
+        bool IsEmpty() const { return m_stages.empty(); }
+        void Clear() { m_stages.clear(); }
+
+    private:
+        // Either fused point ops or one whole-image effect
+        struct Stage {
+            std::vector<PointOp> ops;
+            std::function<void(const ImageView&)> pass;
+
+            // Same ops with color runs baked, when the color LUT is in use.
+            // lut is the lattice of the trailing run, kept to bake further ops into.
+            std::vector<PointOp> lutOps;
+            std::optional<ColorLut3D> lut;
+        };
+
+        void BakeOp(Stage& stage, const PointOp& op) const;
+
+        std::vector<Stage> m_stages;
+        bool m_useLut = false;
+        LutInterpolation m_lutInterpolation = LutInterpolation::Tetrahedral;
+        int m_lutSize = ColorLut3D::kDefaultSize;
+    };
+
+}
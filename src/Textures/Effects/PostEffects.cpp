@@ -1,156 +1,97 @@
 #include "PostEffects.h"
-#include "../Texture.h"
+#include "Blur.h"
+#include "Convolution.h"
+#include "PointOps.h"
+#include "TextureUtils.h"
 #include <cmath>
 #include <algorithm>
 #include <random>
+#include <vector>
 
 namespace TextureEffects {
 
-void PostEffects::AdjustBrightness(std::shared_ptr<Texture> texture, float brightness)
+void PostEffects::AdjustBrightness(const ImageView& image, float brightness)
 {
-    if (!texture) return;
-
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect)) return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
-
-    brightness = std::max(-1.0f, std::min(1.0f, brightness));
-
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            D3DCOLOR color = pixels[y * pitch + x];
-
-            BYTE r = (color >> 16) & 0xFF;
-            BYTE g = (color >> 8) & 0xFF;
-            BYTE b = color & 0xFF;
-            BYTE a = (color >> 24) & 0xFF;
-
-            if (brightness > 0)
-            {
-                r = static_cast<BYTE>(r + (255 - r) * brightness);
-                g = static_cast<BYTE>(g + (255 - g) * brightness);
-                b = static_cast<BYTE>(b + (255 - b) * brightness);
-            }
-            else
-            {
-                r = static_cast<BYTE>(r * (1.0f + brightness));
-                g = static_cast<BYTE>(g * (1.0f + brightness));
-                b = static_cast<BYTE>(b * (1.0f + brightness));
-            }
-
-            pixels[y * pitch + x] = D3DCOLOR_ARGB(a, r, g, b);
-        }
-    }
-
-    texture->Unlock();
+    PointOps::Run(image, PointOps::Brightness(brightness));
 }
 
-void PostEffects::AdjustContrast(std::shared_ptr<Texture> texture, float contrast)
+void PostEffects::AdjustContrast(const ImageView& image, float contrast)
 {
-    if (!texture) return;
-
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect)) return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
-
-    float factor = (259.0f * (contrast + 255.0f)) / (255.0f * (259.0f - contrast));
+    PointOps::Run(image, PointOps::Contrast(contrast));
+}
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            D3DCOLOR color = pixels[y * pitch + x];
+void PostEffects::AdjustSaturation(const ImageView& image, float saturation)
+{
+    PointOps::Run(image, PointOps::Saturation(saturation));
+}
 
-            BYTE r = (color >> 16) & 0xFF;
-            BYTE g = (color >> 8) & 0xFF;
-            BYTE b = color & 0xFF;
-            BYTE a = (color >> 24) & 0xFF;
+void PostEffects::AdjustHue(const ImageView& image, float hueShift)
+{
+    PointOps::Run(image, PointOps::Hue(hueShift));
+}
 
-            r = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(factor * (r - 128) + 128))));
-            g = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(factor * (g - 128) + 128))));
-            b = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(factor * (b - 128) + 128))));
+void PostEffects::AdjustGamma(const ImageView& image, float gamma)
+{
+    if (gamma <= 0.0f) return;
 
-            pixels[y * pitch + x] = D3DCOLOR_ARGB(a, r, g, b);
-        }
-    }
+    PointOps::Run(image, PointOps::Gamma(gamma));
+}
 
-    texture->Unlock();
+void PostEffects::ColorBalance(const ImageView& image, float redBalance, float greenBalance, float blueBalance)
+{
+    PointOps::Run(image, PointOps::ColorBalance(redBalance, greenBalance, blueBalance));
 }
 
-void PostEffects::AdjustSaturation(std::shared_ptr<Texture> texture, float saturation)
+void PostEffects::Posterize(const ImageView& image, int levels)
 {
-    if (!texture) return;
+    if (levels < 2) return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect)) return;
+    PointOps::Run(image, PointOps::Posterize(levels));
+}
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+void PostEffects::Threshold(const ImageView& image, float threshold, bool binary)
+{
+    PointOps::Run(image, PointOps::Threshold(threshold, binary));
+}
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            D3DCOLOR color = pixels[y * pitch + x];
+void PostEffects::Invert(const ImageView& image)
+{
+    PointOps::Run(image, PointOps::Invert());
+}
 
-            D3DXVECTOR3 hsv = RGBToHSV(color);
-            hsv.y *= saturation; // Adjust saturation
-            hsv.y = std::max(0.0f, std::min(1.0f, hsv.y));
+void PostEffects::Sepia(const ImageView& image, float intensity)
+{
+    PointOps::Run(image, PointOps::Sepia(intensity));
+}
 
-            pixels[y * pitch + x] = HSVToRGB(hsv);
-        }
-    }
+void PostEffects::AddVignette(const ImageView& image, float strength, float radius)
+{
+    if (strength <= 0.0f) return;
 
-    texture->Unlock();
+    PointOps::Run(image, PointOps::Vignette(strength, radius));
 }
 
-void PostEffects::ApplyBlur(std::shared_ptr<Texture> texture, float radius)
+void PostEffects::ApplyBlur(const ImageView& image, float radius)
 {
-    if (!texture || radius <= 0.0f) return;
+    if (!image.IsValid() || radius <= 0.0f) return;
 
     int kernelSize = static_cast<int>(radius * 2) + 1;
     if (kernelSize % 2 == 0) kernelSize++;
 
-    std::vector<float> kernel(kernelSize * kernelSize);
-    float sum = 0.0f;
-
-    // Generate Gaussian kernel
-    int center = kernelSize / 2;
-    for (int y = 0; y < kernelSize; y++)
-    {
-        for (int x = 0; x < kernelSize; x++)
-        {
-            float distance = sqrtf(static_cast<float>((x - center) * (x - center) + (y - center) * (y - center)));
-            float value = expf(-(distance * distance) / (2.0f * radius * radius));
-            kernel[y * kernelSize + x] = value;
-            sum += value;
-        }
-    }
-
-    // Normalize kernel
-    for (float& value : kernel)
-    {
-        value /= sum;
-    }
+    // Gaussian with sigma = radius cut off at the kernel edge. The 2D kernel
+    // is the product of two of these, so it runs as two 1D passes; wide ones
+    // become box passes of the same variance.
+    Blur::Smooth(image, Blur::GaussianKernel(radius, kernelSize / 2));
+}
 
-    ApplyKernel(texture, kernel.data(), kernelSize);
+void PostEffects::ApplyGaussianBlur(const ImageView& image, float sigma)
+{
+    Blur::Gaussian(image, sigma);
 }
 
-void PostEffects::ApplySharpen(std::shared_ptr<Texture> texture, float amount)
+void PostEffects::ApplySharpen(const ImageView& image, float amount)
 {
-    if (!texture) return;
+    if (!image.IsValid()) return;
 
     float kernel[9] = {
         0.0f, -amount, 0.0f,
@@ -158,12 +99,49 @@ void PostEffects::ApplySharpen(std::shared_ptr<Texture> texture, float amount)
         0.0f, -amount, 0.0f
     };
 
-    ApplyKernel(texture, kernel, 3);
+    ApplyKernel(image, kernel, 3);
+}
+
+void PostEffects::ApplyUnsharpMask(const ImageView& image, float amount, float radius)
+{
+    if (!image.IsValid() || radius <= 0.0f) return;
+
+    int width = image.width;
+    int height = image.height;
+
+    PixelBuffer blurred(width, height);
+    image.CopyTo(blurred.GetView());
+    Blur::Gaussian(blurred.GetView(), radius);
+
+    // Push every pixel away from its blurred neighborhood
+    for (int y = 0; y < height; y++)
+    {
+        D3DCOLOR* row = image.Row(y);
+        const D3DCOLOR* blurRow = blurred.GetView().Row(y);
+
+        for (int x = 0; x < width; x++)
+        {
+            D3DCOLOR color = row[x];
+            D3DCOLOR blur = blurRow[x];
+
+            int channels[3];
+            for (int c = 0; c < 3; c++)
+            {
+                int shift = 16 - c * 8;
+                float original = static_cast<float>((color >> shift) & 0xFF);
+                float smooth = static_cast<float>((blur >> shift) & 0xFF);
+                channels[c] = std::max(0, std::min(255, static_cast<int>(original + amount * (original - smooth) + 0.5f)));
+            }
+
+            BYTE a = (color >> 24) & 0xFF;
+            row[x] = D3DCOLOR_ARGB(a, channels[0], channels[1], channels[2]);
+        }
+    }
 }
 
-void PostEffects::ApplyEmboss(std::shared_ptr<Texture> texture, float strength, float angle)
+void PostEffects::ApplyEmboss(const ImageView& image, float strength, float angle)
 {
-    if (!texture) return;
+    if (!image.IsValid()) return;
 
     float rad = angle * 3.14159f / 180.0f;
     float cosA = cosf(rad) * strength;
@@ -175,41 +153,58 @@ void PostEffects::ApplyEmboss(std::shared_ptr<Texture> texture, float strength,
         sinA - cosA, sinA, cosA + sinA
     };
 
-    ApplyKernel(texture, kernel, 3);
+    ApplyKernel(image, kernel, 3);
 }
 
-void PostEffects::ApplyEdgeDetection(std::shared_ptr<Texture> texture, float threshold)
+void PostEffects::ApplyEdgeDetection(const ImageView& image, float threshold)
 {
-    if (!texture) return;
+    if (!image.IsValid()) return;
 
-    // Sobel edge detection
-    float sobelX[9] = {
-        -1, 0, 1,
-        -2, 0, 2,
-        -1, 0, 1
-    };
+    int width = image.width;
+    int height = image.height;
+    std::vector<float> luminance(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; y++)
+    {
+        const D3DCOLOR* row = image.Row(y);
+        for (int x = 0; x < width; x++)
+        {
+            luminance[static_cast<size_t>(y) * width + x] = Utils::GetLuminance(row[x]);
+        }
+    }
 
-    float sobelY[9] = {
-        -1, -2, -1,
-         0,  0,  0,
-         1,  2,  1
+    auto at = [&](int x, int y) {
+        x = std::clamp(x, 0, width - 1);
+        y = std::clamp(y, 0, height - 1);
+        return luminance[static_cast<size_t>(y) * width + x];
     };
 
-    // Apply both kernels and combine
-    ApplySobel(texture);
+    // Sobel gradient magnitude, scaled so a step from black to white is 1;
+    // edges at or above the threshold go white, the rest black
+    for (int y = 0; y < height; y++)
+    {
+        D3DCOLOR* row = image.Row(y);
+        for (int x = 0; x < width; x++)
+        {
+            float gx = (at(x + 1, y - 1) + 2.0f * at(x + 1, y) + at(x + 1, y + 1)) -
+                       (at(x - 1, y - 1) + 2.0f * at(x - 1, y) + at(x - 1, y + 1));
+            float gy = (at(x - 1, y + 1) + 2.0f * at(x, y + 1) + at(x + 1, y + 1)) -
+                       (at(x - 1, y - 1) + 2.0f * at(x, y - 1) + at(x + 1, y - 1));
+            float magnitude = std::sqrt(gx * gx + gy * gy) * 0.25f;
+
+            D3DCOLOR alpha = row[x] & 0xFF000000;
+            row[x] = alpha | (magnitude >= threshold ? 0x00FFFFFF : 0);
+        }
+    }
 }
 
-void PostEffects::AddNoise(std::shared_ptr<Texture> texture, float amount, bool monochrome)
+void PostEffects::AddNoise(const ImageView& image, float amount, bool monochrome)
 {
-    if (!texture || amount <= 0.0f) return;
-
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect)) return;
+    if (!image.IsValid() || amount <= 0.0f) return;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -247,21 +242,16 @@ void PostEffects::AddNoise(std::shared_ptr<Texture> texture, float amount, bool
             pixels[y * pitch + x] = D3DCOLOR_ARGB(a, r, g, b);
         }
     }
-
-    texture->Unlock();
 }
 
-void PostEffects::Pixelate(std::shared_ptr<Texture> texture, int pixelSize)
+void PostEffects::Pixelate(const ImageView& image, int pixelSize)
 {
-    if (!texture || pixelSize <= 1) return;
+    if (!image.IsValid() || pixelSize <= 1) return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect)) return;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
     // Create a copy for sampling
     std::vector<DWORD> originalPixels(width * height);
@@ -292,74 +282,62 @@ void PostEffects::Pixelate(std::shared_ptr<Texture> texture, int pixelSize)
             }
         }
     }
-
-    texture->Unlock();
 }
 
-// Helper functions
-void PostEffects::ApplyKernel(std::shared_ptr<Texture> texture, const float* kernel, int kernelSize, float divisor)
+void PostEffects::AddGlow(const ImageView& image, float intensity, float radius, D3DCOLOR glowColor)
 {
-    if (!texture) return;
-
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect)) return;
+    if (!image.IsValid() || intensity <= 0.0f || radius <= 0.0f) return;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    int width = image.width;
+    int height = image.height;
 
-    // Create a copy for sampling
-    std::vector<DWORD> originalPixels(width * height);
+    // Bright areas spread their luminance over about radius pixels (2 sigma)
+    PixelBuffer glow(width, height);
     for (int y = 0; y < height; y++)
     {
+        const D3DCOLOR* row = image.Row(y);
+        D3DCOLOR* glowRow = glow.GetView().Row(y);
+
         for (int x = 0; x < width; x++)
         {
-            originalPixels[y * width + x] = pixels[y * pitch + x];
+            BYTE luminance = static_cast<BYTE>(Utils::GetLuminance(row[x]) * 255.0f);
+            glowRow[x] = D3DCOLOR_ARGB(255, luminance, luminance, luminance);
         }
     }
 
-    int halfKernel = kernelSize / 2;
+    Blur::Gaussian(glow.GetView(), radius * 0.5f);
+
+    float glowR = ((glowColor >> 16) & 0xFF) * intensity / 255.0f;
+    float glowG = ((glowColor >> 8) & 0xFF) * intensity / 255.0f;
+    float glowB = (glowColor & 0xFF) * intensity / 255.0f;
 
     for (int y = 0; y < height; y++)
     {
+        D3DCOLOR* row = image.Row(y);
+        const D3DCOLOR* glowRow = glow.GetView().Row(y);
+
         for (int x = 0; x < width; x++)
         {
-            float r = 0.0f, g = 0.0f, b = 0.0f;
-
-            for (int ky = 0; ky < kernelSize; ky++)
-            {
-                for (int kx = 0; kx < kernelSize; kx++)
-                {
-                    int px = std::max(0, std::min(width - 1, x + kx - halfKernel));
-                    int py = std::max(0, std::min(height - 1, y + ky - halfKernel));
-
-                    D3DCOLOR color = originalPixels[py * width + px];
-                    float weight = kernel[ky * kernelSize + kx];
-
-                    r += ((color >> 16) & 0xFF) * weight;
-                    g += ((color >> 8) & 0xFF) * weight;
-                    b += (color & 0xFF) * weight;
-                }
-            }
+            D3DCOLOR color = row[x];
+            float amount = static_cast<float>(glowRow[x] & 0xFF);
 
-            r /= divisor;
-            g /= divisor;
-            b /= divisor;
-
-            BYTE nr = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(r))));
-            BYTE ng = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(g))));
-            BYTE nb = static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(b))));
-            BYTE a = (originalPixels[y * width + x] >> 24) & 0xFF;
+            int r = std::min(255, static_cast<int>(((color >> 16) & 0xFF) + glowR * amount));
+            int g = std::min(255, static_cast<int>(((color >> 8) & 0xFF) + glowG * amount));
+            int b = std::min(255, static_cast<int>((color & 0xFF) + glowB * amount));
+            BYTE a = (color >> 24) & 0xFF;
 
-            pixels[y * pitch + x] = D3DCOLOR_ARGB(a, nr, ng, nb);
+            row[x] = D3DCOLOR_ARGB(a, r, g, b);
         }
     }
+}
 
-    texture->Unlock();
+// Helper functions
+void PostEffects::ApplyKernel(const ImageView& image, const float* kernel, int kernelSize, float divisor)
+{
+    Convolution::Apply(image, kernel, kernelSize, divisor);
 }
 
-void PostEffects::ApplySobel(std::shared_ptr<Texture> texture)
+void PostEffects::ApplySobel(const ImageView& image)
 {
     // Simplified Sobel implementation - in practice would need more sophisticated edge detection
     float sobelKernel[9] = {
@@ -368,98 +346,19 @@ void PostEffects::ApplySobel(std::shared_ptr<Texture> texture)
         -1, -1, -1
     };
 
-    ApplyKernel(texture, sobelKernel, 3);
-}
-
-// Color space conversion functions
-D3DXVECTOR3 PostEffects::RGBToHSV(D3DCOLOR color)
-{
-    float r = ((color >> 16) & 0xFF) / 255.0f;
-    float g = ((color >> 8) & 0xFF) / 255.0f;
-    float b = (color & 0xFF) / 255.0f;
-
-    float max_val = std::max({r, g, b});
-    float min_val = std::min({r, g, b});
-    float delta = max_val - min_val;
-
-    D3DXVECTOR3 hsv;
-    hsv.z = max_val; // Value
-
-    if (max_val == 0.0f)
-    {
-        hsv.y = 0.0f; // Saturation
-    }
-    else
-    {
-        hsv.y = delta / max_val; // Saturation
-    }
-
-    if (delta == 0.0f)
-    {
-        hsv.x = 0.0f; // Hue
-    }
-    else
-    {
-        if (max_val == r)
-            hsv.x = 60.0f * fmodf((g - b) / delta, 6.0f);
-        else if (max_val == g)
-            hsv.x = 60.0f * ((b - r) / delta + 2.0f);
-        else
-            hsv.x = 60.0f * ((r - g) / delta + 4.0f);
-
-        if (hsv.x < 0.0f) hsv.x += 360.0f;
-    }
-
-    return hsv;
+    ApplyKernel(image, sobelKernel, 3);
 }
 
-D3DCOLOR PostEffects::HSVToRGB(const D3DXVECTOR3& hsv)
+void PostEffects::ApplyLaplacian(const ImageView& image)
 {
-    float c = hsv.z * hsv.y;
-    float x = c * (1.0f - fabsf(fmodf(hsv.x / 60.0f, 2.0f) - 1.0f));
-    float m = hsv.z - c;
-
-    float r, g, b;
-
-    if (hsv.x >= 0.0f && hsv.x < 60.0f)
-    {
-        r = c; g = x; b = 0.0f;
-    }
-    else if (hsv.x >= 60.0f && hsv.x < 120.0f)
-    {
-        r = x; g = c; b = 0.0f;
-    }
-    else if (hsv.x >= 120.0f && hsv.x < 180.0f)
-    {
-        r = 0.0f; g = c; b = x;
-    }
-    else if (hsv.x >= 180.0f && hsv.x < 240.0f)
-    {
-        r = 0.0f; g = x; b = c;
-    }
-    else if (hsv.x >= 240.0f && hsv.x < 300.0f)
-    {
-        r = x; g = 0.0f; b = c;
-    }
-    else
-    {
-        r = c; g = 0.0f; b = x;
-    }
-
-    BYTE nr = static_cast<BYTE>((r + m) * 255.0f);
-    BYTE ng = static_cast<BYTE>((g + m) * 255.0f);
-    BYTE nb = static_cast<BYTE>((b + m) * 255.0f);
-
-    return D3DCOLOR_ARGB(255, nr, ng, nb);
-}
-
-float PostEffects::GetLuminance(D3DCOLOR color)
-{
-    float r = ((color >> 16) & 0xFF) / 255.0f;
-    float g = ((color >> 8) & 0xFF) / 255.0f;
-    float b = (color & 0xFF) / 255.0f;
+    // 4-neighbour Laplacian: flat areas go to black, edges and detail stay bright
+    float laplacianKernel[9] = {
+         0, -1,  0,
+        -1,  4, -1,
+         0, -1,  0
+    };
 
-    return 0.299f * r + 0.587f * g + 0.114f * b;
+    ApplyKernel(image, laplacianKernel, 3);
 }
 
 } // namespace TextureEffects
@@ -1,327 +1,457 @@
 #include "ProceduralTextures.h"
 #include "NoiseGenerator.h"
-#include "../Texture.h"
+#include "EffectThreads.h"
+#include "../../Core/ThreadPool.h"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 namespace TextureEffects {
 
-std::shared_ptr<Texture> ProceduralTextures::CreateCheckerboard(IDirect3DDevice9* device, int width, int height,
-                                                               int checkerSize, D3DCOLOR color1, D3DCOLOR color2)
-{
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
+BakeCache* ProceduralTextures::s_bakeCache = nullptr;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
+void ProceduralTextures::SetBakeCache(BakeCache* cache)
+{
+    s_bakeCache = cache;
+}
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+BakeCache* ProceduralTextures::GetBakeCache()
+{
+    return s_bakeCache;
+}
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            bool checker = ((x / checkerSize) + (y / checkerSize)) % 2 == 0;
-            pixels[y * pitch + x] = checker ? color1 : color2;
-        }
-    }
+void ProceduralTextures::ForEachTile(int width, int height, const std::function<void(const TileRect&)>& fillTile)
+{
+    if (width <= 0 || height <= 0)
+        return;
 
-    texture->Unlock();
-    return texture;
+    int tilesX = (width + kTileSize - 1) / kTileSize;
+    int tilesY = (height + kTileSize - 1) / kTileSize;
+
+    // Every tile writes a disjoint rectangle, so the order tiles complete in
+    // does not affect the result
+    GetEffectThreadPool().ParallelFor(tilesX * tilesY, [&](int index) {
+        TileRect tile;
+        tile.x0 = (index % tilesX) * kTileSize;
+        tile.y0 = (index / tilesX) * kTileSize;
+        tile.x1 = std::min(tile.x0 + kTileSize, width);
+        tile.y1 = std::min(tile.y0 + kTileSize, height);
+        fillTile(tile);
+    });
 }
 
-std::shared_ptr<Texture> ProceduralTextures::CreateStripes(IDirect3DDevice9* device, int width, int height,
-                                                          int stripeWidth, D3DCOLOR color1, D3DCOLOR color2, bool vertical)
+void ProceduralTextures::EvaluateTileNoise(const NoiseParams& params, const TileRect& tile, int width, int height,
+                                           float* out, float scaleY)
 {
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
+    float dx = 1.0f / width;
+    float dy = scaleY / height;
+    float x = static_cast<float>(tile.x0) / width;
+    float y = static_cast<float>(tile.y0) / height * scaleY;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
+    NoiseGenerator::EvaluateGrid(params, x, y, dx, dy, tile.Width(), tile.Height(), out, tile.Width());
+}
+
+void ProceduralTextures::GenerateCheckerboard(const ImageView& image, int checkerSize, D3DCOLOR color1, D3DCOLOR color2)
+{
+    if (!image.IsValid())
+        return;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        for (int y = tile.y0; y < tile.y1; y++)
         {
-            int coord = vertical ? x : y;
-            bool stripe = (coord / stripeWidth) % 2 == 0;
-            pixels[y * pitch + x] = stripe ? color1 : color2;
+            for (int x = tile.x0; x < tile.x1; x++)
+            {
+                bool checker = ((x / checkerSize) + (y / checkerSize)) % 2 == 0;
+                pixels[y * pitch + x] = checker ? color1 : color2;
+            }
         }
-    }
-
-    texture->Unlock();
-    return texture;
+    });
 }
 
-std::shared_ptr<Texture> ProceduralTextures::CreateGradient(IDirect3DDevice9* device, int width, int height,
-                                                           D3DCOLOR startColor, D3DCOLOR endColor, bool radial)
+void ProceduralTextures::GenerateStripes(const ImageView& image, int stripeWidth, D3DCOLOR color1, D3DCOLOR color2,
+                                         bool vertical)
 {
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
+    if (!image.IsValid())
+        return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        for (int y = tile.y0; y < tile.y1; y++)
+        {
+            for (int x = tile.x0; x < tile.x1; x++)
+            {
+                int coord = vertical ? x : y;
+                bool stripe = (coord / stripeWidth) % 2 == 0;
+                pixels[y * pitch + x] = stripe ? color1 : color2;
+            }
+        }
+    });
+}
+
+void ProceduralTextures::GenerateGradient(const ImageView& image, D3DCOLOR startColor, D3DCOLOR endColor, bool radial)
+{
+    if (!image.IsValid())
+        return;
+
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
     float centerX = width * 0.5f;
     float centerY = height * 0.5f;
     float maxRadius = sqrtf(centerX * centerX + centerY * centerY);
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        for (int y = tile.y0; y < tile.y1; y++)
         {
-            float t;
-            if (radial)
+            for (int x = tile.x0; x < tile.x1; x++)
             {
-                float dx = x - centerX;
-                float dy = y - centerY;
-                float distance = sqrtf(dx * dx + dy * dy);
-                t = std::min(1.0f, distance / maxRadius);
+                float t;
+                if (radial)
+                {
+                    float dx = x - centerX;
+                    float dy = y - centerY;
+                    float distance = sqrtf(dx * dx + dy * dy);
+                    t = std::min(1.0f, distance / maxRadius);
+                }
+                else
+                {
+                    t = static_cast<float>(x) / static_cast<float>(width - 1);
+                }
+
+                pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(t, startColor, endColor);
             }
-            else
+        }
+    });
+}
+
+void ProceduralTextures::GeneratePerlinNoise(const ImageView& image, float frequency, int octaves)
+{
+    if (!image.IsValid())
+        return;
+
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
+
+    NoiseParams noiseParams;
+    noiseParams.frequency = frequency;
+    noiseParams.octaves = octaves;
+    noiseParams.persistence = 0.5f;
+
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        std::vector<float> noise(static_cast<size_t>(tile.Width()) * tile.Height());
+        EvaluateTileNoise(noiseParams, tile, width, height, noise.data());
+
+        const float* src = noise.data();
+        for (int y = tile.y0; y < tile.y1; y++)
+        {
+            for (int x = tile.x0; x < tile.x1; x++)
             {
-                t = static_cast<float>(x) / static_cast<float>(width - 1);
+                pixels[y * pitch + x] = NoiseGenerator::NoiseToGrayscale(*src++);
             }
-
-            pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(t, startColor, endColor);
         }
-    }
-
-    texture->Unlock();
-    return texture;
+    });
 }
 
-std::shared_ptr<Texture> ProceduralTextures::CreatePerlinNoise(IDirect3DDevice9* device, int width, int height,
-                                                              float frequency, int octaves)
+void ProceduralTextures::GenerateTurbulence(const ImageView& image, float frequency, int octaves)
 {
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
+    if (!image.IsValid())
+        return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    NoiseParams noiseParams;
+    noiseParams.fractal = NoiseFractal::Turbulence;
+    noiseParams.frequency = frequency;
+    noiseParams.octaves = octaves;
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            float fx = static_cast<float>(x) / width;
-            float fy = static_cast<float>(y) / height;
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        std::vector<float> noise(static_cast<size_t>(tile.Width()) * tile.Height());
+        EvaluateTileNoise(noiseParams, tile, width, height, noise.data());
 
-            float noise = NoiseGenerator::Perlin2D(fx, fy, frequency, octaves, 0.5f);
-            pixels[y * pitch + x] = NoiseGenerator::NoiseToGrayscale(noise);
+        const float* src = noise.data();
+        for (int y = tile.y0; y < tile.y1; y++)
+        {
+            for (int x = tile.x0; x < tile.x1; x++)
+            {
+                pixels[y * pitch + x] = NoiseGenerator::NoiseToGrayscale(*src++);
+            }
         }
-    }
+    });
+}
 
-    texture->Unlock();
-    return texture;
+void ProceduralTextures::GenerateClouds(const ImageView& image, float frequency, int octaves)
+{
+    if (!image.IsValid())
+        return;
+
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
+
+    D3DCOLOR skyColor = D3DCOLOR_XRGB(135, 206, 250);   // Light blue
+    D3DCOLOR cloudColor = D3DCOLOR_XRGB(255, 255, 255); // White
+
+    NoiseParams noiseParams;
+    noiseParams.frequency = frequency;
+    noiseParams.octaves = octaves;
+    noiseParams.persistence = 0.6f;
+
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        std::vector<float> noise(static_cast<size_t>(tile.Width()) * tile.Height());
+        EvaluateTileNoise(noiseParams, tile, width, height, noise.data());
+
+        const float* src = noise.data();
+        for (int y = tile.y0; y < tile.y1; y++)
+        {
+            for (int x = tile.x0; x < tile.x1; x++)
+            {
+                float cloud = NoiseGenerator::ThresholdNoise(*src++, 0.4f, 0.2f);
+                pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(cloud, skyColor, cloudColor);
+            }
+        }
+    });
 }
 
-std::shared_ptr<Texture> ProceduralTextures::CreateTurbulence(IDirect3DDevice9* device, int width, int height,
-                                                             float frequency, int octaves)
+void ProceduralTextures::GenerateVoronoi(const ImageView& image, float frequency, D3DCOLOR color1, D3DCOLOR color2)
 {
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
+    if (!image.IsValid())
+        return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        std::vector<CellularResult> cells(tile.Width());
+        float cellX = static_cast<float>(tile.x0) / width * frequency;
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+        for (int y = tile.y0; y < tile.y1; y++)
         {
-            float fx = static_cast<float>(x) / width;
             float fy = static_cast<float>(y) / height;
+            NoiseGenerator::CellularRow(cellX, fy * frequency, frequency / width, tile.Width(),
+                                        CellularMetric::Euclidean, cells.data());
 
-            float noise = NoiseGenerator::Turbulence2D(fx, fy, frequency, octaves);
-            pixels[y * pitch + x] = NoiseGenerator::NoiseToGrayscale(noise);
+            for (int x = tile.x0; x < tile.x1; x++)
+            {
+                float distance = std::min(1.0f, cells[x - tile.x0].f1);
+                pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(distance, color1, color2);
+            }
         }
-    }
-
-    texture->Unlock();
-    return texture;
+    });
 }
 
-std::shared_ptr<Texture> ProceduralTextures::CreateClouds(IDirect3DDevice9* device, int width, int height,
-                                                         float frequency, int octaves)
+void ProceduralTextures::GenerateWoodGrain(const ImageView& image, D3DCOLOR lightWood, D3DCOLOR darkWood)
 {
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
+    if (!image.IsValid())
+        return;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    NoiseParams noiseParams;
+    noiseParams.frequency = 8.0f;
+    noiseParams.octaves = 3;
+    noiseParams.persistence = 0.3f;
 
-    D3DCOLOR skyColor = D3DCOLOR_XRGB(135, 206, 250);   // Light blue
-    D3DCOLOR cloudColor = D3DCOLOR_XRGB(255, 255, 255); // White
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        std::vector<float> noise(static_cast<size_t>(tile.Width()) * tile.Height());
+        EvaluateTileNoise(noiseParams, tile, width, height, noise.data());
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+        const float* src = noise.data();
+        for (int y = tile.y0; y < tile.y1; y++)
         {
-            float fx = static_cast<float>(x) / width;
-            float fy = static_cast<float>(y) / height;
+            for (int x = tile.x0; x < tile.x1; x++)
+            {
+                float fx = static_cast<float>(x) / width;
+                float fy = static_cast<float>(y) / height;
 
-            float noise = NoiseGenerator::FractalNoise2D(fx, fy, frequency, octaves, 0.6f, 2.0f);
-            noise = NoiseGenerator::ThresholdNoise(noise, 0.4f, 0.2f);
+                // Create wood ring pattern
+                float distance = sqrtf(fx * fx + fy * fy * 4.0f); // Elongate in Y
+                float rings = sinf(distance * 20.0f) * 0.5f + 0.5f;
 
-            pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(noise, skyColor, cloudColor);
-        }
-    }
+                // Add noise for natural variation
+                rings += *src++ * 0.3f;
 
-    texture->Unlock();
-    return texture;
+                rings = std::max(0.0f, std::min(1.0f, rings));
+                pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(rings, darkWood, lightWood);
+            }
+        }
+    });
 }
 
-std::shared_ptr<Texture> ProceduralTextures::CreateWoodGrain(IDirect3DDevice9* device, int width, int height,
-                                                            D3DCOLOR lightWood, D3DCOLOR darkWood)
+void ProceduralTextures::GenerateMarble(const ImageView& image, D3DCOLOR baseColor, D3DCOLOR veinColor)
 {
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
+    if (!image.IsValid())
+        return;
+
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
+    NoiseParams baseParams;
+    baseParams.frequency = 2.0f;
+    baseParams.octaves = 2;
+    baseParams.persistence = 0.3f;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        std::vector<float> baseNoise(static_cast<size_t>(tile.Width()) * tile.Height());
+        EvaluateTileNoise(baseParams, tile, width, height, baseNoise.data());
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+        const float* src = baseNoise.data();
+        for (int y = tile.y0; y < tile.y1; y++)
         {
-            float fx = static_cast<float>(x) / width;
-            float fy = static_cast<float>(y) / height;
+            for (int x = tile.x0; x < tile.x1; x++)
+            {
+                float fx = static_cast<float>(x) / width;
+                float fy = static_cast<float>(y) / height;
 
-            // Create wood ring pattern
-            float distance = sqrtf(fx * fx + fy * fy * 4.0f); // Elongate in Y
-            float rings = sinf(distance * 20.0f) * 0.5f + 0.5f;
+                // Create marble veins using warped noise
+                float veins = NoiseGenerator::WarpedNoise2D(fx, fy, 0.1f, 4.0f);
+                veins = NoiseGenerator::ThresholdNoise(veins, 0.6f, 0.1f);
 
-            // Add noise for natural variation
-            float noise = NoiseGenerator::Perlin2D(fx, fy, 8.0f, 3, 0.3f);
-            rings += noise * 0.3f;
+                // Add subtle base noise
+                veins += *src++ * 0.2f;
 
-            rings = std::max(0.0f, std::min(1.0f, rings));
-            pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(rings, darkWood, lightWood);
+                veins = std::max(0.0f, std::min(1.0f, veins));
+                pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(veins, baseColor, veinColor);
+            }
         }
-    }
-
-    texture->Unlock();
-    return texture;
+    });
 }
 
-std::shared_ptr<Texture> ProceduralTextures::CreateMarble(IDirect3DDevice9* device, int width, int height,
-                                                         D3DCOLOR baseColor, D3DCOLOR veinColor)
+void ProceduralTextures::GenerateMetal(const ImageView& image, D3DCOLOR metalColor, float roughness)
 {
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
-
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    if (!image.IsValid())
+        return;
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
+
+    // High frequency noise for metal surface
+    NoiseParams surfaceParams;
+    surfaceParams.frequency = 32.0f;
+    surfaceParams.octaves = 4;
+    surfaceParams.persistence = 0.3f;
+
+    // Scratches: a single octave stretched along Y
+    NoiseParams scratchParams;
+    scratchParams.frequency = 1.0f;
+    scratchParams.octaves = 1;
+
+    BYTE baseR = (metalColor >> 16) & 0xFF;
+    BYTE baseG = (metalColor >> 8) & 0xFF;
+    BYTE baseB = metalColor & 0xFF;
+
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        size_t tileSize = static_cast<size_t>(tile.Width()) * tile.Height();
+        std::vector<float> surface(tileSize);
+        std::vector<float> scratches(tileSize);
+        EvaluateTileNoise(surfaceParams, tile, width, height, surface.data());
+        EvaluateTileNoise(scratchParams, tile, width, height, scratches.data(), 10.0f);
+
+        size_t i = 0;
+        for (int y = tile.y0; y < tile.y1; y++)
         {
-            float fx = static_cast<float>(x) / width;
-            float fy = static_cast<float>(y) / height;
+            for (int x = tile.x0; x < tile.x1; x++, i++)
+            {
+                float noise = surface[i] * roughness + (1.0f - roughness) * 0.5f;
 
-            // Create marble veins using warped noise
-            float veins = NoiseGenerator::WarpedNoise2D(fx, fy, 0.1f, 4.0f);
-            veins = NoiseGenerator::ThresholdNoise(veins, 0.6f, 0.1f);
+                // Add some scratches
+                noise += scratches[i] * 0.1f;
 
-            // Add subtle base noise
-            float baseNoise = NoiseGenerator::Perlin2D(fx, fy, 2.0f, 2, 0.3f) * 0.2f;
-            veins += baseNoise;
+                noise = std::max(0.0f, std::min(1.0f, noise));
 
-            veins = std::max(0.0f, std::min(1.0f, veins));
-            pixels[y * pitch + x] = NoiseGenerator::NoiseToColor(veins, baseColor, veinColor);
-        }
-    }
+                // Brighten/darken the metal color based on noise
+                float factor = 0.8f + noise * 0.4f; // Range [0.8, 1.2]
+                BYTE r = static_cast<BYTE>(std::min(255, static_cast<int>(baseR * factor)));
+                BYTE g = static_cast<BYTE>(std::min(255, static_cast<int>(baseG * factor)));
+                BYTE b = static_cast<BYTE>(std::min(255, static_cast<int>(baseB * factor)));
 
-    texture->Unlock();
-    return texture;
+                pixels[y * pitch + x] = D3DCOLOR_ARGB(255, r, g, b);
+            }
+        }
+    });
 }
 
-std::shared_ptr<Texture> ProceduralTextures::CreateMetal(IDirect3DDevice9* device, int width, int height,
-                                                        D3DCOLOR metalColor, float roughness)
+void ProceduralTextures::GenerateRock(const ImageView& image, D3DCOLOR rockColor, float roughness)
 {
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(device, width, height, D3DFMT_A8R8G8B8))
-        return nullptr;
+    if (!image.IsValid())
+        return;
+
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
+
+    const float stoneFrequency = 6.0f;
+
+    NoiseParams surfaceParams;
+    surfaceParams.frequency = 12.0f;
+    surfaceParams.octaves = 5;
+    surfaceParams.persistence = 0.5f;
 
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return nullptr;
+    BYTE baseR = (rockColor >> 16) & 0xFF;
+    BYTE baseG = (rockColor >> 8) & 0xFF;
+    BYTE baseB = rockColor & 0xFF;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        std::vector<float> surface(static_cast<size_t>(tile.Width()) * tile.Height());
+        std::vector<CellularResult> cells(tile.Width());
+        EvaluateTileNoise(surfaceParams, tile, width, height, surface.data());
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+        float cellX = static_cast<float>(tile.x0) / width * stoneFrequency;
+        const float* src = surface.data();
+
+        for (int y = tile.y0; y < tile.y1; y++)
         {
-            float fx = static_cast<float>(x) / width;
             float fy = static_cast<float>(y) / height;
+            NoiseGenerator::CellularRow(cellX, fy * stoneFrequency, stoneFrequency / width, tile.Width(),
+                                        CellularMetric::Euclidean, cells.data());
 
-            // High frequency noise for metal surface
-            float noise = NoiseGenerator::Perlin2D(fx, fy, 32.0f, 4, 0.3f);
-            noise = noise * roughness + (1.0f - roughness) * 0.5f;
+            for (int x = tile.x0; x < tile.x1; x++)
+            {
+                const CellularResult& cell = cells[x - tile.x0];
 
-            // Add some scratches
-            float scratches = NoiseGenerator::Perlin2D(fx, fy * 10.0f, 1.0f, 1) * 0.1f;
-            noise += scratches;
+                // Cracks along the cell borders, where F2 - F1 goes to zero
+                float crack = NoiseGenerator::ThresholdNoise(cell.Edge(), 0.08f, 0.06f);
 
-            noise = std::max(0.0f, std::min(1.0f, noise));
+                // Each stone gets its own tone from the cell ID
+                float tone = 0.85f + static_cast<float>(cell.cellId & 0xFF) / 255.0f * 0.3f;
 
-            // Brighten/darken the metal color based on noise
-            BYTE r = (metalColor >> 16) & 0xFF;
-            BYTE g = (metalColor >> 8) & 0xFF;
-            BYTE b = metalColor & 0xFF;
+                float shade = (1.0f - roughness) * 0.5f + roughness * *src++;
+                float factor = tone * (0.6f + shade * 0.6f) * (0.35f + 0.65f * crack);
 
-            float factor = 0.8f + noise * 0.4f; // Range [0.8, 1.2]
-            r = static_cast<BYTE>(std::min(255, static_cast<int>(r * factor)));
-            g = static_cast<BYTE>(std::min(255, static_cast<int>(g * factor)));
-            b = static_cast<BYTE>(std::min(255, static_cast<int>(b * factor)));
+                BYTE r = static_cast<BYTE>(std::min(255, static_cast<int>(baseR * factor)));
+                BYTE g = static_cast<BYTE>(std::min(255, static_cast<int>(baseG * factor)));
+                BYTE b = static_cast<BYTE>(std::min(255, static_cast<int>(baseB * factor)));
 
-            pixels[y * pitch + x] = D3DCOLOR_ARGB(255, r, g, b);
+                pixels[y * pitch + x] = D3DCOLOR_ARGB(255, r, g, b);
+            }
         }
-    }
-
-    texture->Unlock();
-    return texture;
+    });
 }
 
 // Helper functions
@@ -337,26 +467,22 @@ D3DCOLOR ProceduralTextures::BlendColors(D3DCOLOR color1, D3DCOLOR color2, float
     return NoiseGenerator::NoiseToColor(blend, color1, color2);
 }
 
-void ProceduralTextures::FillSolidColor(std::shared_ptr<Texture> texture, D3DCOLOR color)
+void ProceduralTextures::FillSolidColor(const ImageView& image, D3DCOLOR color)
 {
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
+    if (!image.IsValid())
         return;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    D3DCOLOR* pixels = image.pixels;
+    int pitch = image.pitch;
+    int width = image.width;
+    int height = image.height;
 
-    for (int y = 0; y < height; y++)
-    {
-        for (int x = 0; x < width; x++)
+    ForEachTile(width, height, [&](const TileRect& tile) {
+        for (int y = tile.y0; y < tile.y1; y++)
         {
-            pixels[y * pitch + x] = color;
+            std::fill(pixels + y * pitch + tile.x0, pixels + y * pitch + tile.x1, color);
         }
-    }
-
-    texture->Unlock();
+    });
 }
 
 } // namespace TextureEffects
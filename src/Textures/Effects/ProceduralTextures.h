@@ -1,15 +1,66 @@
 #pragma once
 
-#include <d3d9.h>
+#include <functional>
 #include <memory>
+#include "NoiseCore.h"
+#include "PixelBuffer.h"
 
 class Texture;
+struct IDirect3DDevice9;
 
 namespace TextureEffects {
 
+    class BakeCache;
+    class BakeKey;
+
     class ProceduralTextures {
     public:
+        // Cache the Create* functions bake their textures into. nullptr, the
+        // default, generates every time.
+        static void SetBakeCache(BakeCache* cache);
+        static BakeCache* GetBakeCache();
+
+        // Part of every bake key: bump it whenever a Generate* function
+        // changes its output, so older bakes are never loaded
+        static const int kBakeVersion = 1;
+
         // Basic patterns
+        static void GenerateCheckerboard(const ImageView& image, int checkerSize, D3DCOLOR color1, D3DCOLOR color2);
+        static void GenerateStripes(const ImageView& image, int stripeWidth, D3DCOLOR color1, D3DCOLOR color2,
+                                    bool vertical = false);
+        static void GenerateGradient(const ImageView& image, D3DCOLOR startColor, D3DCOLOR endColor, bool radial = false);
+        static void GenerateCircles(const ImageView& image, int circleSize, D3DCOLOR color1, D3DCOLOR color2);
+        static void GeneratePolkaDots(const ImageView& image, int dotRadius, int spacing, D3DCOLOR dotColor, D3DCOLOR bgColor);
+
+        // Noise textures
+        static void GeneratePerlinNoise(const ImageView& image, float frequency = 4.0f, int octaves = 4);
+        static void GenerateTurbulence(const ImageView& image, float frequency = 4.0f, int octaves = 6);
+        static void GenerateClouds(const ImageView& image, float frequency = 2.0f, int octaves = 5);
+        static void GenerateVoronoi(const ImageView& image, float frequency = 8.0f,
+                                    D3DCOLOR color1 = D3DCOLOR_XRGB(255, 255, 255),
+                                    D3DCOLOR color2 = D3DCOLOR_XRGB(0, 0, 0));
+
+        // Material textures
+        static void GenerateWoodGrain(const ImageView& image, D3DCOLOR lightWood, D3DCOLOR darkWood);
+        static void GenerateMarble(const ImageView& image, D3DCOLOR baseColor, D3DCOLOR veinColor);
+        static void GenerateMetal(const ImageView& image, D3DCOLOR metalColor, float roughness = 0.2f);
+        static void GenerateBrick(const ImageView& image, D3DCOLOR brickColor, D3DCOLOR mortarColor,
+                                  int brickWidth = 64, int brickHeight = 32);
+        static void GenerateFabric(const ImageView& image, D3DCOLOR fabricColor, int threadDensity = 32);
+
+        // Organic textures
+        static void GenerateSkin(const ImageView& image, D3DCOLOR baseColor, float roughness = 0.3f);
+        static void GenerateLeather(const ImageView& image, D3DCOLOR leatherColor, float grainSize = 0.5f);
+        static void GenerateRock(const ImageView& image, D3DCOLOR rockColor, float roughness = 0.8f);
+
+        // Special effects
+        static void GenerateElectric(const ImageView& image, D3DCOLOR electricColor, float intensity = 1.0f);
+        static void GenerateCaustics(const ImageView& image, D3DCOLOR waterColor, float time = 0.0f);
+
+        // Texture creation (engine build): an A8R8G8B8 texture with a full
+        // mip chain whose top level is the matching Generate* function. Each
+        // result is baked under its parameters, so with a bake cache set
+        // the next run maps it from disk instead of generating it again.
         static std::shared_ptr<Texture> CreateCheckerboard(IDirect3DDevice9* device, int width, int height,
                                                           int checkerSize, D3DCOLOR color1, D3DCOLOR color2);
         static std::shared_ptr<Texture> CreateStripes(IDirect3DDevice9* device, int width, int height,
@@ -20,8 +71,6 @@ namespace TextureEffects {
                                                      int circleSize, D3DCOLOR color1, D3DCOLOR color2);
         static std::shared_ptr<Texture> CreatePolkaDots(IDirect3DDevice9* device, int width, int height,
                                                        int dotRadius, int spacing, D3DCOLOR dotColor, D3DCOLOR bgColor);
-
-        // Noise textures
         static std::shared_ptr<Texture> CreatePerlinNoise(IDirect3DDevice9* device, int width, int height,
                                                          float frequency = 4.0f, int octaves = 4);
         static std::shared_ptr<Texture> CreateTurbulence(IDirect3DDevice9* device, int width, int height,
@@ -31,8 +80,6 @@ namespace TextureEffects {
         static std::shared_ptr<Texture> CreateVoronoi(IDirect3DDevice9* device, int width, int height,
                                                      float frequency = 8.0f, D3DCOLOR color1 = D3DCOLOR_XRGB(255, 255, 255),
                                                      D3DCOLOR color2 = D3DCOLOR_XRGB(0, 0, 0));
-
-        // Material textures
         static std::shared_ptr<Texture> CreateWoodGrain(IDirect3DDevice9* device, int width, int height,
                                                       D3DCOLOR lightWood, D3DCOLOR darkWood);
         static std::shared_ptr<Texture> CreateMarble(IDirect3DDevice9* device, int width, int height,
@@ -43,26 +90,49 @@ namespace TextureEffects {
                                                    D3DCOLOR brickColor, D3DCOLOR mortarColor, int brickWidth = 64, int brickHeight = 32);
         static std::shared_ptr<Texture> CreateFabric(IDirect3DDevice9* device, int width, int height,
                                                     D3DCOLOR fabricColor, int threadDensity = 32);
-
-        // Organic textures
         static std::shared_ptr<Texture> CreateSkin(IDirect3DDevice9* device, int width, int height,
                                                  D3DCOLOR baseColor, float roughness = 0.3f);
         static std::shared_ptr<Texture> CreateLeather(IDirect3DDevice9* device, int width, int height,
                                                      D3DCOLOR leatherColor, float grainSize = 0.5f);
         static std::shared_ptr<Texture> CreateRock(IDirect3DDevice9* device, int width, int height,
                                                   D3DCOLOR rockColor, float roughness = 0.8f);
-
-        // Special effects
         static std::shared_ptr<Texture> CreateElectric(IDirect3DDevice9* device, int width, int height,
                                                       D3DCOLOR electricColor, float intensity = 1.0f);
         static std::shared_ptr<Texture> CreateCaustics(IDirect3DDevice9* device, int width, int height,
                                                       D3DCOLOR waterColor, float time = 0.0f);
 
+        // Bake behind the Create* functions, for other generators: maps the
+        // chain from the bake cache if key was baked, otherwise generate
+        // fills a key.GetWidth() x key.GetHeight() image, the chain is built
+        // with the default MipOptions and stored. The noise seed is added to
+        // the key here.
+        static std::shared_ptr<Texture> CreateBaked(IDirect3DDevice9* device, const BakeKey& key,
+                                                    const std::function<void(const ImageView&)>& generate);
+
     private:
+        // 64x64 ARGB tiles (16 KB) stay resident in L1/L2 while being filled
+        static const int kTileSize = 64;
+
+        struct TileRect {
+            int x0, y0;
+            int x1, y1; // Exclusive
+            int Width() const { return x1 - x0; }
+            int Height() const { return y1 - y0; }
+        };
+
+        // Runs fillTile for every tile of a width x height image in parallel
+        static void ForEachTile(int width, int height, const std::function<void(const TileRect&)>& fillTile);
+
+        // Noise for the tile's pixels in texture UV space, tile.Width() floats per row
+        static void EvaluateTileNoise(const NoiseParams& params, const TileRect& tile, int width, int height,
+                                      float* out, float scaleY = 1.0f);
+
         // Helper functions
         static float CalculateDistance(float x1, float y1, float x2, float y2);
         static D3DCOLOR BlendColors(D3DCOLOR color1, D3DCOLOR color2, float blend);
-        static void FillSolidColor(std::shared_ptr<Texture> texture, D3DCOLOR color);
+        static void FillSolidColor(const ImageView& image, D3DCOLOR color);
+
+        static BakeCache* s_bakeCache;
     };
 
 }
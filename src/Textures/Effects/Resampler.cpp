@@ -0,0 +1,371 @@
+#include "Resampler.h"
+#include "ColorSpace.h"
+#include "EffectThreads.h"
+#include "../../Core/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESAMPLER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TextureEffects {
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// Kaiser window shape; larger values narrow the main lobe less and damp
+// the side lobes more
+const double kKaiserBeta = 4.0;
+
+double Sinc(double x)
+{
+    if (x == 0.0) return 1.0;
+    x *= kPi;
+    return sin(x) / x;
+}
+
+// Mitchell-Netravali cubic family, support 2
+double Cubic(double x, double b, double c)
+{
+    x = fabs(x);
+    if (x < 1.0)
+        return ((12.0 - 9.0 * b - 6.0 * c) * x * x * x + (-18.0 + 12.0 * b + 6.0 * c) * x * x + (6.0 - 2.0 * b)) / 6.0;
+    if (x < 2.0)
+        return ((-b - 6.0 * c) * x * x * x + (6.0 * b + 30.0 * c) * x * x + (-12.0 * b - 48.0 * c) * x +
+                (8.0 * b + 24.0 * c)) / 6.0;
+    return 0.0;
+}
+
+// Modified Bessel function of the first kind, order 0 (power series)
+double BesselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    double quarter = x * x * 0.25;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= quarter / (static_cast<double>(k) * k);
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+double Evaluate(ResampleFilter filter, double x)
+{
+    switch (filter)
+    {
+    case ResampleFilter::Box:
+        return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+    case ResampleFilter::Bilinear:
+        return std::max(0.0, 1.0 - fabs(x));
+    case ResampleFilter::CatmullRom:
+        return Cubic(x, 0.0, 0.5);
+    case ResampleFilter::Mitchell:
+        return Cubic(x, 1.0 / 3.0, 1.0 / 3.0);
+    case ResampleFilter::Lanczos3:
+        return fabs(x) < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+    case ResampleFilter::Kaiser:
+    {
+        double t = x / 3.0;
+        if (fabs(t) >= 1.0) return 0.0;
+        return Sinc(x) * BesselI0(kKaiserBeta * sqrt(1.0 - t * t)) / BesselI0(kKaiserBeta);
+    }
+    }
+    return 0.0;
+}
+
+// Pixels to RGBA floats in [0, 1], colors multiplied by alpha if weighted
+void DecodeRow(const D3DCOLOR* source, float* rgba, int count, bool srgb, bool weighted)
+{
+    if (srgb)
+    {
+        ColorSpace::DecodeSRGB(source, rgba, count);
+        if (weighted)
+        {
+            for (int x = 0; x < count; x++)
+            {
+                float* pixel = rgba + x * 4;
+                pixel[0] *= pixel[3];
+                pixel[1] *= pixel[3];
+                pixel[2] *= pixel[3];
+            }
+        }
+        return;
+    }
+
+#if defined(RESAMPLER_SSE2)
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+    const __m128 colorLanes = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i zero = _mm_setzero_si128();
+    for (int x = 0; x < count; x++)
+    {
+        // Bytes are blue, green, red, alpha; lanes become red, green, blue, alpha
+        __m128i bytes = _mm_cvtsi32_si128(static_cast<int>(source[x]));
+        __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+        __m128 pixel = _mm_mul_ps(_mm_cvtepi32_ps(lanes), scale);
+        pixel = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 0, 1, 2));
+        if (weighted)
+        {
+            __m128 alpha = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+            pixel = _mm_mul_ps(pixel, _mm_or_ps(_mm_and_ps(colorLanes, alpha), _mm_andnot_ps(colorLanes, one)));
+        }
+        _mm_storeu_ps(rgba + x * 4, pixel);
+    }
+#else
+    const float scale = 1.0f / 255.0f;
+    for (int x = 0; x < count; x++)
+    {
+        D3DCOLOR color = source[x];
+        float* out = rgba + x * 4;
+        float alpha = static_cast<float>(color >> 24) * scale;
+        float factor = weighted ? alpha : 1.0f;
+        out[0] = static_cast<float>((color >> 16) & 0xFF) * scale * factor;
+        out[1] = static_cast<float>((color >> 8) & 0xFF) * scale * factor;
+        out[2] = static_cast<float>(color & 0xFF) * scale * factor;
+        out[3] = alpha;
+    }
+#endif
+}
+
+BYTE ToByte(float value)
+{
+    return static_cast<BYTE>(std::max(0, std::min(255, static_cast<int>(value * 255.0f + 0.5f))));
+}
+
+// Inverse of DecodeRow; rgba is modified
+void EncodeRow(float* rgba, D3DCOLOR* destination, int count, bool srgb, bool weighted)
+{
+    if (weighted)
+    {
+        for (int x = 0; x < count; x++)
+        {
+            float* pixel = rgba + x * 4;
+            float alpha = std::max(0.0f, std::min(1.0f, pixel[3]));
+            float scale = alpha > 0.0f ? 1.0f / alpha : 0.0f;
+            pixel[0] *= scale;
+            pixel[1] *= scale;
+            pixel[2] *= scale;
+            pixel[3] = alpha;
+        }
+    }
+
+    if (srgb)
+    {
+        ColorSpace::EncodeSRGB(rgba, destination, count);
+        return;
+    }
+
+    for (int x = 0; x < count; x++)
+    {
+        const float* pixel = rgba + x * 4;
+        destination[x] = D3DCOLOR_ARGB(ToByte(pixel[3]), ToByte(pixel[0]), ToByte(pixel[1]), ToByte(pixel[2]));
+    }
+}
+
+// One source row of RGBA floats to width output pixels
+void HorizontalRow(const float* source, const ResampleWeights& table, float* destination, int width)
+{
+    for (int x = 0; x < width; x++)
+    {
+        const float* weights = table.weights.data() + static_cast<size_t>(x) * table.maxTaps;
+        const float* pixel = source + table.start[x] * 4;
+        int count = table.count[x];
+
+#if defined(RESAMPLER_SSE2)
+        __m128 sum = _mm_setzero_ps();
+        for (int k = 0; k < count; k++)
+        {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(pixel + k * 4)));
+        }
+        _mm_storeu_ps(destination + x * 4, sum);
+#else
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int k = 0; k < count; k++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                sum[c] += weights[k] * pixel[k * 4 + c];
+            }
+        }
+        std::copy(sum, sum + 4, destination + x * 4);
+#endif
+    }
+}
+
+// Weighted sum of count rows of floats (length a multiple of 4)
+void VerticalRow(const float* const* rows, const float* weights, int count, float* destination, int length)
+{
+    std::fill(destination, destination + length, 0.0f);
+    for (int k = 0; k < count; k++)
+    {
+        const float* row = rows[k];
+        float weight = weights[k];
+
+#if defined(RESAMPLER_SSE2)
+        __m128 w = _mm_set1_ps(weight);
+        for (int i = 0; i < length; i += 4)
+        {
+            __m128 sum = _mm_loadu_ps(destination + i);
+            _mm_storeu_ps(destination + i, _mm_add_ps(sum, _mm_mul_ps(w, _mm_loadu_ps(row + i))));
+        }
+#else
+        for (int i = 0; i < length; i++)
+        {
+            destination[i] += weight * row[i];
+        }
+#endif
+    }
+}
+
+} // namespace
+
+float Resampler::EvaluateFilter(ResampleFilter filter, float x)
+{
+    return static_cast<float>(Evaluate(filter, x));
+}
+
+float Resampler::GetFilterRadius(ResampleFilter filter)
+{
+    switch (filter)
+    {
+    case ResampleFilter::Box:        return 0.5f;
+    case ResampleFilter::Bilinear:   return 1.0f;
+    case ResampleFilter::CatmullRom:
+    case ResampleFilter::Mitchell:   return 2.0f;
+    case ResampleFilter::Lanczos3:
+    case ResampleFilter::Kaiser:     return 3.0f;
+    }
+    return 1.0f;
+}
+
+ResampleWeights Resampler::ComputeWeights(int sourceSize, int destinationSize, ResampleFilter filter)
+{
+    ResampleWeights table;
+    if (sourceSize <= 0 || destinationSize <= 0)
+        return table;
+
+    double ratio = static_cast<double>(sourceSize) / destinationSize;
+    double stretch = std::max(1.0, ratio);
+    double radius = GetFilterRadius(filter) * stretch;
+
+    std::vector<std::vector<double>> rows(destinationSize);
+    table.start.resize(destinationSize);
+    table.count.resize(destinationSize);
+
+    for (int i = 0; i < destinationSize; i++)
+    {
+        double center = (i + 0.5) * ratio - 0.5;
+        int left = static_cast<int>(ceil(center - radius));
+        int right = static_cast<int>(floor(center + radius));
+        int first = std::max(0, std::min(sourceSize - 1, left));
+        int last = std::max(0, std::min(sourceSize - 1, right));
+
+        // Taps past the edges land on the edge pixels
+        std::vector<double>& weights = rows[i];
+        weights.assign(last - first + 1, 0.0);
+        double total = 0.0;
+        for (int j = left; j <= right; j++)
+        {
+            double weight = Evaluate(filter, (j - center) / stretch);
+            int index = std::max(0, std::min(sourceSize - 1, j));
+            weights[index - first] += weight;
+            total += weight;
+        }
+
+        if (total == 0.0)
+        {
+            // Only reachable with degenerate filters; fall back to the nearest pixel
+            int nearest = std::max(0, std::min(sourceSize - 1, static_cast<int>(floor(center + 0.5))));
+            first = nearest;
+            weights.assign(1, 1.0);
+            total = 1.0;
+        }
+
+        // Drop zero taps at both ends
+        size_t begin = 0;
+        size_t end = weights.size();
+        while (end - begin > 1 && weights[begin] == 0.0) begin++;
+        while (end - begin > 1 && weights[end - 1] == 0.0) end--;
+        weights = std::vector<double>(weights.begin() + begin, weights.begin() + end);
+        for (double& weight : weights)
+        {
+            weight /= total;
+        }
+
+        table.start[i] = first + static_cast<int>(begin);
+        table.count[i] = static_cast<int>(weights.size());
+        table.maxTaps = std::max(table.maxTaps, table.count[i]);
+    }
+
+    table.weights.assign(static_cast<size_t>(destinationSize) * table.maxTaps, 0.0f);
+    for (int i = 0; i < destinationSize; i++)
+    {
+        for (int k = 0; k < table.count[i]; k++)
+        {
+            table.weights[static_cast<size_t>(i) * table.maxTaps + k] = static_cast<float>(rows[i][k]);
+        }
+    }
+    return table;
+}
+
+bool Resampler::Resize(const ImageView& source, const ImageView& destination, const ResampleOptions& options)
+{
+    if (!source.IsValid() || !destination.IsValid())
+        return false;
+
+    int sourceWidth = source.width;
+    int width = destination.width;
+    int height = destination.height;
+
+    ResampleWeights columns = ComputeWeights(sourceWidth, width, options.filter);
+    ResampleWeights rows = ComputeWeights(source.height, height, options.filter);
+    bool weighted = options.alphaWeighted && source.format == PixelFormat::A8R8G8B8;
+    bool srgb = options.srgb;
+    size_t stride = static_cast<size_t>(width) * 4;
+
+    int bands = (height + kRowsPerTask - 1) / kRowsPerTask;
+    GetEffectThreadPool().ParallelFor(bands, [&](int band) {
+        int y0 = band * kRowsPerTask;
+        int y1 = std::min(y0 + kRowsPerTask, height);
+
+        // Source rows this band reads, filtered horizontally once each
+        int first = rows.start[y0];
+        int last = first;
+        for (int y = y0; y < y1; y++)
+        {
+            last = std::max(last, rows.start[y] + rows.count[y]);
+        }
+
+        std::vector<float> decoded(static_cast<size_t>(sourceWidth) * 4);
+        std::vector<float> horizontal(stride * (last - first));
+        for (int sy = first; sy < last; sy++)
+        {
+            DecodeRow(source.Row(sy), decoded.data(), sourceWidth, srgb, weighted);
+            HorizontalRow(decoded.data(), columns, horizontal.data() + (sy - first) * stride, width);
+        }
+
+        std::vector<const float*> taps(rows.maxTaps);
+        std::vector<float> out(stride);
+        for (int y = y0; y < y1; y++)
+        {
+            for (int k = 0; k < rows.count[y]; k++)
+            {
+                taps[k] = horizontal.data() + (rows.start[y] + k - first) * stride;
+            }
+
+            const float* weights = rows.weights.data() + static_cast<size_t>(y) * rows.maxTaps;
+            VerticalRow(taps.data(), weights, rows.count[y], out.data(), static_cast<int>(stride));
+            EncodeRow(out.data(), destination.Row(y), width, srgb, weighted);
+        }
+    });
+
+    return true;
+}
+
+} // namespace TextureEffects
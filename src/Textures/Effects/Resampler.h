@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include "PixelBuffer.h"
+
+namespace TextureEffects {
+
+    enum class ResampleFilter {
+        Box,            // Average of the covered pixels; nearest pixel when enlarging
+        Bilinear,       // Triangle (tent), 1 pixel radius
+        CatmullRom,     // Cubic B = 0, C = 1/2: sharp, slight ringing
+        Mitchell,       // Cubic B = C = 1/3: softer, almost no ringing
+        Lanczos3,       // Windowed sinc, 3 lobes: sharpest, some ringing
+        Kaiser          // Kaiser-windowed sinc, 3 lobes: between Mitchell and Lanczos
+    };
+
+    struct ResampleOptions {
+        ResampleFilter filter = ResampleFilter::Lanczos3;
+
+        // Filter colors in linear light: the source is decoded from sRGB and
+        // the result encoded back, so averages keep their brightness
+        bool srgb = true;
+
+        // Weight colors by alpha, so transparent pixels do not bleed their
+        // color into visible ones. Ignored for X8R8G8B8 images.
+        bool alphaWeighted = true;
+    };
+
+    // Filter taps of one axis: output pixel i reads count[i] source pixels
+    // from start[i], weights[i * maxTaps + k]. Out-of-range taps are folded
+    // onto the edge pixels and every row of weights sums to 1.
+    struct ResampleWeights {
+        std::vector<int> start;
+        std::vector<int> count;
+        std::vector<float> weights;
+        int maxTaps = 0;
+    };
+
+    // Separable resampler: a horizontal and a vertical pass of precomputed
+    // weight tables, in float over four channels. Bands of output rows run
+    // on the thread pool, and the result does not depend on the thread count.
+    class Resampler {
+    public:
+        // Resamples source into destination, whatever the two sizes. The views
+        // must not overlap. Returns false if either view is invalid.
+        static bool Resize(const ImageView& source, const ImageView& destination,
+                           const ResampleOptions& options = ResampleOptions());
+
+        // Weight table for resampling sourceSize pixels to destinationSize.
+        // Pixel centers are aligned; when shrinking the filter is stretched
+        // by the size ratio so it averages every covered pixel.
+        static ResampleWeights ComputeWeights(int sourceSize, int destinationSize, ResampleFilter filter);
+
+        // Filter value at x source pixels from the center, and how far it reaches
+        static float EvaluateFilter(ResampleFilter filter, float x);
+        static float GetFilterRadius(ResampleFilter filter);
+
+        // Output rows per band
+        static const int kRowsPerTask = 16;
+    };
+
+}
@@ -0,0 +1,256 @@
+#include "StagingRing.h"
+#include "../../Core/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace TextureEffects {
+
+StagingRing::StagingRing(int bufferCount)
+    : m_slots(std::max(2, bufferCount))
+    , m_width(0)
+    , m_height(0)
+    , m_nextFrame(0)
+    , m_lastUploadedFrame(0)
+{
+}
+
+bool StagingRing::Allocate(int width, int height, PixelFormat format)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const Slot& slot : m_slots)
+    {
+        if (slot.state == SlotState::Writing || slot.state == SlotState::Uploading)
+            return false;
+    }
+
+    if (width == m_width && height == m_height && m_slots[0].buffer.GetFormat() == format)
+        return m_slots[0].buffer.IsValid();
+
+    for (Slot& slot : m_slots)
+    {
+        if (slot.state == SlotState::Ready)
+        {
+            m_stats.dropped++;
+        }
+        slot.state = SlotState::Free;
+
+        if (!slot.buffer.Allocate(width, height, format))
+        {
+            m_width = 0;
+            m_height = 0;
+            return false;
+        }
+    }
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+int StagingRing::BeginWrite()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int chosen = -1;
+    for (int i = 0; i < static_cast<int>(m_slots.size()); i++)
+    {
+        if (m_slots[i].state == SlotState::Free)
+        {
+            chosen = i;
+            break;
+        }
+    }
+
+    // No free slot: overwrite the oldest frame nobody has uploaded yet
+    if (chosen < 0)
+    {
+        for (int i = 0; i < static_cast<int>(m_slots.size()); i++)
+        {
+            if (m_slots[i].state == SlotState::Ready && (chosen < 0 || m_slots[i].frame < m_slots[chosen].frame))
+                chosen = i;
+        }
+
+        if (chosen < 0)
+            return -1;
+
+        m_stats.dropped++;
+    }
+
+    m_slots[chosen].state = SlotState::Writing;
+    m_slots[chosen].frame = ++m_nextFrame;
+    return chosen;
+}
+
+ImageView StagingRing::GetView(int slot) const
+{
+    return m_slots[slot].buffer.GetView();
+}
+
+void StagingRing::EndWrite(int slot)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_slots[slot].state = SlotState::Ready;
+    m_stats.published++;
+}
+
+void StagingRing::CancelWrite(int slot)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_slots[slot].state = SlotState::Free;
+}
+
+bool StagingRing::UploadLatest(UploadSink& sink)
+{
+    int newest = -1;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (int i = 0; i < static_cast<int>(m_slots.size()); i++)
+        {
+            if (m_slots[i].state == SlotState::Ready && (newest < 0 || m_slots[i].frame > m_slots[newest].frame))
+                newest = i;
+        }
+
+        if (newest < 0)
+            return false;
+
+        for (int i = 0; i < static_cast<int>(m_slots.size()); i++)
+        {
+            if (i != newest && m_slots[i].state == SlotState::Ready)
+            {
+                m_slots[i].state = SlotState::Free;
+                m_stats.dropped++;
+            }
+        }
+
+        m_slots[newest].state = SlotState::Uploading;
+    }
+
+    // The producer cannot claim an uploading slot, so no lock is needed here
+    bool uploaded = sink.Upload(m_slots[newest].buffer.GetView());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_slots[newest].state = SlotState::Free;
+    if (uploaded)
+    {
+        m_lastUploadedFrame = m_slots[newest].frame;
+        m_stats.uploaded++;
+    }
+    else
+    {
+        m_stats.failedUploads++;
+    }
+    return uploaded;
+}
+
+bool StagingRing::HasFrame() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::any_of(m_slots.begin(), m_slots.end(), [](const Slot& slot) {
+        return slot.state == SlotState::Ready;
+    });
+}
+
+uint64_t StagingRing::GetLastUploadedFrame() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastUploadedFrame;
+}
+
+size_t StagingRing::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t total = 0;
+    for (const Slot& slot : m_slots)
+    {
+        total += slot.buffer.GetMemoryUsage();
+    }
+    return total;
+}
+
+StagingRing::Stats StagingRing::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+StagedRender::StagedRender(int bufferCount)
+    : m_ring(bufferCount)
+    , m_failed(false)
+    , m_lastRenderMs(0.0f)
+{
+}
+
+StagedRender::~StagedRender()
+{
+    Wait();
+}
+
+bool StagedRender::Launch(ThreadPool* pool, const RenderFunc& render, float time, int width, int height)
+{
+    if (IsRendering() || !m_ring.Allocate(width, height))
+        return false;
+
+    int slot = m_ring.BeginWrite();
+    if (slot < 0)
+        return false;
+
+    auto job = [this, render, time, slot]() {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        bool rendered = true;
+        try
+        {
+            render(time, m_ring.GetView(slot));
+        }
+        catch (...)
+        {
+            rendered = false;
+        }
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        m_lastRenderMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+
+        if (rendered)
+        {
+            m_ring.EndWrite(slot);
+        }
+        else
+        {
+            m_ring.CancelWrite(slot);
+            m_failed = true;
+        }
+    };
+
+    if (pool)
+    {
+        m_job = pool->Submit(job);
+    }
+    else
+    {
+        job();
+    }
+    return true;
+}
+
+bool StagedRender::IsRendering() const
+{
+    return m_job.valid() && m_job.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+void StagedRender::Wait()
+{
+    if (m_job.valid())
+    {
+        m_job.wait();
+    }
+}
+
+bool StagedRender::Collect(UploadSink& sink)
+{
+    return m_ring.UploadLatest(sink);
+}
+
+} // namespace TextureEffects
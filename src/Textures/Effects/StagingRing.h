@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+#include "PixelBuffer.h"
+
+class ThreadPool;
+
+// CPU staging between effect generation and texture uploads. Platform-neutral:
+// the destination is reached through UploadSink, so the ring and its frame
+// pacing run headless with a mock sink.
+
+namespace TextureEffects {
+
+    // Destination of finished frames. Every upload replaces the whole image,
+    // so implementations can drop the previous contents (D3DLOCK_DISCARD on
+    // dynamic textures) instead of waiting for the GPU to finish reading it.
+    class UploadSink {
+    public:
+        virtual ~UploadSink() = default;
+        virtual bool Upload(const ImageView& image) = 0;
+    };
+
+    // Ring of staging buffers shared by one producer (rendering, usually on a
+    // worker) and one consumer (uploading, on the render thread). A slot is
+    // never handed to the producer while it is being uploaded, and the
+    // consumer only takes the newest finished frame: older ones are dropped
+    // instead of queued, so latency never builds up.
+    class StagingRing {
+    public:
+        struct Stats {
+            size_t published = 0;
+            size_t uploaded = 0;
+            size_t dropped = 0;       // Published, then replaced by a newer frame before upload
+            size_t failedUploads = 0;
+        };
+
+        // At least two buffers: one being written while the other uploads
+        explicit StagingRing(int bufferCount = 2);
+
+        // Resizes every slot and drops finished frames. Fails while a slot
+        // is being written or uploaded.
+        bool Allocate(int width, int height, PixelFormat format = PixelFormat::A8R8G8B8);
+
+        // Producer: claims a free slot, or recycles the oldest unread frame
+        // if there is none. Returns -1 when every slot is in use.
+        int BeginWrite();
+        ImageView GetView(int slot) const;
+        void EndWrite(int slot);
+        void CancelWrite(int slot);
+
+        // Consumer: uploads the newest finished frame. Returns false if
+        // there was none or the sink failed.
+        bool UploadLatest(UploadSink& sink);
+        bool HasFrame() const;
+
+        // Sequence number of the last uploaded frame (frames are numbered by
+        // BeginWrite order, starting at 1); 0 before the first upload
+        uint64_t GetLastUploadedFrame() const;
+
+        int GetBufferCount() const { return static_cast<int>(m_slots.size()); }
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        size_t GetMemoryUsage() const;
+        Stats GetStats() const;
+
+    private:
+        enum class SlotState { Free, Writing, Ready, Uploading };
+
+        struct Slot {
+            PixelBuffer buffer;
+            SlotState state = SlotState::Free;
+            uint64_t frame = 0;
+        };
+
+        std::vector<Slot> m_slots;
+        int m_width;
+        int m_height;
+        uint64_t m_nextFrame;
+        uint64_t m_lastUploadedFrame;
+        Stats m_stats;
+        mutable std::mutex m_mutex;
+    };
+
+    // One effect's render-ahead pipeline: Launch renders a frame into the
+    // ring (on a worker, or inline without a pool), Collect uploads the
+    // newest finished one. Both are called from the same thread; at most one
+    // render is in flight, so a slow effect skips frames instead of queueing.
+    class StagedRender {
+    public:
+        using RenderFunc = std::function<void(float time, const ImageView& image)>;
+
+        explicit StagedRender(int bufferCount = 2);
+        ~StagedRender();
+
+        StagedRender(const StagedRender&) = delete;
+        StagedRender& operator=(const StagedRender&) = delete;
+
+        // Returns false if a render is still in flight or no slot is free.
+        // With a pool the render runs there and Launch returns immediately.
+        bool Launch(ThreadPool* pool, const RenderFunc& render, float time, int width, int height);
+        bool IsRendering() const;
+        void Wait();
+
+        // Uploads the newest finished frame, if any
+        bool Collect(UploadSink& sink);
+
+        bool HasFailed() const { return m_failed.load(); }
+        float GetLastRenderMs() const { return m_lastRenderMs.load(); }
+        const StagingRing& GetRing() const { return m_ring; }
+
+    private:
+        StagingRing m_ring;
+        std::future<void> m_job;
+        std::atomic<bool> m_failed;
+        std::atomic<float> m_lastRenderMs;
+    };
+
+}
@@ -0,0 +1,320 @@
+#include "StreamingQueue.h"
+#include "../../Core/ThreadPool.h"
+#include <algorithm>
+#include <limits>
+
+namespace TextureEffects {
+
+ThreadPool* StreamingQueue::s_threadPool = nullptr;
+
+namespace {
+
+// Loads spend most of their time blocked on file I/O, so by default they
+// run on workers of their own and never hold up the effects pool
+ThreadPool& LoadThreadPool()
+{
+    static ThreadPool instance(StreamingQueue::kDefaultLoadThreads);
+    return instance;
+}
+
+} // namespace
+
+StreamingQueue::StreamingQueue(int maxLoads)
+    : m_nextHandle(1)
+    , m_maxLoads(maxLoads > 0 ? maxLoads : std::max(1, GetThreadPool().GetThreadCount()))
+    , m_activeLoads(0)
+{
+}
+
+StreamingQueue::~StreamingQueue()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (auto& pair : m_entries)
+    {
+        StreamState state = pair.second.state;
+        if (state == StreamState::Queued || state == StreamState::Loading || state == StreamState::Loaded)
+            Finish(pair.second, StreamState::Cancelled);
+    }
+    m_queued.clear();
+    m_loaded.clear();
+
+    // The workers still running reference this queue
+    m_condition.wait(lock, [this]() { return m_activeLoads == 0; });
+}
+
+StreamHandle StreamingQueue::Submit(StreamRequest request)
+{
+    StreamHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        handle = m_nextHandle++;
+
+        Entry& entry = m_entries[handle];
+        entry.request = std::move(request);
+        m_queued.push_back(handle);
+        m_stats.submitted++;
+    }
+
+    Dispatch();
+    return handle;
+}
+
+bool StreamingQueue::SetPriority(StreamHandle handle, int priority)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end())
+        return false;
+
+    StreamState state = it->second.state;
+    if (state != StreamState::Queued && state != StreamState::Loading && state != StreamState::Loaded)
+        return false;
+
+    it->second.request.priority = priority;
+    return true;
+}
+
+bool StreamingQueue::Cancel(StreamHandle handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end())
+        return false;
+
+    Entry& entry = it->second;
+    switch (entry.state)
+    {
+    case StreamState::Queued:
+        m_queued.erase(std::find(m_queued.begin(), m_queued.end(), handle));
+        break;
+    case StreamState::Loaded:
+        m_loaded.erase(std::find(m_loaded.begin(), m_loaded.end(), handle));
+        break;
+    case StreamState::Loading:
+        // The worker drops the result when the load returns
+        entry.state = StreamState::Cancelled;
+        m_stats.cancelled++;
+        return true;
+    default:
+        return false;
+    }
+
+    Finish(entry, StreamState::Cancelled);
+    m_condition.notify_all();
+    return true;
+}
+
+StreamState StreamingQueue::GetState(StreamHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(handle);
+    return it != m_entries.end() ? it->second.state : StreamState::Unknown;
+}
+
+bool StreamingQueue::Forget(StreamHandle handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(handle);
+    if (it == m_entries.end())
+        return false;
+
+    StreamState state = it->second.state;
+    if (state == StreamState::Queued || state == StreamState::Loading || state == StreamState::Loaded)
+        return false;
+
+    // A cancelled load or a commit still running is erased when it returns
+    it->second.forgotten = true;
+    if (!it->second.running)
+        m_entries.erase(it);
+    return true;
+}
+
+int StreamingQueue::Update(size_t byteBudget)
+{
+    int committed = 0;
+    size_t spent = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_loaded.empty())
+    {
+        // Highest priority first; stop at the first one that does not fit
+        auto best = FindHighestPriority(m_loaded);
+        Entry& candidate = m_entries[*best];
+        if (committed > 0 && spent + candidate.uploadBytes > byteBudget)
+            break;
+
+        StreamHandle handle = *best;
+        m_loaded.erase(best);
+        std::function<bool()> commit = std::move(candidate.request.commit);
+        size_t bytes = candidate.uploadBytes;
+        candidate.state = StreamState::Committed;
+        candidate.running = true;
+
+        lock.unlock();
+        bool succeeded = commit && commit();
+        commit = nullptr;
+        lock.lock();
+
+        Entry& entry = m_entries[handle];
+        entry.running = false;
+        Finish(entry, succeeded ? StreamState::Committed : StreamState::Failed);
+        if (succeeded)
+            m_stats.committedBytes += bytes;
+        if (entry.forgotten)
+            m_entries.erase(handle);
+
+        committed++;
+        spent += bytes;
+    }
+
+    m_condition.notify_all();
+    return committed;
+}
+
+void StreamingQueue::Flush()
+{
+    for (;;)
+    {
+        Update(std::numeric_limits<size_t>::max());
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() {
+            return !m_loaded.empty() || (m_queued.empty() && m_activeLoads == 0);
+        });
+
+        if (m_loaded.empty())
+            return;
+    }
+}
+
+size_t StreamingQueue::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t pending = m_queued.size() + m_loaded.size();
+    for (const auto& pair : m_entries)
+    {
+        if (pair.second.state == StreamState::Loading)
+            pending++;
+    }
+    return pending;
+}
+
+StreamingQueue::Stats StreamingQueue::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void StreamingQueue::SetThreadPool(ThreadPool* pool)
+{
+    s_threadPool = pool;
+}
+
+ThreadPool& StreamingQueue::GetThreadPool()
+{
+    return s_threadPool ? *s_threadPool : LoadThreadPool();
+}
+
+void StreamingQueue::Dispatch()
+{
+    // Each worker keeps taking requests until none is queued, so only the
+    // missing workers are started. Submitted without the lock: a pool
+    // without workers runs them right here.
+    int workers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        workers = std::min(m_maxLoads - m_activeLoads, static_cast<int>(m_queued.size()));
+        if (workers <= 0)
+            return;
+        m_activeLoads += workers;
+    }
+
+    ThreadPool& pool = GetThreadPool();
+    for (int i = 0; i < workers; i++)
+    {
+        pool.Submit([this]() { RunLoads(); });
+    }
+}
+
+void StreamingQueue::RunLoads()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_queued.empty())
+    {
+        auto next = FindHighestPriority(m_queued);
+        StreamHandle handle = *next;
+        m_queued.erase(next);
+
+        Entry& started = m_entries[handle];
+        started.state = StreamState::Loading;
+        started.running = true;
+        std::function<bool(size_t&)> load = std::move(started.request.load);
+
+        lock.unlock();
+        size_t uploadBytes = 0;
+        bool succeeded = load && load(uploadBytes);
+        load = nullptr;
+        lock.lock();
+
+        // Cancelled while loading: already counted, only the callbacks go
+        Entry& entry = m_entries[handle];
+        entry.running = false;
+        if (entry.state == StreamState::Cancelled)
+        {
+            entry.request = StreamRequest();
+            if (entry.forgotten)
+                m_entries.erase(handle);
+        }
+        else if (!succeeded)
+        {
+            Finish(entry, StreamState::Failed);
+        }
+        else
+        {
+            entry.state = StreamState::Loaded;
+            entry.uploadBytes = uploadBytes;
+            m_loaded.push_back(handle);
+        }
+        m_condition.notify_all();
+    }
+
+    m_activeLoads--;
+    m_condition.notify_all();
+}
+
+std::vector<StreamHandle>::iterator StreamingQueue::FindHighestPriority(std::vector<StreamHandle>& handles)
+{
+    // Handles grow with submission order, so ties go to the oldest request
+    auto best = handles.begin();
+    for (auto it = handles.begin(); it != handles.end(); ++it)
+    {
+        const StreamRequest& request = m_entries[*it].request;
+        const StreamRequest& current = m_entries[*best].request;
+        if (request.priority > current.priority || (request.priority == current.priority && *it < *best))
+            best = it;
+    }
+    return best;
+}
+
+void StreamingQueue::Finish(Entry& entry, StreamState state)
+{
+    entry.state = state;
+    entry.request = StreamRequest();
+
+    switch (state)
+    {
+    case StreamState::Committed: m_stats.committed++; break;
+    case StreamState::Failed: m_stats.failed++; break;
+    case StreamState::Cancelled: m_stats.cancelled++; break;
+    default: break;
+    }
+}
+
+} // namespace TextureEffects
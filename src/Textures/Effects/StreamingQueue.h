@@ -0,0 +1,126 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+// Asynchronous loading split between worker threads and the render thread.
+// Platform-neutral: a request is a pair of callbacks, so the queue and its
+// per-frame budget run headless with mock loads.
+
+namespace TextureEffects {
+
+    enum class StreamState {
+        Unknown,    // Handle never returned by Submit
+        Queued,
+        Loading,
+        Loaded,     // Waiting for Update to commit it
+        Committed,
+        Failed,
+        Cancelled
+    };
+
+    // One load, split where it has to change threads
+    struct StreamRequest {
+        // On a worker: file I/O and decoding. Sets the bytes the commit will
+        // upload, charged against the frame budget. False if it failed.
+        std::function<bool(size_t& uploadBytes)> load;
+        // On the thread calling Update: creates the resource from what load
+        // prepared. Never called after a failed load or a cancellation.
+        std::function<bool()> commit;
+        int priority = 0; // Higher loads and commits first
+    };
+
+    using StreamHandle = uint64_t; // 0 is never returned by Submit
+
+    // Loads run on the pool, highest priority first, a few at a time so a
+    // priority change still matters for requests that have not started.
+    // Finished loads wait until Update commits them, again by priority,
+    // until the frame's byte budget is spent. The callbacks are released as
+    // soon as a request commits, fails or is cancelled; only its state stays
+    // until Forget.
+    class StreamingQueue {
+    public:
+        struct Stats {
+            size_t submitted = 0;
+            size_t committed = 0;
+            size_t failed = 0;
+            size_t cancelled = 0;
+            size_t committedBytes = 0;
+        };
+
+        // maxLoads <= 0 runs one load per pool worker (at least one). On a
+        // pool without workers loads run inside Submit.
+        explicit StreamingQueue(int maxLoads = 0);
+        // Cancels everything pending and waits for the loads in flight
+        ~StreamingQueue();
+
+        StreamingQueue(const StreamingQueue&) = delete;
+        StreamingQueue& operator=(const StreamingQueue&) = delete;
+
+        StreamHandle Submit(StreamRequest request);
+
+        // Both fail once the request is committed, failed or cancelled. A
+        // load already running finishes, but its result is dropped.
+        bool SetPriority(StreamHandle handle, int priority);
+        bool Cancel(StreamHandle handle);
+        StreamState GetState(StreamHandle handle) const;
+
+        // Drops a committed, failed or cancelled request, whose state turns
+        // Unknown. Callers that poll GetState forget what they have seen.
+        bool Forget(StreamHandle handle);
+
+        // Render thread, once per frame: commits finished loads until
+        // byteBudget is spent. The first one always commits, so a request
+        // larger than the budget still goes through. Returns the count.
+        int Update(size_t byteBudget);
+
+        // Waits for every pending request and commits it (loading screens)
+        void Flush();
+
+        // Queued, loading or waiting for a commit
+        size_t GetPendingCount() const;
+        Stats GetStats() const;
+
+        // Pool the loads run on. nullptr selects the queue's own pool of
+        // kDefaultLoadThreads workers, separate from ThreadPool::Default()
+        // so loads blocked on I/O do not take workers from the effects.
+        static void SetThreadPool(ThreadPool* pool);
+        static ThreadPool& GetThreadPool();
+
+        static const int kDefaultLoadThreads = 2;
+
+    private:
+        struct Entry {
+            StreamRequest request;
+            StreamState state = StreamState::Queued;
+            size_t uploadBytes = 0;
+            bool running = false;   // Loading or committing, outside the lock
+            bool forgotten = false; // Erased once it stops running
+        };
+
+        void Dispatch();
+        void RunLoads();
+        std::vector<StreamHandle>::iterator FindHighestPriority(std::vector<StreamHandle>& handles);
+        void Finish(Entry& entry, StreamState state);
+
+        std::unordered_map<StreamHandle, Entry> m_entries;
+        std::vector<StreamHandle> m_queued;
+        std::vector<StreamHandle> m_loaded;
+        StreamHandle m_nextHandle;
+        int m_maxLoads;
+        int m_activeLoads;
+        Stats m_stats;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+
+        static ThreadPool* s_threadPool;
+    };
+
+}
@@ -0,0 +1,320 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <numeric>
+
+namespace TextureEffects {
+
+namespace {
+
+int RoundUp(int value, int multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+int NextPowerOfTwo(int value)
+{
+    int power = 1;
+    while (power < value)
+        power *= 2;
+    return power;
+}
+
+// Fills the padding texels around image, placed at (x, y) of level, with
+// the image's nearest edge texel
+void ExtendBorder(const ImageView& level, const ImageView& image, int x, int y, int padding)
+{
+    int top = std::max(y - padding, 0);
+    int bottom = std::min(y + image.height + padding, level.height);
+    int left = std::max(x - padding, 0);
+    int right = std::min(x + image.width + padding, level.width);
+
+    for (int row = top; row < bottom; row++)
+    {
+        D3DCOLOR* destination = level.Row(row);
+        bool inside = row >= y && row < y + image.height;
+        for (int column = left; column < right; column++)
+        {
+            if (inside && column == x)
+            {
+                column += image.width - 1;
+                continue;
+            }
+            destination[column] = image.GetClamped(column - x, row - y);
+        }
+    }
+}
+
+} // namespace
+
+SkylinePacker::SkylinePacker(int width, int height)
+    : m_width(0)
+    , m_height(0)
+    , m_usedArea(0)
+{
+    Reset(width, height);
+}
+
+void SkylinePacker::Reset(int width, int height)
+{
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_usedArea = 0;
+    m_skyline.clear();
+    if (m_width > 0)
+        m_skyline.push_back({ 0, 0, m_width });
+}
+
+bool SkylinePacker::Insert(int width, int height, int& x, int& y)
+{
+    if (width <= 0 || height <= 0)
+        return false;
+
+    size_t bestIndex = m_skyline.size();
+    int bestX = 0;
+    int bestY = INT_MAX;
+    for (size_t i = 0; i < m_skyline.size(); i++)
+    {
+        int top;
+        if (Fits(i, width, height, top) && (top < bestY || (top == bestY && m_skyline[i].x < bestX)))
+        {
+            bestIndex = i;
+            bestX = m_skyline[i].x;
+            bestY = top;
+        }
+    }
+    if (bestIndex == m_skyline.size())
+        return false;
+
+    AddSegment(bestIndex, bestX, bestY + height, width);
+    m_usedArea += static_cast<size_t>(width) * height;
+    x = bestX;
+    y = bestY;
+    return true;
+}
+
+bool SkylinePacker::Fits(size_t index, int width, int height, int& top) const
+{
+    // Rests on the highest segment under it
+    if (m_skyline[index].x + width > m_width)
+        return false;
+
+    top = 0;
+    int remaining = width;
+    for (size_t i = index; remaining > 0; i++)
+    {
+        top = std::max(top, m_skyline[i].y);
+        if (top + height > m_height)
+            return false;
+        remaining -= m_skyline[i].width;
+    }
+    return true;
+}
+
+void SkylinePacker::AddSegment(size_t index, int x, int y, int width)
+{
+    m_skyline.insert(m_skyline.begin() + index, { x, y, width });
+
+    // Segments now under the new one shrink or go
+    int end = x + width;
+    for (size_t i = index + 1; i < m_skyline.size();)
+    {
+        Segment& segment = m_skyline[i];
+        if (segment.x >= end)
+            break;
+
+        int covered = end - segment.x;
+        if (segment.width <= covered)
+        {
+            m_skyline.erase(m_skyline.begin() + i);
+            continue;
+        }
+        segment.x += covered;
+        segment.width -= covered;
+        break;
+    }
+
+    for (size_t i = 1; i < m_skyline.size();)
+    {
+        if (m_skyline[i - 1].y == m_skyline[i].y)
+        {
+            m_skyline[i - 1].width += m_skyline[i].width;
+            m_skyline.erase(m_skyline.begin() + i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+int TextureAtlas::Add(const ImageView& image)
+{
+    if (!image.IsValid())
+        return -1;
+
+    PixelBuffer copy(image.width, image.height, image.format);
+    image.CopyTo(copy.GetView());
+    m_images.push_back(std::move(copy));
+    return static_cast<int>(m_images.size()) - 1;
+}
+
+bool TextureAtlas::Build(const AtlasOptions& options)
+{
+    m_regions.assign(m_images.size(), AtlasRegion());
+    m_levels.clear();
+    if (m_images.empty())
+        return false;
+
+    // Every level with at least one texel of padding, unless told otherwise.
+    // Positions and padding are multiples of the coarsest level's texel.
+    int padding = std::max(options.padding, 0);
+    int levelCount = options.mipLevels;
+    if (levelCount <= 0)
+    {
+        levelCount = 1;
+        while ((padding >> levelCount) > 0)
+            levelCount++;
+    }
+    int alignment = 1 << (levelCount - 1);
+    padding = RoundUp(padding, alignment);
+
+    std::vector<int> boxWidths(m_images.size());
+    std::vector<int> boxHeights(m_images.size());
+    size_t area = 0;
+    int widest = 0;
+    int tallest = 0;
+    for (size_t i = 0; i < m_images.size(); i++)
+    {
+        boxWidths[i] = RoundUp(m_images[i].GetWidth() + 2 * padding, alignment);
+        boxHeights[i] = RoundUp(m_images[i].GetHeight() + 2 * padding, alignment);
+        area += static_cast<size_t>(boxWidths[i]) * boxHeights[i];
+        widest = std::max(widest, boxWidths[i]);
+        tallest = std::max(tallest, boxHeights[i]);
+    }
+
+    // Tallest first keeps the skyline flat
+    std::vector<size_t> order(m_images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return boxHeights[a] != boxHeights[b] ? boxHeights[a] > boxHeights[b] : boxWidths[a] > boxWidths[b];
+    });
+
+    // Smallest power-of-two atlas that takes them all, growing the shorter side
+    int width = NextPowerOfTwo(widest);
+    int height = NextPowerOfTwo(tallest);
+    while (static_cast<size_t>(width) * height < area)
+    {
+        if (width <= height)
+            width *= 2;
+        else
+            height *= 2;
+    }
+
+    std::vector<int> boxX(m_images.size());
+    std::vector<int> boxY(m_images.size());
+    SkylinePacker packer;
+    bool packed = false;
+    while (!packed && width <= options.maxSize && height <= options.maxSize)
+    {
+        packer.Reset(width, height);
+        packed = true;
+        for (size_t i : order)
+        {
+            if (!packer.Insert(boxWidths[i], boxHeights[i], boxX[i], boxY[i]))
+            {
+                packed = false;
+                break;
+            }
+        }
+
+        if (!packed)
+        {
+            if (width <= height)
+                width *= 2;
+            else
+                height *= 2;
+        }
+    }
+
+    if (!packed)
+    {
+        std::cerr << "Atlas images do not fit in " << options.maxSize << "x" << options.maxSize << std::endl;
+        return false;
+    }
+
+    levelCount = std::min(levelCount, MipChain::CountLevels(width, height));
+    for (int level = 0; level < levelCount; level++)
+    {
+        m_levels.emplace_back(std::max(1, width >> level), std::max(1, height >> level));
+        m_levels.back().Clear();
+    }
+
+    MipOptions mipOptions = options.mip;
+    mipOptions.maxLevels = levelCount;
+    for (size_t i = 0; i < m_images.size(); i++)
+    {
+        AtlasRegion& region = m_regions[i];
+        region.x = boxX[i] + padding;
+        region.y = boxY[i] + padding;
+        region.width = m_images[i].GetWidth();
+        region.height = m_images[i].GetHeight();
+        region.offsetU = static_cast<float>(region.x) / width;
+        region.offsetV = static_cast<float>(region.y) / height;
+        region.scaleU = static_cast<float>(region.width) / width;
+        region.scaleV = static_cast<float>(region.height) / height;
+
+        MipChain chain;
+        if (!chain.Build(m_images[i].GetView(), mipOptions))
+            return false;
+
+        // An image with fewer levels than the atlas repeats its last one
+        for (int level = 0; level < levelCount; level++)
+        {
+            ImageView image = chain.GetLevel(std::min(level, chain.GetLevelCount() - 1));
+            ImageView destination = m_levels[level].GetView();
+            int x = region.x >> level;
+            int y = region.y >> level;
+            image.CopyTo(destination.SubView(x, y, image.width, image.height));
+            ExtendBorder(destination, image, x, y, padding >> level);
+        }
+    }
+    return true;
+}
+
+void TextureAtlas::Clear()
+{
+    m_images.clear();
+    m_regions.clear();
+    m_levels.clear();
+}
+
+float TextureAtlas::GetOccupancy() const
+{
+    if (m_levels.empty())
+        return 0.0f;
+
+    size_t used = 0;
+    for (const AtlasRegion& region : m_regions)
+    {
+        used += static_cast<size_t>(region.width) * region.height;
+    }
+    return static_cast<float>(used) / (static_cast<float>(GetWidth()) * GetHeight());
+}
+
+size_t TextureAtlas::GetMemoryUsage() const
+{
+    size_t bytes = 0;
+    for (const PixelBuffer& level : m_levels)
+    {
+        bytes += level.GetMemoryUsage();
+    }
+    for (const PixelBuffer& image : m_images)
+    {
+        bytes += image.GetMemoryUsage();
+    }
+    return bytes;
+}
+
+} // namespace TextureEffects
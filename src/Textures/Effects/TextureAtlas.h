@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "MipChain.h"
+#include "PixelBuffer.h"
+
+namespace TextureEffects {
+
+    // Where an image landed in an atlas. A material layer samples it with
+    // uv * scale + offset (Material::SetAtlasRegion).
+    struct AtlasRegion {
+        int x = 0;              // Level 0 texels of the image, padding excluded
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        float offsetU = 0.0f;
+        float offsetV = 0.0f;
+        float scaleU = 1.0f;
+        float scaleV = 1.0f;
+    };
+
+    // Skyline rectangle packer: the top edge of what has been placed is
+    // kept as a list of horizontal segments, and each rectangle goes where
+    // it rests lowest, then leftmost
+    class SkylinePacker {
+    public:
+        SkylinePacker(int width = 0, int height = 0);
+
+        void Reset(int width, int height);
+        // False if the rectangle does not fit anywhere
+        bool Insert(int width, int height, int& x, int& y);
+
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        size_t GetUsedArea() const { return m_usedArea; }
+
+    private:
+        struct Segment {
+            int x;
+            int y;
+            int width;
+        };
+
+        bool Fits(size_t index, int width, int height, int& top) const;
+        void AddSegment(size_t index, int x, int y, int width);
+
+        std::vector<Segment> m_skyline;
+        int m_width;
+        int m_height;
+        size_t m_usedArea;
+    };
+
+    struct AtlasOptions {
+        // Texels around each image, copied from its edges, so filtering
+        // never reaches a neighbour
+        int padding = 4;
+        // Largest side of the atlas
+        int maxSize = 2048;
+        // 0 makes as many levels as the padding keeps apart: one more than
+        // log2(padding), so 3 for a padding of 4
+        int mipLevels = 0;
+        // How each image's levels are filtered
+        MipOptions mip;
+    };
+
+    // Packs small 32-bit images (checkerboards, gradients, UI elements)
+    // into one texture, so materials using them share a bind. Every image
+    // gets its own mip chain and each atlas level is assembled from those,
+    // with the borders extended again, so neighbours never bleed into each
+    // other at any level. Images are placed on multiples of the coarsest
+    // level's texel, so they stay aligned at every level. Regions cannot
+    // repeat: wrap addressing would show the neighbours.
+    class TextureAtlas {
+    public:
+        // Copies image; returns its index, or -1 if it is invalid
+        int Add(const ImageView& image);
+
+        // Packs every image into the smallest power-of-two atlas up to
+        // maxSize and builds its levels. False if they do not fit.
+        bool Build(const AtlasOptions& options = AtlasOptions());
+        void Clear();
+
+        int GetImageCount() const { return static_cast<int>(m_images.size()); }
+        // Valid after Build
+        const AtlasRegion& GetRegion(int index) const { return m_regions[index]; }
+
+        int GetWidth() const { return m_levels.empty() ? 0 : m_levels[0].GetWidth(); }
+        int GetHeight() const { return m_levels.empty() ? 0 : m_levels[0].GetHeight(); }
+        int GetLevelCount() const { return static_cast<int>(m_levels.size()); }
+        ImageView GetLevel(int level) const { return m_levels[level].GetView(); }
+
+        // Fraction of the atlas covered by images, padding excluded
+        float GetOccupancy() const;
+        size_t GetMemoryUsage() const;
+
+    private:
+        std::vector<PixelBuffer> m_images;
+        std::vector<AtlasRegion> m_regions;
+        std::vector<PixelBuffer> m_levels;
+    };
+
+}
@@ -0,0 +1,347 @@
+#include "AnimatedEffects.h"
+#include "BakeCache.h"
+#include "NoiseGenerator.h"
+#include "PostEffectChain.h"
+#include "PostEffects.h"
+#include "ProceduralTextures.h"
+#include "TextureUtils.h"
+#include "../Texture.h"
+
+// Texture entry points of the effects library. The effects themselves only
+// see ImageViews; these lock the texture's top level, run the ImageView
+// version and unlock. Engine build only, since Texture needs Direct3D.
+
+namespace TextureEffects {
+
+namespace {
+
+template <typename Func>
+void WithImage(const std::shared_ptr<Texture>& texture, Func&& func, DWORD flags = 0)
+{
+    ImageView image;
+    if (!texture || !texture->LockImage(image, flags))
+        return;
+
+    func(image);
+    texture->Unlock();
+}
+
+} // namespace
+
+// Animated effects
+
+void AnimatedEffects::UpdateLavaTexture(std::shared_ptr<Texture> texture, const LavaParams& params)
+{
+    WithImage(texture, [&](const ImageView& image) { RenderLava(params, image); });
+}
+
+void AnimatedEffects::UpdateWaterTexture(std::shared_ptr<Texture> texture, const WaterParams& params)
+{
+    WithImage(texture, [&](const ImageView& image) { RenderWater(params, image); });
+}
+
+void AnimatedEffects::UpdateFireTexture(std::shared_ptr<Texture> texture, const FireParams& params)
+{
+    WithImage(texture, [&](const ImageView& image) { RenderFire(params, image); });
+}
+
+void AnimatedEffects::UpdatePlasmaTexture(std::shared_ptr<Texture> texture, const PlasmaParams& params)
+{
+    WithImage(texture, [&](const ImageView& image) { RenderPlasma(params, image); });
+}
+
+void AnimatedEffects::UpdateElectricTexture(std::shared_ptr<Texture> texture, const ElectricParams& params)
+{
+    WithImage(texture, [&](const ImageView& image) { RenderElectric(params, image); });
+}
+
+void AnimatedEffects::UpdateEnergyTexture(std::shared_ptr<Texture> texture, const EnergyParams& params)
+{
+    WithImage(texture, [&](const ImageView& image) { RenderEnergy(params, image); });
+}
+
+void AnimatedEffects::UpdateSwirlTexture(std::shared_ptr<Texture> texture, const SwirlParams& params)
+{
+    WithImage(texture, [&](const ImageView& image) { RenderSwirl(params, image); });
+}
+
+// Post effects
+
+void PostEffects::AdjustBrightness(std::shared_ptr<Texture> texture, float brightness)
+{
+    WithImage(texture, [&](const ImageView& image) { AdjustBrightness(image, brightness); });
+}
+
+void PostEffects::AdjustContrast(std::shared_ptr<Texture> texture, float contrast)
+{
+    WithImage(texture, [&](const ImageView& image) { AdjustContrast(image, contrast); });
+}
+
+void PostEffects::AdjustSaturation(std::shared_ptr<Texture> texture, float saturation)
+{
+    WithImage(texture, [&](const ImageView& image) { AdjustSaturation(image, saturation); });
+}
+
+void PostEffects::AdjustHue(std::shared_ptr<Texture> texture, float hueShift)
+{
+    WithImage(texture, [&](const ImageView& image) { AdjustHue(image, hueShift); });
+}
+
+void PostEffects::AdjustGamma(std::shared_ptr<Texture> texture, float gamma)
+{
+    WithImage(texture, [&](const ImageView& image) { AdjustGamma(image, gamma); });
+}
+
+void PostEffects::ColorBalance(std::shared_ptr<Texture> texture, float redBalance, float greenBalance, float blueBalance)
+{
+    WithImage(texture, [&](const ImageView& image) { ColorBalance(image, redBalance, greenBalance, blueBalance); });
+}
+
+void PostEffects::Posterize(std::shared_ptr<Texture> texture, int levels)
+{
+    WithImage(texture, [&](const ImageView& image) { Posterize(image, levels); });
+}
+
+void PostEffects::Threshold(std::shared_ptr<Texture> texture, float threshold, bool binary)
+{
+    WithImage(texture, [&](const ImageView& image) { Threshold(image, threshold, binary); });
+}
+
+void PostEffects::Invert(std::shared_ptr<Texture> texture)
+{
+    WithImage(texture, [&](const ImageView& image) { Invert(image); });
+}
+
+void PostEffects::Sepia(std::shared_ptr<Texture> texture, float intensity)
+{
+    WithImage(texture, [&](const ImageView& image) { Sepia(image, intensity); });
+}
+
+void PostEffects::ApplyBlur(std::shared_ptr<Texture> texture, float radius)
+{
+    WithImage(texture, [&](const ImageView& image) { ApplyBlur(image, radius); });
+}
+
+void PostEffects::ApplyGaussianBlur(std::shared_ptr<Texture> texture, float sigma)
+{
+    WithImage(texture, [&](const ImageView& image) { ApplyGaussianBlur(image, sigma); });
+}
+
+void PostEffects::ApplySharpen(std::shared_ptr<Texture> texture, float amount)
+{
+    WithImage(texture, [&](const ImageView& image) { ApplySharpen(image, amount); });
+}
+
+void PostEffects::ApplyUnsharpMask(std::shared_ptr<Texture> texture, float amount, float radius)
+{
+    WithImage(texture, [&](const ImageView& image) { ApplyUnsharpMask(image, amount, radius); });
+}
+
+void PostEffects::ApplyEmboss(std::shared_ptr<Texture> texture, float strength, float angle)
+{
+    WithImage(texture, [&](const ImageView& image) { ApplyEmboss(image, strength, angle); });
+}
+
+void PostEffects::ApplyEdgeDetection(std::shared_ptr<Texture> texture, float threshold)
+{
+    WithImage(texture, [&](const ImageView& image) { ApplyEdgeDetection(image, threshold); });
+}
+
+void PostEffects::ApplySobel(std::shared_ptr<Texture> texture)
+{
+    WithImage(texture, [&](const ImageView& image) { ApplySobel(image); });
+}
+
+void PostEffects::ApplyLaplacian(std::shared_ptr<Texture> texture)
+{
+    WithImage(texture, [&](const ImageView& image) { ApplyLaplacian(image); });
+}
+
+void PostEffects::AddNoise(std::shared_ptr<Texture> texture, float amount, bool monochrome)
+{
+    WithImage(texture, [&](const ImageView& image) { AddNoise(image, amount, monochrome); });
+}
+
+void PostEffects::AddVignette(std::shared_ptr<Texture> texture, float strength, float radius)
+{
+    WithImage(texture, [&](const ImageView& image) { AddVignette(image, strength, radius); });
+}
+
+void PostEffects::Pixelate(std::shared_ptr<Texture> texture, int pixelSize)
+{
+    WithImage(texture, [&](const ImageView& image) { Pixelate(image, pixelSize); });
+}
+
+void PostEffects::AddGlow(std::shared_ptr<Texture> texture, float intensity, float radius, D3DCOLOR glowColor)
+{
+    WithImage(texture, [&](const ImageView& image) { AddGlow(image, intensity, radius, glowColor); });
+}
+
+void PostEffectChain::Apply(std::shared_ptr<Texture> texture) const
+{
+    WithImage(texture, [&](const ImageView& image) { Apply(image); });
+}
+
+// Procedural textures
+
+std::shared_ptr<Texture> ProceduralTextures::CreateCheckerboard(IDirect3DDevice9* device, int width, int height,
+                                                                int checkerSize, D3DCOLOR color1, D3DCOLOR color2)
+{
+    BakeKey key = BakeKey("checkerboard", kBakeVersion, width, height).Add(checkerSize).Add(color1).Add(color2);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateCheckerboard(image, checkerSize, color1, color2);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateStripes(IDirect3DDevice9* device, int width, int height,
+                                                           int stripeWidth, D3DCOLOR color1, D3DCOLOR color2, bool vertical)
+{
+    BakeKey key = BakeKey("stripes", kBakeVersion, width, height).Add(stripeWidth).Add(color1).Add(color2).Add(vertical);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateStripes(image, stripeWidth, color1, color2, vertical);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateGradient(IDirect3DDevice9* device, int width, int height,
+                                                            D3DCOLOR startColor, D3DCOLOR endColor, bool radial)
+{
+    BakeKey key = BakeKey("gradient", kBakeVersion, width, height).Add(startColor).Add(endColor).Add(radial);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateGradient(image, startColor, endColor, radial);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreatePerlinNoise(IDirect3DDevice9* device, int width, int height,
+                                                               float frequency, int octaves)
+{
+    BakeKey key = BakeKey("perlin", kBakeVersion, width, height).Add(frequency).Add(octaves);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GeneratePerlinNoise(image, frequency, octaves);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateTurbulence(IDirect3DDevice9* device, int width, int height,
+                                                              float frequency, int octaves)
+{
+    BakeKey key = BakeKey("turbulence", kBakeVersion, width, height).Add(frequency).Add(octaves);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateTurbulence(image, frequency, octaves);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateClouds(IDirect3DDevice9* device, int width, int height,
+                                                          float frequency, int octaves)
+{
+    BakeKey key = BakeKey("clouds", kBakeVersion, width, height).Add(frequency).Add(octaves);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateClouds(image, frequency, octaves);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateVoronoi(IDirect3DDevice9* device, int width, int height,
+                                                           float frequency, D3DCOLOR color1, D3DCOLOR color2)
+{
+    BakeKey key = BakeKey("voronoi", kBakeVersion, width, height).Add(frequency).Add(color1).Add(color2);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateVoronoi(image, frequency, color1, color2);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateWoodGrain(IDirect3DDevice9* device, int width, int height,
+                                                             D3DCOLOR lightWood, D3DCOLOR darkWood)
+{
+    BakeKey key = BakeKey("wood", kBakeVersion, width, height).Add(lightWood).Add(darkWood);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateWoodGrain(image, lightWood, darkWood);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateMarble(IDirect3DDevice9* device, int width, int height,
+                                                          D3DCOLOR baseColor, D3DCOLOR veinColor)
+{
+    BakeKey key = BakeKey("marble", kBakeVersion, width, height).Add(baseColor).Add(veinColor);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateMarble(image, baseColor, veinColor);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateMetal(IDirect3DDevice9* device, int width, int height,
+                                                         D3DCOLOR metalColor, float roughness)
+{
+    BakeKey key = BakeKey("metal", kBakeVersion, width, height).Add(metalColor).Add(roughness);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateMetal(image, metalColor, roughness);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateRock(IDirect3DDevice9* device, int width, int height,
+                                                        D3DCOLOR rockColor, float roughness)
+{
+    BakeKey key = BakeKey("rock", kBakeVersion, width, height).Add(rockColor).Add(roughness);
+    return CreateBaked(device, key, [&](const ImageView& image) {
+        GenerateRock(image, rockColor, roughness);
+    });
+}
+
+std::shared_ptr<Texture> ProceduralTextures::CreateBaked(IDirect3DDevice9* device, const BakeKey& key,
+                                                         const std::function<void(const ImageView&)>& generate)
+{
+    // The noise generators also depend on the shared permutation table
+    MipOptions options;
+    BakeKey bakeKey = key;
+    bakeKey.Add(options).Add(static_cast<int>(NoiseGenerator::GetSeed()));
+
+    auto texture = std::make_shared<Texture>();
+    BakeCache* cache = GetBakeCache();
+    TextureFile file;
+    if (cache && cache->Load(bakeKey, file))
+        return texture->CreateFromTextureFile(device, file, TextureType::DIFFUSE) ? texture : nullptr;
+
+    PixelBuffer image(key.GetWidth(), key.GetHeight());
+    if (!image.IsValid())
+        return nullptr;
+    generate(image.GetView());
+
+    MipChain chain;
+    if (!chain.Build(image.GetView(), options) || !texture->CreateFromMipChain(device, chain))
+        return nullptr;
+
+    if (cache)
+        cache->Store(bakeKey, chain);
+    return texture;
+}
+
+// Utilities
+
+std::shared_ptr<Texture> Utils::ResizeTexture(IDirect3DDevice9* device, std::shared_ptr<Texture> source, int newWidth,
+                                              int newHeight, const ResampleOptions& options)
+{
+    if (!source || newWidth <= 0 || newHeight <= 0)
+        return nullptr;
+
+    ImageView image;
+    if (!source->LockImage(image, D3DLOCK_READONLY))
+        return nullptr;
+
+    D3DFORMAT format = image.format == PixelFormat::X8R8G8B8 ? D3DFMT_X8R8G8B8 : D3DFMT_A8R8G8B8;
+    auto resized = std::make_shared<Texture>();
+    ImageView target;
+    bool created = resized->CreateEmpty(device, newWidth, newHeight, format) && resized->LockImage(target);
+    if (created)
+    {
+        Resampler::Resize(image, target, options);
+        resized->Unlock();
+    }
+
+    source->Unlock();
+    return created ? resized : nullptr;
+}
+
+D3DCOLOR Utils::SampleBilinear(std::shared_ptr<Texture> texture, float u, float v)
+{
+    D3DCOLOR color = D3DCOLOR_ARGB(0, 0, 0, 0);
+    WithImage(texture, [&](const ImageView& image) { color = SampleBilinear(image, u, v); }, D3DLOCK_READONLY);
+    return color;
+}
+
+} // namespace TextureEffects
@@ -1,19 +1,45 @@
 #include "TextureEffectManager.h"
 #include "AnimatedEffects.h"
+#include "EffectThreads.h"
 #include "../Texture.h"
+#include "../../Core/ThreadPool.h"
 #include <algorithm>
 #include <chrono>
+#include <iostream>
 
 namespace TextureEffects {
 
+namespace {
+
+// Dynamic textures are locked with DISCARD so the driver hands out fresh
+// memory instead of waiting for the GPU; managed textures lock their
+// system-memory copy, which the runtime uploads on next use.
+class TextureUploadSink : public UploadSink {
+public:
+    explicit TextureUploadSink(Texture& texture) : m_texture(texture) {}
+
+    bool Upload(const ImageView& image) override
+    {
+        return m_texture.Upload(image, m_texture.IsDynamic() ? D3DLOCK_DISCARD : 0);
+    }
+
+private:
+    Texture& m_texture;
+};
+
+} // namespace
+
 EffectManager::EffectManager()
     : m_globalTime(0.0f)
     , m_timeScale(1.0f)
     , m_maxEffectsPerFrame(10)
     , m_updateFrequency(60.0f)
+    , m_frameBudgetMs(4.0f)
+    , m_renderAhead(true)
     , m_lastUpdateTime(0.0f)
     , m_averageUpdateTime(0.0f)
     , m_updatesThisFrame(0)
+    , m_deferredThisFrame(0)
     , m_frameCounter(0)
 {
 }
@@ -29,23 +55,86 @@ void EffectManager::Update(float deltaTime)
 
     m_globalTime += deltaTime * m_timeScale;
     m_updatesThisFrame = 0;
+    m_deferredThisFrame = 0;
     m_frameCounter++;
 
-    // Update effects with frame limit
-    size_t effectsToUpdate = std::min(m_effects.size(), m_maxEffectsPerFrame);
+    // Upload the frames rendered ahead during the previous frame
+    CollectRenderAhead();
+
+    std::vector<EffectEntry*> scheduled = ScheduleEffects(deltaTime);
+
+    std::vector<EffectEntry*> staged;
+    for (EffectEntry* effect : scheduled)
+    {
+        if (IsStaged(*effect))
+        {
+            staged.push_back(effect);
+        }
+    }
+
+    ThreadPool& pool = GetEffectThreadPool();
+    bool renderAhead = m_renderAhead && pool.GetThreadCount() > 0;
 
-    for (size_t i = 0; i < effectsToUpdate; i++)
+    if (renderAhead)
     {
-        if (i < m_effects.size())
+        // Render for the time the next Update will show, assuming a steady frame rate
+        float aheadTime = m_globalTime + deltaTime * m_timeScale;
+        for (EffectEntry* effect : staged)
+        {
+            effect->pendingTime = aheadTime * effect->timeScale;
+            effect->staged->Launch(&pool, effect->renderFunc, effect->pendingTime,
+                                   effect->texture->GetWidth(), effect->texture->GetHeight());
+        }
+    }
+    else
+    {
+        // Render effects fill their staging rings in parallel and upload below
+        for (EffectEntry* effect : staged)
+        {
+            effect->pendingTime = m_globalTime * effect->timeScale;
+        }
+
+        pool.ParallelFor(static_cast<int>(staged.size()), [&staged](int i) {
+            EffectEntry& effect = *staged[i];
+            effect.staged->Launch(nullptr, effect.renderFunc, effect.pendingTime,
+                                  effect.texture->GetWidth(), effect.texture->GetHeight());
+        });
+    }
+
+    // Texture access stays on this thread
+    for (EffectEntry* effect : scheduled)
+    {
+        if (!IsStaged(*effect))
+        {
+            UpdateOnCallingThread(*effect);
+        }
+        else if (!renderAhead)
         {
-            UpdateEffect(m_effects[i], deltaTime);
+            CommitStaging(*effect);
         }
     }
 
+    // Remove problematic effects
+    for (const auto& effect : m_effects)
+    {
+        if (effect.failed)
+        {
+            std::cerr << "Effect update failed, unregistering: " << effect.name << std::endl;
+        }
+    }
+    m_effects.erase(
+        std::remove_if(m_effects.begin(), m_effects.end(),
+            [](const EffectEntry& entry) {
+                return entry.failed;
+            }),
+        m_effects.end()
+    );
+
     // Calculate performance metrics
     auto endTime = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
     float updateTime = duration.count() / 1000.0f; // Convert to milliseconds
+    m_lastUpdateTime = updateTime;
 
     // Moving average for update time
     float alpha = 0.1f; // Smoothing factor
@@ -54,79 +143,79 @@ void EffectManager::Update(float deltaTime)
 
 void EffectManager::RegisterLavaEffect(std::shared_ptr<Texture> texture, const AnimatedEffects::LavaParams& params)
 {
-    auto updateFunc = [params](std::shared_ptr<Texture> tex, float time) mutable {
+    auto renderFunc = [params](float time, const ImageView& image) {
         AnimatedEffects::LavaParams animParams = params;
         animParams.time = time;
-        AnimatedEffects::UpdateLavaTexture(tex, animParams);
+        AnimatedEffects::RenderLava(animParams, image);
     };
 
-    RegisterCustomEffect(texture, updateFunc, "Lava");
+    RegisterRenderEffect(texture, renderFunc, "Lava");
 }
 
 void EffectManager::RegisterWaterEffect(std::shared_ptr<Texture> texture, const AnimatedEffects::WaterParams& params)
 {
-    auto updateFunc = [params](std::shared_ptr<Texture> tex, float time) mutable {
+    auto renderFunc = [params](float time, const ImageView& image) {
         AnimatedEffects::WaterParams animParams = params;
         animParams.time = time;
-        AnimatedEffects::UpdateWaterTexture(tex, animParams);
+        AnimatedEffects::RenderWater(animParams, image);
     };
 
-    RegisterCustomEffect(texture, updateFunc, "Water");
+    RegisterRenderEffect(texture, renderFunc, "Water");
 }
 
 void EffectManager::RegisterFireEffect(std::shared_ptr<Texture> texture, const AnimatedEffects::FireParams& params)
 {
-    auto updateFunc = [params](std::shared_ptr<Texture> tex, float time) mutable {
+    auto renderFunc = [params](float time, const ImageView& image) {
         AnimatedEffects::FireParams animParams = params;
         animParams.time = time;
-        AnimatedEffects::UpdateFireTexture(tex, animParams);
+        AnimatedEffects::RenderFire(animParams, image);
     };
 
-    RegisterCustomEffect(texture, updateFunc, "Fire");
+    RegisterRenderEffect(texture, renderFunc, "Fire");
 }
 
 void EffectManager::RegisterPlasmaEffect(std::shared_ptr<Texture> texture, const AnimatedEffects::PlasmaParams& params)
 {
-    auto updateFunc = [params](std::shared_ptr<Texture> tex, float time) mutable {
+    auto renderFunc = [params](float time, const ImageView& image) {
         AnimatedEffects::PlasmaParams animParams = params;
         animParams.time = time;
-        AnimatedEffects::UpdatePlasmaTexture(tex, animParams);
+        AnimatedEffects::RenderPlasma(animParams, image);
     };
 
-    RegisterCustomEffect(texture, updateFunc, "Plasma");
+    RegisterRenderEffect(texture, renderFunc, "Plasma");
 }
 
 void EffectManager::RegisterElectricEffect(std::shared_ptr<Texture> texture, const AnimatedEffects::ElectricParams& params)
 {
-    auto updateFunc = [params](std::shared_ptr<Texture> tex, float time) mutable {
+    auto renderFunc = [params](float time, const ImageView& image) {
         AnimatedEffects::ElectricParams animParams = params;
         animParams.time = time;
-        AnimatedEffects::UpdateElectricTexture(tex, animParams);
+        AnimatedEffects::RenderElectric(animParams, image);
     };
 
-    RegisterCustomEffect(texture, updateFunc, "Electric");
+    RegisterRenderEffect(texture, renderFunc, "Electric");
 }
 
 void EffectManager::RegisterEnergyEffect(std::shared_ptr<Texture> texture, const AnimatedEffects::EnergyParams& params)
 {
-    auto updateFunc = [params](std::shared_ptr<Texture> tex, float time) mutable {
+    auto renderFunc = [params](float time, const ImageView& image) {
         AnimatedEffects::EnergyParams animParams = params;
         animParams.time = time;
-        AnimatedEffects::UpdateEnergyTexture(tex, animParams);
+        AnimatedEffects::RenderEnergy(animParams, image);
     };
 
-    RegisterCustomEffect(texture, updateFunc, "Energy");
+    RegisterRenderEffect(texture, renderFunc, "Energy");
 }
 
 void EffectManager::RegisterSwirlEffect(std::shared_ptr<Texture> texture, const AnimatedEffects::SwirlParams& params)
 {
-    auto updateFunc = [params](std::shared_ptr<Texture> tex, float time) mutable {
+    auto renderFunc = [params](float time, const ImageView& image) {
         AnimatedEffects::SwirlParams animParams = params;
         animParams.time = time;
-        AnimatedEffects::UpdateSwirlTexture(tex, animParams);
+        AnimatedEffects::RenderSwirl(animParams, image);
     };
 
-    RegisterCustomEffect(texture, updateFunc, "Swirl");
+    RegisterRenderEffect(texture, renderFunc, "Swirl");
 }
 
 void EffectManager::RegisterCustomEffect(std::shared_ptr<Texture> texture,
@@ -144,10 +233,61 @@ void EffectManager::RegisterCustomEffect(std::shared_ptr<Texture> texture,
     entry.updateFunc = updateFunc;
     entry.name = name;
     entry.lastUpdateTime = m_globalTime;
+    entry.lastUpdateFrame = m_frameCounter;
+
+    m_effects.push_back(entry);
+}
+
+void EffectManager::RegisterRenderEffect(std::shared_ptr<Texture> texture, RenderFunc renderFunc,
+                                         const std::string& name)
+{
+    if (!texture || !renderFunc)
+        return;
+
+    // Remove existing effect for this texture
+    UnregisterEffect(texture);
+
+    // Rewritten every frame: a dynamic texture takes the upload without
+    // waiting for the GPU to finish reading the previous one
+    if (!texture->IsDynamic() && !texture->MakeDynamic())
+        std::cerr << "Effect texture stays managed, uploads wait for the GPU: " << name << std::endl;
+
+    EffectEntry entry;
+    entry.texture = texture;
+    entry.renderFunc = renderFunc;
+    entry.staged = std::make_shared<StagedRender>();
+    entry.name = name;
+    entry.lastUpdateTime = m_globalTime;
+    entry.lastUpdateFrame = m_frameCounter;
 
     m_effects.push_back(entry);
 }
 
+void EffectManager::OnLostDevice()
+{
+    // Renders in flight only write their staging buffers
+    for (auto& effect : m_effects)
+        effect.texture->OnLostDevice();
+}
+
+void EffectManager::OnResetDevice()
+{
+    for (auto& effect : m_effects)
+    {
+        if (!effect.texture->IsDynamic())
+            continue;
+
+        if (!effect.texture->OnResetDevice())
+        {
+            effect.failed = true;
+            continue;
+        }
+
+        // The recreated texture has undefined contents
+        UpdateOnCallingThread(effect);
+    }
+}
+
 void EffectManager::UnregisterEffect(std::shared_ptr<Texture> texture)
 {
     m_effects.erase(
@@ -203,6 +343,117 @@ void EffectManager::SetEffectTimeScale(std::shared_ptr<Texture> texture, float s
     }
 }
 
+void EffectManager::SetEffectPriority(std::shared_ptr<Texture> texture, float priority)
+{
+    EffectEntry* effect = FindEffect(texture);
+    if (effect)
+    {
+        effect->priority = std::max(0.0f, priority);
+    }
+}
+
+void EffectManager::SetEffectUpdateInterval(std::shared_ptr<Texture> texture, float seconds)
+{
+    EffectEntry* effect = FindEffect(texture);
+    if (effect)
+    {
+        effect->updateInterval = std::max(0.0f, seconds);
+    }
+}
+
+bool EffectManager::EnableFlipbook(std::shared_ptr<Texture> texture, int frameCount, float period,
+                                   bool crossFade, const std::string& cacheFile)
+{
+    EffectEntry* effect = FindEffect(texture);
+    if (!effect || (!effect->updateFunc && !effect->renderFunc))
+        return false;
+
+    int width = texture->GetWidth();
+    int height = texture->GetHeight();
+
+    auto flipbook = std::make_shared<Flipbook>();
+    bool loaded = !cacheFile.empty() && flipbook->LoadFromFile(cacheFile, width, height, frameCount, period);
+
+    if (!loaded)
+    {
+        // Render each frame with the regular update and read it back
+        auto render = [effect, texture](float time, const ImageView& frame) {
+            if (effect->renderFunc)
+            {
+                effect->renderFunc(time, frame);
+                return true;
+            }
+
+            effect->updateFunc(texture, time);
+
+            ImageView image;
+            if (!texture->LockImage(image, D3DLOCK_READONLY))
+                return false;
+
+            image.CopyTo(frame);
+            texture->Unlock();
+            return true;
+        };
+
+        if (!flipbook->Bake(width, height, frameCount, period, render))
+            return false;
+
+        if (!cacheFile.empty() && !flipbook->SaveToFile(cacheFile))
+        {
+            std::cerr << "Failed to write flipbook cache: " << cacheFile << std::endl;
+        }
+    }
+
+    effect->flipbook = flipbook;
+    effect->crossFade = crossFade;
+    return true;
+}
+
+void EffectManager::DisableFlipbook(std::shared_ptr<Texture> texture)
+{
+    EffectEntry* effect = FindEffect(texture);
+    if (effect)
+    {
+        effect->flipbook.reset();
+    }
+}
+
+bool EffectManager::HasFlipbook(std::shared_ptr<Texture> texture) const
+{
+    auto it = std::find_if(m_effects.begin(), m_effects.end(),
+        [texture](const EffectEntry& entry) {
+            return entry.texture == texture;
+        });
+
+    return it != m_effects.end() && it->flipbook != nullptr;
+}
+
+size_t EffectManager::GetStagingMemoryUsage() const
+{
+    size_t total = 0;
+    for (const auto& effect : m_effects)
+    {
+        if (effect.staged)
+        {
+            total += effect.staged->GetRing().GetMemoryUsage();
+        }
+    }
+    return total;
+}
+
+size_t EffectManager::GetFlipbookMemoryUsage() const
+{
+    size_t total = 0;
+    for (const auto& effect : m_effects)
+    {
+        if (effect.flipbook)
+        {
+            total += effect.flipbook->GetMemoryUsage();
+        }
+    }
+    return total;
+}
+
 bool EffectManager::HasEffect(std::shared_ptr<Texture> texture) const
 {
     return std::find_if(m_effects.begin(), m_effects.end(),
@@ -224,34 +475,249 @@ std::vector<std::shared_ptr<Texture>> EffectManager::GetActiveTextures() const
     return textures;
 }
 
-void EffectManager::UpdateEffect(EffectEntry& effect, float deltaTime)
+std::vector<EffectManager::EffectEntry*> EffectManager::ScheduleEffects(float deltaTime)
 {
-    if (effect.isPaused || !effect.texture || !effect.updateFunc)
-        return;
+    // Half a frame of slack keeps an effect whose interval equals the frame
+    // time from skipping every other frame due to float accumulation
+    float slack = deltaTime * m_timeScale * 0.5f;
+
+    std::vector<EffectEntry*> due;
+    for (auto& effect : m_effects)
+    {
+        if (effect.isPaused || !effect.texture || (!effect.updateFunc && !effect.renderFunc))
+            continue;
+
+        // A render still in flight covers this frame; CollectRenderAhead counts it as late
+        if (IsStaged(effect) && effect.staged->IsRendering())
+            continue;
+
+        if (ShouldUpdateEffect(effect, m_globalTime, slack))
+        {
+            due.push_back(&effect);
+        }
+    }
+
+    // Most overdue first, weighted by priority. Updated effects drop to the
+    // back, so under a tight budget they are served round-robin.
+    auto score = [this](const EffectEntry* effect) {
+        return effect->priority * static_cast<float>(m_frameCounter - effect->lastUpdateFrame);
+    };
+    std::stable_sort(due.begin(), due.end(), [&score](const EffectEntry* a, const EffectEntry* b) {
+        return score(a) > score(b);
+    });
+
+    // Predict the frame cost from each effect's moving averages: commits and
+    // calling-thread updates add up, worker renders are spread over the pool
+    float lanes = static_cast<float>(GetEffectThreadPool().GetThreadCount() + 1);
+    float serialMs = 0.0f;
+    float parallelMs = 0.0f;
+    float longestRenderMs = 0.0f;
+
+    std::vector<EffectEntry*> scheduled;
+    for (EffectEntry* effect : due)
+    {
+        const EffectStats& stats = effect->stats;
+        bool offThread = IsStaged(*effect);
+
+        float nextSerialMs = serialMs + stats.averageCommitMs + (offThread ? 0.0f : stats.averageRenderMs);
+        float nextParallelMs = parallelMs + (offThread ? stats.averageRenderMs : 0.0f);
+        float nextLongestMs = offThread ? std::max(longestRenderMs, stats.averageRenderMs) : longestRenderMs;
+        float predictedMs = nextSerialMs + std::max(nextParallelMs / lanes, nextLongestMs);
+
+        // The most overdue effect always runs so every effect keeps making progress
+        bool overCount = m_maxEffectsPerFrame > 0 && scheduled.size() >= m_maxEffectsPerFrame;
+        bool overBudget = m_frameBudgetMs > 0.0f && predictedMs > m_frameBudgetMs;
+        if (!scheduled.empty() && (overCount || overBudget))
+        {
+            effect->stats.deferredCount++;
+            m_deferredThisFrame++;
+            continue;
+        }
 
-    if (!ShouldUpdateEffect(effect, m_globalTime))
+        serialMs = nextSerialMs;
+        parallelMs = nextParallelMs;
+        longestRenderMs = nextLongestMs;
+
+        MarkScheduled(*effect);
+        scheduled.push_back(effect);
+    }
+
+    return scheduled;
+}
+
+void EffectManager::CollectRenderAhead()
+{
+    for (auto& effect : m_effects)
+    {
+        if (!IsStaged(effect))
+            continue;
+
+        if (effect.staged->IsRendering())
+        {
+            effect.stats.lateCount++;
+            continue;
+        }
+
+        if (effect.staged->HasFailed() || effect.staged->GetRing().HasFrame())
+        {
+            CommitStaging(effect);
+        }
+    }
+}
+
+void EffectManager::CommitStaging(EffectEntry& effect)
+{
+    if (effect.staged->HasFailed())
+    {
+        effect.failed = true;
         return;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    TextureUploadSink sink(*effect.texture);
+    bool uploaded = effect.staged->Collect(sink);
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    if (uploaded)
+    {
+        RecordUpdate(effect, effect.staged->GetLastRenderMs(),
+                     std::chrono::duration<float, std::milli>(endTime - startTime).count());
+    }
+    effect.stats.droppedFrames = effect.staged->GetRing().GetStats().dropped;
+}
+
+void EffectManager::UpdateOnCallingThread(EffectEntry& effect)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+    float effectTime = m_globalTime * effect.timeScale;
 
-    try
+    if (!effect.flipbook || !UpdateFromFlipbook(effect, effectTime))
     {
-        float effectTime = m_globalTime * effect.timeScale;
-        effect.updateFunc(effect.texture, effectTime);
-        effect.lastUpdateTime = m_globalTime;
-        m_updatesThisFrame++;
+        if (effect.renderFunc)
+        {
+            // Flipbook no longer matches the texture: render it directly
+            effect.staged->Wait();
+            effect.staged->Launch(nullptr, effect.renderFunc, effectTime,
+                                  effect.texture->GetWidth(), effect.texture->GetHeight());
+            CommitStaging(effect);
+            return;
+        }
+
+        try
+        {
+            effect.updateFunc(effect.texture, effectTime);
+        }
+        catch (...)
+        {
+            effect.failed = true;
+            return;
+        }
     }
-    catch (...)
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    RecordUpdate(effect, std::chrono::duration<float, std::milli>(endTime - startTime).count(), 0.0f);
+}
+
+bool EffectManager::UpdateFromFlipbook(EffectEntry& effect, float effectTime)
+{
+    const Flipbook& flipbook = *effect.flipbook;
+    if (flipbook.GetWidth() != effect.texture->GetWidth() || flipbook.GetHeight() != effect.texture->GetHeight())
+        return false;
+
+    // Sample writes every pixel
+    ImageView image;
+    if (!effect.texture->LockImage(image, effect.texture->IsDynamic() ? D3DLOCK_DISCARD : 0))
+        return false;
+
+    flipbook.Sample(effectTime, effect.crossFade, image);
+
+    effect.texture->Unlock();
+    return true;
+}
+
+EffectManager::EffectEntry* EffectManager::FindEffect(std::shared_ptr<Texture> texture)
+{
+    auto it = std::find_if(m_effects.begin(), m_effects.end(),
+        [texture](EffectEntry& entry) {
+            return entry.texture == texture;
+        });
+
+    return it != m_effects.end() ? &(*it) : nullptr;
+}
+
+const EffectManager::EffectEntry* EffectManager::FindEffect(std::shared_ptr<Texture> texture) const
+{
+    auto it = std::find_if(m_effects.begin(), m_effects.end(),
+        [texture](const EffectEntry& entry) {
+            return entry.texture == texture;
+        });
+
+    return it != m_effects.end() ? &(*it) : nullptr;
+}
+
+void EffectManager::MarkScheduled(EffectEntry& effect)
+{
+    effect.lastUpdateTime = m_globalTime;
+    effect.lastUpdateFrame = m_frameCounter;
+    m_updatesThisFrame++;
+}
+
+void EffectManager::RecordUpdate(EffectEntry& effect, float renderMs, float commitMs)
+{
+    EffectStats& stats = effect.stats;
+    float alpha = stats.updateCount == 0 ? 1.0f : 0.1f;
+    stats.lastRenderMs = renderMs;
+    stats.lastCommitMs = commitMs;
+    stats.averageRenderMs = stats.averageRenderMs * (1.0f - alpha) + renderMs * alpha;
+    stats.averageCommitMs = stats.averageCommitMs * (1.0f - alpha) + commitMs * alpha;
+    stats.maxMs = std::max(stats.maxMs, renderMs + commitMs);
+    stats.updateCount++;
+}
+
+std::vector<EffectManager::EffectStats> EffectManager::GetEffectStats() const
+{
+    std::vector<EffectStats> result;
+    result.reserve(m_effects.size());
+
+    for (const auto& effect : m_effects)
     {
-        // Remove problematic effect
-        UnregisterEffect(effect.texture);
+        EffectStats stats = effect.stats;
+        stats.name = effect.name;
+        stats.priority = effect.priority;
+        stats.framesSinceUpdate = m_frameCounter - effect.lastUpdateFrame;
+        result.push_back(stats);
     }
+
+    return result;
 }
 
-bool EffectManager::ShouldUpdateEffect(const EffectEntry& effect, float currentTime) const
+bool EffectManager::GetEffectStats(std::shared_ptr<Texture> texture, EffectStats& stats) const
 {
-    if (effect.updateInterval <= 0.0f)
+    const EffectEntry* effect = FindEffect(texture);
+    if (!effect)
+        return false;
+
+    stats = effect->stats;
+    stats.name = effect->name;
+    stats.priority = effect->priority;
+    stats.framesSinceUpdate = m_frameCounter - effect->lastUpdateFrame;
+    return true;
+}
+
+bool EffectManager::ShouldUpdateEffect(const EffectEntry& effect, float currentTime, float slack) const
+{
+    float interval = GetEffectiveInterval(effect);
+    if (interval <= 0.0f)
         return true; // Update every frame
 
-    return (currentTime - effect.lastUpdateTime) >= effect.updateInterval;
+    return (currentTime - effect.lastUpdateTime) + slack >= interval;
+}
+
+float EffectManager::GetEffectiveInterval(const EffectEntry& effect) const
+{
+    float globalInterval = m_updateFrequency > 0.0f ? 1.0f / m_updateFrequency : 0.0f;
+    return std::max(effect.updateInterval, globalInterval);
 }
 
 // Preset configurations
@@ -1,20 +1,53 @@
 #pragma once
 
-#include <d3d9.h>
 #include <memory>
 #include <vector>
 #include <functional>
 #include <unordered_map>
 #include <string>
 #include "AnimatedEffects.h"
+#include "Flipbook.h"
+#include "StagingRing.h"
 
 class Texture;
 
 namespace TextureEffects {
 
-    // Effect manager for coordinating multiple effects
+    // Effect manager for coordinating multiple effects.
+    //
+    // Update schedules effects within a per-frame millisecond budget: every
+    // due effect is scored by priority x frames since its last update, so
+    // effects that miss a frame move up and all of them are served in turn.
+    // Effects registered with a render function (all built-in ones) render
+    // into a ring of CPU staging buffers on the worker pool; the texture
+    // upload always happens on the thread calling Update. Their textures are
+    // made dynamic at registration, so the upload locks with D3DLOCK_DISCARD,
+    // and OnLostDevice/OnResetDevice must bracket every device reset. With
+    // render-ahead (the default) Update starts the next frame's renders and
+    // returns without waiting; the following Update uploads them, so
+    // generation overlaps the frame.
+    // Custom texture callbacks and flipbook sampling run on the calling thread.
     class EffectManager {
     public:
+        // Writes one frame into a view with the texture's size. Called from
+        // worker threads: must not touch the device or texture.
+        using RenderFunc = std::function<void(float time, const ImageView& image)>;
+
+        struct EffectStats {
+            std::string name;
+            float priority = 1.0f;
+            size_t updateCount = 0;
+            size_t deferredCount = 0;     // Frames it was due but left out by the budget
+            size_t lateCount = 0;         // Frames its render-ahead was still running at Update
+            size_t droppedFrames = 0;     // Staged frames replaced before they were uploaded
+            size_t framesSinceUpdate = 0;
+            float lastRenderMs = 0.0f;    // Pixel generation (worker thread for render effects)
+            float lastCommitMs = 0.0f;    // Texture lock + copy on the calling thread
+            float averageRenderMs = 0.0f; // Moving averages, used to predict the frame cost
+            float averageCommitMs = 0.0f;
+            float maxMs = 0.0f;           // Slowest render + commit so far
+        };
+
         EffectManager();
         ~EffectManager();
 
@@ -36,6 +69,14 @@ namespace TextureEffects {
         void RegisterCustomEffect(std::shared_ptr<Texture> texture,
                                  std::function<void(std::shared_ptr<Texture>, float)> updateFunc,
                                  const std::string& name = "");
+        void RegisterRenderEffect(std::shared_ptr<Texture> texture, RenderFunc renderFunc,
+                                  const std::string& name = "");
+
+        // Around IDirect3DDevice9::Reset: releases the dynamic effect
+        // textures, then recreates them and fills them with the current frame
+        // (paused effects too)
+        void OnLostDevice();
+        void OnResetDevice();
 
         // Effect management
         void UnregisterEffect(std::shared_ptr<Texture> texture);
@@ -43,29 +84,67 @@ namespace TextureEffects {
         void PauseEffect(std::shared_ptr<Texture> texture);
         void ResumeEffect(std::shared_ptr<Texture> texture);
         void SetEffectTimeScale(std::shared_ptr<Texture> texture, float scale);
+        void SetEffectPriority(std::shared_ptr<Texture> texture, float priority);
+        void SetEffectUpdateInterval(std::shared_ptr<Texture> texture, float seconds);
+
+        // Flipbook mode: bakes frameCount frames of one period of the effect,
+        // then each update only copies or cross-fades two cached frames. If
+        // cacheFile is set, a matching file is loaded instead of baking and a
+        // fresh bake is written to it. Lava/water loop seamlessly when their
+        // loopPeriod equals period.
+        bool EnableFlipbook(std::shared_ptr<Texture> texture, int frameCount, float period,
+                            bool crossFade = true, const std::string& cacheFile = "");
+        void DisableFlipbook(std::shared_ptr<Texture> texture);
+        bool HasFlipbook(std::shared_ptr<Texture> texture) const;
+        size_t GetFlipbookMemoryUsage() const;
 
         // Effect querying
         bool HasEffect(std::shared_ptr<Texture> texture) const;
         size_t GetEffectCount() const { return m_effects.size(); }
         std::vector<std::shared_ptr<Texture>> GetActiveTextures() const;
 
-        // Performance settings
+        // Performance settings. maxEffects 0 and budget 0 mean no limit;
+        // frequency caps how often any single effect updates (0 = every frame).
         void SetMaxEffectsPerFrame(size_t maxEffects) { m_maxEffectsPerFrame = maxEffects; }
         void SetUpdateFrequency(float frequency) { m_updateFrequency = frequency; }
+        void SetFrameBudget(float milliseconds) { m_frameBudgetMs = milliseconds; }
+        float GetFrameBudget() const { return m_frameBudgetMs; }
+
+        // Render-ahead adds one frame of latency to render effects in exchange
+        // for not waiting on their generation. Without pool workers renders
+        // always complete inside Update.
+        void SetRenderAhead(bool enabled) { m_renderAhead = enabled; }
+        bool GetRenderAhead() const { return m_renderAhead; }
+        size_t GetStagingMemoryUsage() const;
 
         // Statistics
         float GetAverageUpdateTime() const { return m_averageUpdateTime; }
         size_t GetUpdatesThisFrame() const { return m_updatesThisFrame; }
+        size_t GetDeferredThisFrame() const { return m_deferredThisFrame; }
+        std::vector<EffectStats> GetEffectStats() const;
+        bool GetEffectStats(std::shared_ptr<Texture> texture, EffectStats& stats) const;
 
     private:
         struct EffectEntry {
             std::shared_ptr<Texture> texture;
             std::function<void(std::shared_ptr<Texture>, float)> updateFunc;
+            RenderFunc renderFunc;
             std::string name;
             bool isPaused = false;
             float timeScale = 1.0f;
+            float priority = 1.0f;
             float lastUpdateTime = 0.0f;
+            size_t lastUpdateFrame = 0;
             float updateInterval = 0.0f; // 0 = every frame
+            std::shared_ptr<Flipbook> flipbook;
+            bool crossFade = true;
+
+            // Staging ring and in-flight render; shared so the entry can be
+            // copied while a worker writes into it
+            std::shared_ptr<StagedRender> staged;
+            float pendingTime = 0.0f; // Time of the frame in flight
+            bool failed = false;
+            EffectStats stats;
         };
 
         std::vector<EffectEntry> m_effects;
@@ -73,16 +152,29 @@ namespace TextureEffects {
         float m_timeScale;
         size_t m_maxEffectsPerFrame;
         float m_updateFrequency;
+        float m_frameBudgetMs;
+        bool m_renderAhead;
 
         // Performance tracking
         float m_lastUpdateTime;
         float m_averageUpdateTime;
         size_t m_updatesThisFrame;
+        size_t m_deferredThisFrame;
         size_t m_frameCounter;
 
         // Internal helpers
-        void UpdateEffect(EffectEntry& effect, float deltaTime);
-        bool ShouldUpdateEffect(const EffectEntry& effect, float currentTime) const;
+        std::vector<EffectEntry*> ScheduleEffects(float deltaTime);
+        void CollectRenderAhead();
+        void CommitStaging(EffectEntry& effect);
+        void UpdateOnCallingThread(EffectEntry& effect);
+        bool UpdateFromFlipbook(EffectEntry& effect, float effectTime);
+        void MarkScheduled(EffectEntry& effect);
+        void RecordUpdate(EffectEntry& effect, float renderMs, float commitMs);
+        EffectEntry* FindEffect(std::shared_ptr<Texture> texture);
+        const EffectEntry* FindEffect(std::shared_ptr<Texture> texture) const;
+        bool IsStaged(const EffectEntry& effect) const { return effect.renderFunc && !effect.flipbook; }
+        bool ShouldUpdateEffect(const EffectEntry& effect, float currentTime, float slack) const;
+        float GetEffectiveInterval(const EffectEntry& effect) const;
     };
 
     // Preset effect configurations
@@ -0,0 +1,343 @@
+#include "TextureFile.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace TextureEffects {
+
+namespace {
+
+const uint32_t kTextureFileMagic = 0x58455445; // "ETEX"
+const uint32_t kTextureFileVersion = 1;
+const uint64_t kLevelAlignment = 16;
+
+struct TextureFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint64_t contentHash;
+};
+
+static_assert(sizeof(TextureFileHeader) == 32, "Texture file header layout changed");
+static_assert(sizeof(TextureFileLevel) == 32, "Texture file level layout changed");
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool IsBlockFormat(TextureFileFormat format, BlockFormat& blockFormat)
+{
+    switch (format)
+    {
+    case TextureFileFormat::BC1: blockFormat = BlockFormat::BC1; return true;
+    case TextureFileFormat::BC3: blockFormat = BlockFormat::BC3; return true;
+    case TextureFileFormat::BC4: blockFormat = BlockFormat::BC4; return true;
+    case TextureFileFormat::BC5: blockFormat = BlockFormat::BC5; return true;
+    default: return false;
+    }
+}
+
+bool IsValidFormat(uint32_t format)
+{
+    return format >= static_cast<uint32_t>(TextureFileFormat::A8R8G8B8) &&
+           format <= static_cast<uint32_t>(TextureFileFormat::BC5);
+}
+
+uint64_t RotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t MixWord(uint64_t word)
+{
+    word *= 0x87C37B91114253D5ull;
+    word = RotateLeft(word, 31);
+    return word * 0x4CF5AD432745937Full;
+}
+
+// Seed of the content hash: everything in the header but the hash itself
+uint64_t HashDescription(TextureFileFormat format, int width, int height, int levelCount)
+{
+    uint32_t description[4] = { static_cast<uint32_t>(format), static_cast<uint32_t>(width),
+                                static_cast<uint32_t>(height), static_cast<uint32_t>(levelCount) };
+    return TextureFile::HashBytes(description, sizeof(description));
+}
+
+// Level table of a width x height file, offsets after the header and table
+std::vector<TextureFileLevel> LayoutLevels(TextureFileFormat format, int width, int height, int levelCount)
+{
+    std::vector<TextureFileLevel> levels(levelCount);
+    uint64_t offset = AlignUp(sizeof(TextureFileHeader) + levelCount * sizeof(TextureFileLevel), kLevelAlignment);
+    for (int i = 0; i < levelCount; i++)
+    {
+        TextureFileLevel& level = levels[i];
+        level.width = static_cast<uint32_t>(std::max(1, width >> i));
+        level.height = static_cast<uint32_t>(std::max(1, height >> i));
+        level.pitch = static_cast<uint32_t>(TextureFile::GetLevelPitch(format, level.width));
+        level.rows = static_cast<uint32_t>(TextureFile::GetLevelRows(format, level.height));
+        level.size = static_cast<uint64_t>(level.pitch) * level.rows;
+        level.offset = offset;
+        offset = AlignUp(offset + level.size, kLevelAlignment);
+    }
+    return levels;
+}
+
+} // namespace
+
+TextureFile::TextureFile()
+    : m_format(TextureFileFormat::A8R8G8B8)
+    , m_width(0)
+    , m_height(0)
+    , m_contentHash(0)
+{
+}
+
+bool TextureFile::Open(const std::string& filename)
+{
+    Close();
+
+    if (!m_file.Open(filename))
+        return false;
+
+    TextureFileHeader header = {};
+    if (m_file.GetSize() >= sizeof(header))
+        memcpy(&header, m_file.GetData(), sizeof(header));
+
+    if (header.magic != kTextureFileMagic || header.version != kTextureFileVersion || !IsValidFormat(header.format) ||
+        header.width == 0 || header.height == 0 || header.width > 65536 || header.height > 65536 ||
+        header.levelCount == 0 ||
+        static_cast<int>(header.levelCount) > MipChain::CountLevels(header.width, header.height))
+    {
+        std::cerr << "Invalid texture file: " << filename << std::endl;
+        Close();
+        return false;
+    }
+
+    // The table must describe exactly the layout the writer produces, and
+    // every level must lie inside the file
+    TextureFileFormat format = static_cast<TextureFileFormat>(header.format);
+    std::vector<TextureFileLevel> expected = LayoutLevels(format, header.width, header.height, header.levelCount);
+    size_t tableEnd = sizeof(header) + expected.size() * sizeof(TextureFileLevel);
+    bool valid = tableEnd <= m_file.GetSize() && expected.back().offset + expected.back().size <= m_file.GetSize();
+    for (size_t i = 0; valid && i < expected.size(); i++)
+    {
+        TextureFileLevel level;
+        memcpy(&level, m_file.GetData() + sizeof(header) + i * sizeof(TextureFileLevel), sizeof(level));
+        valid = memcmp(&level, &expected[i], sizeof(level)) == 0;
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Damaged texture file: " << filename << std::endl;
+        Close();
+        return false;
+    }
+
+    m_filename = filename;
+    m_format = format;
+    m_width = static_cast<int>(header.width);
+    m_height = static_cast<int>(header.height);
+    m_contentHash = header.contentHash;
+    m_levels.swap(expected);
+    return true;
+}
+
+void TextureFile::Close()
+{
+    m_file.Close();
+    m_filename.clear();
+    m_format = TextureFileFormat::A8R8G8B8;
+    m_width = 0;
+    m_height = 0;
+    m_contentHash = 0;
+    m_levels.clear();
+}
+
+bool TextureFile::VerifyContentHash() const
+{
+    if (!IsOpen())
+        return false;
+
+    uint64_t hash = HashDescription(m_format, m_width, m_height, GetLevelCount());
+    for (int i = 0; i < GetLevelCount(); i++)
+    {
+        hash = HashBytes(GetLevelData(i), static_cast<size_t>(m_levels[i].size), hash);
+    }
+    return hash == m_contentHash;
+}
+
+bool TextureFile::Write(const std::string& filename, TextureFileFormat format, int width, int height,
+                        const TextureFileSource* levels, int levelCount)
+{
+    if (!IsValidFormat(static_cast<uint32_t>(format)) || width <= 0 || height <= 0 || width > 65536 ||
+        height > 65536 || !levels || levelCount <= 0 || levelCount > MipChain::CountLevels(width, height))
+    {
+        std::cerr << "Invalid texture file parameters!" << std::endl;
+        return false;
+    }
+
+    std::vector<TextureFileLevel> table = LayoutLevels(format, width, height, levelCount);
+
+    // Sources with padded rows are packed first, so each level is one range
+    std::vector<std::vector<uint8_t>> packed(levelCount);
+    std::vector<const uint8_t*> data(levelCount);
+    uint64_t hash = HashDescription(format, width, height, levelCount);
+    for (int i = 0; i < levelCount; i++)
+    {
+        const TextureFileLevel& level = table[i];
+        if (!levels[i].data || levels[i].pitch < static_cast<int>(level.pitch))
+        {
+            std::cerr << "Invalid texture file level " << i << "!" << std::endl;
+            return false;
+        }
+
+        const uint8_t* source = static_cast<const uint8_t*>(levels[i].data);
+        if (levels[i].pitch != static_cast<int>(level.pitch))
+        {
+            packed[i].resize(static_cast<size_t>(level.size));
+            for (uint32_t row = 0; row < level.rows; row++)
+            {
+                memcpy(packed[i].data() + static_cast<size_t>(row) * level.pitch,
+                       source + static_cast<size_t>(row) * levels[i].pitch, level.pitch);
+            }
+            source = packed[i].data();
+        }
+
+        data[i] = source;
+        hash = HashBytes(source, static_cast<size_t>(level.size), hash);
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Failed to open texture file for writing: " << filename << std::endl;
+        return false;
+    }
+
+    TextureFileHeader header = { kTextureFileMagic, kTextureFileVersion, static_cast<uint32_t>(format),
+                                 static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                                 static_cast<uint32_t>(levelCount), hash };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(TextureFileLevel));
+
+    uint64_t position = sizeof(header) + table.size() * sizeof(TextureFileLevel);
+    const char padding[kLevelAlignment] = {};
+    for (int i = 0; i < levelCount; i++)
+    {
+        file.write(padding, static_cast<std::streamsize>(table[i].offset - position));
+        file.write(reinterpret_cast<const char*>(data[i]), static_cast<std::streamsize>(table[i].size));
+        position = table[i].offset + table[i].size;
+    }
+
+    if (!file)
+    {
+        std::cerr << "Failed to write texture file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TextureFile::WriteMipChain(const std::string& filename, const MipChain& chain, TextureFileFormat format,
+                                BlockQuality quality)
+{
+    if (chain.IsEmpty())
+    {
+        std::cerr << "Empty mip chain!" << std::endl;
+        return false;
+    }
+
+    int levelCount = chain.GetLevelCount();
+    std::vector<TextureFileSource> sources(levelCount);
+    std::vector<std::vector<uint8_t>> blocks;
+
+    BlockFormat blockFormat;
+    bool compressed = IsBlockFormat(format, blockFormat);
+    if (compressed)
+        blocks.resize(levelCount);
+
+    for (int i = 0; i < levelCount; i++)
+    {
+        ImageView level = chain.GetLevel(i);
+        if (compressed)
+        {
+            blocks[i].resize(BlockCompressor::GetCompressedSize(blockFormat, level.width, level.height));
+            BlockCompressor::Compress(level, blockFormat, blocks[i].data(), 0, quality);
+            sources[i].data = blocks[i].data();
+            sources[i].pitch = GetLevelPitch(format, level.width);
+        }
+        else
+        {
+            sources[i].data = level.pixels;
+            sources[i].pitch = level.pitch * static_cast<int>(sizeof(D3DCOLOR));
+        }
+    }
+
+    ImageView top = chain.GetLevel(0);
+    return Write(filename, format, top.width, top.height, sources.data(), levelCount);
+}
+
+int TextureFile::GetLevelPitch(TextureFileFormat format, int width)
+{
+    BlockFormat blockFormat;
+    if (IsBlockFormat(format, blockFormat))
+        return (width + 3) / 4 * BlockCompressor::GetBlockSize(blockFormat);
+    return width * static_cast<int>(sizeof(D3DCOLOR));
+}
+
+int TextureFile::GetLevelRows(TextureFileFormat format, int height)
+{
+    BlockFormat blockFormat;
+    if (IsBlockFormat(format, blockFormat))
+        return (height + 3) / 4;
+    return height;
+}
+
+uint64_t TextureFile::HashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed ^ (size * 0x9E3779B97F4A7C15ull);
+
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; i++)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i * 8, 8);
+        hash ^= MixWord(word);
+        hash = RotateLeft(hash, 27) * 5 + 0x52DCE729;
+    }
+
+    size_t tail = size - words * 8;
+    if (tail > 0)
+    {
+        uint64_t word = 0;
+        memcpy(&word, bytes + words * 8, tail);
+        hash ^= MixWord(word);
+    }
+
+    // Final avalanche so every input bit affects every output bit
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+bool TextureFile::IsTextureFile(const std::string& filename)
+{
+    const std::string extension = ".etex";
+    if (filename.size() < extension.size())
+        return false;
+
+    return std::equal(extension.begin(), extension.end(), filename.end() - extension.size(), [](char a, char b) {
+        return a == std::tolower(static_cast<unsigned char>(b));
+    });
+}
+
+} // namespace TextureEffects
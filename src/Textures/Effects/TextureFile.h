@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BlockCompression.h"
+#include "MipChain.h"
+#include "../../Core/MappedFile.h"
+
+namespace TextureEffects {
+
+    // Pixel layouts a texture file can hold; each maps to one D3DFORMAT
+    enum class TextureFileFormat : uint32_t {
+        A8R8G8B8 = 1,
+        X8R8G8B8,
+        BC1,
+        BC3,
+        BC4,
+        BC5
+    };
+
+    // Where one level's rows start and how they are laid out. pitch is the
+    // byte distance between rows: rows of pixels for A8R8G8B8/X8R8G8B8,
+    // rows of 4x4 blocks for the BC formats.
+    struct TextureFileLevel {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t pitch = 0;
+        uint32_t rows = 0;
+    };
+
+    // First rows of one level to write; pitch in bytes
+    struct TextureFileSource {
+        const void* data = nullptr;
+        int pitch = 0;
+    };
+
+    // Engine texture container (.etex): a header, a table of levels and the
+    // levels' rows exactly as the GPU takes them, each level 16-byte aligned.
+    // Written by a bake step and read by memory-mapping the file, so loading
+    // copies each level once, straight into the locked texture. Little-endian.
+    class TextureFile {
+    public:
+        TextureFile();
+
+        // Maps the file and checks the header and level table against its
+        // size. Level data is not read until it is used.
+        bool Open(const std::string& filename);
+        void Close();
+
+        bool IsOpen() const { return m_file.IsOpen(); }
+        const std::string& GetFilename() const { return m_filename; }
+        TextureFileFormat GetFormat() const { return m_format; }
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        int GetLevelCount() const { return static_cast<int>(m_levels.size()); }
+        uint64_t GetContentHash() const { return m_contentHash; }
+        size_t GetFileSize() const { return m_file.GetSize(); }
+
+        const TextureFileLevel& GetLevel(int level) const { return m_levels[level]; }
+        const uint8_t* GetLevelData(int level) const { return m_file.GetData() + m_levels[level].offset; }
+
+        // Hashes every level again and compares with the stored hash
+        bool VerifyContentHash() const;
+
+        // Writes width x height with levels (one source per level, level i
+        // being max(1, size >> i)). Rows are packed in the file whatever the
+        // source pitch. Returns false on invalid arguments or I/O errors.
+        static bool Write(const std::string& filename, TextureFileFormat format, int width, int height,
+                          const TextureFileSource* levels, int levelCount);
+
+        // Bake step: writes every level of a mip chain, block-compressing
+        // them for the BC formats
+        static bool WriteMipChain(const std::string& filename, const MipChain& chain, TextureFileFormat format,
+                                  BlockQuality quality = BlockQuality::Fast);
+
+        // Bytes per row (of pixels or blocks) and row count of a level
+        static int GetLevelPitch(TextureFileFormat format, int width);
+        static int GetLevelRows(TextureFileFormat format, int height);
+
+        // 64-bit hash of a byte range; seed chains ranges together
+        static uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+        // True for the .etex extension
+        static bool IsTextureFile(const std::string& filename);
+
+    private:
+        MappedFile m_file;
+        std::string m_filename;
+        TextureFileFormat m_format;
+        int m_width;
+        int m_height;
+        uint64_t m_contentHash;
+        std::vector<TextureFileLevel> m_levels;
+    };
+
+}
@@ -0,0 +1,112 @@
+#include "TextureLod.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TextureEffects {
+
+float GetProjectedSize(float radius, float distance, float fovY, int viewportHeight)
+{
+    if (distance <= radius)
+        return static_cast<float>(viewportHeight);
+
+    // Tangent of the sphere's half angle against the half field of view
+    float halfAngle = radius / std::sqrt(distance * distance - radius * radius);
+    return viewportHeight * halfAngle / std::tan(fovY * 0.5f);
+}
+
+int SelectMipLevel(int width, int height, int levelCount, float screenSize, float bias)
+{
+    if (levelCount <= 1)
+        return 0;
+    if (!(screenSize > 0.0f))
+        return levelCount - 1;
+
+    // Coarsest level that still has a texel for every pixel
+    float ratio = static_cast<float>(std::max(width, height)) / screenSize;
+    float level = std::floor(std::log2(ratio) + bias);
+    return static_cast<int>(std::clamp(level, 0.0f, static_cast<float>(levelCount - 1)));
+}
+
+size_t GetLevelRangeBytes(TextureFileFormat format, int width, int height, int firstLevel, int levelCount)
+{
+    size_t bytes = 0;
+    for (int level = std::max(firstLevel, 0); level < levelCount; level++)
+    {
+        int levelWidth = std::max(1, width >> level);
+        int levelHeight = std::max(1, height >> level);
+        bytes += static_cast<size_t>(TextureFile::GetLevelPitch(format, levelWidth)) *
+                 TextureFile::GetLevelRows(format, levelHeight);
+    }
+    return bytes;
+}
+
+TextureLod::TextureLod()
+    : TextureLod(TextureFileFormat::A8R8G8B8, 1, 1, 1)
+{
+}
+
+TextureLod::TextureLod(TextureFileFormat format, int width, int height, int levelCount, int tailSize, int dropDelay)
+    : m_format(format)
+    , m_width(width)
+    , m_height(height)
+    , m_levelCount(std::max(levelCount, 1))
+    , m_tailLevel(0)
+    , m_dropDelay(std::max(dropDelay, 0))
+    , m_residentLevel(0)
+    , m_requestedLevel(0)
+    , m_framesCoarser(0)
+{
+    while (m_tailLevel < m_levelCount - 1 && std::max(width >> m_tailLevel, height >> m_tailLevel) > tailSize)
+    {
+        m_tailLevel++;
+    }
+
+    m_residentLevel = m_tailLevel;
+    m_requestedLevel = m_levelCount;
+}
+
+void TextureLod::Request(int level)
+{
+    m_requestedLevel = std::min(m_requestedLevel, ClampLevel(level));
+}
+
+void TextureLod::RequestSize(float screenSize, float bias)
+{
+    Request(SelectMipLevel(m_width, m_height, m_levelCount, screenSize, bias));
+}
+
+int TextureLod::Update()
+{
+    int wanted = std::min(m_requestedLevel, m_tailLevel);
+    m_requestedLevel = m_levelCount;
+
+    if (wanted <= m_residentLevel)
+    {
+        m_framesCoarser = 0;
+        return wanted;
+    }
+
+    if (++m_framesCoarser < m_dropDelay)
+        return m_residentLevel;
+
+    m_framesCoarser = 0;
+    return wanted;
+}
+
+void TextureLod::SetResidentLevel(int level)
+{
+    m_residentLevel = std::min(ClampLevel(level), m_tailLevel);
+    m_framesCoarser = 0;
+}
+
+size_t TextureLod::GetBytes(int firstLevel) const
+{
+    return GetLevelRangeBytes(m_format, m_width, m_height, ClampLevel(firstLevel), m_levelCount);
+}
+
+int TextureLod::ClampLevel(int level) const
+{
+    return std::clamp(level, 0, m_levelCount - 1);
+}
+
+} // namespace TextureEffects
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include "TextureFile.h"
+
+// Mip-tail-first texture streaming: which levels of a texture are worth
+// keeping for the size it covers on screen. Platform-neutral, so the
+// residency decisions run headless; TextureManager turns them into loads.
+
+namespace TextureEffects {
+
+    // Diameter in pixels of a bounding sphere radius units across, distance
+    // units from a perspective camera with vertical field of view fovY
+    // (radians), on a viewport viewportHeight pixels high. A camera inside
+    // the sphere gets the whole viewport.
+    float GetProjectedSize(float radius, float distance, float fovY, int viewportHeight);
+
+    // Finest level worth having for a width x height texture drawn
+    // screenSize pixels across: the coarsest whose larger side still covers
+    // screenSize. A positive bias picks coarser levels, a negative one
+    // finer. Clamped to [0, levelCount - 1].
+    int SelectMipLevel(int width, int height, int levelCount, float screenSize, float bias = 0.0f);
+
+    // Bytes of levels firstLevel to levelCount - 1 as stored in a .etex file
+    size_t GetLevelRangeBytes(TextureFileFormat format, int width, int height, int firstLevel, int levelCount);
+
+    // Residency of one texture, as the first (finest) level held. The mip
+    // tail, from the first level no larger than tailSize down, is always
+    // held. Request the level each draw needs during a frame, then Update
+    // once: finer levels are wanted at once, coarser ones only after
+    // dropDelay frames in a row without needing more, so a texture does not
+    // reload back and forth at a boundary. A texture nobody requests falls
+    // back to its tail.
+    class TextureLod {
+    public:
+        TextureLod();
+        TextureLod(TextureFileFormat format, int width, int height, int levelCount, int tailSize = 64,
+                   int dropDelay = 30);
+
+        TextureFileFormat GetFormat() const { return m_format; }
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        int GetLevelCount() const { return m_levelCount; }
+        int GetTailLevel() const { return m_tailLevel; }
+
+        // Finest level wanted this frame; the finest request wins
+        void Request(int level);
+        void RequestSize(float screenSize, float bias = 0.0f);
+        bool HasRequest() const { return m_requestedLevel < m_levelCount; }
+
+        // Ends the frame's requests and returns the first level that should
+        // be resident: the current one unless a load is due
+        int Update();
+
+        int GetResidentLevel() const { return m_residentLevel; }
+        void SetResidentLevel(int level);
+
+        size_t GetResidentBytes() const { return GetBytes(m_residentLevel); }
+        size_t GetBytes(int firstLevel) const;
+
+    private:
+        int ClampLevel(int level) const;
+
+        TextureFileFormat m_format;
+        int m_width;
+        int m_height;
+        int m_levelCount;
+        int m_tailLevel;
+        int m_dropDelay;
+        int m_residentLevel;
+        int m_requestedLevel;   // m_levelCount when nothing was requested
+        int m_framesCoarser;    // Frames in a row needing less than resident
+    };
+
+}
@@ -1,5 +1,5 @@
 #include "TextureUtils.h"
-#include "../Texture.h"
+#include "ColorSpace.h"
 #include <cmath>
 #include <algorithm>
 #include <random>
@@ -181,83 +181,69 @@ D3DXVECTOR2 Utils::Rotate2D(const D3DXVECTOR2& v, float angle)
 
 D3DXVECTOR3 Utils::RGBToHSV(D3DCOLOR color)
 {
-    float r = ((color >> 16) & 0xFF) / 255.0f;
-    float g = ((color >> 8) & 0xFF) / 255.0f;
-    float b = (color & 0xFF) / 255.0f;
-
-    float max_val = std::max({r, g, b});
-    float min_val = std::min({r, g, b});
-    float delta = max_val - min_val;
-
     D3DXVECTOR3 hsv;
-    hsv.z = max_val; // Value
-
-    if (max_val == 0.0f)
-    {
-        hsv.y = 0.0f; // Saturation
-    }
-    else
-    {
-        hsv.y = delta / max_val; // Saturation
-    }
-
-    if (delta == 0.0f)
-    {
-        hsv.x = 0.0f; // Hue
-    }
-    else
-    {
-        if (max_val == r)
-            hsv.x = 60.0f * fmodf((g - b) / delta, 6.0f);
-        else if (max_val == g)
-            hsv.x = 60.0f * ((b - r) / delta + 2.0f);
-        else
-            hsv.x = 60.0f * ((r - g) / delta + 4.0f);
-
-        if (hsv.x < 0.0f) hsv.x += 360.0f;
-    }
-
+    ColorSpace::RGBToHSV(&color, &hsv.x, &hsv.y, &hsv.z, 1);
     return hsv;
 }
 
 D3DCOLOR Utils::HSVToRGB(const D3DXVECTOR3& hsv)
 {
-    float c = hsv.z * hsv.y;
-    float x = c * (1.0f - fabsf(fmodf(hsv.x / 60.0f, 2.0f) - 1.0f));
-    float m = hsv.z - c;
-
-    float r, g, b;
-
-    if (hsv.x >= 0.0f && hsv.x < 60.0f)
-    {
-        r = c; g = x; b = 0.0f;
-    }
-    else if (hsv.x >= 60.0f && hsv.x < 120.0f)
-    {
-        r = x; g = c; b = 0.0f;
-    }
-    else if (hsv.x >= 120.0f && hsv.x < 180.0f)
-    {
-        r = 0.0f; g = c; b = x;
-    }
-    else if (hsv.x >= 180.0f && hsv.x < 240.0f)
-    {
-        r = 0.0f; g = x; b = c;
-    }
-    else if (hsv.x >= 240.0f && hsv.x < 300.0f)
-    {
-        r = x; g = 0.0f; b = c;
-    }
-    else
-    {
-        r = c; g = 0.0f; b = x;
-    }
-
-    BYTE nr = static_cast<BYTE>((r + m) * 255.0f);
-    BYTE ng = static_cast<BYTE>((g + m) * 255.0f);
-    BYTE nb = static_cast<BYTE>((b + m) * 255.0f);
-
-    return D3DCOLOR_ARGB(255, nr, ng, nb);
+    D3DCOLOR color = D3DCOLOR_ARGB(255, 0, 0, 0);
+    ColorSpace::HSVToRGB(&hsv.x, &hsv.y, &hsv.z, &color, 1);
+    return color;
+}
+
+D3DXVECTOR3 Utils::RGBToHSL(D3DCOLOR color)
+{
+    D3DXVECTOR3 hsl;
+    ColorSpace::RGBToHSL(&color, &hsl.x, &hsl.y, &hsl.z, 1);
+    return hsl;
+}
+
+D3DCOLOR Utils::HSLToRGB(const D3DXVECTOR3& hsl)
+{
+    D3DCOLOR color = D3DCOLOR_ARGB(255, 0, 0, 0);
+    ColorSpace::HSLToRGB(&hsl.x, &hsl.y, &hsl.z, &color, 1);
+    return color;
+}
+
+D3DXVECTOR3 Utils::RGBToLab(D3DCOLOR color)
+{
+    D3DXVECTOR3 lab;
+    ColorSpace::RGBToLab(&color, &lab.x, &lab.y, &lab.z, 1);
+    return lab;
+}
+
+D3DCOLOR Utils::LabToRGB(const D3DXVECTOR3& lab)
+{
+    D3DCOLOR color = D3DCOLOR_ARGB(255, 0, 0, 0);
+    ColorSpace::LabToRGB(&lab.x, &lab.y, &lab.z, &color, 1);
+    return color;
+}
+
+D3DCOLOR Utils::SRGBToLinear(D3DCOLOR color)
+{
+    float rgba[4];
+    ColorSpace::DecodeSRGB(&color, rgba, 1);
+
+    BYTE r = static_cast<BYTE>(rgba[0] * 255.0f + 0.5f);
+    BYTE g = static_cast<BYTE>(rgba[1] * 255.0f + 0.5f);
+    BYTE b = static_cast<BYTE>(rgba[2] * 255.0f + 0.5f);
+    return (color & 0xFF000000) | D3DCOLOR_ARGB(0, r, g, b);
+}
+
+D3DCOLOR Utils::LinearToSRGB(D3DCOLOR color)
+{
+    float rgba[4] = {
+        ((color >> 16) & 0xFF) / 255.0f,
+        ((color >> 8) & 0xFF) / 255.0f,
+        (color & 0xFF) / 255.0f,
+        ((color >> 24) & 0xFF) / 255.0f,
+    };
+
+    D3DCOLOR result;
+    ColorSpace::EncodeSRGB(rgba, &result, 1);
+    return result;
 }
 
 float Utils::GetLuminance(D3DCOLOR color)
@@ -269,12 +255,12 @@ float Utils::GetLuminance(D3DCOLOR color)
     return 0.299f * r + 0.587f * g + 0.114f * b;
 }
 
-D3DCOLOR Utils::SampleBilinear(std::shared_ptr<Texture> texture, float u, float v)
+D3DCOLOR Utils::SampleBilinear(const ImageView& image, float u, float v)
 {
-    if (!texture) return D3DCOLOR_ARGB(0, 0, 0, 0);
+    if (!image.IsValid()) return D3DCOLOR_ARGB(0, 0, 0, 0);
 
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    int width = image.width;
+    int height = image.height;
 
     float x = u * (width - 1);
     float y = v * (height - 1);
@@ -287,10 +273,10 @@ D3DCOLOR Utils::SampleBilinear(std::shared_ptr<Texture> texture, float u, float
     float fx = x - x0;
     float fy = y - y0;
 
-    D3DCOLOR c00 = GetPixelSafe(texture, x0, y0);
-    D3DCOLOR c01 = GetPixelSafe(texture, x0, y1);
-    D3DCOLOR c10 = GetPixelSafe(texture, x1, y0);
-    D3DCOLOR c11 = GetPixelSafe(texture, x1, y1);
+    D3DCOLOR c00 = GetPixelSafe(image, x0, y0);
+    D3DCOLOR c01 = GetPixelSafe(image, x0, y1);
+    D3DCOLOR c10 = GetPixelSafe(image, x1, y0);
+    D3DCOLOR c11 = GetPixelSafe(image, x1, y1);
 
     D3DCOLOR c0 = InterpolateColor(c00, c10, fx);
     D3DCOLOR c1 = InterpolateColor(c01, c11, fx);
@@ -370,26 +356,11 @@ float Utils::EaseInOutSine(float t)
 }
 
 // Helper functions
-D3DCOLOR Utils::GetPixelSafe(std::shared_ptr<Texture> texture, int x, int y)
+D3DCOLOR Utils::GetPixelSafe(const ImageView& image, int x, int y)
 {
-    if (!texture) return D3DCOLOR_ARGB(0, 0, 0, 0);
-
-    int width = texture->GetWidth();
-    int height = texture->GetHeight();
+    if (!image.IsValid()) return D3DCOLOR_ARGB(0, 0, 0, 0);
 
-    x = std::max(0, std::min(width - 1, x));
-    y = std::max(0, std::min(height - 1, y));
-
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return D3DCOLOR_ARGB(0, 0, 0, 0);
-
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
-    D3DCOLOR color = pixels[y * pitch + x];
-
-    texture->Unlock();
-    return color;
+    return image.GetClamped(x, y);
 }
 
 } // namespace TextureEffects
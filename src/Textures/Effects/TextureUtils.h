@@ -1,10 +1,11 @@
 #pragma once
 
-#include <d3d9.h>
-#include <d3dx9.h>
 #include <memory>
+#include "PixelBuffer.h"
+#include "Resampler.h"
 
 class Texture;
+struct IDirect3DDevice9;
 
 namespace TextureEffects {
 
@@ -56,17 +57,28 @@ namespace TextureEffects {
         // Texture utilities
         static bool CopyTexture(std::shared_ptr<Texture> source, std::shared_ptr<Texture> destination);
         static std::shared_ptr<Texture> CloneTexture(IDirect3DDevice9* device, std::shared_ptr<Texture> source);
-        static std::shared_ptr<Texture> ResizeTexture(IDirect3DDevice9* device, std::shared_ptr<Texture> source, int newWidth, int newHeight);
+        static std::shared_ptr<Texture> ResizeTexture(IDirect3DDevice9* device, std::shared_ptr<Texture> source, int newWidth, int newHeight,
+                                                     const ResampleOptions& options = ResampleOptions());
         static std::shared_ptr<Texture> CropTexture(IDirect3DDevice9* device, std::shared_ptr<Texture> source,
                                                    int x, int y, int width, int height);
 
         // Sampling utilities
+        static D3DCOLOR SampleNearest(const ImageView& image, float u, float v);
+        static D3DCOLOR SampleBilinear(const ImageView& image, float u, float v);
+        static D3DCOLOR SampleBicubic(const ImageView& image, float u, float v);
+
+        // Histogram and analysis
+        static void CalculateHistogram(const ImageView& image, int histogram[256], int channel = -1); // -1 for luminance
+        static float CalculateAverageLuminance(const ImageView& image);
+        static D3DCOLOR CalculateAverageColor(const ImageView& image);
+        static void GetMinMaxLuminance(const ImageView& image, float& minLum, float& maxLum);
+
+        // Texture versions (engine build): lock the top level and run the
+        // ImageView version above
         static D3DCOLOR SampleNearest(std::shared_ptr<Texture> texture, float u, float v);
         static D3DCOLOR SampleBilinear(std::shared_ptr<Texture> texture, float u, float v);
         static D3DCOLOR SampleBicubic(std::shared_ptr<Texture> texture, float u, float v);
-
-        // Histogram and analysis
-        static void CalculateHistogram(std::shared_ptr<Texture> texture, int histogram[256], int channel = -1); // -1 for luminance
+        static void CalculateHistogram(std::shared_ptr<Texture> texture, int histogram[256], int channel = -1);
         static float CalculateAverageLuminance(std::shared_ptr<Texture> texture);
         static D3DCOLOR CalculateAverageColor(std::shared_ptr<Texture> texture);
         static void GetMinMaxLuminance(std::shared_ptr<Texture> texture, float& minLum, float& maxLum);
@@ -97,7 +109,7 @@ namespace TextureEffects {
     private:
         // Internal helper functions
         static float CubicInterpolate(float a, float b, float c, float d, float t);
-        static D3DCOLOR GetPixelSafe(std::shared_ptr<Texture> texture, int x, int y);
+        static D3DCOLOR GetPixelSafe(const ImageView& image, int x, int y);
     };
 
 }
@@ -3,6 +3,7 @@
 #include "../Shaders/Effect.h"
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 
 Material::Material(const std::string& name)
     : m_name(name)
@@ -140,6 +141,11 @@ void Material::SetUVTransform(int stage, float offsetU, float offsetV, float sca
     }
 }
 
+void Material::SetAtlasRegion(int stage, const TextureEffects::AtlasRegion& region)
+{
+    SetUVTransform(stage, region.offsetU, region.offsetV, region.scaleU, region.scaleV);
+}
+
 void Material::UpdateAnimation(float deltaTime)
 {
     for (int i = 0; i < MAX_TEXTURE_STAGES; i++)
@@ -259,8 +265,29 @@ void Material::ApplyLayer(IDirect3DDevice9* device, int stage, const TextureLaye
     device->SetTextureStageState(stage, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
     device->SetTextureStageState(stage, D3DTSS_ALPHAARG2, stage == 0 ? D3DTA_DIFFUSE : D3DTA_CURRENT);
 
-    // UV Transform - esto requeriría matrices de transformación
-    // Por simplicidad, lo omitimos por ahora
+    // Transformación de UV: uv' = rotar(uv) * escala + desplazamiento
+    bool identity = layer.uvOffsetU == 0.0f && layer.uvOffsetV == 0.0f && layer.uvScaleU == 1.0f &&
+                    layer.uvScaleV == 1.0f && layer.uvRotation == 0.0f;
+    if (identity)
+    {
+        device->SetTextureStageState(stage, D3DTSS_TEXTURETRANSFORMFLAGS, D3DTTFF_DISABLE);
+        return;
+    }
+
+    // Con coordenadas 2D la traslación va en la tercera fila
+    float c = cosf(layer.uvRotation);
+    float s = sinf(layer.uvRotation);
+    D3DXMATRIX transform;
+    D3DXMatrixIdentity(&transform);
+    transform._11 = c * layer.uvScaleU;
+    transform._12 = s * layer.uvScaleV;
+    transform._21 = -s * layer.uvScaleU;
+    transform._22 = c * layer.uvScaleV;
+    transform._31 = layer.uvOffsetU;
+    transform._32 = layer.uvOffsetV;
+
+    device->SetTransform(static_cast<D3DTRANSFORMSTATETYPE>(D3DTS_TEXTURE0 + stage), &transform);
+    device->SetTextureStageState(stage, D3DTSS_TEXTURETRANSFORMFLAGS, D3DTTFF_COUNT2);
 }
 
 D3DTEXTUREOP Material::ConvertBlendMode(BlendMode mode) const
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <string>
 #include "TextureManager.h"  // Include for TextureType enum
+#include "Effects/TextureAtlas.h"
 
 class Texture;
 class Effect;
@@ -80,6 +81,8 @@ public:
 
     // UV manipulation
     void SetUVTransform(int stage, float offsetU, float offsetV, float scaleU, float scaleV, float rotation = 0.0f);
+    // Samples one image of an atlas texture (no rotation; the layer must not repeat)
+    void SetAtlasRegion(int stage, const TextureEffects::AtlasRegion& region);
     void SetUVOffset(int stage, float u, float v);
     void SetUVScale(int stage, float u, float v);
     void SetUVRotation(int stage, float rotation);
@@ -1,7 +1,10 @@
 #include "Texture.h"
 #include "../Core/Utils.h"
+#include <algorithm>
 #include <iostream>
 
+uint64_t Texture::s_currentFrame = 0;
+
 Texture::Texture()
     : m_device(nullptr)
     , m_texture(nullptr)
@@ -13,8 +16,11 @@ Texture::Texture()
     , m_depth(0)
     , m_format(D3DFMT_UNKNOWN)
     , m_mipLevels(0)
+    , m_lodLevel(0)
     , m_memoryUsage(0)
     , m_isLocked(false)
+    , m_isDynamic(false)
+    , m_lastUsedFrame(s_currentFrame)
 {
     memset(&m_animationData, 0, sizeof(m_animationData));
     m_animationData.scaleU = 1.0f;
@@ -34,6 +40,22 @@ bool Texture::CreateFromFile(IDirect3DDevice9* device, const std::string& filena
         return false;
     }
 
+    // Contenedor propio: se mapea en memoria en lugar de decodificarse
+    if (TextureEffects::TextureFile::IsTextureFile(filename))
+    {
+        TextureEffects::TextureFile file;
+        if (!file.Open(filename))
+        {
+            std::cerr << "Failed to load texture from file: " << filename << std::endl;
+            return false;
+        }
+        if (!CreateFromTextureFile(device, file, type))
+            return false;
+
+        std::cout << "Loaded texture: " << filename << " (" << m_width << "x" << m_height << ")" << std::endl;
+        return true;
+    }
+
     m_device = device;
     m_filename = filename;
     m_type = type;
@@ -92,6 +114,7 @@ bool Texture::CreateEmpty(IDirect3DDevice9* device, int width, int height, D3DFO
     m_height = height;
     m_format = format;
     m_mipLevels = (mipLevels == 0) ? 1 : mipLevels;
+    m_lodLevel = 0;
 
     HRESULT hr = device->CreateTexture(
         width,
@@ -110,7 +133,190 @@ bool Texture::CreateEmpty(IDirect3DDevice9* device, int width, int height, D3DFO
         return false;
     }
 
+    m_isDynamic = false;
+    CalculateMemoryUsage();
+    return true;
+}
+
+bool Texture::CreateDynamic(IDirect3DDevice9* device, int width, int height, D3DFORMAT format)
+{
+    if (!device)
+    {
+        std::cerr << "Invalid device pointer!" << std::endl;
+        return false;
+    }
+
+    m_device = device;
+    m_width = width;
+    m_height = height;
+    m_format = format;
+    m_mipLevels = 1;
+
+    // Textura dinámica en D3DPOOL_DEFAULT: se bloquea con D3DLOCK_DISCARD y el
+    // driver entrega memoria nueva en lugar de esperar a la GPU. Hay que
+    // recrearla tras un reset del dispositivo.
+    HRESULT hr = device->CreateTexture(
+        width,
+        height,
+        1,
+        D3DUSAGE_DYNAMIC,
+        format,
+        D3DPOOL_DEFAULT,
+        &m_texture,
+        nullptr
+    );
+
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create dynamic texture! (HRESULT: 0x" << std::hex << hr << ")" << std::endl;
+        return false;
+    }
+
+    m_isDynamic = true;
+    CalculateMemoryUsage();
+    return true;
+}
+
+bool Texture::MakeDynamic()
+{
+    if (!m_texture || m_cubeTexture || m_volumeTexture)
+        return false;
+
+    if (m_isDynamic)
+        return true;
+
+    Texture dynamic;
+    if (!dynamic.CreateDynamic(m_device, m_width, m_height, m_format))
+        return false;
+
+    // Conservar nombre y tipo: solo cambia el recurso
+    dynamic.m_filename = m_filename;
+    dynamic.m_type = m_type;
+    return Swap(dynamic);
+}
+
+void Texture::OnLostDevice()
+{
+    if (!m_isDynamic || !m_texture)
+        return;
+
+    // Se liberan solo los recursos; tamaño y formato quedan para recrearla
+    m_texture->Release();
+    m_texture = nullptr;
+}
+
+bool Texture::OnResetDevice()
+{
+    if (!m_isDynamic || m_texture)
+        return true;
+
+    return CreateDynamic(m_device, m_width, m_height, m_format);
+}
+
+bool Texture::CreateCubeMap(IDirect3DDevice9* device, const std::string& filename)
+{
+    if (!device)
+    {
+        std::cerr << "Invalid device pointer!" << std::endl;
+        return false;
+    }
+
+    m_device = device;
+    m_filename = filename;
+    m_type = TextureType::CUBE_MAP;
+
+    std::wstring wFilename = StringToWString(filename);
+    HRESULT hr = D3DXCreateCubeTextureFromFileExW(
+        device,
+        wFilename.c_str(),
+        D3DX_DEFAULT,          // size
+        D3DX_DEFAULT,          // mip levels
+        0,                     // usage
+        D3DFMT_FROM_FILE,      // format
+        D3DPOOL_MANAGED,       // pool
+        D3DX_DEFAULT,          // filter
+        D3DX_DEFAULT,          // mip filter
+        0,                     // color key
+        nullptr,               // src info
+        nullptr,               // palette
+        &m_cubeTexture
+    );
+
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to load cube map from file: " << filename << " (HRESULT: 0x"
+                  << std::hex << hr << ")" << std::endl;
+        return false;
+    }
+
+    D3DSURFACE_DESC desc;
+    m_cubeTexture->GetLevelDesc(0, &desc);
+
+    m_width = desc.Width;
+    m_height = desc.Height;
+    m_depth = 1;
+    m_format = desc.Format;
+    m_mipLevels = m_cubeTexture->GetLevelCount();
+    m_lodLevel = 0;
+
+    CalculateMemoryUsage();
+
+    std::cout << "Loaded cube map: " << filename << " (" << m_width << "x" << m_height << ")" << std::endl;
+    return true;
+}
+
+bool Texture::CreateVolumeTexture(IDirect3DDevice9* device, const std::string& filename)
+{
+    if (!device)
+    {
+        std::cerr << "Invalid device pointer!" << std::endl;
+        return false;
+    }
+
+    m_device = device;
+    m_filename = filename;
+    m_type = TextureType::VOLUME;
+
+    std::wstring wFilename = StringToWString(filename);
+    HRESULT hr = D3DXCreateVolumeTextureFromFileExW(
+        device,
+        wFilename.c_str(),
+        D3DX_DEFAULT,          // width
+        D3DX_DEFAULT,          // height
+        D3DX_DEFAULT,          // depth
+        D3DX_DEFAULT,          // mip levels
+        0,                     // usage
+        D3DFMT_FROM_FILE,      // format
+        D3DPOOL_MANAGED,       // pool
+        D3DX_DEFAULT,          // filter
+        D3DX_DEFAULT,          // mip filter
+        0,                     // color key
+        nullptr,               // src info
+        nullptr,               // palette
+        &m_volumeTexture
+    );
+
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to load volume texture from file: " << filename << " (HRESULT: 0x"
+                  << std::hex << hr << ")" << std::endl;
+        return false;
+    }
+
+    D3DVOLUME_DESC desc;
+    m_volumeTexture->GetLevelDesc(0, &desc);
+
+    m_width = desc.Width;
+    m_height = desc.Height;
+    m_depth = desc.Depth;
+    m_format = desc.Format;
+    m_mipLevels = m_volumeTexture->GetLevelCount();
+    m_lodLevel = 0;
+
     CalculateMemoryUsage();
+
+    std::cout << "Loaded volume texture: " << filename << " (" << m_width << "x" << m_height << "x" << m_depth
+              << ")" << std::endl;
     return true;
 }
 
@@ -119,6 +325,8 @@ void Texture::Bind(int stage) const
     if (!m_device)
         return;
 
+    m_lastUsedFrame = s_currentFrame;
+
     if (m_texture)
     {
         m_device->SetTexture(stage, m_texture);
@@ -165,15 +373,489 @@ void Texture::Unlock()
     }
 }
 
+bool Texture::LockImage(TextureEffects::ImageView& image, DWORD flags)
+{
+    // Los efectos solo trabajan con píxeles de 32 bits
+    TextureEffects::PixelFormat format;
+    if (m_format == D3DFMT_A8R8G8B8)
+        format = TextureEffects::PixelFormat::A8R8G8B8;
+    else if (m_format == D3DFMT_X8R8G8B8)
+        format = TextureEffects::PixelFormat::X8R8G8B8;
+    else
+        return false;
+
+    D3DLOCKED_RECT lockedRect;
+    if (!Lock(&lockedRect, nullptr, flags))
+        return false;
+
+    image = TextureEffects::ImageView(static_cast<D3DCOLOR*>(lockedRect.pBits), m_width, m_height,
+                                      lockedRect.Pitch / sizeof(D3DCOLOR), format);
+    return true;
+}
+
+bool Texture::Upload(const TextureEffects::ImageView& image, DWORD flags)
+{
+    if (image.width != m_width || image.height != m_height)
+        return false;
+
+    TextureEffects::ImageView target;
+    if (!LockImage(target, flags))
+        return false;
+
+    image.CopyTo(target);
+    Unlock();
+    return true;
+}
+
+bool Texture::Download(TextureEffects::PixelBuffer& buffer)
+{
+    TextureEffects::ImageView source;
+    if (!LockImage(source, D3DLOCK_READONLY))
+        return false;
+
+    bool allocated = buffer.Allocate(m_width, m_height, source.format);
+    if (allocated)
+    {
+        source.CopyTo(buffer.GetView());
+    }
+
+    Unlock();
+    return allocated;
+}
+
+bool Texture::UploadLevel(int level, const TextureEffects::ImageView& image)
+{
+    if (!m_texture || level < 0 || level >= static_cast<int>(m_texture->GetLevelCount()))
+        return false;
+    if (m_format != D3DFMT_A8R8G8B8 && m_format != D3DFMT_X8R8G8B8)
+        return false;
+
+    D3DSURFACE_DESC desc;
+    m_texture->GetLevelDesc(level, &desc);
+    if (image.width != static_cast<int>(desc.Width) || image.height != static_cast<int>(desc.Height))
+        return false;
+
+    D3DLOCKED_RECT lockedRect;
+    if (FAILED(m_texture->LockRect(level, &lockedRect, nullptr, 0)))
+        return false;
+
+    TextureEffects::PixelFormat format = m_format == D3DFMT_X8R8G8B8 ? TextureEffects::PixelFormat::X8R8G8B8
+                                                                      : TextureEffects::PixelFormat::A8R8G8B8;
+    TextureEffects::ImageView target(static_cast<D3DCOLOR*>(lockedRect.pBits), image.width, image.height,
+                                     lockedRect.Pitch / sizeof(D3DCOLOR), format);
+    image.CopyTo(target);
+    m_texture->UnlockRect(level);
+    return true;
+}
+
+bool Texture::CreateFromTextureFile(IDirect3DDevice9* device, const TextureEffects::TextureFile& file, TextureType type,
+                                    int firstLevel)
+{
+    if (!file.IsOpen())
+    {
+        std::cerr << "Texture file not open!" << std::endl;
+        return false;
+    }
+
+    if (firstLevel < 0 || firstLevel >= file.GetLevelCount())
+    {
+        std::cerr << "Invalid first mip level " << firstLevel << "!" << std::endl;
+        return false;
+    }
+
+    const TextureEffects::TextureFileLevel& top = file.GetLevel(firstLevel);
+    if (!CreateEmpty(device, top.width, top.height, GetD3DFormat(file.GetFormat()), file.GetLevelCount() - firstLevel))
+        return false;
+
+    m_filename = file.GetFilename();
+    m_type = type;
+    m_lodLevel = firstLevel;
+
+    for (int level = 0; level < m_mipLevels; level++)
+    {
+        D3DLOCKED_RECT lockedRect;
+        if (FAILED(m_texture->LockRect(level, &lockedRect, nullptr, 0)))
+        {
+            std::cerr << "Failed to lock mip level " << level << "!" << std::endl;
+            return false;
+        }
+
+        // Rows are packed in the file; one copy if the driver packs them too
+        const TextureEffects::TextureFileLevel& info = file.GetLevel(firstLevel + level);
+        const uint8_t* source = file.GetLevelData(firstLevel + level);
+        BYTE* destination = static_cast<BYTE*>(lockedRect.pBits);
+        if (lockedRect.Pitch == static_cast<INT>(info.pitch))
+        {
+            memcpy(destination, source, static_cast<size_t>(info.size));
+        }
+        else
+        {
+            for (uint32_t row = 0; row < info.rows; row++)
+            {
+                memcpy(destination + static_cast<size_t>(row) * lockedRect.Pitch,
+                       source + static_cast<size_t>(row) * info.pitch, info.pitch);
+            }
+        }
+
+        m_texture->UnlockRect(level);
+    }
+    return true;
+}
+
+bool Texture::CreateFromMipChain(IDirect3DDevice9* device, const TextureEffects::MipChain& chain, D3DFORMAT format)
+{
+    if (chain.IsEmpty())
+    {
+        std::cerr << "Empty mip chain!" << std::endl;
+        return false;
+    }
+
+    TextureEffects::ImageView top = chain.GetLevel(0);
+    if (!CreateEmpty(device, top.width, top.height, format, chain.GetLevelCount()))
+        return false;
+
+    for (int level = 0; level < chain.GetLevelCount(); level++)
+    {
+        if (!UploadLevel(level, chain.GetLevel(level)))
+        {
+            std::cerr << "Failed to upload mip level " << level << "!" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Texture::CreateFromMemory(IDirect3DDevice9* device, const void* data, size_t size, const std::string& filename,
+                               TextureType type)
+{
+    if (!device || !data || size == 0)
+    {
+        std::cerr << "Invalid texture data: " << filename << std::endl;
+        return false;
+    }
+
+    m_device = device;
+    m_filename = filename;
+    m_type = type;
+
+    HRESULT hr = D3DXCreateTextureFromFileInMemoryEx(
+        device,
+        data,
+        static_cast<UINT>(size),
+        D3DX_DEFAULT_NONPOW2,  // width
+        D3DX_DEFAULT_NONPOW2,  // height
+        D3DX_DEFAULT,          // mip levels
+        0,                     // usage
+        D3DFMT_FROM_FILE,      // format
+        D3DPOOL_MANAGED,       // pool
+        D3DX_DEFAULT,          // filter
+        D3DX_DEFAULT,          // mip filter
+        0,                     // color key
+        nullptr,               // src info
+        nullptr,               // palette
+        &m_texture
+    );
+
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to load texture from memory: " << filename << " (HRESULT: 0x"
+                  << std::hex << hr << ")" << std::endl;
+        return false;
+    }
+
+    D3DSURFACE_DESC desc;
+    m_texture->GetLevelDesc(0, &desc);
+
+    m_width = desc.Width;
+    m_height = desc.Height;
+    m_format = desc.Format;
+    m_mipLevels = m_texture->GetLevelCount();
+
+    CalculateMemoryUsage();
+    return true;
+}
+
+bool Texture::CreateReference(const Texture& source)
+{
+    if (!source.m_texture)
+    {
+        std::cerr << "Invalid source texture!" << std::endl;
+        return false;
+    }
+
+    Release();
+
+    m_device = source.m_device;
+    m_texture = source.m_texture;
+    m_texture->AddRef();
+    m_type = source.m_type;
+    m_width = source.m_width;
+    m_height = source.m_height;
+    m_format = source.m_format;
+    m_mipLevels = source.m_mipLevels;
+    m_lodLevel = source.m_lodLevel;
+    m_memoryUsage = 0; // Counted by the source
+    return true;
+}
+
+bool Texture::Swap(Texture& other)
+{
+    if (m_isLocked || other.m_isLocked)
+    {
+        std::cerr << "Cannot swap a locked texture!" << std::endl;
+        return false;
+    }
+
+    std::swap(m_device, other.m_device);
+    std::swap(m_texture, other.m_texture);
+    std::swap(m_cubeTexture, other.m_cubeTexture);
+    std::swap(m_volumeTexture, other.m_volumeTexture);
+    std::swap(m_filename, other.m_filename);
+    std::swap(m_type, other.m_type);
+    std::swap(m_width, other.m_width);
+    std::swap(m_height, other.m_height);
+    std::swap(m_depth, other.m_depth);
+    std::swap(m_format, other.m_format);
+    std::swap(m_mipLevels, other.m_mipLevels);
+    std::swap(m_lodLevel, other.m_lodLevel);
+    std::swap(m_memoryUsage, other.m_memoryUsage);
+    std::swap(m_isDynamic, other.m_isDynamic);
+    return true;
+}
+
+bool Texture::SaveToFile(const std::string& filename) const
+{
+    if (!m_texture)
+        return false;
+
+    if (!TextureEffects::TextureFile::IsTextureFile(filename))
+    {
+        D3DXIMAGE_FILEFORMAT fileFormat = D3DXIFF_DDS;
+        std::string extension = filename.substr(filename.find_last_of('.') + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == "png")
+            fileFormat = D3DXIFF_PNG;
+        else if (extension == "bmp")
+            fileFormat = D3DXIFF_BMP;
+        else if (extension == "jpg" || extension == "jpeg")
+            fileFormat = D3DXIFF_JPG;
+        else if (extension == "tga")
+            fileFormat = D3DXIFF_TGA;
+
+        std::wstring wFilename = StringToWString(filename);
+        return SUCCEEDED(D3DXSaveTextureToFileW(wFilename.c_str(), fileFormat, m_texture, nullptr));
+    }
+
+    TextureEffects::TextureFileFormat fileFormat;
+    if (!GetFileFormat(m_format, fileFormat))
+    {
+        std::cerr << "Texture format cannot be stored in a texture file!" << std::endl;
+        return false;
+    }
+
+    // Every level stays locked while the file is written
+    int levels = static_cast<int>(m_texture->GetLevelCount());
+    std::vector<TextureEffects::TextureFileSource> sources(levels);
+    int locked = 0;
+    for (; locked < levels; locked++)
+    {
+        D3DLOCKED_RECT lockedRect;
+        if (FAILED(m_texture->LockRect(locked, &lockedRect, nullptr, D3DLOCK_READONLY)))
+            break;
+        sources[locked].data = lockedRect.pBits;
+        sources[locked].pitch = lockedRect.Pitch;
+    }
+
+    bool saved = locked == levels &&
+                 TextureEffects::TextureFile::Write(filename, fileFormat, m_width, m_height, sources.data(), levels);
+
+    for (int level = 0; level < locked; level++)
+    {
+        m_texture->UnlockRect(level);
+    }
+    return saved;
+}
+
 bool Texture::GenerateMipmaps()
+{
+    return GenerateMipmaps(GetMipOptions());
+}
+
+bool Texture::GenerateMipmaps(const TextureEffects::MipOptions& options)
 {
     if (!m_texture)
         return false;
 
-    // DirectX 9 genera mipmaps automáticamente si se especifica D3DX_DEFAULT en mip levels
-    // Para texturas ya creadas, usamos D3DXFilterTexture
-    HRESULT hr = D3DXFilterTexture(m_texture, nullptr, D3DX_DEFAULT, D3DX_DEFAULT);
-    return SUCCEEDED(hr);
+    int levels = static_cast<int>(m_texture->GetLevelCount());
+    if (levels <= 1)
+        return true;
+
+    if (m_format != D3DFMT_A8R8G8B8 && m_format != D3DFMT_X8R8G8B8)
+    {
+        // Formats the CPU builder cannot write (compressed, 16-bit)
+        HRESULT hr = D3DXFilterTexture(m_texture, nullptr, D3DX_DEFAULT, D3DX_DEFAULT);
+        return SUCCEEDED(hr);
+    }
+
+    TextureEffects::PixelBuffer top;
+    if (!Download(top))
+        return false;
+
+    TextureEffects::MipOptions chainOptions = options;
+    chainOptions.maxLevels = levels;
+
+    TextureEffects::MipChain chain;
+    if (!chain.Build(top.GetView(), chainOptions))
+        return false;
+
+    for (int level = 1; level < chain.GetLevelCount(); level++)
+    {
+        if (!UploadLevel(level, chain.GetLevel(level)))
+            return false;
+    }
+    return true;
+}
+
+bool Texture::Compress(D3DFORMAT format, TextureEffects::BlockQuality quality)
+{
+    TextureEffects::BlockFormat blockFormat;
+    if (!GetBlockFormat(format, blockFormat))
+    {
+        std::cerr << "Unsupported block compression format!" << std::endl;
+        return false;
+    }
+
+    if (!m_texture || (m_format != D3DFMT_A8R8G8B8 && m_format != D3DFMT_X8R8G8B8))
+    {
+        std::cerr << "Only 32-bit textures can be block compressed!" << std::endl;
+        return false;
+    }
+
+    if (m_width % 4 != 0 || m_height % 4 != 0)
+    {
+        std::cerr << "Block compressed textures need sizes that are multiples of 4!" << std::endl;
+        return false;
+    }
+
+    // Top level from the texture, smaller levels rebuilt as GenerateMipmaps does
+    TextureEffects::PixelBuffer top;
+    if (!Download(top))
+        return false;
+
+    TextureEffects::MipOptions options = GetMipOptions();
+    options.maxLevels = static_cast<int>(m_texture->GetLevelCount());
+
+    TextureEffects::MipChain chain;
+    if (!chain.Build(top.GetView(), options))
+        return false;
+
+    IDirect3DTexture9* compressed = nullptr;
+    HRESULT hr = m_device->CreateTexture(m_width, m_height, chain.GetLevelCount(), 0, format, D3DPOOL_MANAGED,
+                                         &compressed, nullptr);
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create compressed texture! (HRESULT: 0x" << std::hex << hr << ")" << std::endl;
+        return false;
+    }
+
+    // Blocks are encoded straight into each locked level
+    for (int level = 0; level < chain.GetLevelCount(); level++)
+    {
+        D3DLOCKED_RECT lockedRect;
+        if (FAILED(compressed->LockRect(level, &lockedRect, nullptr, 0)))
+        {
+            compressed->Release();
+            return false;
+        }
+
+        TextureEffects::BlockCompressor::Compress(chain.GetLevel(level), blockFormat, lockedRect.pBits,
+                                                  lockedRect.Pitch, quality);
+        compressed->UnlockRect(level);
+    }
+
+    m_texture->Release();
+    m_texture = compressed;
+    m_format = format;
+    m_mipLevels = chain.GetLevelCount();
+    CalculateMemoryUsage();
+    return true;
+}
+
+bool Texture::GetBlockFormat(D3DFORMAT format, TextureEffects::BlockFormat& blockFormat)
+{
+    switch (format)
+    {
+    case D3DFMT_DXT1:
+        blockFormat = TextureEffects::BlockFormat::BC1;
+        return true;
+    case D3DFMT_DXT5:
+        blockFormat = TextureEffects::BlockFormat::BC3;
+        return true;
+    default:
+        break;
+    }
+
+    // FOURCC formats, not part of the D3DFORMAT enumeration
+    if (format == D3DFMT_ATI1)
+    {
+        blockFormat = TextureEffects::BlockFormat::BC4;
+        return true;
+    }
+    if (format == D3DFMT_ATI2)
+    {
+        blockFormat = TextureEffects::BlockFormat::BC5;
+        return true;
+    }
+    return false;
+}
+
+bool Texture::GetFileFormat(D3DFORMAT format, TextureEffects::TextureFileFormat& fileFormat)
+{
+    TextureEffects::BlockFormat blockFormat;
+    if (GetBlockFormat(format, blockFormat))
+    {
+        switch (blockFormat)
+        {
+        case TextureEffects::BlockFormat::BC1: fileFormat = TextureEffects::TextureFileFormat::BC1; break;
+        case TextureEffects::BlockFormat::BC3: fileFormat = TextureEffects::TextureFileFormat::BC3; break;
+        case TextureEffects::BlockFormat::BC4: fileFormat = TextureEffects::TextureFileFormat::BC4; break;
+        case TextureEffects::BlockFormat::BC5: fileFormat = TextureEffects::TextureFileFormat::BC5; break;
+        }
+        return true;
+    }
+
+    switch (format)
+    {
+    case D3DFMT_A8R8G8B8:
+        fileFormat = TextureEffects::TextureFileFormat::A8R8G8B8;
+        return true;
+    case D3DFMT_X8R8G8B8:
+        fileFormat = TextureEffects::TextureFileFormat::X8R8G8B8;
+        return true;
+    default:
+        return false;
+    }
+}
+
+D3DFORMAT Texture::GetD3DFormat(TextureEffects::TextureFileFormat fileFormat)
+{
+    switch (fileFormat)
+    {
+    case TextureEffects::TextureFileFormat::X8R8G8B8: return D3DFMT_X8R8G8B8;
+    case TextureEffects::TextureFileFormat::BC1:      return D3DFMT_DXT1;
+    case TextureEffects::TextureFileFormat::BC3:      return D3DFMT_DXT5;
+    case TextureEffects::TextureFileFormat::BC4:      return D3DFMT_ATI1;
+    case TextureEffects::TextureFileFormat::BC5:      return D3DFMT_ATI2;
+    default:                                          return D3DFMT_A8R8G8B8;
+    }
+}
+
+TextureEffects::MipOptions Texture::GetMipOptions() const
+{
+    TextureEffects::MipOptions options;
+    options.normalMap = m_type == TextureType::NORMAL;
+    options.srgb = m_type == TextureType::DIFFUSE || m_type == TextureType::EMISSION;
+    return options;
 }
 
 void Texture::SetFilter(TextureFilter filter)
@@ -237,52 +919,97 @@ void Texture::Release()
 
     m_device = nullptr;
     m_isLocked = false;
+    m_isDynamic = false;
 }
 
 void Texture::CalculateMemoryUsage()
 {
-    if (!m_texture)
+    m_memoryUsage = 0;
+    for (int level = 0; level < m_mipLevels; level++)
     {
-        m_memoryUsage = 0;
-        return;
+        m_memoryUsage += GetLevelMemoryUsage(level);
     }
+}
+
+size_t Texture::GetLevelMemoryUsage(int level) const
+{
+    if (!IsValid() || level < 0 || level >= m_mipLevels)
+        return 0;
+
+    int width = std::max(1, m_width >> level);
+    int height = std::max(1, m_height >> level);
+    int slices = m_volumeTexture ? std::max(1, m_depth >> level) : 1;
+    return GetSurfaceSize(m_format, width, height) * slices * GetFaceCount();
+}
 
-    // Cálculo aproximado del uso de memoria
-    int bytesPerPixel = 4; // Asumimos ARGB por defecto
+size_t Texture::GetSurfaceSize(D3DFORMAT format, int width, int height)
+{
+    // Formatos por bloques de 4x4: filas de bloques
+    size_t blockBytes = 0;
+    if (format == D3DFMT_DXT1 || format == D3DFMT_ATI1)
+        blockBytes = 8;
+    else if (format == D3DFMT_DXT2 || format == D3DFMT_DXT3 || format == D3DFMT_DXT4 || format == D3DFMT_DXT5 ||
+             format == D3DFMT_ATI2)
+        blockBytes = 16;
 
-    switch (m_format)
+    if (blockBytes > 0)
     {
-    case D3DFMT_R5G6B5:
-    case D3DFMT_X1R5G5B5:
-    case D3DFMT_A1R5G5B5:
-        bytesPerPixel = 2;
+        size_t blocksWide = std::max(1, (width + 3) / 4);
+        size_t blocksHigh = std::max(1, (height + 3) / 4);
+        return blocksWide * blocksHigh * blockBytes;
+    }
+
+    int bitsPerPixel;
+    switch (format)
+    {
+    case D3DFMT_A32B32G32R32F:
+        bitsPerPixel = 128;
         break;
-    case D3DFMT_R8G8B8:
-        bytesPerPixel = 3;
+    case D3DFMT_A16B16G16R16:
+    case D3DFMT_A16B16G16R16F:
+    case D3DFMT_G32R32F:
+    case D3DFMT_Q16W16V16U16:
+        bitsPerPixel = 64;
         break;
-    case D3DFMT_A8R8G8B8:
-    case D3DFMT_X8R8G8B8:
-        bytesPerPixel = 4;
+    case D3DFMT_R8G8B8:
+        bitsPerPixel = 24;
         break;
-    case D3DFMT_DXT1:
-        bytesPerPixel = 1; // Comprimido
+    case D3DFMT_R5G6B5:
+    case D3DFMT_X1R5G5B5:
+    case D3DFMT_A1R5G5B5:
+    case D3DFMT_A4R4G4B4:
+    case D3DFMT_X4R4G4B4:
+    case D3DFMT_A8R3G3B2:
+    case D3DFMT_A8L8:
+    case D3DFMT_A8P8:
+    case D3DFMT_L16:
+    case D3DFMT_R16F:
+    case D3DFMT_V8U8:
+    case D3DFMT_L6V5U5:
+    case D3DFMT_UYVY:
+    case D3DFMT_YUY2:
+    case D3DFMT_R8G8_B8G8:
+    case D3DFMT_G8R8_G8B8:
+        bitsPerPixel = 16;
         break;
-    case D3DFMT_DXT3:
-    case D3DFMT_DXT5:
-        bytesPerPixel = 1; // Comprimido
+    case D3DFMT_A8:
+    case D3DFMT_L8:
+    case D3DFMT_P8:
+    case D3DFMT_R3G3B2:
+    case D3DFMT_A4L4:
+        bitsPerPixel = 8;
         break;
     default:
-        bytesPerPixel = 4;
+        // A8R8G8B8, X8R8G8B8, G16R16, R32F, ... y los desconocidos
+        bitsPerPixel = 32;
         break;
     }
 
-    m_memoryUsage = m_width * m_height * bytesPerPixel;
+    // Los formatos empaquetados de 2x1 (UYVY, R8G8_B8G8...) van por pares
+    if (format == D3DFMT_UYVY || format == D3DFMT_YUY2 || format == D3DFMT_R8G8_B8G8 || format == D3DFMT_G8R8_G8B8)
+        width = (width + 1) & ~1;
 
-    // Añadir memoria de mipmaps (aproximadamente 1/3 adicional)
-    if (m_mipLevels > 1)
-    {
-        m_memoryUsage = static_cast<size_t>(m_memoryUsage * 1.33f);
-    }
+    return static_cast<size_t>(width) * height * bitsPerPixel / 8;
 }
 
 D3DTEXTUREFILTERTYPE Texture::ConvertFilter(TextureFilter filter) const
@@ -4,6 +4,10 @@
 #include <d3dx9.h>
 #include <string>
 #include "TextureManager.h"
+#include "Effects/BlockCompression.h"
+#include "Effects/MipChain.h"
+#include "Effects/PixelBuffer.h"
+#include "Effects/TextureFile.h"
 
 class Texture {
 public:
@@ -13,12 +17,42 @@ public:
     // Creation
     bool CreateFromFile(IDirect3DDevice9* device, const std::string& filename, TextureType type);
     bool CreateEmpty(IDirect3DDevice9* device, int width, int height, D3DFORMAT format, int mipLevels = 1);
+    bool CreateDynamic(IDirect3DDevice9* device, int width, int height, D3DFORMAT format);
     bool CreateCubeMap(IDirect3DDevice9* device, const std::string& filename);
     bool CreateVolumeTexture(IDirect3DDevice9* device, const std::string& filename);
 
-    // Binding
+    // Baked .etex container: every level is copied from the mapped file
+    // straight into the locked texture. CreateFromFile picks this for .etex.
+    // firstLevel > 0 skips the finest levels (LOD streaming): the texture is
+    // the file's level firstLevel and the smaller ones.
+    bool CreateFromTextureFile(IDirect3DDevice9* device, const TextureEffects::TextureFile& file, TextureType type,
+                               int firstLevel = 0);
+
+    // Texture with one level per level of the chain (A8R8G8B8/X8R8G8B8)
+    bool CreateFromMipChain(IDirect3DDevice9* device, const TextureEffects::MipChain& chain,
+                            D3DFORMAT format = D3DFMT_A8R8G8B8);
+
+    // Image file already read into memory (any format D3DX reads), decoded
+    // here; filename is only recorded. Used by asynchronous loads.
+    bool CreateFromMemory(IDirect3DDevice9* device, const void* data, size_t size, const std::string& filename,
+                          TextureType type);
+
+    // Shares source's texture (one more reference) without counting its
+    // memory again, e.g. one placeholder standing in for many textures
+    bool CreateReference(const Texture& source);
+
+    // Exchanges the GPU resources and their description with other, so
+    // everyone holding this Texture sees the new contents. The animation
+    // data and last use stay. Fails if either is locked.
+    bool Swap(Texture& other);
+
+    // Binding. Bind stamps the texture with the current frame, which
+    // TextureManager uses to evict the least recently used textures.
     void Bind(int stage = 0) const;
     void Unbind(int stage = 0) const;
+    uint64_t GetLastUsedFrame() const { return m_lastUsedFrame; }
+    static void SetCurrentFrame(uint64_t frame) { s_currentFrame = frame; }
+    static uint64_t GetCurrentFrame() { return s_currentFrame; }
 
     // Properties
     IDirect3DTexture9* GetD3DTexture() const { return m_texture; }
@@ -32,13 +66,52 @@ public:
     int GetDepth() const { return m_depth; }
     D3DFORMAT GetFormat() const { return m_format; }
     int GetMipLevels() const { return m_mipLevels; }
-    size_t GetMemoryUsage() const { return m_memoryUsage; }
+    int GetLodLevel() const { return m_lodLevel; } // Source level the top level came from
+    size_t GetMemoryUsage() const { return m_memoryUsage; } // Every level, face and slice; 0 for references
+    size_t GetLevelMemoryUsage(int level) const;                // One level, all its faces and slices
+    int GetFaceCount() const { return m_cubeTexture ? 6 : 1; }
+
+    // Bytes of one width x height surface in format: rows of 4x4 blocks for
+    // DXT1-5 and ATI1/ATI2, packed pixels otherwise (unknown formats count
+    // as 32 bits per pixel)
+    static size_t GetSurfaceSize(D3DFORMAT format, int width, int height);
+    bool IsDynamic() const { return m_isDynamic; }
+
+    // Replaces a 2D texture with a dynamic one of the same size and format
+    // (top level only), in place for everyone holding it. For textures
+    // rewritten every frame, which then lock with D3DLOCK_DISCARD.
+    bool MakeDynamic();
+
+    // Dynamic textures live in D3DPOOL_DEFAULT: OnLostDevice releases them
+    // before IDirect3DDevice9::Reset and OnResetDevice recreates them, with
+    // undefined contents, afterwards. Other textures ignore both.
+    void OnLostDevice();
+    bool OnResetDevice();
 
     // Texture operations
     bool Lock(D3DLOCKED_RECT* lockedRect, const RECT* rect = nullptr, DWORD flags = 0);
     void Unlock();
+
+    // CPU image access for the effects library (A8R8G8B8/X8R8G8B8 only).
+    // LockImage maps the top level as a view; call Unlock when done.
+    bool LockImage(TextureEffects::ImageView& image, DWORD flags = 0);
+    bool Upload(const TextureEffects::ImageView& image, DWORD flags = 0);
+    bool Download(TextureEffects::PixelBuffer& buffer);
+    bool UploadLevel(int level, const TextureEffects::ImageView& image);
+    // .etex writes every level as stored (32-bit or DXT1/DXT5/ATI1/ATI2);
+    // other extensions go through D3DX
     bool SaveToFile(const std::string& filename) const;
+
+    // Rebuilds the levels below the top one on the CPU (32-bit formats) with
+    // options matching the texture type: sRGB for diffuse and emission,
+    // renormalized normals for normal maps. Other formats use D3DX.
     bool GenerateMipmaps();
+    bool GenerateMipmaps(const TextureEffects::MipOptions& options);
+
+    // Replaces a 32-bit texture with a block-compressed copy (DXT1, DXT5,
+    // ATI1, ATI2), every level encoded on the CPU. Sizes must be multiples
+    // of 4. The levels are rebuilt from the top one as GenerateMipmaps does.
+    bool Compress(D3DFORMAT format, TextureEffects::BlockQuality quality = TextureEffects::BlockQuality::Fast);
 
     // Data access
     bool GetPixelData(std::vector<DWORD>& data) const;
@@ -72,6 +145,10 @@ public:
 
 private:
     void CalculateMemoryUsage();
+    TextureEffects::MipOptions GetMipOptions() const;
+    static bool GetBlockFormat(D3DFORMAT format, TextureEffects::BlockFormat& blockFormat);
+    static bool GetFileFormat(D3DFORMAT format, TextureEffects::TextureFileFormat& fileFormat);
+    static D3DFORMAT GetD3DFormat(TextureEffects::TextureFileFormat fileFormat);
     D3DTEXTUREFILTERTYPE ConvertFilter(TextureFilter filter) const;
     D3DTEXTUREADDRESS ConvertWrap(TextureWrap wrap) const;
 
@@ -87,8 +164,13 @@ private:
     int m_depth;
     D3DFORMAT m_format;
     int m_mipLevels;
+    int m_lodLevel;
     size_t m_memoryUsage;
 
     bool m_isLocked;
+    bool m_isDynamic;
     AnimationData m_animationData;
+    mutable uint64_t m_lastUsedFrame;
+
+    static uint64_t s_currentFrame;
 };
@@ -8,6 +8,7 @@
 #include "Effects/AnimatedEffects.h"
 #include "Effects/UVEffects.h"
 #include "Effects/PostEffects.h"
+#include "Effects/PostEffectChain.h"
 #include "Effects/TextureUtils.h"
 #include "Effects/TextureEffectManager.h"
 
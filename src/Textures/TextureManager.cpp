@@ -1,15 +1,92 @@
 #include "TextureManager.h"
 #include "Texture.h"
+#include "Material.h"
+#include "Effects/NoiseCore.h"
+#include "Effects/ProceduralTextures.h"
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+// Lo que un worker prepara para una carga asíncrona: los .etex se mapean y
+// se comprueban, el resto se lee entero para que D3DX lo decodifique
+struct AsyncTextureLoad {
+    std::string filename;
+    TextureEffects::TextureFile file;
+    std::vector<uint8_t> data;
+    std::shared_ptr<TextureEffects::TextureLod> lod; // Solo la cola de mips si no es nulo
+    int tailSize = 0;
+
+    int GetFirstLevel() const { return lod ? lod->GetTailLevel() : 0; }
+
+    bool Read(size_t& uploadBytes)
+    {
+        if (TextureEffects::TextureFile::IsTextureFile(filename))
+        {
+            // El hash toca todas las páginas, así el commit copia desde memoria
+            if (!file.Open(filename) || !file.VerifyContentHash())
+                return false;
+
+            if (lod)
+            {
+                *lod = TextureEffects::TextureLod(file.GetFormat(), file.GetWidth(), file.GetHeight(),
+                                                  file.GetLevelCount(), tailSize);
+            }
+
+            uploadBytes = 0;
+            for (int i = GetFirstLevel(); i < file.GetLevelCount(); i++)
+            {
+                uploadBytes += static_cast<size_t>(file.GetLevel(i).size);
+            }
+            return true;
+        }
+
+        std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+        if (!stream)
+            return false;
+
+        data.resize(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        if (data.empty() || !stream.read(reinterpret_cast<char*>(data.data()), data.size()))
+            return false;
+
+        // Tamaño decodificado según la cabecera (D3DX no necesita el device)
+        D3DXIMAGE_INFO info;
+        if (FAILED(D3DXGetImageInfoFromFileInMemory(data.data(), static_cast<UINT>(data.size()), &info)))
+            return false;
+
+        uploadBytes = static_cast<size_t>(info.Width) * info.Height * 4;
+        return true;
+    }
+};
+
+// Lee un byte por página, en el hilo de carga, para que el commit copie
+// desde memoria sin esperar al disco
+void TouchPages(const uint8_t* data, size_t size)
+{
+    volatile uint8_t sink = 0;
+    for (size_t offset = 0; offset < size; offset += 4096)
+    {
+        sink = data[offset];
+    }
+    (void)sink;
+}
+
+} // namespace
 
 TextureManager::TextureManager()
     : m_device(nullptr)
+    , m_uploadBudget(4 * 1024 * 1024)
+    , m_lodStreaming(true)
+    , m_lodTailSize(64)
+    , m_frame(0)
     , m_defaultFilter(TextureFilter::LINEAR)
     , m_defaultWrap(TextureWrap::REPEAT)
     , m_anisotropyLevel(4)
     , m_mipMapBias(0.0f)
-    , m_poolSize(100)
+    , m_poolSize(256 * 1024 * 1024)
     , m_totalMemoryUsage(0)
 {
 }
@@ -29,6 +106,11 @@ bool TextureManager::Initialize(IDirect3DDevice9* device)
 
     m_device = device;
 
+    // Las texturas generadas se guardan horneadas entre ejecuciones
+    if (!m_bakeCache.IsEnabled())
+        m_bakeCache.SetDirectory("cache/textures");
+    TextureEffects::ProceduralTextures::SetBakeCache(&m_bakeCache);
+
     std::cout << "TextureManager initialized successfully!" << std::endl;
     return true;
 }
@@ -36,6 +118,10 @@ bool TextureManager::Initialize(IDirect3DDevice9* device)
 void TextureManager::Shutdown()
 {
     UnloadAllTextures();
+    m_placeholder.reset();
+
+    if (TextureEffects::ProceduralTextures::GetBakeCache() == &m_bakeCache)
+        TextureEffects::ProceduralTextures::SetBakeCache(nullptr);
     m_device = nullptr;
 }
 
@@ -47,34 +133,453 @@ std::shared_ptr<Texture> TextureManager::LoadTexture(const std::string& filename
     auto it = m_textures.find(key);
     if (it != m_textures.end())
     {
+        m_residencyStats.hits++;
+        auto pending = m_pendingLoads.find(key);
+        if (pending == m_pendingLoads.end())
+            return it->second;
+
+        // Aún en streaming: se carga aquí, en la misma textura que ya se repartió
+        m_streaming.Cancel(pending->second.handle);
+        m_streaming.Forget(pending->second.handle);
+        m_pendingLoads.erase(pending);
+
+        Texture loaded;
+        bool created = UsesLod(filename) ? CreateLodTexture(key, filename, type, loaded)
+                                         : loaded.CreateFromFile(m_device, filename, type);
+        if (!created || !it->second->Swap(loaded))
+        {
+            std::cerr << "Failed to load texture: " << filename << std::endl;
+            m_textures.erase(it);
+            m_reloaders.erase(key);
+            ForgetLod(key);
+            return nullptr;
+        }
         return it->second;
     }
 
     // Crear nueva textura
+    RecordMiss(key);
     auto texture = std::make_shared<Texture>();
-    if (!texture->CreateFromFile(m_device, filename, type))
+    bool created = UsesLod(filename) ? CreateLodTexture(key, filename, type, *texture)
+                                     : texture->CreateFromFile(m_device, filename, type);
+    if (!created)
     {
         std::cerr << "Failed to load texture: " << filename << std::endl;
+        ForgetLod(key);
         return nullptr;
     }
 
     // Almacenar en cache
-    m_textures[key] = texture;
+    AddResident(key, texture, [this, filename, type]() { return LoadTexture(filename, type); });
 
     std::cout << "Loaded texture: " << filename << " (Type: " << static_cast<int>(type) << ")" << std::endl;
     return texture;
 }
 
+std::shared_ptr<Texture> TextureManager::LoadCubeTexture(const std::string& filename)
+{
+    std::string key = GetTextureKey(filename, TextureType::CUBE_MAP);
+
+    auto it = m_textures.find(key);
+    if (it != m_textures.end())
+    {
+        m_residencyStats.hits++;
+        return it->second;
+    }
+
+    RecordMiss(key);
+    auto texture = std::make_shared<Texture>();
+    if (!texture->CreateCubeMap(m_device, filename))
+    {
+        std::cerr << "Failed to load cube texture: " << filename << std::endl;
+        return nullptr;
+    }
+
+    AddResident(key, texture, [this, filename]() { return LoadCubeTexture(filename); });
+    return texture;
+}
+
+std::shared_ptr<Texture> TextureManager::LoadVolumeTexture(const std::string& filename)
+{
+    std::string key = GetTextureKey(filename, TextureType::VOLUME);
+
+    auto it = m_textures.find(key);
+    if (it != m_textures.end())
+    {
+        m_residencyStats.hits++;
+        return it->second;
+    }
+
+    RecordMiss(key);
+    auto texture = std::make_shared<Texture>();
+    if (!texture->CreateVolumeTexture(m_device, filename))
+    {
+        std::cerr << "Failed to load volume texture: " << filename << std::endl;
+        return nullptr;
+    }
+
+    AddResident(key, texture, [this, filename]() { return LoadVolumeTexture(filename); });
+    return texture;
+}
+
+std::shared_ptr<Texture> TextureManager::LoadTextureAsync(const std::string& filename, TextureType type, int priority)
+{
+    std::string key = GetTextureKey(filename, type);
+
+    auto it = m_textures.find(key);
+    if (it != m_textures.end())
+    {
+        m_residencyStats.hits++;
+        return it->second;
+    }
+
+    // Placeholder compartido hasta que la carga se confirme
+    RecordMiss(key);
+    auto placeholder = GetPlaceholder();
+    auto texture = std::make_shared<Texture>();
+    if (!placeholder || !texture->CreateReference(*placeholder))
+    {
+        std::cerr << "Failed to create placeholder for texture: " << filename << std::endl;
+        return nullptr;
+    }
+
+    auto load = std::make_shared<AsyncTextureLoad>();
+    load->filename = filename;
+    if (UsesLod(filename))
+    {
+        load->lod = std::make_shared<TextureEffects::TextureLod>();
+        load->tailSize = m_lodTailSize;
+    }
+
+    TextureEffects::StreamRequest request;
+    request.priority = priority;
+    request.load = [load](size_t& uploadBytes) { return load->Read(uploadBytes); };
+
+    // En el hilo de render: crear la textura y cambiarla por el placeholder.
+    // Si ya nadie la usa no se crea.
+    IDirect3DDevice9* device = m_device;
+    std::weak_ptr<Texture> target = texture;
+    request.commit = [load, target, device, type]() {
+        auto destination = target.lock();
+        if (!destination)
+            return false;
+
+        Texture loaded;
+        bool created = load->file.IsOpen()
+            ? loaded.CreateFromTextureFile(device, load->file, type, load->GetFirstLevel())
+            : loaded.CreateFromMemory(device, load->data.data(), load->data.size(), load->filename, type);
+        return created && destination->Swap(loaded);
+    };
+
+    PendingLoad pending;
+    pending.handle = m_streaming.Submit(std::move(request));
+    pending.filename = filename;
+    pending.type = type;
+    pending.lod = load->lod;
+    if (load->lod)
+        pending.file = std::shared_ptr<const TextureEffects::TextureFile>(load, &load->file);
+    m_pendingLoads[key] = pending;
+    AddResident(key, texture, [this, filename, type, priority]() { return LoadTextureAsync(filename, type, priority); });
+
+    return texture;
+}
+
+bool TextureManager::SetLoadPriority(const std::string& filename, TextureType type, int priority)
+{
+    auto it = m_pendingLoads.find(GetTextureKey(filename, type));
+    return it != m_pendingLoads.end() && m_streaming.SetPriority(it->second.handle, priority);
+}
+
+bool TextureManager::CancelLoad(const std::string& filename, TextureType type)
+{
+    std::string key = GetTextureKey(filename, type);
+    auto it = m_pendingLoads.find(key);
+    if (it == m_pendingLoads.end())
+        return false;
+
+    m_streaming.Cancel(it->second.handle);
+    m_streaming.Forget(it->second.handle);
+    m_pendingLoads.erase(it);
+    m_textures.erase(key);
+    m_reloaders.erase(key);
+
+    std::cout << "Cancelled texture load: " << filename << std::endl;
+    return true;
+}
+
+bool TextureManager::IsLoading(const std::string& filename, TextureType type) const
+{
+    return m_pendingLoads.find(GetTextureKey(filename, type)) != m_pendingLoads.end();
+}
+
+void TextureManager::BeginFrame()
+{
+    Texture::SetCurrentFrame(++m_frame);
+
+    UpdateLods();
+    UpdateStreaming();
+    CleanupUnusedTextures();
+}
+
+void TextureManager::UpdateStreaming()
+{
+    if (m_pendingLoads.empty() && m_streaming.GetPendingCount() == 0)
+        return;
+
+    m_streaming.Update(m_uploadBudget);
+    CollectFinishedLoads();
+}
+
+void TextureManager::WaitForPendingLoads()
+{
+    m_streaming.Flush();
+    CollectFinishedLoads();
+}
+
+void TextureManager::PreloadTextures(const std::vector<std::string>& filenames)
+{
+    for (const std::string& filename : filenames)
+    {
+        LoadTextureAsync(filename);
+    }
+    WaitForPendingLoads();
+}
+
+void TextureManager::CollectFinishedLoads()
+{
+    for (auto it = m_pendingLoads.begin(); it != m_pendingLoads.end();)
+    {
+        TextureEffects::StreamState state = m_streaming.GetState(it->second.handle);
+        if (state == TextureEffects::StreamState::Committed)
+        {
+            std::cout << "Loaded texture: " << it->second.filename << std::endl;
+            if (it->second.lod)
+            {
+                ForgetLod(it->first);
+                m_lods[it->first] = LodTexture{ *it->second.lod, it->second.filename, it->second.type, m_frame,
+                                                it->second.file->GetContentHash() };
+            }
+        }
+        else if (state == TextureEffects::StreamState::Failed)
+        {
+            // Quien la tenga se queda con el placeholder
+            std::cerr << "Failed to load texture: " << it->second.filename << std::endl;
+            m_textures.erase(it->first);
+            m_reloaders.erase(it->first);
+        }
+        else
+        {
+            ++it;
+            continue;
+        }
+
+        m_streaming.Forget(it->second.handle);
+        it = m_pendingLoads.erase(it);
+    }
+}
+
+void TextureManager::CancelAllLoads()
+{
+    for (const auto& pair : m_pendingLoads)
+    {
+        m_streaming.Cancel(pair.second.handle);
+        m_streaming.Forget(pair.second.handle);
+    }
+    m_pendingLoads.clear();
+
+    for (auto& pair : m_lods)
+    {
+        if (pair.second.handle != 0)
+        {
+            m_streaming.Cancel(pair.second.handle);
+            m_streaming.Forget(pair.second.handle);
+            pair.second.handle = 0;
+        }
+    }
+}
+
+void TextureManager::SetLodStreaming(bool enabled, int tailSize)
+{
+    // Solo afecta a las texturas que se carguen a partir de ahora
+    m_lodStreaming = enabled;
+    m_lodTailSize = std::max(tailSize, 1);
+}
+
+void TextureManager::RequestTextureSize(const Texture& texture, float screenSize)
+{
+    if (m_lods.empty())
+        return;
+
+    auto it = m_lods.find(GetTextureKey(texture.GetFilename(), texture.GetType()));
+    if (it != m_lods.end())
+    {
+        it->second.lod.RequestSize(screenSize, m_mipMapBias);
+    }
+}
+
+void TextureManager::RequestMaterialSize(const Material& material, float screenSize)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        const TextureLayer& layer = material.GetTextureLayer(i);
+        if (!layer.enabled || !layer.texture)
+            continue;
+
+        // Una textura que se repite cubre menos pantalla por repetición
+        float tiling = std::max(std::fabs(layer.uvScaleU), std::fabs(layer.uvScaleV));
+        RequestTextureSize(*layer.texture, tiling > 1.0f ? screenSize / tiling : screenSize);
+    }
+}
+
+bool TextureManager::UsesLod(const std::string& filename) const
+{
+    return m_lodStreaming && TextureEffects::TextureFile::IsTextureFile(filename);
+}
+
+bool TextureManager::CreateLodTexture(const std::string& key, const std::string& filename, TextureType type,
+                                      Texture& texture)
+{
+    // El hash se comprueba aquí una vez; los cambios de nivel confían en él
+    TextureEffects::TextureFile file;
+    if (!file.Open(filename) || !file.VerifyContentHash())
+        return false;
+
+    // Solo la cola de mips; los niveles finos llegan con RequestTextureSize
+    TextureEffects::TextureLod lod(file.GetFormat(), file.GetWidth(), file.GetHeight(), file.GetLevelCount(),
+                                   m_lodTailSize);
+    if (!texture.CreateFromTextureFile(m_device, file, type, lod.GetTailLevel()))
+        return false;
+
+    ForgetLod(key);
+    m_lods[key] = LodTexture{ lod, filename, type, m_frame, file.GetContentHash() };
+    return true;
+}
+
+void TextureManager::UpdateLods()
+{
+    for (auto it = m_lods.begin(); it != m_lods.end();)
+    {
+        LodTexture& entry = it->second;
+        if (entry.handle != 0)
+        {
+            TextureEffects::StreamState state = m_streaming.GetState(entry.handle);
+            if (state == TextureEffects::StreamState::Queued || state == TextureEffects::StreamState::Loading ||
+                state == TextureEffects::StreamState::Loaded)
+            {
+                ++it;
+                continue;
+            }
+
+            m_streaming.Forget(entry.handle);
+            entry.handle = 0;
+            if (state == TextureEffects::StreamState::Failed)
+            {
+                // Se queda con los niveles que tiene
+                std::cerr << "Failed to stream texture levels: " << entry.filename << std::endl;
+                it = m_lods.erase(it);
+                continue;
+            }
+            if (state == TextureEffects::StreamState::Committed)
+                entry.lod.SetResidentLevel(entry.loadingLevel);
+        }
+
+        auto texture = m_textures.find(it->first);
+        if (texture == m_textures.end())
+        {
+            ++it;
+            continue;
+        }
+
+        // Enlazada el último frame sin que nadie diera su tamaño: todos los niveles
+        uint64_t lastUsed = texture->second->GetLastUsedFrame();
+        if (!entry.lod.HasRequest() && lastUsed > entry.createdFrame && lastUsed + 1 >= m_frame)
+            entry.lod.Request(0);
+
+        int level = entry.lod.Update();
+        if (level != entry.lod.GetResidentLevel())
+        {
+            auto file = std::make_shared<TextureEffects::TextureFile>();
+            std::string filename = entry.filename;
+            size_t bytes = entry.lod.GetBytes(level);
+            uint64_t contentHash = entry.contentHash;
+
+            TextureEffects::StreamRequest request;
+            // Primero lo que más detalle gana; soltar niveles no corre prisa
+            request.priority = entry.lod.GetResidentLevel() - level;
+            request.load = [file, filename, bytes, contentHash, level](size_t& uploadBytes) {
+                // Hasheado ya al abrirlo la primera vez: basta con que sea el
+                // mismo archivo, y solo se leen los niveles que se suben
+                if (!file->Open(filename) || file->GetContentHash() != contentHash || level >= file->GetLevelCount())
+                    return false;
+
+                const TextureEffects::TextureFileLevel& last = file->GetLevel(file->GetLevelCount() - 1);
+                uint64_t first = file->GetLevel(level).offset;
+                TouchPages(file->GetLevelData(level), static_cast<size_t>(last.offset + last.size - first));
+
+                uploadBytes = bytes;
+                return true;
+            };
+
+            IDirect3DDevice9* device = m_device;
+            std::weak_ptr<Texture> target = texture->second;
+            TextureType type = entry.type;
+            request.commit = [file, target, device, type, level]() {
+                auto destination = target.lock();
+                if (!destination)
+                    return false;
+
+                Texture loaded;
+                return loaded.CreateFromTextureFile(device, *file, type, level) && destination->Swap(loaded);
+            };
+
+            entry.handle = m_streaming.Submit(std::move(request));
+            entry.loadingLevel = level;
+        }
+        ++it;
+    }
+}
+
+void TextureManager::ForgetLod(const std::string& key)
+{
+    auto it = m_lods.find(key);
+    if (it == m_lods.end())
+        return;
+
+    if (it->second.handle != 0)
+    {
+        m_streaming.Cancel(it->second.handle);
+        m_streaming.Forget(it->second.handle);
+    }
+    m_lods.erase(it);
+}
+
+std::shared_ptr<Texture> TextureManager::GetPlaceholder()
+{
+    if (!m_placeholder)
+    {
+        const int size = 128;
+        auto placeholder = std::make_shared<Texture>();
+        if (!placeholder->CreateEmpty(m_device, size, size, D3DFMT_A8R8G8B8))
+            return nullptr;
+
+        CreateCheckerboardPattern(placeholder, size, size);
+        m_placeholder = placeholder;
+    }
+    return m_placeholder;
+}
+
 std::shared_ptr<Texture> TextureManager::CreateProceduralTexture(const std::string& name, int width, int height, D3DFORMAT format)
 {
     // Verificar si ya existe
     auto it = m_textures.find(name);
     if (it != m_textures.end())
     {
+        m_residencyStats.hits++;
         return it->second;
     }
 
     // Crear textura vacía
+    RecordMiss(name);
     auto texture = std::make_shared<Texture>();
     if (!texture->CreateEmpty(m_device, width, height, format))
     {
@@ -85,8 +590,9 @@ std::shared_ptr<Texture> TextureManager::CreateProceduralTexture(const std::stri
     // Llenar con patrón de ajedrez simple
     CreateCheckerboardPattern(texture, width, height);
 
-    // Almacenar
-    m_textures[name] = texture;
+    // Almacenar sin recarga: quien la pide la rellena después, y volver a
+    // crearla solo devolvería el ajedrez, así que no se expulsa
+    AddResident(name, texture, nullptr);
 
     std::cout << "Created procedural texture: " << name << " (" << width << "x" << height << ")" << std::endl;
     return texture;
@@ -98,27 +604,73 @@ std::shared_ptr<Texture> TextureManager::CreateNoiseTexture(const std::string& n
     auto it = m_textures.find(name);
     if (it != m_textures.end())
     {
+        m_residencyStats.hits++;
         return it->second;
     }
 
-    // Crear textura vacía
-    auto texture = std::make_shared<Texture>();
-    if (!texture->CreateEmpty(m_device, width, height, D3DFMT_A8R8G8B8))
+    // Generar ruido, o mapearlo de la caché si ya se horneó con estos parámetros
+    TextureEffects::BakeKey key("manager_noise", TextureEffects::ProceduralTextures::kBakeVersion, width, height);
+    key.Add(frequency).Add(octaves);
+    RecordMiss(name);
+    auto texture = TextureEffects::ProceduralTextures::CreateBaked(m_device, key,
+        [&](const TextureEffects::ImageView& image) { CreateNoisePattern(image, frequency, octaves); });
+    if (!texture)
     {
         std::cerr << "Failed to create noise texture: " << name << std::endl;
         return nullptr;
     }
 
-    // Generar ruido
-    CreateNoisePattern(texture, width, height, frequency, octaves);
-
     // Almacenar
-    m_textures[name] = texture;
+    AddResident(name, texture, [this, name, width, height, frequency, octaves]() {
+        return CreateNoiseTexture(name, width, height, frequency, octaves);
+    });
 
     std::cout << "Created noise texture: " << name << " (" << width << "x" << height << ")" << std::endl;
     return texture;
 }
 
+std::shared_ptr<Texture> TextureManager::CreateAtlasTexture(const std::string& name,
+                                                            std::shared_ptr<const TextureEffects::TextureAtlas> atlas)
+{
+    auto it = m_textures.find(name);
+    if (it != m_textures.end())
+    {
+        m_residencyStats.hits++;
+        return it->second;
+    }
+
+    if (!atlas || atlas->GetLevelCount() == 0)
+    {
+        std::cerr << "Atlas not built: " << name << std::endl;
+        return nullptr;
+    }
+
+    // Los niveles ya vienen hechos: cada uno con sus bordes extendidos
+    RecordMiss(name);
+    auto texture = std::make_shared<Texture>();
+    if (!texture->CreateEmpty(m_device, atlas->GetWidth(), atlas->GetHeight(), D3DFMT_A8R8G8B8,
+                              atlas->GetLevelCount()))
+    {
+        std::cerr << "Failed to create atlas texture: " << name << std::endl;
+        return nullptr;
+    }
+
+    for (int level = 0; level < atlas->GetLevelCount(); level++)
+    {
+        if (!texture->UploadLevel(level, atlas->GetLevel(level)))
+        {
+            std::cerr << "Failed to upload atlas level " << level << ": " << name << std::endl;
+            return nullptr;
+        }
+    }
+
+    AddResident(name, texture, [this, name, atlas]() { return CreateAtlasTexture(name, atlas); });
+
+    std::cout << "Created atlas texture: " << name << " (" << atlas->GetWidth() << "x" << atlas->GetHeight()
+              << ", " << atlas->GetImageCount() << " images)" << std::endl;
+    return texture;
+}
+
 void TextureManager::CreateCheckerboardPattern(std::shared_ptr<Texture> texture, int width, int height)
 {
     D3DLOCKED_RECT lockedRect;
@@ -144,55 +696,130 @@ void TextureManager::CreateCheckerboardPattern(std::shared_ptr<Texture> texture,
     texture->Unlock();
 }
 
-void TextureManager::CreateNoisePattern(std::shared_ptr<Texture> texture, int width, int height, float frequency, int octaves)
+void TextureManager::CreateNoisePattern(const TextureEffects::ImageView& image, float frequency, int octaves)
 {
-    D3DLOCKED_RECT lockedRect;
-    if (!texture->Lock(&lockedRect))
-        return;
+    // Ruido fractal evaluado por filas completas
+    TextureEffects::NoiseParams noiseParams;
+    noiseParams.frequency = frequency;
+    noiseParams.octaves = octaves;
 
-    DWORD* pixels = static_cast<DWORD*>(lockedRect.pBits);
-    int pitch = lockedRect.Pitch / sizeof(DWORD);
+    const int width = image.width;
+    const int height = image.height;
+    const int bandRows = 64;
+    std::vector<float> band(static_cast<size_t>(width) * bandRows);
+    float dx = 1.0f / width;
+    float dy = 1.0f / height;
 
-    for (int y = 0; y < height; y++)
+    for (int y0 = 0; y0 < height; y0 += bandRows)
     {
-        for (int x = 0; x < width; x++)
-        {
-            // Noise simple usando funciones trigonométricas
-            float fx = static_cast<float>(x) / width * frequency;
-            float fy = static_cast<float>(y) / height * frequency;
+        int rows = std::min(bandRows, height - y0);
+        TextureEffects::NoiseCore::Default().EvaluateGrid(noiseParams, 0.0f, static_cast<float>(y0) * dy, dx, dy,
+                                                          width, rows, band.data(), width);
 
-            float noise = 0.0f;
-            float amplitude = 1.0f;
+        for (int row = 0; row < rows; row++)
+        {
+            const float* noise = band.data() + static_cast<size_t>(row) * width;
+            D3DCOLOR* dst = image.Row(y0 + row);
 
-            for (int i = 0; i < octaves; i++)
+            for (int x = 0; x < width; x++)
             {
-                noise += sin(fx * 6.28f) * cos(fy * 6.28f) * amplitude;
-                fx *= 2.0f;
-                fy *= 2.0f;
-                amplitude *= 0.5f;
+                BYTE intensity = static_cast<BYTE>(noise[x] * 255);
+                dst[x] = D3DCOLOR_ARGB(255, intensity, intensity, intensity);
             }
+        }
+    }
+}
 
-            // Normalizar a [0, 1]
-            noise = (noise + 1.0f) * 0.5f;
-            noise = std::max(0.0f, std::min(1.0f, noise));
+bool TextureManager::SetBakeCacheDirectory(const std::string& directory)
+{
+    return m_bakeCache.SetDirectory(directory);
+}
 
-            BYTE intensity = static_cast<BYTE>(noise * 255);
-            pixels[y * pitch + x] = D3DCOLOR_ARGB(255, intensity, intensity, intensity);
-        }
+bool TextureManager::SaveTexture(const std::shared_ptr<Texture>& texture, const std::string& filename)
+{
+    if (!texture || !texture->SaveToFile(filename))
+    {
+        std::cerr << "Failed to save texture: " << filename << std::endl;
+        return false;
     }
 
-    texture->Unlock();
+    std::cout << "Saved texture: " << filename << std::endl;
+    return true;
+}
+
+bool TextureManager::CompressTexture(const std::string& name, D3DFORMAT compressedFormat,
+                                     TextureEffects::BlockQuality quality)
+{
+    auto texture = GetTexture(name);
+    if (!texture)
+    {
+        std::cerr << "Texture not found: " << name << std::endl;
+        return false;
+    }
+
+    size_t before = texture->GetMemoryUsage();
+    if (!texture->Compress(compressedFormat, quality))
+    {
+        std::cerr << "Failed to compress texture: " << name << std::endl;
+        return false;
+    }
+
+    // Recargarla o cambiarle el nivel de LOD desde el archivo perdería la
+    // compresión: se queda residente con los niveles que tiene
+    m_reloaders.erase(name);
+    ForgetLod(name);
+
+    std::cout << "Compressed texture: " << name << " (" << before / 1024 << " KB -> "
+              << texture->GetMemoryUsage() / 1024 << " KB)" << std::endl;
+    return true;
+}
+
+bool TextureManager::GenerateMipmaps(const std::string& name)
+{
+    auto texture = GetTexture(name);
+    if (!texture)
+    {
+        std::cerr << "Texture not found: " << name << std::endl;
+        return false;
+    }
+
+    if (!texture->GenerateMipmaps())
+    {
+        std::cerr << "Failed to generate mipmaps: " << name << std::endl;
+        return false;
+    }
+
+    // Igual que al comprimir: los niveles nuevos no se recuperan recargando
+    // ni desde el archivo del LOD
+    m_reloaders.erase(name);
+    ForgetLod(name);
+    return true;
 }
 
 std::shared_ptr<Texture> TextureManager::GetTexture(const std::string& name)
 {
     auto it = m_textures.find(name);
-    return (it != m_textures.end()) ? it->second : nullptr;
+    if (it != m_textures.end())
+    {
+        m_residencyStats.hits++;
+        return it->second;
+    }
+
+    // Expulsada por el presupuesto: se vuelve a crear igual que la primera vez
+    auto reload = m_reloaders.find(name);
+    if (reload != m_reloaders.end())
+    {
+        ReloadFunc func = reload->second;
+        return func();
+    }
+
+    m_residencyStats.misses++;
+    return nullptr;
 }
 
 bool TextureManager::HasTexture(const std::string& name) const
 {
-    return m_textures.find(name) != m_textures.end();
+    return m_textures.find(name) != m_textures.end() || m_reloaders.find(name) != m_reloaders.end();
 }
 
 void TextureManager::UnloadTexture(const std::string& name)
@@ -200,15 +827,29 @@ void TextureManager::UnloadTexture(const std::string& name)
     auto it = m_textures.find(name);
     if (it != m_textures.end())
     {
+        auto pending = m_pendingLoads.find(name);
+        if (pending != m_pendingLoads.end())
+        {
+            m_streaming.Cancel(pending->second.handle);
+            m_streaming.Forget(pending->second.handle);
+            m_pendingLoads.erase(pending);
+        }
+
         m_textures.erase(it);
         std::cout << "Unloaded texture: " << name << std::endl;
     }
+    m_reloaders.erase(name);
+    ForgetLod(name);
 }
 
 void TextureManager::UnloadAllTextures()
 {
+    CancelAllLoads();
+
     size_t count = m_textures.size();
     m_textures.clear();
+    m_reloaders.clear();
+    m_lods.clear();
 
     if (count > 0)
     {
@@ -216,6 +857,11 @@ void TextureManager::UnloadAllTextures()
     }
 }
 
+void TextureManager::SetMipMapBias(float bias)
+{
+    m_mipMapBias = bias;
+}
+
 void TextureManager::BindTextures(const std::vector<std::shared_ptr<Texture>>& textures, int startStage)
 {
     for (size_t i = 0; i < textures.size() && (startStage + i) < 8; i++)
@@ -256,6 +902,7 @@ std::vector<TextureInfo> TextureManager::GetLoadedTextures() const
         info.type = pair.second->GetType();
         info.width = pair.second->GetWidth();
         info.height = pair.second->GetHeight();
+        info.mipLevels = pair.second->GetMipLevels();
         info.format = pair.second->GetFormat();
         info.memoryUsage = pair.second->GetMemoryUsage();
         infos.push_back(info);
@@ -264,6 +911,168 @@ std::vector<TextureInfo> TextureManager::GetLoadedTextures() const
     return infos;
 }
 
+TextureMemoryReport TextureManager::GetMemoryReport(const std::vector<std::shared_ptr<Material>>& materials) const
+{
+    TextureMemoryReport report;
+    for (const auto& pair : m_textures)
+    {
+        const Texture& texture = *pair.second;
+        int type = static_cast<int>(texture.GetType());
+        if (type >= 0 && type < static_cast<int>(TextureType::COUNT))
+        {
+            report.byType[type].bytes += texture.GetMemoryUsage();
+            report.byType[type].count++;
+        }
+        report.totalBytes += texture.GetMemoryUsage();
+        report.textureCount++;
+    }
+
+    // Texturas de cada material, sin repetir, y cuántos materiales usan cada una
+    std::vector<std::vector<const Texture*>> materialTextures;
+    std::unordered_map<const Texture*, int> users;
+    for (const auto& material : materials)
+    {
+        std::vector<const Texture*> textures;
+        for (int i = 0; material && i < 8; i++)
+        {
+            const Texture* texture = material->GetTextureLayer(i).texture.get();
+            if (texture && std::find(textures.begin(), textures.end(), texture) == textures.end())
+            {
+                textures.push_back(texture);
+                users[texture]++;
+            }
+        }
+        materialTextures.push_back(textures);
+    }
+
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        TextureMemoryReport::MaterialGroup group;
+        group.name = materials[i] ? materials[i]->GetName() : std::string();
+        for (const Texture* texture : materialTextures[i])
+        {
+            group.bytes += texture->GetMemoryUsage();
+            if (users[texture] == 1)
+                group.uniqueBytes += texture->GetMemoryUsage();
+            group.count++;
+        }
+        report.byMaterial.push_back(group);
+    }
+
+    for (const auto& pair : m_textures)
+    {
+        if (users.find(pair.second.get()) == users.end())
+        {
+            report.unreferenced.bytes += pair.second->GetMemoryUsage();
+            report.unreferenced.count++;
+        }
+    }
+    return report;
+}
+
+void TextureManager::PrintMemoryReport(const std::vector<std::shared_ptr<Material>>& materials) const
+{
+    static const char* typeNames[] = { "Diffuse", "Normal", "Specular", "Metallic", "Roughness",
+                                       "Ambient occlusion", "Emission", "Displacement", "Cube map", "Volume" };
+    static_assert(sizeof(typeNames) / sizeof(typeNames[0]) == static_cast<size_t>(TextureType::COUNT),
+                  "One name per texture type");
+    const double kilobyte = 1024.0;
+
+    TextureMemoryReport report = GetMemoryReport(materials);
+    std::cout << "=== Texture Memory ===" << std::endl;
+    std::cout << report.textureCount << " textures, " << report.totalBytes / kilobyte << " KB (budget "
+              << m_poolSize / kilobyte << " KB)" << std::endl;
+
+    std::cout << "[By type]" << std::endl;
+    for (int i = 0; i < static_cast<int>(TextureType::COUNT); i++)
+    {
+        if (report.byType[i].count > 0)
+        {
+            std::cout << "  " << typeNames[i] << ": " << report.byType[i].count << " textures, "
+                      << report.byType[i].bytes / kilobyte << " KB" << std::endl;
+        }
+    }
+
+    if (!report.byMaterial.empty())
+    {
+        std::cout << "[By material]" << std::endl;
+        for (const auto& group : report.byMaterial)
+        {
+            std::cout << "  " << group.name << ": " << group.count << " textures, " << group.bytes / kilobyte
+                      << " KB (" << group.uniqueBytes / kilobyte << " KB its own)" << std::endl;
+        }
+        std::cout << "  (no material): " << report.unreferenced.count << " textures, "
+                  << report.unreferenced.bytes / kilobyte << " KB" << std::endl;
+    }
+}
+
+TextureResidencyStats TextureManager::GetResidencyStats() const
+{
+    TextureResidencyStats stats = m_residencyStats;
+    stats.residentBytes = GetTotalMemoryUsage();
+    stats.residentCount = m_textures.size();
+    stats.evictedCount = 0;
+    for (const auto& pair : m_reloaders)
+    {
+        if (m_textures.find(pair.first) == m_textures.end())
+            stats.evictedCount++;
+    }
+    stats.budgetBytes = m_poolSize;
+    return stats;
+}
+
+void TextureManager::CleanupUnusedTextures()
+{
+    size_t resident = GetTotalMemoryUsage();
+    if (resident <= m_poolSize)
+        return;
+
+    // Candidatas: solo las tiene el manager, se pueden recrear, no están
+    // cargándose y no se usaron en este frame; primero las que hace más
+    // tiempo que no se enlazan
+    std::vector<std::pair<uint64_t, std::string>> candidates;
+    for (const auto& pair : m_textures)
+    {
+        const std::shared_ptr<Texture>& texture = pair.second;
+        if (texture.use_count() > 1 || texture->GetLastUsedFrame() >= m_frame ||
+            m_reloaders.find(pair.first) == m_reloaders.end() ||
+            m_pendingLoads.find(pair.first) != m_pendingLoads.end())
+            continue;
+
+        candidates.emplace_back(texture->GetLastUsedFrame(), pair.first);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto& candidate : candidates)
+    {
+        if (resident <= m_poolSize)
+            break;
+
+        auto it = m_textures.find(candidate.second);
+        resident -= std::min(resident, it->second->GetMemoryUsage());
+        m_textures.erase(it);
+        ForgetLod(candidate.second);
+        m_residencyStats.evictions++;
+    }
+}
+
+void TextureManager::AddResident(const std::string& key, const std::shared_ptr<Texture>& texture, ReloadFunc reload)
+{
+    m_textures[key] = texture;
+    if (reload)
+        m_reloaders[key] = std::move(reload);
+    else
+        m_reloaders.erase(key);
+    CleanupUnusedTextures();
+}
+
+void TextureManager::RecordMiss(const std::string& key)
+{
+    m_residencyStats.misses++;
+    if (m_reloaders.find(key) != m_reloaders.end())
+        m_residencyStats.reloads++;
+}
+
 std::string TextureManager::GetTextureKey(const std::string& filename, TextureType type) const
 {
     return filename + "_" + std::to_string(static_cast<int>(type));
@@ -2,12 +2,23 @@
 
 #include <d3d9.h>
 #include <d3dx9.h>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <memory>
 #include <vector>
+#include "Effects/BakeCache.h"
+#include "Effects/BlockCompression.h"
+#include "Effects/StreamingQueue.h"
+#include "Effects/TextureAtlas.h"
+#include "Effects/TextureLod.h"
 
 class Texture;
+class Material;
+
+// BC4 and BC5 (one and two channel block formats), exposed by D3D9 drivers as FOURCC codes
+const D3DFORMAT D3DFMT_ATI1 = static_cast<D3DFORMAT>(MAKEFOURCC('A', 'T', 'I', '1'));
+const D3DFORMAT D3DFMT_ATI2 = static_cast<D3DFORMAT>(MAKEFOURCC('A', 'T', 'I', '2'));
 
 enum class TextureType {
     DIFFUSE = 0,
@@ -45,6 +56,40 @@ struct TextureInfo {
     size_t memoryUsage = 0;
 };
 
+// Bytes of the resident textures, grouped by type and by material. Each
+// texture counts once in byType; one shared by several materials counts in
+// each of them, and in uniqueBytes of none.
+struct TextureMemoryReport {
+    struct Group {
+        size_t bytes = 0;
+        size_t count = 0;
+    };
+
+    struct MaterialGroup {
+        std::string name;
+        size_t bytes = 0;       // Every texture the material uses
+        size_t uniqueBytes = 0; // Textures no other reported material uses
+        size_t count = 0;
+    };
+
+    size_t totalBytes = 0;
+    size_t textureCount = 0;
+    Group byType[static_cast<int>(TextureType::COUNT)];
+    std::vector<MaterialGroup> byMaterial;
+    Group unreferenced;         // Resident textures none of the materials uses
+};
+
+struct TextureResidencyStats {
+    size_t hits = 0;          // Lookups that found the texture resident
+    size_t misses = 0;        // Lookups that had to load or create it
+    size_t reloads = 0;       // Misses on textures evicted earlier
+    size_t evictions = 0;
+    size_t residentBytes = 0;
+    size_t residentCount = 0;
+    size_t evictedCount = 0;  // Evicted, reloaded when asked for again
+    size_t budgetBytes = 0;
+};
+
 class TextureManager {
 public:
     TextureManager();
@@ -58,6 +103,40 @@ public:
     std::shared_ptr<Texture> LoadCubeTexture(const std::string& filename);
     std::shared_ptr<Texture> LoadVolumeTexture(const std::string& filename);
 
+    // Asynchronous loading: returns at once with a placeholder (a shared
+    // checkerboard) that becomes the real texture when UpdateStreaming
+    // commits it, so materials can hold it from the start. Files are read
+    // and decoded on worker threads; the render thread only creates the
+    // textures, under the per-frame upload budget.
+    std::shared_ptr<Texture> LoadTextureAsync(const std::string& filename, TextureType type = TextureType::DIFFUSE,
+                                              int priority = 0);
+    bool SetLoadPriority(const std::string& filename, TextureType type, int priority);
+    // The texture leaves the cache; whoever holds it keeps the placeholder
+    bool CancelLoad(const std::string& filename, TextureType type);
+    bool IsLoading(const std::string& filename, TextureType type) const;
+    size_t GetPendingLoadCount() const { return m_pendingLoads.size(); }
+
+    // Render thread, once per frame: advances the frame Texture::Bind
+    // stamps, commits finished loads and evicts down to the pool size
+    void BeginFrame();
+
+    // Render thread, once per frame (BeginFrame calls it): commits finished loads
+    void UpdateStreaming();
+    void WaitForPendingLoads();
+    void SetUploadBudget(size_t bytesPerFrame) { m_uploadBudget = bytesPerFrame; }
+
+    // LOD streaming (on by default): baked .etex textures load with only
+    // their mip tail, the levels no larger than tailSize. Finer levels
+    // stream in once a draw reports a screen size that needs them, and are
+    // dropped again when nothing has needed them for a while. A texture
+    // bound without a reported size gets every level.
+    void SetLodStreaming(bool enabled, int tailSize = 64);
+    bool IsLodStreaming() const { return m_lodStreaming; }
+    // Renderer, for each draw: pixels the texture covers on screen. The
+    // mip map bias moves the level picked.
+    void RequestTextureSize(const Texture& texture, float screenSize);
+    void RequestMaterialSize(const Material& material, float screenSize);
+
     // Procedural textures
     std::shared_ptr<Texture> CreateProceduralTexture(const std::string& name, int width, int height,
                                                      D3DFORMAT format = D3DFMT_A8R8G8B8);
@@ -66,6 +145,17 @@ public:
     std::shared_ptr<Texture> CreateGradientTexture(const std::string& name, int width, int height,
                                                    D3DCOLOR color1, D3DCOLOR color2, bool horizontal = true);
 
+    // Texture holding a built atlas, every level of it. Materials pick an
+    // image with Material::SetAtlasRegion(stage, atlas->GetRegion(i)). The
+    // atlas is kept to recreate the texture if it is evicted.
+    std::shared_ptr<Texture> CreateAtlasTexture(const std::string& name,
+                                                std::shared_ptr<const TextureEffects::TextureAtlas> atlas);
+
+    // Noise and ProceduralTextures::Create* results are baked here, keyed
+    // by their parameters; "cache/textures" unless changed, empty disables it
+    bool SetBakeCacheDirectory(const std::string& directory);
+    const TextureEffects::BakeCache& GetBakeCache() const { return m_bakeCache; }
+
     // Texture management
     void UnloadTexture(const std::string& name);
     void UnloadAllTextures();
@@ -74,7 +164,8 @@ public:
 
     // Texture operations
     bool SaveTexture(const std::shared_ptr<Texture>& texture, const std::string& filename);
-    bool CompressTexture(const std::string& name, D3DFORMAT compressedFormat);
+    bool CompressTexture(const std::string& name, D3DFORMAT compressedFormat,
+                         TextureEffects::BlockQuality quality = TextureEffects::BlockQuality::Fast);
     bool GenerateMipmaps(const std::string& name);
 
     // Batch operations
@@ -91,22 +182,85 @@ public:
     size_t GetTextureCount() const { return m_textures.size(); }
     size_t GetTotalMemoryUsage() const;
     std::vector<TextureInfo> GetLoadedTextures() const;
+    // The manager does not track materials: pass the ones to group by
+    TextureMemoryReport GetMemoryReport(const std::vector<std::shared_ptr<Material>>& materials = {}) const;
+    void PrintMemoryReport(const std::vector<std::shared_ptr<Material>>& materials = {}) const;
 
-    // Preloading
+    // Preloading: loads run in parallel, returns when every one is created
     void PreloadTextures(const std::vector<std::string>& filenames);
+
+    // Residency: byte budget for resident textures (256 MB by default).
+    // Over it, textures that only the manager holds (no Material or other
+    // owner) are evicted, least recently bound first; asking for one again
+    // (Load*, Create* or GetTexture) reloads it. Only textures that can be
+    // recreated as they are (files, noise bakes, atlases) are evicted:
+    // CreateProceduralTexture canvases and textures changed by
+    // CompressTexture or GenerateMipmaps stay resident, and LOD streaming
+    // stops for the latter so a level change cannot undo them.
     void SetTexturePoolSize(size_t poolSize) { m_poolSize = poolSize; }
+    size_t GetTexturePoolSize() const { return m_poolSize; }
+    TextureResidencyStats GetResidencyStats() const;
 
 private:
+    // Recreates an evicted texture the way it was first created; textures
+    // without one are never evicted
+    using ReloadFunc = std::function<std::shared_ptr<Texture>()>;
+
+    struct PendingLoad {
+        TextureEffects::StreamHandle handle = 0;
+        std::string filename;
+        TextureType type = TextureType::DIFFUSE;
+        std::shared_ptr<TextureEffects::TextureLod> lod; // Filled by the load when streamed by LOD
+        std::shared_ptr<const TextureEffects::TextureFile> file; // Its file, hash checked, when streamed by LOD
+    };
+
+    struct LodTexture {
+        TextureEffects::TextureLod lod;
+        std::string filename;
+        TextureType type;
+        uint64_t createdFrame = 0;
+        uint64_t contentHash = 0; // Checked at first open; level loads need the same file
+        TextureEffects::StreamHandle handle = 0; // Level change in flight
+        int loadingLevel = 0;
+    };
+
     std::string GetTextureKey(const std::string& filename, TextureType type) const;
     bool LoadTextureFromFile(const std::string& filename, IDirect3DTexture9** texture,
                             int* width = nullptr, int* height = nullptr);
     void CleanupUnusedTextures();
+    void AddResident(const std::string& key, const std::shared_ptr<Texture>& texture, ReloadFunc reload);
+    void RecordMiss(const std::string& key);
     void CreateCheckerboardPattern(std::shared_ptr<Texture> texture, int width, int height);
-    void CreateNoisePattern(std::shared_ptr<Texture> texture, int width, int height, float frequency, int octaves);
+    static void CreateNoisePattern(const TextureEffects::ImageView& image, float frequency, int octaves);
+    std::shared_ptr<Texture> GetPlaceholder();
+    void CollectFinishedLoads();
+    void CancelAllLoads();
+    bool UsesLod(const std::string& filename) const;
+    bool CreateLodTexture(const std::string& key, const std::string& filename, TextureType type, Texture& texture);
+    void UpdateLods();
+    void ForgetLod(const std::string& key);
 
     IDirect3DDevice9* m_device;
     std::unordered_map<std::string, std::shared_ptr<Texture>> m_textures;
 
+    // Asynchronous loading
+    TextureEffects::StreamingQueue m_streaming;
+    std::unordered_map<std::string, PendingLoad> m_pendingLoads;
+    std::shared_ptr<Texture> m_placeholder;
+    size_t m_uploadBudget;
+
+    // LOD streaming
+    std::unordered_map<std::string, LodTexture> m_lods;
+    bool m_lodStreaming;
+    int m_lodTailSize;
+
+    TextureEffects::BakeCache m_bakeCache;
+
+    // Residency
+    std::unordered_map<std::string, ReloadFunc> m_reloaders;
+    uint64_t m_frame;
+    TextureResidencyStats m_residencyStats;
+
     // Settings
     TextureFilter m_defaultFilter;
     TextureWrap m_defaultWrap;
@@ -0,0 +1,250 @@
+// Bake keys and the on-disk bake cache: stable and distinct hashes, store
+// and load round trips, rejection of stale or damaged bakes, no temporary
+// files left behind, concurrent stores of one key, and Clear.
+
+#include "TestCheck.h"
+#include "Textures/Effects/BakeCache.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+// Fresh directory per run, so leftovers of another run never count
+std::string MakeTempDirectory()
+{
+    std::random_device device;
+    return (std::filesystem::temp_directory_path() / ("bake_cache_tests_" + std::to_string(device()))).string();
+}
+
+std::vector<std::string> ListFiles(const std::string& directory)
+{
+    std::vector<std::string> names;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+        names.push_back(entry.path().filename().string());
+    return names;
+}
+
+MipChain MakeChain(int width, int height, uint32_t seed)
+{
+    PixelBuffer image(width, height);
+    ImageView view = image.GetView();
+    uint32_t state = seed;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            state = state * 1664525u + 1013904223u;
+            view.At(x, y) = state;
+        }
+    }
+
+    MipChain chain;
+    chain.Build(view);
+    return chain;
+}
+
+bool SameLevels(const TextureFile& file, const MipChain& chain)
+{
+    if (file.GetLevelCount() != chain.GetLevelCount())
+        return false;
+
+    for (int level = 0; level < chain.GetLevelCount(); level++)
+    {
+        ImageView view = chain.GetLevel(level);
+        const TextureFileLevel& info = file.GetLevel(level);
+        if (static_cast<int>(info.width) != view.width || static_cast<int>(info.height) != view.height)
+            return false;
+
+        for (int y = 0; y < view.height; y++)
+        {
+            if (memcmp(file.GetLevelData(level) + static_cast<size_t>(y) * info.pitch, view.Row(y),
+                       view.width * sizeof(D3DCOLOR)) != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+void TestKeys()
+{
+    auto base = []() { return BakeKey("marble", 1, 256, 256).Add(4).Add(0.5f).Add(D3DCOLOR_XRGB(10, 20, 30)); };
+    CHECK(base().GetHash() == base().GetHash());
+
+    // Everything the bake depends on changes the hash
+    CHECK(BakeKey("marble", 2, 256, 256).Add(4).Add(0.5f).Add(D3DCOLOR_XRGB(10, 20, 30)).GetHash() != base().GetHash());
+    CHECK(BakeKey("marble", 1, 256, 128).Add(4).Add(0.5f).Add(D3DCOLOR_XRGB(10, 20, 30)).GetHash() != base().GetHash());
+    CHECK(BakeKey("wood", 1, 256, 256).Add(4).Add(0.5f).Add(D3DCOLOR_XRGB(10, 20, 30)).GetHash() != base().GetHash());
+    CHECK(BakeKey("marble", 1, 256, 256).Add(5).Add(0.5f).Add(D3DCOLOR_XRGB(10, 20, 30)).GetHash() != base().GetHash());
+    CHECK(base().Add(true).GetHash() != base().GetHash());
+
+    // Types and string boundaries are part of the key
+    CHECK(BakeKey("g", 1, 1, 1).Add(1).GetHash() != BakeKey("g", 1, 1, 1).Add(true).GetHash());
+    CHECK(BakeKey("g", 1, 1, 1).Add(1).GetHash() != BakeKey("g", 1, 1, 1).Add(static_cast<D3DCOLOR>(1)).GetHash());
+    CHECK(BakeKey("g", 1, 1, 1).Add(std::string("ab")).Add(std::string("c")).GetHash() !=
+          BakeKey("g", 1, 1, 1).Add(std::string("a")).Add(std::string("bc")).GetHash());
+
+    // -0 and 0, and any two NaNs, make the same texture
+    CHECK(BakeKey("g", 1, 1, 1).Add(0.0f).GetHash() == BakeKey("g", 1, 1, 1).Add(-0.0f).GetHash());
+    CHECK(BakeKey("g", 1, 1, 1).Add(std::nanf("")).GetHash() == BakeKey("g", 1, 1, 1).Add(-std::nanf("1")).GetHash());
+
+    MipOptions options;
+    MipOptions sharper;
+    sharper.filter = ResampleFilter::Lanczos3;
+    CHECK(BakeKey("g", 1, 1, 1).Add(options).GetHash() == BakeKey("g", 1, 1, 1).Add(MipOptions()).GetHash());
+    CHECK(BakeKey("g", 1, 1, 1).Add(options).GetHash() != BakeKey("g", 1, 1, 1).Add(sharper).GetHash());
+}
+
+void TestDisabled()
+{
+    BakeCache cache;
+    CHECK(!cache.IsEnabled());
+
+    BakeKey key("noise", 1, 16, 16);
+    TextureFile file;
+    CHECK(!cache.Load(key, file));
+    CHECK(!cache.Store(key, MakeChain(16, 16, 1)));
+    CHECK(cache.GetStats().stores == 0);
+}
+
+void TestStoreAndLoad(const std::string& directory)
+{
+    BakeCache cache;
+    CHECK(cache.SetDirectory(directory));
+    CHECK(cache.IsEnabled());
+
+    BakeKey key = BakeKey("noise", 1, 64, 32).Add(3);
+    std::string path = cache.GetPath(key);
+    CHECK(std::filesystem::path(path).parent_path() == std::filesystem::path(directory));
+    CHECK(TextureFile::IsTextureFile(path));
+
+    TextureFile file;
+    CHECK(!cache.Load(key, file));
+
+    MipChain chain = MakeChain(64, 32, 2);
+    CHECK(cache.Store(key, chain));
+    CHECK(cache.Load(key, file));
+    CHECK(SameLevels(file, chain));
+    file.Close();
+
+    // Only the bake is left, no temporary file
+    CHECK(ListFiles(directory) == std::vector<std::string>({ std::filesystem::path(path).filename().string() }));
+
+    // A chain of another size is not stored under the key
+    CHECK(!cache.Store(key, MakeChain(32, 32, 3)));
+
+    BakeCache::Stats stats = cache.GetStats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.stores == 1);
+}
+
+void TestStaleAndDamaged(const std::string& directory)
+{
+    BakeCache cache;
+    CHECK(cache.SetDirectory(directory));
+
+    // Another size's bake sitting at the key's path misses
+    BakeKey key("stale", 1, 32, 32);
+    BakeKey other("stale", 1, 16, 16);
+    CHECK(cache.Store(other, MakeChain(16, 16, 4)));
+    std::filesystem::copy_file(cache.GetPath(other), cache.GetPath(key),
+                               std::filesystem::copy_options::overwrite_existing);
+    TextureFile file;
+    CHECK(!cache.Load(key, file));
+
+    // So does a bake with one changed byte, until it is stored again
+    MipChain chain = MakeChain(32, 32, 5);
+    CHECK(cache.Store(key, chain));
+    std::string path = cache.GetPath(key);
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    bytes[bytes.size() - 3] ^= 0x40;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    CHECK(!cache.Load(key, file));
+
+    CHECK(cache.Store(key, chain));
+    CHECK(cache.Load(key, file));
+    CHECK(SameLevels(file, chain));
+    file.Close();
+}
+
+void TestConcurrentStores(const std::string& directory)
+{
+    // Threads storing the same key never see each other's partial files
+    BakeCache cache;
+    CHECK(cache.SetDirectory(directory));
+
+    BakeKey key("shared", 1, 128, 128);
+    MipChain chain = MakeChain(128, 128, 6);
+    const int threadCount = 6;
+    std::vector<int> results(threadCount, 0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&, i]() {
+            for (int round = 0; round < 4; round++)
+                results[i] += cache.Store(key, chain) ? 1 : 0;
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (int result : results)
+        CHECK(result == 4);
+
+    TextureFile file;
+    CHECK(cache.Load(key, file));
+    CHECK(SameLevels(file, chain));
+    file.Close();
+
+    for (const std::string& name : ListFiles(directory))
+        CHECK(name.find(".tmp") == std::string::npos);
+}
+
+void TestClear(const std::string& directory)
+{
+    BakeCache cache;
+    CHECK(cache.SetDirectory(directory));
+    CHECK(cache.Store(BakeKey("clear", 1, 8, 8), MakeChain(8, 8, 7)));
+
+    // Bakes and leftover temporary files go; anything else stays
+    std::ofstream(cache.GetPath(BakeKey("crashed", 1, 8, 8)) + ".tmp1234-0") << "partial";
+    std::ofstream((std::filesystem::path(directory) / "notes.txt").string()) << "keep";
+
+    cache.Clear();
+    CHECK(ListFiles(directory) == std::vector<std::string>({ "notes.txt" }));
+}
+
+} // namespace
+
+int main()
+{
+    std::string directory = MakeTempDirectory();
+
+    TestKeys();
+    TestDisabled();
+    TestStoreAndLoad(directory + "/store");
+    TestStaleAndDamaged(directory + "/stale");
+    TestConcurrentStores(directory + "/shared");
+    TestClear(directory + "/clear");
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return Test::Finish("BakeCacheTests");
+}
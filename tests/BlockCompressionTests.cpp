@@ -0,0 +1,261 @@
+// Block compression quality and layout: PSNR of the decoded result against
+// per-format floors in both quality modes, images with partial blocks and
+// single-block levels, and identical bytes from the SSE2 and scalar index
+// selection and from any pool size.
+
+#include "TestCheck.h"
+#include "Core/CpuFeatures.h"
+#include "Core/ThreadPool.h"
+#include "Textures/Effects/BlockCompression.h"
+#include "Textures/Effects/EffectThreads.h"
+#include "Textures/Effects/NoiseCore.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+int Clamp(float value)
+{
+    return std::max(0, std::min(255, static_cast<int>(value)));
+}
+
+// Rock-like albedo with a cutout alpha
+void FillAlbedo(const ImageView& image)
+{
+    NoiseCore noise(11);
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            float large = noise.Perlin(x * 0.04f, y * 0.04f) * 0.5f + 0.5f;
+            float detail = noise.Perlin(x * 0.3f, y * 0.3f) * 0.5f + 0.5f;
+            float mix = large * 0.7f + detail * 0.3f;
+            int alpha = Clamp((noise.Perlin(x * 0.1f + 5.0f, y * 0.1f) + 0.2f) * 600.0f + 128.0f);
+            image.At(x, y) = D3DCOLOR_ARGB(alpha, Clamp(90 + mix * 110), Clamp(70 + mix * 90 + detail * 20),
+                                           Clamp(50 + large * 60));
+        }
+    }
+}
+
+// Height in every channel, the normal's X and Y in red and green
+void FillNormals(const ImageView& image)
+{
+    NoiseCore noise(4);
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            float dx = noise.Perlin(x * 0.1f, y * 0.1f);
+            float dy = noise.Perlin(x * 0.1f + 31.0f, y * 0.1f);
+            float length = sqrtf(dx * dx + dy * dy + 1.0f);
+            image.At(x, y) = D3DCOLOR_ARGB(255, Clamp((dx / length + 1.0f) * 127.5f + 0.5f),
+                                           Clamp((dy / length + 1.0f) * 127.5f + 0.5f), 255);
+        }
+    }
+}
+
+// Uncorrelated channels, the worst case for every mode
+void FillRandom(const ImageView& image, unsigned seed)
+{
+    std::mt19937 random(seed);
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+            image.At(x, y) = static_cast<D3DCOLOR>(random());
+    }
+}
+
+float RoundTripPSNR(const ImageView& image, BlockFormat format, BlockQuality quality)
+{
+    std::vector<BYTE> blocks(BlockCompressor::GetCompressedSize(format, image.width, image.height));
+    PixelBuffer decoded(image.width, image.height);
+    if (!BlockCompressor::Compress(image, format, blocks.data(), 0, quality) ||
+        !BlockCompressor::Decompress(blocks.data(), 0, format, decoded.GetView()))
+        return 0.0f;
+    return BlockCompressor::ComputePSNR(image, decoded.GetView(), format);
+}
+
+std::vector<BYTE> Encode(const ImageView& image, BlockFormat format, BlockQuality quality)
+{
+    std::vector<BYTE> blocks(BlockCompressor::GetCompressedSize(format, image.width, image.height));
+    BlockCompressor::Compress(image, format, blocks.data(), 0, quality);
+    return blocks;
+}
+
+const BlockFormat kFormats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5 };
+const BlockQuality kQualities[] = { BlockQuality::Fast, BlockQuality::High };
+
+// Floors sit 1 to 1.5 dB under what the encoder reaches on these images
+void TestPSNRFloors()
+{
+    PixelBuffer albedo(128, 128);
+    PixelBuffer opaque(128, 128, PixelFormat::X8R8G8B8);
+    PixelBuffer normals(128, 128);
+    FillAlbedo(albedo.GetView());
+    albedo.GetView().CopyTo(opaque.GetView());
+    FillNormals(normals.GetView());
+
+    struct Case {
+        BlockFormat format;
+        const PixelBuffer* source;
+        float fast;
+        float high;
+    };
+    const Case cases[] = {
+        { BlockFormat::BC1, &opaque, 40.0f, 41.0f },
+        { BlockFormat::BC3, &albedo, 37.5f, 38.5f },
+        { BlockFormat::BC4, &albedo, 50.0f, 51.5f },
+        { BlockFormat::BC5, &normals, 41.5f, 43.0f },
+    };
+
+    for (const Case& test : cases)
+    {
+        float fast = RoundTripPSNR(test.source->GetView(), test.format, BlockQuality::Fast);
+        float high = RoundTripPSNR(test.source->GetView(), test.format, BlockQuality::High);
+        CHECK(fast >= test.fast);
+        CHECK(high >= test.high);
+        CHECK(high >= fast - 0.05f);
+    }
+}
+
+// Solid colors survive up to 5:6:5 rounding, and a solid value exactly
+void TestSolidBlocks()
+{
+    PixelBuffer solid(4, 4);
+    solid.Clear(D3DCOLOR_ARGB(255, 200, 100, 37));
+    for (BlockQuality quality : kQualities)
+    {
+        CHECK(RoundTripPSNR(solid.GetView(), BlockFormat::BC1, quality) >= 44.0f);
+        CHECK(std::isinf(RoundTripPSNR(solid.GetView(), BlockFormat::BC4, quality)));
+        CHECK(std::isinf(RoundTripPSNR(solid.GetView(), BlockFormat::BC5, quality)));
+    }
+}
+
+// Right and bottom blocks that are only partly covered, and levels smaller
+// than one block
+void TestPartialBlocks()
+{
+    const int sizes[][2] = { { 1, 1 }, { 2, 2 }, { 3, 5 }, { 37, 21 }, { 130, 6 } };
+    for (const auto& size : sizes)
+    {
+        PixelBuffer image(size[0], size[1]);
+        PixelBuffer opaque(size[0], size[1], PixelFormat::X8R8G8B8);
+        FillAlbedo(image.GetView());
+        image.GetView().CopyTo(opaque.GetView());
+        int blocksWide = (size[0] + 3) / 4;
+        int blocksHigh = (size[1] + 3) / 4;
+
+        for (BlockFormat format : kFormats)
+        {
+            CHECK(BlockCompressor::GetCompressedSize(format, size[0], size[1]) ==
+                  static_cast<size_t>(blocksWide) * blocksHigh * BlockCompressor::GetBlockSize(format));
+
+            const PixelBuffer& source = format == BlockFormat::BC1 ? opaque : image;
+            for (BlockQuality quality : kQualities)
+                CHECK(RoundTripPSNR(source.GetView(), format, quality) >= 36.0f);
+        }
+
+        // A view into a wider image encodes like a packed copy, and a row
+        // pitch leaves the bytes between rows alone
+        PixelBuffer wide(size[0] + 9, size[1]);
+        wide.Clear(D3DCOLOR_ARGB(255, 255, 0, 255));
+        image.GetView().CopyTo(wide.GetView().SubView(5, 0, size[0], size[1]));
+        ImageView sub = wide.GetView().SubView(5, 0, size[0], size[1]);
+        CHECK(Encode(sub, BlockFormat::BC3, BlockQuality::Fast) == Encode(image.GetView(), BlockFormat::BC3, BlockQuality::Fast));
+
+        int rowBytes = blocksWide * 16;
+        int pitch = rowBytes + 8;
+        std::vector<BYTE> pitched(static_cast<size_t>(pitch) * blocksHigh, 0xAB);
+        CHECK(BlockCompressor::Compress(image.GetView(), BlockFormat::BC3, pitched.data(), pitch));
+        std::vector<BYTE> packed = Encode(image.GetView(), BlockFormat::BC3, BlockQuality::Fast);
+        for (int row = 0; row < blocksHigh; row++)
+        {
+            const BYTE* line = pitched.data() + static_cast<size_t>(row) * pitch;
+            CHECK(std::equal(line, line + rowBytes, packed.data() + static_cast<size_t>(row) * rowBytes));
+            CHECK(std::all_of(line + rowBytes, line + pitch, [](BYTE value) { return value == 0xAB; }));
+        }
+    }
+}
+
+// Pixels with alpha under 128 become transparent black in BC1
+void TestTransparency()
+{
+    PixelBuffer image(8, 4);
+    FillAlbedo(image.GetView());
+    image.GetView().At(1, 1) = D3DCOLOR_ARGB(10, 200, 30, 30);
+    image.GetView().At(6, 2) = D3DCOLOR_ARGB(127, 20, 30, 200);
+    image.GetView().At(2, 3) = D3DCOLOR_ARGB(128, 20, 30, 200);
+
+    std::vector<BYTE> blocks = Encode(image.GetView(), BlockFormat::BC1, BlockQuality::High);
+    PixelBuffer decoded(8, 4);
+    CHECK(BlockCompressor::Decompress(blocks.data(), 0, BlockFormat::BC1, decoded.GetView()));
+    CHECK(decoded.GetView().At(1, 1) == 0);
+    CHECK(decoded.GetView().At(6, 2) == 0);
+    CHECK((decoded.GetView().At(2, 3) >> 24) == 255);
+}
+
+void TestSSE2MatchesScalar()
+{
+    if (CpuFeatures::GetMaxSimdLevel() < SimdLevel::SSE2)
+        return;
+
+    PixelBuffer albedo(68, 36);
+    PixelBuffer normals(68, 36);
+    PixelBuffer noise(68, 36);
+    FillAlbedo(albedo.GetView());
+    FillNormals(normals.GetView());
+    FillRandom(noise.GetView(), 99);
+    const PixelBuffer* sources[] = { &albedo, &normals, &noise };
+
+    for (const PixelBuffer* source : sources)
+    {
+        for (BlockFormat format : kFormats)
+        {
+            for (BlockQuality quality : kQualities)
+            {
+                BlockCompressor::SetSimdLevel(SimdLevel::Scalar);
+                std::vector<BYTE> scalar = Encode(source->GetView(), format, quality);
+                BlockCompressor::SetSimdLevel(SimdLevel::SSE2);
+                std::vector<BYTE> sse2 = Encode(source->GetView(), format, quality);
+                CHECK(scalar == sse2);
+            }
+        }
+    }
+
+    BlockCompressor::SetSimdLevel(CpuFeatures::GetMaxSimdLevel());
+}
+
+void TestPoolSizeIndependence()
+{
+    PixelBuffer image(96, 80);
+    FillAlbedo(image.GetView());
+
+    ThreadPool serial(0);
+    ThreadPool pool(3);
+    for (BlockFormat format : kFormats)
+    {
+        SetEffectThreadPool(&serial);
+        std::vector<BYTE> single = Encode(image.GetView(), format, BlockQuality::High);
+        SetEffectThreadPool(&pool);
+        std::vector<BYTE> pooled = Encode(image.GetView(), format, BlockQuality::High);
+        CHECK(single == pooled);
+    }
+    SetEffectThreadPool(nullptr);
+}
+
+} // namespace
+
+int main()
+{
+    TestPSNRFloors();
+    TestSolidBlocks();
+    TestPartialBlocks();
+    TestTransparency();
+    TestSSE2MatchesScalar();
+    TestPoolSizeIndependence();
+    return Test::Finish("BlockCompressionTests");
+}
@@ -0,0 +1,203 @@
+// Blur kernels and box radii, results of the separable and box paths on
+// known images, alpha left alone, and the same pixels with any pool size.
+
+#include "TestCheck.h"
+#include "Core/ThreadPool.h"
+#include "Textures/Effects/Blur.h"
+#include "Textures/Effects/EffectThreads.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+bool SamePixels(const PixelBuffer& a, const PixelBuffer& b)
+{
+    if (a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight())
+        return false;
+
+    ImageView viewA = a.GetView();
+    ImageView viewB = b.GetView();
+    for (int y = 0; y < viewA.height; y++)
+    {
+        if (memcmp(viewA.Row(y), viewB.Row(y), viewA.width * sizeof(D3DCOLOR)) != 0)
+            return false;
+    }
+    return true;
+}
+
+// Deterministic pseudo-random colors with varying alpha
+void FillPattern(const ImageView& image)
+{
+    uint32_t state = 12345;
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            state = state * 1664525u + 1013904223u;
+            image.At(x, y) = state;
+        }
+    }
+}
+
+void TestKernels()
+{
+    const float sigmas[] = { 0.5f, 1.0f, 2.5f };
+    for (float sigma : sigmas)
+    {
+        int radius = static_cast<int>(ceilf(3.0f * sigma));
+        std::vector<float> kernel = Blur::GaussianKernel(sigma, radius);
+        CHECK(kernel.size() == static_cast<size_t>(2 * radius + 1));
+
+        float sum = 0.0f;
+        for (int i = 0; i < static_cast<int>(kernel.size()); i++)
+        {
+            sum += kernel[i];
+            CHECK(kernel[i] == kernel[kernel.size() - 1 - i]);
+            CHECK(kernel[i] <= kernel[radius]);
+        }
+        CHECK(fabsf(sum - 1.0f) < 1e-5f);
+    }
+
+    // A wide enough kernel keeps its standard deviation
+    std::vector<float> wide = Blur::GaussianKernel(2.0f, 12);
+    CHECK(fabsf(Blur::KernelSigma(wide.data(), 12) - 2.0f) < 0.01f);
+
+    const float identity[] = { 0.0f, 1.0f, 0.0f };
+    CHECK(Blur::KernelSigma(identity, 1) == 0.0f);
+}
+
+void TestBoxRadii()
+{
+    const float sigmas[] = { 1.0f, 3.0f, 5.0f, 10.0f, 24.0f };
+    for (float sigma : sigmas)
+    {
+        int radii[3];
+        Blur::BoxRadiiForGaussian(sigma, 3, radii);
+
+        int smallest = radii[0];
+        int largest = radii[0];
+        float variance = 0.0f;
+        for (int radius : radii)
+        {
+            CHECK(radius >= 0);
+            smallest = std::min(smallest, radius);
+            largest = std::max(largest, radius);
+            float width = 2.0f * radius + 1.0f;
+            variance += (width * width - 1.0f) / 12.0f;
+        }
+
+        // Widths differ by at most two pixels; the variance is within half
+        // of what swapping one box for the next width would change
+        CHECK(largest - smallest <= 1);
+        int lowerWidth = 2 * smallest + 1;
+        float step = (4.0f * lowerWidth + 4.0f) / 12.0f;
+        CHECK(fabsf(variance - sigma * sigma) <= step * 0.5f + 1e-3f);
+    }
+}
+
+void TestImpulse()
+{
+    // Radius 1 box: one impulse spreads evenly over its 3x3 neighbourhood
+    PixelBuffer image(16, 16);
+    image.Clear(D3DCOLOR_ARGB(255, 0, 0, 0));
+    ImageView view = image.GetView();
+    view.At(8, 8) = D3DCOLOR_ARGB(255, 90, 180, 9);
+
+    Blur::Box(view, 1);
+    for (int y = 0; y < 16; y++)
+    {
+        for (int x = 0; x < 16; x++)
+        {
+            bool inside = x >= 7 && x <= 9 && y >= 7 && y <= 9;
+            CHECK(view.At(x, y) == (inside ? D3DCOLOR_ARGB(255, 10, 20, 1) : D3DCOLOR_ARGB(255, 0, 0, 0)));
+        }
+    }
+
+    // A one-tap kernel changes nothing
+    PixelBuffer pattern(37, 23);
+    FillPattern(pattern.GetView());
+    PixelBuffer copy = pattern;
+    const float identity[] = { 0.0f, 1.0f, 0.0f };
+    Blur::Separable(copy.GetView(), identity, 1);
+    CHECK(SamePixels(pattern, copy));
+}
+
+void TestFlatImages()
+{
+    // Both the separable (sigma 1.5) and the box path (sigma 12) keep a
+    // flat color flat up to the borders, and never touch alpha
+    const float sigmas[] = { 1.5f, 12.0f };
+    for (float sigma : sigmas)
+    {
+        PixelBuffer image(70, 45);
+        ImageView view = image.GetView();
+        for (int y = 0; y < view.height; y++)
+        {
+            for (int x = 0; x < view.width; x++)
+                view.At(x, y) = D3DCOLOR_ARGB((x * 7 + y * 3) & 0xff, 200, 100, 37);
+        }
+
+        Blur::Gaussian(view, sigma);
+        bool flat = true;
+        for (int y = 0; y < view.height; y++)
+        {
+            for (int x = 0; x < view.width; x++)
+                flat = flat && view.At(x, y) == D3DCOLOR_ARGB((x * 7 + y * 3) & 0xff, 200, 100, 37);
+        }
+        CHECK(flat);
+    }
+}
+
+void TestPoolSizes()
+{
+    const std::function<void(const ImageView&)> blurs[] = {
+        [](const ImageView& image) { Blur::Gaussian(image, 2.0f); },
+        [](const ImageView& image) { Blur::Gaussian(image, 15.0f); },
+        [](const ImageView& image) { Blur::Box(image, 4, 2); },
+        [](const ImageView& image) { Blur::Smooth(image, Blur::GaussianKernel(4.0f, 12)); },
+    };
+    const int sizes[][2] = { { 256, 256 }, { 131, 77 }, { 1, 90 } };
+    const int workerCounts[] = { 1, 3, 7 };
+
+    for (const auto& blur : blurs)
+    {
+        for (const auto& size : sizes)
+        {
+            PixelBuffer reference(size[0], size[1]);
+            FillPattern(reference.GetView());
+            PixelBuffer source = reference;
+
+            ThreadPool serial(0);
+            SetEffectThreadPool(&serial);
+            blur(reference.GetView());
+
+            for (int workers : workerCounts)
+            {
+                ThreadPool pool(workers);
+                SetEffectThreadPool(&pool);
+                PixelBuffer image = source;
+                blur(image.GetView());
+                CHECK(SamePixels(reference, image));
+            }
+            SetEffectThreadPool(nullptr);
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestKernels();
+    TestBoxRadii();
+    TestImpulse();
+    TestFlatImages();
+    TestPoolSizes();
+    return Test::Finish("BlurTests");
+}
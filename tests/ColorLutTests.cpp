@@ -0,0 +1,205 @@
+// 3D color LUT: identity and lattice points exact, neutral grays kept by the
+// tetrahedral mode, alpha kept, and the error bounds PostEffectChain
+// documents for the default 33^3 lattice.
+
+#include "TestCheck.h"
+#include "Textures/Effects/ColorLut.h"
+#include "Textures/Effects/PointOps.h"
+#include "Textures/Effects/PostEffectChain.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+using namespace TextureEffects;
+
+namespace {
+
+const LutInterpolation kInterpolations[] = { LutInterpolation::Trilinear, LutInterpolation::Tetrahedral };
+
+int ChannelDifference(D3DCOLOR a, D3DCOLOR b)
+{
+    int worst = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        int difference = abs(static_cast<int>((a >> shift) & 0xff) - static_cast<int>((b >> shift) & 0xff));
+        if (difference > worst)
+            worst = difference;
+    }
+    return worst;
+}
+
+D3DCOLOR ApplyOp(const PointOp& op, D3DCOLOR color)
+{
+    D3DCOLOR pixel = color;
+    PixelSpan span;
+    span.pixels = &pixel;
+    span.count = 1;
+    op.apply(span);
+    return pixel;
+}
+
+// Every third value of each channel, plus 255: 87^3 colors with varying alpha
+PixelBuffer MakeColorCube()
+{
+    const int steps = 87;
+    PixelBuffer image(steps * steps, steps);
+    ImageView view = image.GetView();
+    for (int r = 0; r < steps; r++)
+    {
+        for (int g = 0; g < steps; g++)
+        {
+            for (int b = 0; b < steps; b++)
+            {
+                int alpha = (r * 31 + g * 7 + b) & 0xff;
+                view.At(g * steps + b, r) = D3DCOLOR_ARGB(alpha, std::min(255, r * 3), std::min(255, g * 3),
+                                                          std::min(255, b * 3));
+            }
+        }
+    }
+    return image;
+}
+
+// Largest channel error of the LUT chain against the exact one
+int MaxLutError(const std::function<void(PostEffectChain&)>& record, LutInterpolation interpolation)
+{
+    PixelBuffer exact = MakeColorCube();
+    PixelBuffer baked = exact;
+
+    PostEffectChain direct;
+    record(direct);
+    direct.Apply(exact.GetView());
+
+    PostEffectChain lut;
+    lut.UseColorLut(interpolation);
+    record(lut);
+    lut.Apply(baked.GetView());
+
+    ImageView a = exact.GetView();
+    ImageView b = baked.GetView();
+    int worst = 0;
+    for (int y = 0; y < a.height; y++)
+    {
+        for (int x = 0; x < a.width; x++)
+        {
+            if ((a.At(x, y) >> 24) != (b.At(x, y) >> 24))
+                return 256;
+            worst = std::max(worst, ChannelDifference(a.At(x, y), b.At(x, y)));
+        }
+    }
+    return worst;
+}
+
+void TestIdentity()
+{
+    const int sizes[] = { 2, 17, 33 };
+    for (int size : sizes)
+    {
+        ColorLut3D lut(size);
+        for (LutInterpolation interpolation : kInterpolations)
+        {
+            bool exact = true;
+            for (int r = 0; r < 256; r += 5)
+            {
+                for (int g = 0; g < 256; g += 3)
+                {
+                    for (int b = 0; b < 256; b += 7)
+                    {
+                        D3DCOLOR color = D3DCOLOR_ARGB(0xff, r, g, b);
+                        exact = exact && lut.Lookup(color, interpolation) == color;
+                    }
+                }
+            }
+            CHECK(exact);
+        }
+    }
+
+    // Size is clamped to 2..256
+    CHECK(ColorLut3D(1).GetSize() == 2);
+    CHECK(ColorLut3D(1000).GetSize() == 256);
+}
+
+void TestLatticePoints()
+{
+    // The corners of any lattice are grid points, so they hold op's exact result
+    PointOp op = PointOps::Sepia(0.8f);
+    ColorLut3D lut(33);
+    lut.Transform(op);
+
+    for (int corner = 0; corner < 8; corner++)
+    {
+        D3DCOLOR color = D3DCOLOR_ARGB(0xff, corner & 1 ? 255 : 0, corner & 2 ? 255 : 0, corner & 4 ? 255 : 0);
+        for (LutInterpolation interpolation : kInterpolations)
+            CHECK(lut.Lookup(color, interpolation) == ApplyOp(op, color));
+    }
+}
+
+void TestNeutralAxis()
+{
+    // Saturation leaves grays alone; tetrahedral lookups keep them neutral
+    ColorLut3D lut;
+    lut.Transform(PointOps::Saturation(1.6f));
+    lut.Transform(PointOps::Contrast(30.0f));
+
+    for (int v = 0; v < 256; v++)
+    {
+        D3DCOLOR color = lut.Lookup(D3DCOLOR_ARGB(0xff, v, v, v), LutInterpolation::Tetrahedral);
+        int r = (color >> 16) & 0xff;
+        int g = (color >> 8) & 0xff;
+        int b = color & 0xff;
+        CHECK(r == g && g == b);
+    }
+}
+
+void TestAlphaKept()
+{
+    ColorLut3D lut;
+    lut.Transform(PointOps::Invert());
+
+    PixelBuffer image(19, 7);
+    ImageView view = image.GetView();
+    for (int y = 0; y < view.height; y++)
+    {
+        for (int x = 0; x < view.width; x++)
+            view.At(x, y) = D3DCOLOR_ARGB(x * 13 + y, 0, 128, 255);
+    }
+
+    lut.Apply(view, LutInterpolation::Trilinear);
+    for (int y = 0; y < view.height; y++)
+    {
+        for (int x = 0; x < view.width; x++)
+            CHECK(view.At(x, y) == D3DCOLOR_ARGB(x * 13 + y, 255, 127, 0));
+    }
+}
+
+void TestChainBounds()
+{
+    auto grade = [](PostEffectChain& chain) {
+        chain.AdjustBrightness(0.05f).AdjustContrast(15.0f).AdjustSaturation(1.3f).AdjustHue(10.0f)
+            .AdjustGamma(1.2f).ColorBalance(1.05f, 1.0f, 0.92f).Sepia(0.3f);
+    };
+    auto posterize = [](PostEffectChain& chain) { chain.AdjustSaturation(1.2f).Posterize(6); };
+    auto perChannel = [](PostEffectChain& chain) {
+        chain.AdjustBrightness(0.1f).AdjustContrast(25.0f).AdjustGamma(1.3f).ColorBalance(1.0f, 0.9f, 1.1f);
+    };
+
+    for (LutInterpolation interpolation : kInterpolations)
+    {
+        CHECK(MaxLutError(grade, interpolation) <= 12);
+        CHECK(MaxLutError(posterize, interpolation) <= 50);
+
+        // Runs of per-channel ops stay exact 1D tables
+        CHECK(MaxLutError(perChannel, interpolation) == 0);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestIdentity();
+    TestLatticePoints();
+    TestNeutralAxis();
+    TestAlphaKept();
+    TestChainBounds();
+    return Test::Finish("ColorLutTests");
+}
@@ -0,0 +1,207 @@
+// Span color space conversions: known colors, exact byte round trips over
+// a fifth of the 24-bit colors, hue wrapping, alpha kept, and spans whose length is
+// not a multiple of the vector width.
+
+#include "TestCheck.h"
+#include "Textures/Effects/ColorSpace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+bool Near(float a, float b, float tolerance = 1e-4f)
+{
+    return std::fabs(a - b) <= tolerance;
+}
+
+int ChannelDifference(D3DCOLOR a, D3DCOLOR b)
+{
+    int worst = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        int difference = abs(static_cast<int>((a >> shift) & 0xff) - static_cast<int>((b >> shift) & 0xff));
+        if (difference > worst)
+            worst = difference;
+    }
+    return worst;
+}
+
+void TestKnownColors()
+{
+    const D3DCOLOR colors[] = {
+        D3DCOLOR_XRGB(255, 0, 0), D3DCOLOR_XRGB(255, 255, 0), D3DCOLOR_XRGB(0, 255, 0),
+        D3DCOLOR_XRGB(0, 0, 255), D3DCOLOR_XRGB(128, 128, 128), D3DCOLOR_XRGB(255, 255, 255),
+        D3DCOLOR_XRGB(0, 0, 0),
+    };
+    const float hues[] = { 0.0f, 60.0f, 120.0f, 240.0f, 0.0f, 0.0f, 0.0f };
+    const int count = 7;
+
+    float h[count], s[count], v[count];
+    ColorSpace::RGBToHSV(colors, h, s, v, count);
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(Near(h[i], hues[i], 1e-2f));
+        CHECK(Near(s[i], 1.0f));
+        CHECK(Near(v[i], 1.0f));
+    }
+    CHECK(Near(s[4], 0.0f) && Near(v[4], 128.0f / 255.0f));
+    CHECK(Near(s[5], 0.0f) && Near(v[5], 1.0f));
+    CHECK(Near(v[6], 0.0f));
+
+    float l[count];
+    ColorSpace::RGBToHSL(colors, h, s, l, count);
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(Near(h[i], hues[i], 1e-2f));
+        CHECK(Near(s[i], 1.0f));
+        CHECK(Near(l[i], 0.5f));
+    }
+    CHECK(Near(s[5], 0.0f) && Near(l[5], 1.0f));
+    CHECK(Near(l[6], 0.0f));
+
+    // D65 white is L 100 with no chroma; black is L 0
+    float a[count], b[count];
+    ColorSpace::RGBToLab(colors, l, a, b, count);
+    CHECK(Near(l[5], 100.0f, 0.05f) && Near(a[5], 0.0f, 0.05f) && Near(b[5], 0.0f, 0.05f));
+    CHECK(Near(l[6], 0.0f, 0.05f));
+    CHECK(Near(a[4], 0.0f, 0.05f) && Near(b[4], 0.0f, 0.05f));
+    CHECK(a[0] > 60.0f && b[0] > 50.0f);   // Red
+    CHECK(a[2] < -70.0f && b[2] > 60.0f);  // Green
+    CHECK(b[3] < -90.0f);                  // Blue
+}
+
+void TestRoundTrips()
+{
+    // Every green and blue for every fifth red (0, 5, .., 255), one red per span
+    const int count = 256 * 256;
+    std::vector<D3DCOLOR> colors(count);
+    std::vector<D3DCOLOR> result(count);
+    std::vector<float> x(count), y(count), z(count);
+    std::vector<float> rgba(count * 4);
+
+    int hsvWorst = 0;
+    int hslWorst = 0;
+    int labWorst = 0;
+    int srgbWorst = 0;
+    for (int r = 0; r < 256; r += 5)
+    {
+        for (int i = 0; i < count; i++)
+            colors[i] = D3DCOLOR_ARGB((r + i) & 0xff, r, i >> 8, i & 0xff);
+
+        ColorSpace::RGBToHSV(colors.data(), x.data(), y.data(), z.data(), count);
+        result = colors;
+        ColorSpace::HSVToRGB(x.data(), y.data(), z.data(), result.data(), count);
+        for (int i = 0; i < count; i++)
+            hsvWorst = std::max(hsvWorst, ChannelDifference(colors[i], result[i]));
+
+        ColorSpace::RGBToHSL(colors.data(), x.data(), y.data(), z.data(), count);
+        result = colors;
+        ColorSpace::HSLToRGB(x.data(), y.data(), z.data(), result.data(), count);
+        for (int i = 0; i < count; i++)
+            hslWorst = std::max(hslWorst, ChannelDifference(colors[i], result[i]));
+
+        ColorSpace::RGBToLab(colors.data(), x.data(), y.data(), z.data(), count);
+        result = colors;
+        ColorSpace::LabToRGB(x.data(), y.data(), z.data(), result.data(), count);
+        for (int i = 0; i < count; i++)
+            labWorst = std::max(labWorst, ChannelDifference(colors[i], result[i]));
+
+        ColorSpace::DecodeSRGB(colors.data(), rgba.data(), count);
+        ColorSpace::EncodeSRGB(rgba.data(), result.data(), count);
+        for (int i = 0; i < count; i++)
+            srgbWorst = std::max(srgbWorst, ChannelDifference(colors[i], result[i]));
+    }
+
+    CHECK(hsvWorst == 0);
+    CHECK(hslWorst == 0);
+    CHECK(labWorst == 0);
+    CHECK(srgbWorst == 0);
+}
+
+void TestSRGB()
+{
+    const D3DCOLOR colors[] = { D3DCOLOR_ARGB(0, 0, 0, 0), D3DCOLOR_ARGB(255, 255, 255, 255),
+                                D3DCOLOR_ARGB(51, 188, 10, 128) };
+    float rgba[12];
+    ColorSpace::DecodeSRGB(colors, rgba, 3);
+
+    CHECK(rgba[0] == 0.0f && rgba[1] == 0.0f && rgba[2] == 0.0f && rgba[3] == 0.0f);
+    CHECK(Near(rgba[4], 1.0f, 1e-6f) && Near(rgba[5], 1.0f, 1e-6f) && Near(rgba[6], 1.0f, 1e-6f));
+    CHECK(Near(rgba[7], 1.0f, 1e-6f));
+
+    // Linear light: sRGB 188 is about half, 10 is on the linear toe; alpha is not curved
+    CHECK(Near(rgba[8], 0.5029f, 1e-3f));
+    CHECK(Near(rgba[9], 10.0f / 255.0f / 12.92f, 1e-5f));
+    CHECK(Near(rgba[11], 0.2f, 1e-6f));
+
+    // Encoding clamps
+    const float outside[] = { -0.5f, 2.0f, 0.5f, 1.5f };
+    D3DCOLOR encoded = 0;
+    ColorSpace::EncodeSRGB(outside, &encoded, 1);
+    CHECK((encoded >> 24) == 255);
+    CHECK(((encoded >> 16) & 0xff) == 0);
+    CHECK(((encoded >> 8) & 0xff) == 255);
+    CHECK((encoded & 0xff) == 188);
+}
+
+void TestHueWrapAndAlpha()
+{
+    // Hues outside [0, 360) wrap, out-of-range components clamp, alpha stays
+    const float h[] = { 480.0f, -120.0f, 360.0f, 0.0f, 120.0f };
+    const float s[] = { 1.0f, 1.0f, 1.0f, 2.0f, -1.0f };
+    const float v[] = { 1.0f, 1.0f, 1.0f, 1.0f, 0.5f };
+    D3DCOLOR colors[5];
+    for (int i = 0; i < 5; i++)
+        colors[i] = D3DCOLOR_ARGB(40 * i + 1, 9, 9, 9);
+
+    ColorSpace::HSVToRGB(h, s, v, colors, 5);
+    CHECK(colors[0] == D3DCOLOR_ARGB(1, 0, 255, 0));
+    CHECK(colors[1] == D3DCOLOR_ARGB(41, 0, 0, 255));
+    CHECK(colors[2] == D3DCOLOR_ARGB(81, 255, 0, 0));
+    CHECK(colors[3] == D3DCOLOR_ARGB(121, 255, 0, 0));
+    CHECK(colors[4] == D3DCOLOR_ARGB(161, 128, 128, 128));
+}
+
+void TestSpanTails()
+{
+    // Spans of 1..9 pixels give the same results as one long span
+    const int total = 9;
+    D3DCOLOR colors[total];
+    for (int i = 0; i < total; i++)
+        colors[i] = D3DCOLOR_ARGB(i * 20, 255 - i * 25, i * 28, (i * 71) & 0xff);
+
+    float h[total], s[total], v[total];
+    ColorSpace::RGBToHSV(colors, h, s, v, total);
+
+    for (int count = 1; count <= total; count++)
+    {
+        for (int start = 0; start + count <= total; start++)
+        {
+            float hs[total], ss[total], vs[total];
+            ColorSpace::RGBToHSV(colors + start, hs, ss, vs, count);
+            for (int i = 0; i < count; i++)
+                CHECK(hs[i] == h[start + i] && ss[i] == s[start + i] && vs[i] == v[start + i]);
+
+            D3DCOLOR back[total] = {};
+            ColorSpace::HSVToRGB(hs, ss, vs, back, count);
+            for (int i = 0; i < count; i++)
+                CHECK((back[i] & 0xffffff) == (colors[start + i] & 0xffffff));
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestKnownColors();
+    TestRoundTrips();
+    TestSRGB();
+    TestHueWrapAndAlpha();
+    TestSpanTails();
+    return Test::Finish("ColorSpaceTests");
+}
@@ -0,0 +1,212 @@
+// Fixed point convolution against the float reference, bit-identical on
+// every instruction set and pool size, and the kernels that fall back to
+// the float path.
+
+#include "TestCheck.h"
+#include "Core/ThreadPool.h"
+#include "Textures/Effects/Convolution.h"
+#include "Textures/Effects/EffectThreads.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+struct TestKernel {
+    std::vector<float> weights;
+    int size;
+    float divisor;
+};
+
+const TestKernel kKernels[] = {
+    { { 0, -1, 0, -1, 5, -1, 0, -1, 0 }, 3, 1.0f },                 // Sharpen
+    { { -2, -1, 0, -1, 1, 1, 0, 1, 2 }, 3, 1.0f },                  // Emboss
+    { { 0, 1, 0, 1, -4, 1, 0, 1, 0 }, 3, 1.0f },                    // Laplacian
+    { { 1, 2, 1, 2, 4, 2, 1, 2, 1 }, 3, 16.0f },                    // Binomial blur
+    { { 0.3f, -0.7f, 1.1f, 0.05f, 0.9f, -0.2f, 0.0f, 0.33f, -0.4f }, 3, 1.3f },
+    { { 1, 4, 6, 4, 1, 4, 16, 24, 16, 4, 6, 24, 36, 24, 6, 4, 16, 24, 16, 4, 1, 4, 6, 4, 1 }, 5, 256.0f },
+};
+
+bool SamePixels(const PixelBuffer& a, const PixelBuffer& b)
+{
+    if (a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight())
+        return false;
+
+    ImageView viewA = a.GetView();
+    ImageView viewB = b.GetView();
+    for (int y = 0; y < viewA.height; y++)
+    {
+        if (memcmp(viewA.Row(y), viewB.Row(y), viewA.width * sizeof(D3DCOLOR)) != 0)
+            return false;
+    }
+    return true;
+}
+
+// Largest per-channel difference; alpha must match exactly
+int MaxDifference(const PixelBuffer& a, const PixelBuffer& b)
+{
+    ImageView viewA = a.GetView();
+    ImageView viewB = b.GetView();
+    int worst = 0;
+    for (int y = 0; y < viewA.height; y++)
+    {
+        for (int x = 0; x < viewA.width; x++)
+        {
+            D3DCOLOR colorA = viewA.At(x, y);
+            D3DCOLOR colorB = viewB.At(x, y);
+            if ((colorA >> 24) != (colorB >> 24))
+                return 256;
+
+            for (int shift = 0; shift < 24; shift += 8)
+            {
+                int difference = abs(static_cast<int>((colorA >> shift) & 0xff) - static_cast<int>((colorB >> shift) & 0xff));
+                if (difference > worst)
+                    worst = difference;
+            }
+        }
+    }
+    return worst;
+}
+
+void FillPattern(const ImageView& image)
+{
+    uint32_t state = 987654321;
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            state = state * 1664525u + 1013904223u;
+            image.At(x, y) = state;
+        }
+    }
+}
+
+void TestMatchesFloat()
+{
+    const int sizes[][2] = { { 64, 64 }, { 37, 19 }, { 1, 1 }, { 2, 9 } };
+
+    for (const TestKernel& kernel : kKernels)
+    {
+        CHECK(Convolution::IsFixedPoint(kernel.weights.data(), kernel.size, kernel.divisor));
+
+        for (const auto& size : sizes)
+        {
+            PixelBuffer source(size[0], size[1]);
+            FillPattern(source.GetView());
+
+            PixelBuffer fixed = source;
+            PixelBuffer reference = source;
+            Convolution::Apply(fixed.GetView(), kernel.weights.data(), kernel.size, kernel.divisor);
+            Convolution::ApplyFloat(reference.GetView(), kernel.weights.data(), kernel.size, kernel.divisor);
+            CHECK(MaxDifference(fixed, reference) <= 1);
+        }
+    }
+
+    // Identity and normalized kernels are exact on flat areas
+    const float identity[] = { 0, 0, 0, 0, 1, 0, 0, 0, 0 };
+    PixelBuffer pattern(23, 17);
+    FillPattern(pattern.GetView());
+    PixelBuffer copy = pattern;
+    Convolution::Apply(copy.GetView(), identity, 3);
+    CHECK(SamePixels(pattern, copy));
+
+    PixelBuffer flat(16, 16);
+    flat.Clear(D3DCOLOR_ARGB(77, 201, 13, 128));
+    Convolution::Apply(flat.GetView(), kKernels[5].weights.data(), 5, kKernels[5].divisor);
+    bool unchanged = true;
+    for (int y = 0; y < 16; y++)
+    {
+        for (int x = 0; x < 16; x++)
+            unchanged = unchanged && flat.GetView().At(x, y) == D3DCOLOR_ARGB(77, 201, 13, 128);
+    }
+    CHECK(unchanged);
+}
+
+void TestFloatFallback()
+{
+    // Weights that cannot fit 16 bits, or are not finite, run the float path
+    const float huge[] = { 40000.0f };
+    CHECK(!Convolution::IsFixedPoint(huge, 1));
+    const float zeroDivisor[] = { 0, 0, 0, 0, 1, 0, 0, 0, 0 };
+    CHECK(!Convolution::IsFixedPoint(zeroDivisor, 3, 0.0f));
+    CHECK(!Convolution::IsFixedPoint(nullptr, 3));
+
+    PixelBuffer source(20, 12);
+    FillPattern(source.GetView());
+    PixelBuffer viaApply = source;
+    PixelBuffer viaFloat = source;
+    const float large[] = { 0, 0, 0, 0, 40000.0f, 0, 0, 0, 0 };
+    Convolution::Apply(viaApply.GetView(), large, 3, 39999.0f);
+    Convolution::ApplyFloat(viaFloat.GetView(), large, 3, 39999.0f);
+    CHECK(SamePixels(viaApply, viaFloat));
+}
+
+void TestSimdLevelsMatch()
+{
+    // Widths around the 4- and 8-pixel vector steps
+    const int widths[] = { 1, 3, 7, 8, 9, 16, 33, 130 };
+    const SimdLevel levels[] = { SimdLevel::SSE2, SimdLevel::AVX2 };
+    SimdLevel best = Convolution::GetSimdLevel();
+
+    for (const TestKernel& kernel : kKernels)
+    {
+        for (int width : widths)
+        {
+            PixelBuffer source(width, 11);
+            FillPattern(source.GetView());
+
+            PixelBuffer reference = source;
+            Convolution::SetSimdLevel(SimdLevel::Scalar);
+            Convolution::Apply(reference.GetView(), kernel.weights.data(), kernel.size, kernel.divisor);
+
+            for (SimdLevel level : levels)
+            {
+                PixelBuffer image = source;
+                Convolution::SetSimdLevel(level);
+                Convolution::Apply(image.GetView(), kernel.weights.data(), kernel.size, kernel.divisor);
+                CHECK(SamePixels(reference, image));
+            }
+        }
+    }
+    Convolution::SetSimdLevel(best);
+}
+
+void TestPoolSizes()
+{
+    const int workerCounts[] = { 1, 3, 7 };
+
+    for (const TestKernel& kernel : kKernels)
+    {
+        PixelBuffer source(211, 97);
+        FillPattern(source.GetView());
+
+        PixelBuffer reference = source;
+        ThreadPool serial(0);
+        SetEffectThreadPool(&serial);
+        Convolution::Apply(reference.GetView(), kernel.weights.data(), kernel.size, kernel.divisor);
+
+        for (int workers : workerCounts)
+        {
+            ThreadPool pool(workers);
+            SetEffectThreadPool(&pool);
+            PixelBuffer image = source;
+            Convolution::Apply(image.GetView(), kernel.weights.data(), kernel.size, kernel.divisor);
+            CHECK(SamePixels(reference, image));
+        }
+        SetEffectThreadPool(nullptr);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestMatchesFloat();
+    TestFloatFallback();
+    TestSimdLevelsMatch();
+    TestPoolSizes();
+    return Test::Finish("ConvolutionTests");
+}
@@ -0,0 +1,228 @@
+// CPU mip chains: level count and sizes, box averages, flat images, unit
+// normals in every level of a normal map, and alpha coverage kept for
+// cutout textures.
+
+#include "TestCheck.h"
+#include "Textures/Effects/MipChain.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using namespace TextureEffects;
+
+namespace {
+
+bool IsFlat(const ImageView& view, D3DCOLOR color)
+{
+    for (int y = 0; y < view.height; y++)
+    {
+        for (int x = 0; x < view.width; x++)
+        {
+            if (view.At(x, y) != color)
+                return false;
+        }
+    }
+    return true;
+}
+
+uint32_t Next(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+void TestLevelSizes()
+{
+    CHECK(MipChain::CountLevels(1, 1) == 1);
+    CHECK(MipChain::CountLevels(256, 256) == 9);
+    CHECK(MipChain::CountLevels(256, 64) == 9);
+    CHECK(MipChain::CountLevels(5, 3) == 3);
+    CHECK(MipChain::CountLevels(1, 100) == 7);
+
+    PixelBuffer source(100, 37);
+    source.Clear(D3DCOLOR_ARGB(255, 1, 2, 3));
+    MipChain chain;
+    CHECK(chain.Build(source.GetView()));
+    CHECK(chain.GetLevelCount() == 7);
+
+    // Each level halves, rounding down, and stops at 1
+    const int expected[][2] = { { 100, 37 }, { 50, 18 }, { 25, 9 }, { 12, 4 }, { 6, 2 }, { 3, 1 }, { 1, 1 } };
+    size_t bytes = 0;
+    for (int level = 0; level < chain.GetLevelCount(); level++)
+    {
+        ImageView view = chain.GetLevel(level);
+        CHECK(view.width == expected[level][0] && view.height == expected[level][1]);
+        bytes += static_cast<size_t>(view.pitch) * view.height * sizeof(D3DCOLOR);
+    }
+    CHECK(chain.GetMemoryUsage() == bytes);
+
+    MipOptions limited;
+    limited.maxLevels = 3;
+    CHECK(chain.Build(source.GetView(), limited));
+    CHECK(chain.GetLevelCount() == 3);
+
+    CHECK(!chain.Build(ImageView()));
+}
+
+void TestAverages()
+{
+    // Level 0 is a copy; a box in gamma space averages each 2x2 block
+    PixelBuffer source(4, 4);
+    ImageView view = source.GetView();
+    uint32_t state = 7;
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 4; x++)
+            view.At(x, y) = D3DCOLOR_ARGB(255, (Next(state) & 0x3f) * 4, (Next(state) & 0x3f) * 4, (Next(state) & 0x3f) * 4);
+    }
+
+    MipOptions options;
+    options.filter = ResampleFilter::Box;
+    options.srgb = false;
+    MipChain chain;
+    CHECK(chain.Build(view, options));
+    CHECK(chain.GetLevelCount() == 3);
+
+    for (int y = 0; y < 4; y++)
+        CHECK(memcmp(chain.GetLevel(0).Row(y), view.Row(y), 4 * sizeof(D3DCOLOR)) == 0);
+
+    for (int by = 0; by < 2; by++)
+    {
+        for (int bx = 0; bx < 2; bx++)
+        {
+            for (int shift = 0; shift < 24; shift += 8)
+            {
+                int sum = 0;
+                for (int y = 0; y < 2; y++)
+                {
+                    for (int x = 0; x < 2; x++)
+                        sum += (view.At(bx * 2 + x, by * 2 + y) >> shift) & 0xff;
+                }
+                // Every channel is a multiple of 4, so the average is whole
+                int actual = (chain.GetLevel(1).At(bx, by) >> shift) & 0xff;
+                CHECK(actual == sum / 4);
+            }
+        }
+    }
+
+    // Flat images stay flat with every filter, in gamma and linear light
+    const ResampleFilter filters[] = { ResampleFilter::Box, ResampleFilter::Kaiser, ResampleFilter::Lanczos3 };
+    PixelBuffer flat(64, 40);
+    flat.Clear(D3DCOLOR_ARGB(90, 200, 31, 77));
+    for (ResampleFilter filter : filters)
+    {
+        for (bool srgb : { false, true })
+        {
+            MipOptions flatOptions;
+            flatOptions.filter = filter;
+            flatOptions.srgb = srgb;
+            CHECK(chain.Build(flat.GetView(), flatOptions));
+            for (int level = 0; level < chain.GetLevelCount(); level++)
+                CHECK(IsFlat(chain.GetLevel(level), D3DCOLOR_ARGB(90, 200, 31, 77)));
+        }
+    }
+}
+
+void TestNormalMap()
+{
+    // Random normals facing +z: every level keeps them unit length
+    PixelBuffer source(64, 64);
+    ImageView view = source.GetView();
+    uint32_t state = 99;
+    for (int y = 0; y < 64; y++)
+    {
+        for (int x = 0; x < 64; x++)
+        {
+            float nx = (Next(state) % 2001) / 1000.0f - 1.0f;
+            float ny = (Next(state) % 2001) / 1000.0f - 1.0f;
+            float nz = 0.2f + (Next(state) % 1001) / 1000.0f;
+            float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+            auto encode = [](float value) { return static_cast<int>(std::lround((value * 0.5f + 0.5f) * 255.0f)); };
+            view.At(x, y) = D3DCOLOR_ARGB(255, encode(nx / length), encode(ny / length), encode(nz / length));
+        }
+    }
+
+    MipOptions options;
+    options.normalMap = true;
+    MipChain chain;
+    CHECK(chain.Build(view, options));
+
+    for (int level = 1; level < chain.GetLevelCount(); level++)
+    {
+        ImageView mip = chain.GetLevel(level);
+        float worst = 0.0f;
+        for (int y = 0; y < mip.height; y++)
+        {
+            for (int x = 0; x < mip.width; x++)
+            {
+                D3DCOLOR color = mip.At(x, y);
+                float nx = ((color >> 16) & 0xff) / 127.5f - 1.0f;
+                float ny = ((color >> 8) & 0xff) / 127.5f - 1.0f;
+                float nz = (color & 0xff) / 127.5f - 1.0f;
+                worst = std::fmax(worst, std::fabs(std::sqrt(nx * nx + ny * ny + nz * nz) - 1.0f));
+            }
+        }
+        // Within the quantization of one byte per component
+        CHECK(worst < 0.015f);
+    }
+}
+
+void TestAlphaCoverage()
+{
+    PixelBuffer image(10, 10);
+    ImageView view = image.GetView();
+    for (int y = 0; y < 10; y++)
+    {
+        for (int x = 0; x < 10; x++)
+            view.At(x, y) = D3DCOLOR_ARGB(x * 25 + y, 0, 0, 0);
+    }
+
+    // Alpha >= 128 where x >= 6 (150..159) or x == 5 and y >= 3 (128..134)
+    CHECK(std::fabs(MipChain::GetAlphaCoverage(view, 128.0f / 255.0f) - 0.47f) < 1e-6f);
+    CHECK(MipChain::GetAlphaCoverage(view, 0.0f) == 1.0f);
+
+    MipChain::ScaleAlphaToCoverage(view, 0.5f, 0.8f);
+    CHECK(std::fabs(MipChain::GetAlphaCoverage(view, 0.5f) - 0.8f) <= 0.011f);
+
+    // Sparse foliage-like cutout: filtered alpha alone thins out, the
+    // rescaled chain keeps roughly the coverage of level 0
+    PixelBuffer foliage(128, 128);
+    ImageView leaves = foliage.GetView();
+    uint32_t state = 5;
+    for (int y = 0; y < 128; y++)
+    {
+        for (int x = 0; x < 128; x++)
+            leaves.At(x, y) = (Next(state) % 100) < 35 ? D3DCOLOR_ARGB(255, 40, 160, 30) : D3DCOLOR_ARGB(0, 40, 160, 30);
+    }
+
+    MipOptions options;
+    options.alphaCutoff = 0.5f;
+    MipChain chain;
+    CHECK(chain.Build(leaves, options));
+    float coverage = MipChain::GetAlphaCoverage(chain.GetLevel(0), 0.5f);
+
+    MipOptions plain;
+    MipChain unscaled;
+    CHECK(unscaled.Build(leaves, plain));
+
+    for (int level = 1; level < chain.GetLevelCount(); level++)
+    {
+        ImageView mip = chain.GetLevel(level);
+        if (mip.width * mip.height < 64)
+            break;
+
+        CHECK(std::fabs(MipChain::GetAlphaCoverage(mip, 0.5f) - coverage) < 0.03f);
+    }
+    CHECK(MipChain::GetAlphaCoverage(unscaled.GetLevel(3), 0.5f) < coverage - 0.1f);
+}
+
+} // namespace
+
+int main()
+{
+    TestLevelSizes();
+    TestAverages();
+    TestNormalMap();
+    TestAlphaCoverage();
+    return Test::Finish("MipChainTests");
+}
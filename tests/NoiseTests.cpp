@@ -0,0 +1,118 @@
+// Batched noise must be bit-identical on every instruction set, and tiled
+// procedural generation must not depend on the size of the effects pool.
+
+#include "TestCheck.h"
+#include "Core/CpuFeatures.h"
+#include "Core/ThreadPool.h"
+#include "Textures/Effects/EffectThreads.h"
+#include "Textures/Effects/NoiseCore.h"
+#include "Textures/Effects/ProceduralTextures.h"
+#include <cstring>
+#include <functional>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+bool SameBits(const std::vector<float>& a, const std::vector<float>& b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+bool SamePixels(const PixelBuffer& a, const PixelBuffer& b)
+{
+    if (a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight())
+        return false;
+
+    ImageView viewA = a.GetView();
+    ImageView viewB = b.GetView();
+    for (int y = 0; y < viewA.height; y++)
+    {
+        if (memcmp(viewA.Row(y), viewB.Row(y), viewA.width * sizeof(D3DCOLOR)) != 0)
+            return false;
+    }
+    return true;
+}
+
+// Odd widths leave scalar tails after the 4- and 8-wide kernels
+void TestSimdLevelsMatch()
+{
+    NoiseCore noise(1337);
+    const NoiseFractal fractals[] = { NoiseFractal::FBM, NoiseFractal::Ridged, NoiseFractal::Billow, NoiseFractal::Turbulence };
+    const int widths[] = { 1, 3, 7, 8, 17, 64, 259 };
+    const int height = 9;
+
+    for (NoiseFractal fractal : fractals)
+    {
+        NoiseParams params;
+        params.fractal = fractal;
+        params.frequency = 7.3f;
+        params.octaves = 5;
+
+        for (int width : widths)
+        {
+            std::vector<float> reference(static_cast<size_t>(width) * height);
+            NoiseCore::SetSimdLevel(SimdLevel::Scalar);
+            noise.EvaluateGrid(params, -3.25f, 11.5f, 0.0137f, 0.021f, width, height, reference.data(), width);
+
+            const SimdLevel levels[] = { SimdLevel::SSE2, SimdLevel::AVX2 };
+            for (SimdLevel level : levels)
+            {
+                if (level > CpuFeatures::GetMaxSimdLevel())
+                    break;
+
+                std::vector<float> batched(reference.size());
+                NoiseCore::SetSimdLevel(level);
+                noise.EvaluateGrid(params, -3.25f, 11.5f, 0.0137f, 0.021f, width, height, batched.data(), width);
+                CHECK(SameBits(reference, batched));
+            }
+        }
+    }
+
+    NoiseCore::SetSimdLevel(CpuFeatures::GetMaxSimdLevel());
+}
+
+// Sizes that are and are not multiples of the 64-pixel tile
+void TestTiledOutputAcrossPools()
+{
+    const std::function<void(const ImageView&)> generators[] = {
+        [](const ImageView& image) { ProceduralTextures::GeneratePerlinNoise(image, 6.0f, 5); },
+        [](const ImageView& image) { ProceduralTextures::GenerateMarble(image, D3DCOLOR_XRGB(230, 230, 220), D3DCOLOR_XRGB(60, 60, 70)); },
+        [](const ImageView& image) { ProceduralTextures::GenerateWoodGrain(image, D3DCOLOR_XRGB(200, 150, 90), D3DCOLOR_XRGB(110, 70, 40)); },
+        [](const ImageView& image) { ProceduralTextures::GenerateRock(image, D3DCOLOR_XRGB(128, 120, 110)); },
+        [](const ImageView& image) { ProceduralTextures::GenerateVoronoi(image, 9.0f); },
+    };
+    const int sizes[][2] = { { 256, 256 }, { 200, 130 }, { 1, 67 } };
+    const int workerCounts[] = { 0, 1, 3, 7 };
+
+    for (const auto& generate : generators)
+    {
+        for (const auto& size : sizes)
+        {
+            PixelBuffer reference(size[0], size[1]);
+            ThreadPool serial(0);
+            SetEffectThreadPool(&serial);
+            generate(reference.GetView());
+
+            for (int workers : workerCounts)
+            {
+                ThreadPool pool(workers);
+                SetEffectThreadPool(&pool);
+                PixelBuffer image(size[0], size[1]);
+                generate(image.GetView());
+                CHECK(SamePixels(reference, image));
+            }
+            SetEffectThreadPool(nullptr);
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestSimdLevelsMatch();
+    TestTiledOutputAcrossPools();
+    return Test::Finish("NoiseTests");
+}
@@ -0,0 +1,267 @@
+// Resampler weight tables and filters, exact results on flat images, same
+// size copies and box averages, alpha-weighted filtering, and the same
+// pixels with any pool size.
+
+#include "TestCheck.h"
+#include "Core/ThreadPool.h"
+#include "Textures/Effects/EffectThreads.h"
+#include "Textures/Effects/Resampler.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using namespace TextureEffects;
+
+namespace {
+
+const ResampleFilter kFilters[] = { ResampleFilter::Box, ResampleFilter::Bilinear, ResampleFilter::CatmullRom,
+                                    ResampleFilter::Mitchell, ResampleFilter::Lanczos3, ResampleFilter::Kaiser };
+
+bool SamePixels(const PixelBuffer& a, const PixelBuffer& b)
+{
+    if (a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight())
+        return false;
+
+    ImageView viewA = a.GetView();
+    ImageView viewB = b.GetView();
+    for (int y = 0; y < viewA.height; y++)
+    {
+        if (memcmp(viewA.Row(y), viewB.Row(y), viewA.width * sizeof(D3DCOLOR)) != 0)
+            return false;
+    }
+    return true;
+}
+
+bool IsFlat(const PixelBuffer& image, D3DCOLOR color)
+{
+    ImageView view = image.GetView();
+    for (int y = 0; y < view.height; y++)
+    {
+        for (int x = 0; x < view.width; x++)
+        {
+            if (view.At(x, y) != color)
+                return false;
+        }
+    }
+    return true;
+}
+
+void FillPattern(const ImageView& image, bool opaque)
+{
+    uint32_t state = 424242;
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            state = state * 1664525u + 1013904223u;
+            image.At(x, y) = opaque ? (state | 0xff000000) : state;
+        }
+    }
+}
+
+void TestWeights()
+{
+    const int sizes[][2] = { { 100, 37 }, { 37, 100 }, { 64, 64 }, { 64, 32 }, { 1, 5 }, { 5, 1 }, { 3, 256 } };
+
+    for (ResampleFilter filter : kFilters)
+    {
+        for (const auto& size : sizes)
+        {
+            ResampleWeights table = Resampler::ComputeWeights(size[0], size[1], filter);
+            CHECK(static_cast<int>(table.start.size()) == size[1]);
+            CHECK(static_cast<int>(table.count.size()) == size[1]);
+
+            for (int i = 0; i < size[1]; i++)
+            {
+                CHECK(table.start[i] >= 0);
+                CHECK(table.count[i] >= 1 && table.count[i] <= table.maxTaps);
+                CHECK(table.start[i] + table.count[i] <= size[0]);
+
+                float sum = 0.0f;
+                for (int k = 0; k < table.count[i]; k++)
+                    sum += table.weights[i * table.maxTaps + k];
+                CHECK(std::fabs(sum - 1.0f) < 1e-5f);
+            }
+        }
+    }
+}
+
+void TestFilters()
+{
+    for (ResampleFilter filter : kFilters)
+    {
+        float radius = Resampler::GetFilterRadius(filter);
+        CHECK(radius > 0.0f);
+        CHECK(Resampler::EvaluateFilter(filter, radius + 0.01f) == 0.0f);
+        CHECK(Resampler::EvaluateFilter(filter, -radius - 0.01f) == 0.0f);
+        CHECK(Resampler::EvaluateFilter(filter, 0.3f) == Resampler::EvaluateFilter(filter, -0.3f));
+    }
+
+    // Interpolating filters are 1 at the center and 0 on other pixel centers
+    const ResampleFilter interpolating[] = { ResampleFilter::Bilinear, ResampleFilter::CatmullRom,
+                                             ResampleFilter::Lanczos3 };
+    for (ResampleFilter filter : interpolating)
+    {
+        CHECK(std::fabs(Resampler::EvaluateFilter(filter, 0.0f) - 1.0f) < 1e-6f);
+        for (int x = 1; x <= 3; x++)
+            CHECK(std::fabs(Resampler::EvaluateFilter(filter, static_cast<float>(x))) < 1e-6f);
+    }
+    CHECK(std::fabs(Resampler::EvaluateFilter(ResampleFilter::Bilinear, 0.5f) - 0.5f) < 1e-6f);
+
+    // Mitchell blurs: less than 1 at the center, positive at one pixel
+    CHECK(Resampler::EvaluateFilter(ResampleFilter::Mitchell, 0.0f) < 1.0f);
+    CHECK(Resampler::EvaluateFilter(ResampleFilter::Mitchell, 1.0f) > 0.0f);
+}
+
+void TestFlatAndIdentity()
+{
+    const int sizes[][2] = { { 13, 7 }, { 200, 150 }, { 1, 1 } };
+    const D3DCOLOR flatColor = D3DCOLOR_ARGB(200, 17, 128, 250);
+
+    for (ResampleFilter filter : kFilters)
+    {
+        for (bool srgb : { false, true })
+        {
+            ResampleOptions options;
+            options.filter = filter;
+            options.srgb = srgb;
+
+            PixelBuffer source(64, 48);
+            source.Clear(flatColor);
+            for (const auto& size : sizes)
+            {
+                PixelBuffer destination(size[0], size[1]);
+                CHECK(Resampler::Resize(source.GetView(), destination.GetView(), options));
+                CHECK(IsFlat(destination, flatColor));
+            }
+        }
+    }
+
+    // Same size through an interpolating filter copies opaque pixels
+    const ResampleFilter interpolating[] = { ResampleFilter::Box, ResampleFilter::Bilinear,
+                                             ResampleFilter::CatmullRom, ResampleFilter::Lanczos3 };
+    PixelBuffer pattern(41, 29);
+    FillPattern(pattern.GetView(), true);
+    for (ResampleFilter filter : interpolating)
+    {
+        ResampleOptions options;
+        options.filter = filter;
+        PixelBuffer copy(41, 29);
+        CHECK(Resampler::Resize(pattern.GetView(), copy.GetView(), options));
+        CHECK(SamePixels(pattern, copy));
+    }
+
+    PixelBuffer destination(4, 4);
+    CHECK(!Resampler::Resize(ImageView(), destination.GetView()));
+    CHECK(!Resampler::Resize(pattern.GetView(), ImageView()));
+}
+
+void TestAverages()
+{
+    // Halving with a box in gamma space averages each 2x2 block
+    ResampleOptions options;
+    options.filter = ResampleFilter::Box;
+    options.srgb = false;
+    options.alphaWeighted = false;
+
+    PixelBuffer source(4, 2);
+    ImageView view = source.GetView();
+    view.At(0, 0) = D3DCOLOR_ARGB(255, 0, 0, 0);
+    view.At(1, 0) = D3DCOLOR_ARGB(255, 100, 40, 8);
+    view.At(0, 1) = D3DCOLOR_ARGB(255, 200, 80, 0);
+    view.At(1, 1) = D3DCOLOR_ARGB(255, 100, 0, 12);
+    view.At(2, 0) = view.At(3, 0) = view.At(2, 1) = view.At(3, 1) = D3DCOLOR_ARGB(0, 255, 255, 255);
+
+    PixelBuffer half(2, 1);
+    CHECK(Resampler::Resize(source.GetView(), half.GetView(), options));
+    CHECK(half.GetView().At(0, 0) == D3DCOLOR_ARGB(255, 100, 30, 5));
+    CHECK(half.GetView().At(1, 0) == D3DCOLOR_ARGB(0, 255, 255, 255));
+
+    // In linear light black and white average to sRGB 188, not 128
+    PixelBuffer pair(2, 1);
+    pair.GetView().At(0, 0) = D3DCOLOR_ARGB(255, 0, 0, 0);
+    pair.GetView().At(1, 0) = D3DCOLOR_ARGB(255, 255, 255, 255);
+    PixelBuffer single(1, 1);
+    options.srgb = true;
+    CHECK(Resampler::Resize(pair.GetView(), single.GetView(), options));
+    CHECK(single.GetView().At(0, 0) == D3DCOLOR_ARGB(255, 188, 188, 188));
+
+    options.srgb = false;
+    CHECK(Resampler::Resize(pair.GetView(), single.GetView(), options));
+    CHECK(single.GetView().At(0, 0) == D3DCOLOR_ARGB(255, 128, 128, 128));
+}
+
+void TestAlphaWeighting()
+{
+    // A transparent red pixel next to an opaque blue one: weighted by alpha
+    // the red never shows, unweighted it bleeds into the average
+    PixelBuffer source(2, 1);
+    source.GetView().At(0, 0) = D3DCOLOR_ARGB(0, 255, 0, 0);
+    source.GetView().At(1, 0) = D3DCOLOR_ARGB(255, 0, 0, 255);
+    PixelBuffer single(1, 1);
+
+    ResampleOptions options;
+    options.filter = ResampleFilter::Box;
+    options.srgb = false;
+    CHECK(Resampler::Resize(source.GetView(), single.GetView(), options));
+    CHECK(single.GetView().At(0, 0) == D3DCOLOR_ARGB(128, 0, 0, 255));
+
+    options.alphaWeighted = false;
+    CHECK(Resampler::Resize(source.GetView(), single.GetView(), options));
+    CHECK(single.GetView().At(0, 0) == D3DCOLOR_ARGB(128, 128, 0, 128));
+
+    // X8R8G8B8 images ignore alpha, weighted or not
+    PixelBuffer opaqueSource(2, 1, PixelFormat::X8R8G8B8);
+    opaqueSource.GetView().At(0, 0) = D3DCOLOR_ARGB(0, 255, 0, 0);
+    opaqueSource.GetView().At(1, 0) = D3DCOLOR_ARGB(255, 0, 0, 255);
+    PixelBuffer opaqueSingle(1, 1, PixelFormat::X8R8G8B8);
+    options.alphaWeighted = true;
+    CHECK(Resampler::Resize(opaqueSource.GetView(), opaqueSingle.GetView(), options));
+    CHECK((opaqueSingle.GetView().At(0, 0) & 0xffffff) == D3DCOLOR_ARGB(0, 128, 0, 128));
+}
+
+void TestPoolSizes()
+{
+    const int sizes[][2] = { { 97, 61 }, { 301, 257 }, { 1, 40 } };
+    const int workerCounts[] = { 1, 3, 7 };
+
+    PixelBuffer source(160, 120);
+    FillPattern(source.GetView(), false);
+
+    for (ResampleFilter filter : kFilters)
+    {
+        ResampleOptions options;
+        options.filter = filter;
+
+        for (const auto& size : sizes)
+        {
+            PixelBuffer reference(size[0], size[1]);
+            ThreadPool serial(0);
+            SetEffectThreadPool(&serial);
+            Resampler::Resize(source.GetView(), reference.GetView(), options);
+
+            for (int workers : workerCounts)
+            {
+                ThreadPool pool(workers);
+                SetEffectThreadPool(&pool);
+                PixelBuffer image(size[0], size[1]);
+                Resampler::Resize(source.GetView(), image.GetView(), options);
+                CHECK(SamePixels(reference, image));
+            }
+            SetEffectThreadPool(nullptr);
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestWeights();
+    TestFilters();
+    TestFlatAndIdentity();
+    TestAverages();
+    TestAlphaWeighting();
+    TestPoolSizes();
+    return Test::Finish("ResamplerTests");
+}
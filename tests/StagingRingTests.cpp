@@ -0,0 +1,228 @@
+// Frame pacing of the staging ring against a mock upload sink: which slot
+// is uploaded, dropping of stale frames, the stats, and what happens when
+// every slot is busy.
+
+#include "TestCheck.h"
+#include "Core/ThreadPool.h"
+#include "Textures/Effects/StagingRing.h"
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+// Records the stamp each frame carries in its first pixel. duringUpload
+// runs while the ring has the slot marked as uploading.
+class MockSink : public UploadSink {
+public:
+    bool Upload(const ImageView& image) override
+    {
+        if (duringUpload)
+            duringUpload();
+        if (fail)
+            return false;
+
+        stamps.push_back(image.At(0, 0));
+        return true;
+    }
+
+    std::vector<D3DCOLOR> stamps;
+    std::function<void()> duringUpload;
+    bool fail = false;
+};
+
+// Writes a frame stamped with value and returns its slot
+int Publish(StagingRing& ring, D3DCOLOR value)
+{
+    int slot = ring.BeginWrite();
+    if (slot >= 0)
+    {
+        ring.GetView(slot).At(0, 0) = value;
+        ring.EndWrite(slot);
+    }
+    return slot;
+}
+
+void TestUploadsTheFrameWritten()
+{
+    StagingRing ring(2);
+    CHECK(ring.Allocate(8, 8));
+
+    MockSink sink;
+    CHECK(!ring.UploadLatest(sink));
+    CHECK(!ring.HasFrame());
+    CHECK(ring.GetLastUploadedFrame() == 0);
+
+    for (D3DCOLOR value = 1; value <= 5; value++)
+    {
+        CHECK(Publish(ring, value) >= 0);
+        CHECK(ring.HasFrame());
+        CHECK(ring.UploadLatest(sink));
+        CHECK(!ring.HasFrame());
+    }
+
+    CHECK((sink.stamps == std::vector<D3DCOLOR>{ 1, 2, 3, 4, 5 }));
+    CHECK(ring.GetLastUploadedFrame() == 5);
+
+    StagingRing::Stats stats = ring.GetStats();
+    CHECK(stats.published == 5);
+    CHECK(stats.uploaded == 5);
+    CHECK(stats.dropped == 0);
+}
+
+void TestOlderFramesAreDropped()
+{
+    StagingRing ring(4);
+    CHECK(ring.Allocate(4, 4));
+
+    CHECK(Publish(ring, 10) >= 0);
+    CHECK(Publish(ring, 11) >= 0);
+    CHECK(Publish(ring, 12) >= 0);
+
+    MockSink sink;
+    CHECK(ring.UploadLatest(sink));
+    CHECK((sink.stamps == std::vector<D3DCOLOR>{ 12 }));
+    CHECK(ring.GetLastUploadedFrame() == 3);
+
+    // The dropped frames are not uploaded later
+    CHECK(!ring.HasFrame());
+    CHECK(!ring.UploadLatest(sink));
+
+    StagingRing::Stats stats = ring.GetStats();
+    CHECK(stats.published == 3);
+    CHECK(stats.uploaded == 1);
+    CHECK(stats.dropped == 2);
+}
+
+void TestProducerRecyclesOldestUnreadFrame()
+{
+    StagingRing ring(2);
+    CHECK(ring.Allocate(4, 4));
+
+    int first = Publish(ring, 1);
+    int second = Publish(ring, 2);
+    CHECK(first >= 0 && second >= 0 && first != second);
+
+    // No free slot: the older unread frame is overwritten
+    CHECK(Publish(ring, 3) == first);
+    CHECK(ring.GetStats().dropped == 1);
+
+    MockSink sink;
+    CHECK(ring.UploadLatest(sink));
+    CHECK((sink.stamps == std::vector<D3DCOLOR>{ 3 }));
+    CHECK(ring.GetStats().dropped == 2);
+}
+
+void TestEverySlotBusy()
+{
+    StagingRing ring(2);
+    CHECK(ring.Allocate(4, 4));
+
+    // Both slots being written
+    int a = ring.BeginWrite();
+    int b = ring.BeginWrite();
+    CHECK(a >= 0 && b >= 0 && a != b);
+    CHECK(ring.BeginWrite() == -1);
+    CHECK(!ring.Allocate(16, 16));
+    ring.CancelWrite(b);
+    ring.GetView(a).At(0, 0) = 7;
+    ring.EndWrite(a);
+
+    // While a frame uploads, the producer gets the other slot, and once
+    // that one is being written too there is nothing left to hand out
+    MockSink sink;
+    int claimed = -2;
+    int afterClaim = -2;
+    sink.duringUpload = [&]() {
+        claimed = ring.BeginWrite();
+        afterClaim = ring.BeginWrite();
+        CHECK(!ring.Allocate(16, 16));
+    };
+    CHECK(ring.UploadLatest(sink));
+    CHECK(claimed == b);
+    CHECK(afterClaim == -1);
+    CHECK((sink.stamps == std::vector<D3DCOLOR>{ 7 }));
+
+    // The uploaded slot is free again
+    sink.duringUpload = nullptr;
+    CHECK(Publish(ring, 8) == a);
+    ring.CancelWrite(claimed);
+    CHECK(ring.UploadLatest(sink));
+    CHECK((sink.stamps == std::vector<D3DCOLOR>{ 7, 8 }));
+    CHECK(ring.Allocate(16, 16));
+    CHECK(ring.GetWidth() == 16);
+}
+
+void TestFailedUpload()
+{
+    StagingRing ring(2);
+    CHECK(ring.Allocate(4, 4));
+
+    MockSink sink;
+    sink.fail = true;
+    CHECK(Publish(ring, 1) >= 0);
+    CHECK(!ring.UploadLatest(sink));
+    CHECK(ring.GetStats().failedUploads == 1);
+    CHECK(ring.GetLastUploadedFrame() == 0);
+
+    // The slot was released, so both can be written again
+    CHECK(ring.BeginWrite() >= 0);
+    CHECK(ring.BeginWrite() >= 0);
+}
+
+// A render still in flight makes Launch skip the frame; Collect only sees
+// frames whose render finished
+void TestStagedRenderSkipsWhileRendering()
+{
+    ThreadPool pool(1);
+    StagedRender staged(2);
+    MockSink sink;
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    auto slowRender = [released](float time, const ImageView& image) {
+        released.wait();
+        image.At(0, 0) = static_cast<D3DCOLOR>(time);
+    };
+    auto render = [](float time, const ImageView& image) { image.At(0, 0) = static_cast<D3DCOLOR>(time); };
+
+    CHECK(staged.Launch(&pool, slowRender, 1.0f, 8, 8));
+    CHECK(staged.IsRendering());
+    CHECK(!staged.Launch(&pool, render, 2.0f, 8, 8));
+    CHECK(!staged.Collect(sink));
+
+    release.set_value();
+    staged.Wait();
+    CHECK(!staged.IsRendering());
+    CHECK(staged.Collect(sink));
+    CHECK((sink.stamps == std::vector<D3DCOLOR>{ 1 }));
+
+    // Inline renders run ahead of collection; only the newest is uploaded
+    CHECK(staged.Launch(nullptr, render, 3.0f, 8, 8));
+    CHECK(staged.Launch(nullptr, render, 4.0f, 8, 8));
+    CHECK(staged.Collect(sink));
+    CHECK((sink.stamps == std::vector<D3DCOLOR>{ 1, 4 }));
+    CHECK(staged.GetRing().GetStats().dropped == 1);
+
+    // A render that throws publishes nothing
+    CHECK(staged.Launch(&pool, [](float, const ImageView&) { throw std::runtime_error("render"); }, 5.0f, 8, 8));
+    staged.Wait();
+    CHECK(staged.HasFailed());
+    CHECK(!staged.Collect(sink));
+}
+
+} // namespace
+
+int main()
+{
+    TestUploadsTheFrameWritten();
+    TestOlderFramesAreDropped();
+    TestProducerRecyclesOldestUnreadFrame();
+    TestEverySlotBusy();
+    TestFailedUpload();
+    TestStagedRenderSkipsWhileRendering();
+    return Test::Finish("StagingRingTests");
+}
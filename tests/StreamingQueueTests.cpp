@@ -0,0 +1,223 @@
+// Streaming queue with mock loads: its own load pool, commits by priority
+// within the frame budget, failures, cancellation, Forget, and loads run a
+// few at a time, highest priority first, on a threaded pool.
+
+#include "TestCheck.h"
+#include "Core/ThreadPool.h"
+#include "Textures/Effects/StreamingQueue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+// Request whose load reports bytes and whose commit records its id
+StreamRequest MakeRequest(int id, size_t bytes, int priority, std::vector<int>& commits, bool loadSucceeds = true)
+{
+    StreamRequest request;
+    request.load = [bytes, loadSucceeds](size_t& uploadBytes) {
+        uploadBytes = bytes;
+        return loadSucceeds;
+    };
+    request.commit = [id, &commits]() {
+        commits.push_back(id);
+        return true;
+    };
+    request.priority = priority;
+    return request;
+}
+
+void TestOwnPool()
+{
+    // Loads blocked on I/O must not take workers from the effects
+    StreamingQueue::SetThreadPool(nullptr);
+    ThreadPool& pool = StreamingQueue::GetThreadPool();
+    CHECK(&pool != &ThreadPool::Default());
+    CHECK(pool.GetThreadCount() == StreamingQueue::kDefaultLoadThreads);
+
+    ThreadPool custom(1);
+    StreamingQueue::SetThreadPool(&custom);
+    CHECK(&StreamingQueue::GetThreadPool() == &custom);
+    StreamingQueue::SetThreadPool(nullptr);
+    CHECK(&StreamingQueue::GetThreadPool() == &pool);
+}
+
+void TestBudgetAndPriority()
+{
+    // Without workers every load finishes inside Submit
+    ThreadPool serial(0);
+    StreamingQueue::SetThreadPool(&serial);
+
+    std::vector<int> commits;
+    StreamingQueue queue;
+    StreamHandle low = queue.Submit(MakeRequest(1, 100, 0, commits));
+    StreamHandle high = queue.Submit(MakeRequest(2, 100, 5, commits));
+    StreamHandle middle = queue.Submit(MakeRequest(3, 100, 2, commits));
+    StreamHandle large = queue.Submit(MakeRequest(4, 1000, 10, commits));
+    CHECK(low != 0 && high != 0 && middle != 0 && large != 0);
+    CHECK(queue.GetState(high) == StreamState::Loaded);
+    CHECK(queue.GetPendingCount() == 4);
+    CHECK(commits.empty());
+
+    // The first commit always goes through, even over the budget
+    CHECK(queue.Update(250) == 1);
+    CHECK(commits == std::vector<int>({ 4 }));
+    CHECK(queue.GetState(large) == StreamState::Committed);
+
+    // Then by priority until the next one does not fit
+    CHECK(queue.SetPriority(low, 9));
+    CHECK(queue.Update(250) == 2);
+    CHECK(commits == std::vector<int>({ 4, 1, 2 }));
+    CHECK(queue.Update(0) == 1);
+    CHECK(commits == std::vector<int>({ 4, 1, 2, 3 }));
+    CHECK(queue.Update(1000) == 0);
+    CHECK(queue.GetPendingCount() == 0);
+
+    // Finished requests cannot change, and Forget drops them
+    CHECK(!queue.SetPriority(high, 1));
+    CHECK(!queue.Cancel(high));
+    CHECK(queue.Forget(high));
+    CHECK(queue.GetState(high) == StreamState::Unknown);
+    CHECK(!queue.Forget(high));
+
+    StreamingQueue::Stats stats = queue.GetStats();
+    CHECK(stats.submitted == 4);
+    CHECK(stats.committed == 4);
+    CHECK(stats.committedBytes == 1300);
+    StreamingQueue::SetThreadPool(nullptr);
+}
+
+void TestFailureAndCancel()
+{
+    ThreadPool serial(0);
+    StreamingQueue::SetThreadPool(&serial);
+
+    std::vector<int> commits;
+    StreamingQueue queue;
+    StreamHandle failing = queue.Submit(MakeRequest(1, 10, 0, commits, false));
+    StreamHandle cancelled = queue.Submit(MakeRequest(2, 10, 0, commits));
+    StreamHandle kept = queue.Submit(MakeRequest(3, 10, 0, commits));
+
+    CHECK(queue.GetState(failing) == StreamState::Failed);
+    CHECK(!queue.Forget(kept));
+    CHECK(queue.Cancel(cancelled));
+    CHECK(queue.GetState(cancelled) == StreamState::Cancelled);
+    CHECK(!queue.Cancel(cancelled));
+
+    // Neither a failed load nor a cancelled one commits
+    CHECK(queue.Update(1000) == 1);
+    CHECK(commits == std::vector<int>({ 3 }));
+
+    // A commit that fails marks the request failed
+    StreamRequest request = MakeRequest(4, 10, 0, commits);
+    request.commit = []() { return false; };
+    StreamHandle rejected = queue.Submit(request);
+    CHECK(queue.Update(1000) == 1);
+    CHECK(queue.GetState(rejected) == StreamState::Failed);
+
+    StreamingQueue::Stats stats = queue.GetStats();
+    CHECK(stats.failed == 2);
+    CHECK(stats.cancelled == 1);
+    CHECK(stats.committed == 1);
+    CHECK(queue.GetState(12345) == StreamState::Unknown);
+    StreamingQueue::SetThreadPool(nullptr);
+}
+
+void TestThreadedLoads()
+{
+    ThreadPool pool(4);
+    StreamingQueue::SetThreadPool(&pool);
+
+    // maxLoads 1: a gate holds the first load while the others queue up,
+    // then they load strictly by priority
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool open = false;
+        std::vector<int> loads;
+        std::vector<int> commits;
+
+        StreamingQueue queue(1);
+        StreamRequest gate = MakeRequest(0, 1, 100, commits);
+        gate.load = [&](size_t& uploadBytes) {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&] { return open; });
+            uploadBytes = 1;
+            return true;
+        };
+        queue.Submit(gate);
+
+        const int priorities[] = { 3, 7, 1, 5 };
+        for (int i = 0; i < 4; i++)
+        {
+            StreamRequest request = MakeRequest(i + 1, 1, priorities[i], commits);
+            request.load = [&, i](size_t& uploadBytes) {
+                std::lock_guard<std::mutex> lock(mutex);
+                loads.push_back(i + 1);
+                uploadBytes = 1;
+                return true;
+            };
+            queue.Submit(request);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            open = true;
+        }
+        condition.notify_all();
+        queue.Flush();
+
+        CHECK(loads == std::vector<int>({ 2, 4, 1, 3 }));
+        CHECK(commits.size() == 5);
+        CHECK(queue.GetPendingCount() == 0);
+    }
+
+    // Many loads: never more than maxLoads at once, all committed by Flush
+    {
+        std::atomic<int> running{0};
+        std::atomic<int> peak{0};
+        std::vector<int> commits;
+        const int count = 40;
+
+        StreamingQueue queue(2);
+        for (int i = 0; i < count; i++)
+        {
+            StreamRequest request = MakeRequest(i, 8, i % 5, commits);
+            request.load = [&](size_t& uploadBytes) {
+                int now = ++running;
+                int previous = peak.load();
+                while (now > previous && !peak.compare_exchange_weak(previous, now))
+                {
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                --running;
+                uploadBytes = 8;
+                return true;
+            };
+            queue.Submit(request);
+        }
+
+        queue.Flush();
+        CHECK(static_cast<int>(commits.size()) == count);
+        CHECK(peak.load() >= 1 && peak.load() <= 2);
+        CHECK(queue.GetStats().committedBytes == count * 8u);
+    }
+
+    StreamingQueue::SetThreadPool(nullptr);
+}
+
+} // namespace
+
+int main()
+{
+    TestOwnPool();
+    TestBudgetAndPriority();
+    TestFailureAndCancel();
+    TestThreadedLoads();
+    return Test::Finish("StreamingQueueTests");
+}
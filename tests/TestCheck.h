@@ -0,0 +1,36 @@
+#pragma once
+
+// Minimal assertions for the core tests: a failed check is printed and
+// counted, the test keeps going, and main returns the count for CTest.
+// Built with -DDX9ENGINE_BUILD_TESTS=ON (the default); runs without Direct3D.
+
+#include <cstdio>
+
+namespace Test {
+
+    inline int& Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline int Finish(const char* name)
+    {
+        if (Failures() == 0)
+            std::printf("%s: all checks passed\n", name);
+        else
+            std::printf("%s: %d checks failed\n", name, Failures());
+        return Failures() == 0 ? 0 : 1;
+    }
+
+}
+
+#define CHECK(condition)                                                                          \
+    do                                                                                            \
+    {                                                                                             \
+        if (!(condition))                                                                         \
+        {                                                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);    \
+            Test::Failures()++;                                                                   \
+        }                                                                                         \
+    } while (0)
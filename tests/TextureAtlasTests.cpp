@@ -0,0 +1,179 @@
+// Skyline packing and atlas building: rectangles inside the atlas and
+// apart, images copied with their borders extended, aligned placement,
+// no bleeding between neighbours at any level, and the UV mapping.
+
+#include "TestCheck.h"
+#include "Textures/Effects/TextureAtlas.h"
+#include <algorithm>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+struct Rect {
+    int x, y, width, height;
+};
+
+bool Overlap(const Rect& a, const Rect& b)
+{
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+void TestPacker()
+{
+    SkylinePacker packer(256, 256);
+    const int sizes[][2] = { { 100, 60 }, { 30, 90 }, { 64, 64 }, { 10, 10 }, { 120, 20 }, { 50, 33 }, { 7, 100 } };
+    std::vector<Rect> placed;
+    size_t area = 0;
+
+    for (const auto& size : sizes)
+    {
+        Rect rect = { 0, 0, size[0], size[1] };
+        CHECK(packer.Insert(rect.width, rect.height, rect.x, rect.y));
+        CHECK(rect.x >= 0 && rect.y >= 0 && rect.x + rect.width <= 256 && rect.y + rect.height <= 256);
+        for (const Rect& other : placed)
+            CHECK(!Overlap(rect, other));
+        placed.push_back(rect);
+        area += static_cast<size_t>(rect.width) * rect.height;
+    }
+    CHECK(packer.GetUsedArea() == area);
+
+    // Four quarters fill the square exactly; nothing fits after them
+    packer.Reset(128, 128);
+    for (int i = 0; i < 4; i++)
+    {
+        int x = -1;
+        int y = -1;
+        CHECK(packer.Insert(64, 64, x, y));
+        CHECK(x % 64 == 0 && y % 64 == 0);
+    }
+    int x = 0;
+    int y = 0;
+    CHECK(!packer.Insert(1, 1, x, y));
+    CHECK(!SkylinePacker(32, 32).Insert(33, 1, x, y));
+    CHECK(packer.GetUsedArea() == 128u * 128u);
+}
+
+void TestAtlasLayout()
+{
+    // Flat images of distinct colors and awkward sizes
+    const int sizes[][2] = { { 64, 64 }, { 13, 40 }, { 100, 7 }, { 1, 1 }, { 32, 32 }, { 57, 21 } };
+    const int count = 6;
+    TextureAtlas atlas;
+    std::vector<D3DCOLOR> colors;
+    for (int i = 0; i < count; i++)
+    {
+        PixelBuffer image(sizes[i][0], sizes[i][1]);
+        D3DCOLOR color = D3DCOLOR_ARGB(255, 40 * i, 255 - 30 * i, 17 * i + 5);
+        image.Clear(color);
+        colors.push_back(color);
+        CHECK(atlas.Add(image.GetView()) == i);
+    }
+    CHECK(atlas.Add(ImageView()) == -1);
+    CHECK(atlas.GetImageCount() == count);
+
+    AtlasOptions options;
+    options.padding = 4;
+    CHECK(atlas.Build(options));
+
+    // Power-of-two size, and one more level than log2(padding)
+    int width = atlas.GetWidth();
+    int height = atlas.GetHeight();
+    CHECK((width & (width - 1)) == 0 && (height & (height - 1)) == 0);
+    CHECK(atlas.GetLevelCount() == 3);
+
+    size_t used = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const AtlasRegion& region = atlas.GetRegion(i);
+        CHECK(region.width == sizes[i][0] && region.height == sizes[i][1]);
+        CHECK(region.x % 4 == 0 && region.y % 4 == 0);
+        CHECK(region.x >= options.padding && region.y >= options.padding);
+        CHECK(region.x + region.width + options.padding <= width);
+        CHECK(region.y + region.height + options.padding <= height);
+        CHECK(region.offsetU == static_cast<float>(region.x) / width);
+        CHECK(region.offsetV == static_cast<float>(region.y) / height);
+        CHECK(region.scaleU == static_cast<float>(region.width) / width);
+        CHECK(region.scaleV == static_cast<float>(region.height) / height);
+        used += static_cast<size_t>(region.width) * region.height;
+    }
+    CHECK(atlas.GetOccupancy() == static_cast<float>(used) / (static_cast<float>(width) * height));
+
+    // At every level each image and its padding hold only its own color:
+    // nothing bleeds in from a neighbour or gets overwritten by one
+    for (int level = 0; level < atlas.GetLevelCount(); level++)
+    {
+        ImageView view = atlas.GetLevel(level);
+        CHECK(view.width == width >> level && view.height == height >> level);
+        int padding = options.padding >> level;
+
+        for (int i = 0; i < count; i++)
+        {
+            const AtlasRegion& region = atlas.GetRegion(i);
+            int x0 = (region.x >> level) - padding;
+            int y0 = (region.y >> level) - padding;
+            int x1 = (region.x >> level) + std::max(1, region.width >> level) + padding;
+            int y1 = (region.y >> level) + std::max(1, region.height >> level) + padding;
+
+            bool clean = true;
+            for (int y = y0; y < y1; y++)
+            {
+                for (int x = x0; x < x1; x++)
+                    clean = clean && view.At(x, y) == colors[i];
+            }
+            CHECK(clean);
+        }
+    }
+}
+
+void TestBorders()
+{
+    // A gradient lands untouched at level 0, with each padding texel a
+    // copy of the nearest edge texel
+    PixelBuffer image(9, 6);
+    ImageView source = image.GetView();
+    for (int y = 0; y < 6; y++)
+    {
+        for (int x = 0; x < 9; x++)
+            source.At(x, y) = D3DCOLOR_ARGB(255, x * 20, y * 30, 7);
+    }
+
+    TextureAtlas atlas;
+    atlas.Add(source);
+    AtlasOptions options;
+    options.padding = 2;
+    CHECK(atlas.Build(options));
+
+    const AtlasRegion& region = atlas.GetRegion(0);
+    ImageView level0 = atlas.GetLevel(0);
+    for (int y = -2; y < 6 + 2; y++)
+    {
+        for (int x = -2; x < 9 + 2; x++)
+            CHECK(level0.At(region.x + x, region.y + y) == source.GetClamped(x, y));
+    }
+
+    // Too large for maxSize fails
+    TextureAtlas large;
+    PixelBuffer big(300, 300);
+    big.Clear(D3DCOLOR_ARGB(255, 1, 2, 3));
+    large.Add(big.GetView());
+    AtlasOptions small;
+    small.maxSize = 256;
+    CHECK(!large.Build(small));
+    CHECK(large.GetLevelCount() == 0);
+
+    large.Clear();
+    CHECK(large.GetImageCount() == 0);
+    CHECK(!large.Build());
+}
+
+} // namespace
+
+int main()
+{
+    TestPacker();
+    TestAtlasLayout();
+    TestBorders();
+    return Test::Finish("TextureAtlasTests");
+}
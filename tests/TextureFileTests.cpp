@@ -0,0 +1,276 @@
+// Layout of the .etex container: level alignment and table, Write/Open
+// round trips, rejection of truncated or damaged files, and detection of
+// changed level data by the content hash.
+
+#include "TestCheck.h"
+#include "Textures/Effects/MipChain.h"
+#include "Textures/Effects/TextureFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace TextureEffects;
+
+namespace {
+
+std::string TempFile(const char* name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::vector<uint8_t> ReadAll(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void WriteAll(const std::string& filename, const std::vector<uint8_t>& bytes)
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+void FillPattern(const ImageView& image)
+{
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+            image.At(x, y) = D3DCOLOR_ARGB(255 - x, x * 3, y * 5, (x ^ y) & 255);
+    }
+}
+
+// Every level 16-byte aligned in the file and in memory, in order, without
+// overlap, and sized as GetLevelPitch x GetLevelRows
+void CheckLayout(const TextureFile& file)
+{
+    uint64_t end = 32 + static_cast<uint64_t>(file.GetLevelCount()) * sizeof(TextureFileLevel);
+    for (int i = 0; i < file.GetLevelCount(); i++)
+    {
+        const TextureFileLevel& level = file.GetLevel(i);
+        CHECK(level.offset % 16 == 0);
+        CHECK(reinterpret_cast<uintptr_t>(file.GetLevelData(i)) % 16 == 0);
+        CHECK(level.offset >= end);
+        CHECK(level.width == static_cast<uint32_t>(std::max(1, file.GetWidth() >> i)));
+        CHECK(level.height == static_cast<uint32_t>(std::max(1, file.GetHeight() >> i)));
+        CHECK(level.pitch == static_cast<uint32_t>(TextureFile::GetLevelPitch(file.GetFormat(), level.width)));
+        CHECK(level.rows == static_cast<uint32_t>(TextureFile::GetLevelRows(file.GetFormat(), level.height)));
+        CHECK(level.size == static_cast<uint64_t>(level.pitch) * level.rows);
+        end = level.offset + level.size;
+    }
+    CHECK(end <= file.GetFileSize());
+}
+
+void TestLevelSizes()
+{
+    CHECK(TextureFile::GetLevelPitch(TextureFileFormat::A8R8G8B8, 7) == 28);
+    CHECK(TextureFile::GetLevelRows(TextureFileFormat::A8R8G8B8, 5) == 5);
+    CHECK(TextureFile::GetLevelPitch(TextureFileFormat::BC1, 1) == 8);
+    CHECK(TextureFile::GetLevelPitch(TextureFileFormat::BC1, 5) == 16);
+    CHECK(TextureFile::GetLevelPitch(TextureFileFormat::BC3, 5) == 32);
+    CHECK(TextureFile::GetLevelPitch(TextureFileFormat::BC4, 8) == 16);
+    CHECK(TextureFile::GetLevelPitch(TextureFileFormat::BC5, 9) == 48);
+    CHECK(TextureFile::GetLevelRows(TextureFileFormat::BC1, 1) == 1);
+    CHECK(TextureFile::GetLevelRows(TextureFileFormat::BC5, 9) == 3);
+
+    CHECK(TextureFile::IsTextureFile("rock.etex"));
+    CHECK(TextureFile::IsTextureFile("dir/ROCK.ETEX"));
+    CHECK(!TextureFile::IsTextureFile("rock.dds"));
+    CHECK(!TextureFile::IsTextureFile("etex"));
+}
+
+// Rows written from a padded source come back packed and unchanged
+void TestRoundTrip()
+{
+    std::string filename = TempFile("TextureFileTests_roundtrip.etex");
+
+    MipChain chain;
+    PixelBuffer source(37, 20);
+    FillPattern(source.GetView());
+    CHECK(chain.Build(source.GetView()));
+    CHECK(source.GetPitch() != source.GetWidth());
+
+    CHECK(TextureFile::WriteMipChain(filename, chain, TextureFileFormat::A8R8G8B8));
+
+    TextureFile file;
+    CHECK(file.Open(filename));
+    CHECK(file.GetFormat() == TextureFileFormat::A8R8G8B8);
+    CHECK(file.GetWidth() == 37);
+    CHECK(file.GetHeight() == 20);
+    CHECK(file.GetLevelCount() == chain.GetLevelCount());
+    CHECK(file.VerifyContentHash());
+    CheckLayout(file);
+
+    for (int i = 0; i < file.GetLevelCount(); i++)
+    {
+        ImageView level = chain.GetLevel(i);
+        const uint8_t* data = file.GetLevelData(i);
+        for (int y = 0; y < level.height; y++)
+        {
+            CHECK(memcmp(data + static_cast<size_t>(y) * file.GetLevel(i).pitch, level.Row(y),
+                         level.width * sizeof(D3DCOLOR)) == 0);
+        }
+    }
+
+    file.Close();
+    CHECK(!file.IsOpen());
+    std::filesystem::remove(filename);
+}
+
+// Block formats, including levels smaller than a block
+void TestBlockFormats()
+{
+    std::string filename = TempFile("TextureFileTests_blocks.etex");
+
+    PixelBuffer source(64, 16);
+    FillPattern(source.GetView());
+    MipChain chain;
+    CHECK(chain.Build(source.GetView()));
+
+    const TextureFileFormat formats[] = { TextureFileFormat::BC1, TextureFileFormat::BC3, TextureFileFormat::BC4,
+                                          TextureFileFormat::BC5 };
+    for (TextureFileFormat format : formats)
+    {
+        CHECK(TextureFile::WriteMipChain(filename, chain, format));
+        TextureFile file;
+        CHECK(file.Open(filename));
+        CHECK(file.GetFormat() == format);
+        CHECK(file.GetLevelCount() == 7);
+        CHECK(file.GetLevel(6).width == 1 && file.GetLevel(6).rows == 1);
+        CHECK(file.VerifyContentHash());
+        CheckLayout(file);
+    }
+    std::filesystem::remove(filename);
+}
+
+void TestInvalidWrites()
+{
+    std::string filename = TempFile("TextureFileTests_invalid.etex");
+    std::vector<D3DCOLOR> pixels(16 * 16);
+    TextureFileSource level = { pixels.data(), 16 * 4 };
+    TextureFileSource narrow = { pixels.data(), 15 * 4 };
+    TextureFileSource empty = {};
+
+    CHECK(TextureFile::Write(filename, TextureFileFormat::A8R8G8B8, 16, 16, &level, 1));
+    CHECK(!TextureFile::Write(filename, TextureFileFormat::A8R8G8B8, 0, 16, &level, 1));
+    CHECK(!TextureFile::Write(filename, TextureFileFormat::A8R8G8B8, 16, 16, &level, 0));
+    CHECK(!TextureFile::Write(filename, TextureFileFormat::A8R8G8B8, 16, 16, &level, 6));
+    CHECK(!TextureFile::Write(filename, TextureFileFormat::A8R8G8B8, 16, 16, &narrow, 1));
+    CHECK(!TextureFile::Write(filename, TextureFileFormat::A8R8G8B8, 16, 16, &empty, 1));
+    CHECK(!TextureFile::Write(filename, static_cast<TextureFileFormat>(99), 16, 16, &level, 1));
+    std::filesystem::remove(filename);
+}
+
+// Any cut or damaged header or table fails Open
+void TestDamagedFiles()
+{
+    std::string filename = TempFile("TextureFileTests_damaged.etex");
+
+    PixelBuffer source(32, 32);
+    FillPattern(source.GetView());
+    MipChain chain;
+    CHECK(chain.Build(source.GetView()));
+    CHECK(TextureFile::WriteMipChain(filename, chain, TextureFileFormat::BC3));
+    const std::vector<uint8_t> original = ReadAll(filename);
+
+    TextureFile file;
+    CHECK(file.Open(filename));
+    size_t tableEnd = 32 + static_cast<size_t>(file.GetLevelCount()) * sizeof(TextureFileLevel);
+    file.Close();
+
+    // Truncated anywhere: empty, inside the header, inside the table, inside the last level
+    const size_t cuts[] = { 0, 16, 31, 40, tableEnd - 1, original.size() - 1 };
+    for (size_t cut : cuts)
+    {
+        WriteAll(filename, std::vector<uint8_t>(original.begin(), original.begin() + cut));
+        CHECK(!file.Open(filename));
+        CHECK(!file.IsOpen());
+    }
+
+    // Any changed byte of the header but the hash, or of the level table
+    for (size_t offset = 0; offset < tableEnd; offset++)
+    {
+        if (offset >= 24 && offset < 32)
+            continue;
+
+        std::vector<uint8_t> damaged = original;
+        damaged[offset] ^= 0x10;
+        WriteAll(filename, damaged);
+        CHECK(!file.Open(filename));
+    }
+
+    // A file that is longer than needed is still valid
+    std::vector<uint8_t> longer = original;
+    longer.resize(original.size() + 100);
+    WriteAll(filename, longer);
+    CHECK(file.Open(filename));
+    CHECK(file.VerifyContentHash());
+    file.Close();
+
+    std::filesystem::remove(filename);
+    CHECK(!file.Open(filename));
+}
+
+// A flipped byte in any level, or in the stored hash, fails verification
+void TestContentHash()
+{
+    std::string filename = TempFile("TextureFileTests_hash.etex");
+
+    PixelBuffer source(16, 8);
+    FillPattern(source.GetView());
+    MipChain chain;
+    CHECK(chain.Build(source.GetView()));
+    CHECK(TextureFile::WriteMipChain(filename, chain, TextureFileFormat::A8R8G8B8));
+    const std::vector<uint8_t> original = ReadAll(filename);
+
+    TextureFile file;
+    CHECK(file.Open(filename));
+    std::vector<TextureFileLevel> levels;
+    for (int i = 0; i < file.GetLevelCount(); i++)
+        levels.push_back(file.GetLevel(i));
+    file.Close();
+
+    for (const TextureFileLevel& level : levels)
+    {
+        const uint64_t offsets[] = { level.offset, level.offset + level.size / 2, level.offset + level.size - 1 };
+        for (uint64_t offset : offsets)
+        {
+            std::vector<uint8_t> damaged = original;
+            damaged[static_cast<size_t>(offset)] ^= 0x01;
+            WriteAll(filename, damaged);
+            CHECK(file.Open(filename));
+            CHECK(!file.VerifyContentHash());
+            file.Close();
+        }
+    }
+
+    std::vector<uint8_t> damaged = original;
+    damaged[24] ^= 0x80;
+    WriteAll(filename, damaged);
+    CHECK(file.Open(filename));
+    CHECK(!file.VerifyContentHash());
+    file.Close();
+
+    WriteAll(filename, original);
+    CHECK(file.Open(filename));
+    CHECK(file.VerifyContentHash());
+    file.Close();
+
+    std::filesystem::remove(filename);
+}
+
+} // namespace
+
+int main()
+{
+    TestLevelSizes();
+    TestRoundTrip();
+    TestBlockFormats();
+    TestInvalidWrites();
+    TestDamagedFiles();
+    TestContentHash();
+    return Test::Finish("TextureFileTests");
+}
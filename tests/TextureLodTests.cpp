@@ -0,0 +1,191 @@
+// LOD residency decisions: projected sizes, the level picked for a screen
+// size, bytes of a level range, and the drop delay that keeps a texture
+// from reloading back and forth at a level boundary.
+
+#include "TestCheck.h"
+#include "Textures/Effects/TextureLod.h"
+#include <cmath>
+
+using namespace TextureEffects;
+
+namespace {
+
+bool Near(float a, float b)
+{
+    return std::fabs(a - b) <= 1e-3f * std::fabs(b) + 1e-4f;
+}
+
+void TestProjectedSize()
+{
+    const float fovY = 1.5707964f; // 90 degrees: tan(fovY / 2) == 1
+
+    // Inside or touching the sphere: the whole viewport
+    CHECK(GetProjectedSize(2.0f, 1.0f, fovY, 720) == 720.0f);
+    CHECK(GetProjectedSize(2.0f, 2.0f, fovY, 720) == 720.0f);
+
+    // r / sqrt(d^2 - r^2) of the half viewport per unit of tan(fovY / 2)
+    CHECK(Near(GetProjectedSize(3.0f, 5.0f, fovY, 800), 800.0f * 3.0f / 4.0f));
+    CHECK(Near(GetProjectedSize(1.0f, 100.0f, fovY, 1000), 1000.0f / std::sqrt(9999.0f)));
+
+    // Farther is smaller, a narrower field of view is larger
+    CHECK(GetProjectedSize(1.0f, 20.0f, fovY, 720) < GetProjectedSize(1.0f, 10.0f, fovY, 720));
+    CHECK(GetProjectedSize(1.0f, 10.0f, 0.5f, 720) > GetProjectedSize(1.0f, 10.0f, fovY, 720));
+}
+
+void TestSelectMipLevel()
+{
+    // 1024^2 with 11 levels: the coarsest level still covering the size
+    CHECK(SelectMipLevel(1024, 1024, 11, 1024.0f) == 0);
+    CHECK(SelectMipLevel(1024, 1024, 11, 2000.0f) == 0);
+    CHECK(SelectMipLevel(1024, 1024, 11, 512.0f) == 1);
+    CHECK(SelectMipLevel(1024, 1024, 11, 511.0f) == 1);
+    CHECK(SelectMipLevel(1024, 1024, 11, 513.0f) == 0);
+    CHECK(SelectMipLevel(1024, 1024, 11, 100.0f) == 3);
+    CHECK(SelectMipLevel(1024, 1024, 11, 1.0f) == 10);
+    CHECK(SelectMipLevel(1024, 1024, 11, 0.01f) == 10);
+
+    // The larger side decides
+    CHECK(SelectMipLevel(1024, 64, 11, 256.0f) == 2);
+    CHECK(SelectMipLevel(64, 1024, 11, 256.0f) == 2);
+
+    // Bias moves the level, clamped to the chain
+    CHECK(SelectMipLevel(1024, 1024, 11, 256.0f, 1.0f) == 3);
+    CHECK(SelectMipLevel(1024, 1024, 11, 256.0f, -1.0f) == 1);
+    CHECK(SelectMipLevel(1024, 1024, 11, 256.0f, -5.0f) == 0);
+    CHECK(SelectMipLevel(1024, 1024, 11, 4.0f, 5.0f) == 10);
+
+    // No size, or a chain of one level
+    CHECK(SelectMipLevel(1024, 1024, 11, 0.0f) == 10);
+    CHECK(SelectMipLevel(1024, 1024, 11, -3.0f) == 10);
+    CHECK(SelectMipLevel(1024, 1024, 11, NAN) == 10);
+    CHECK(SelectMipLevel(1024, 1024, 1, 10.0f) == 0);
+    CHECK(SelectMipLevel(1024, 1024, 4, 10.0f) == 3);
+}
+
+void TestLevelRangeBytes()
+{
+    // 256x128 A8R8G8B8, 9 levels: 131072, 32768, 8192, 2048, 512, 128, 32, 8, 4
+    CHECK(GetLevelRangeBytes(TextureFileFormat::A8R8G8B8, 256, 128, 0, 9) == 174764);
+    CHECK(GetLevelRangeBytes(TextureFileFormat::A8R8G8B8, 256, 128, 1, 9) == 43692);
+    CHECK(GetLevelRangeBytes(TextureFileFormat::A8R8G8B8, 256, 128, 8, 9) == 4);
+    CHECK(GetLevelRangeBytes(TextureFileFormat::A8R8G8B8, 256, 128, 9, 9) == 0);
+    CHECK(GetLevelRangeBytes(TextureFileFormat::A8R8G8B8, 256, 128, -2, 9) == 174764);
+
+    // Block formats round every level up to whole 4x4 blocks: 64x64 BC1 is
+    // 2048, 512, 128, 32, then 8 bytes for each of the 4x4, 2x2 and 1x1 levels
+    CHECK(GetLevelRangeBytes(TextureFileFormat::BC1, 64, 64, 0, 7) == 2744);
+    CHECK(GetLevelRangeBytes(TextureFileFormat::BC1, 64, 64, 4, 7) == 24);
+    CHECK(GetLevelRangeBytes(TextureFileFormat::BC3, 64, 64, 4, 7) == 48);
+    CHECK(GetLevelRangeBytes(TextureFileFormat::BC5, 6, 6, 0, 3) == 64 + 16 + 16);
+
+    // Matches TextureLod::GetBytes, which clamps the first level
+    TextureLod lod(TextureFileFormat::BC3, 512, 256, 10);
+    CHECK(lod.GetBytes(0) == GetLevelRangeBytes(TextureFileFormat::BC3, 512, 256, 0, 10));
+    CHECK(lod.GetBytes(3) == GetLevelRangeBytes(TextureFileFormat::BC3, 512, 256, 3, 10));
+    CHECK(lod.GetBytes(20) == GetLevelRangeBytes(TextureFileFormat::BC3, 512, 256, 9, 10));
+    CHECK(lod.GetResidentBytes() == lod.GetBytes(lod.GetTailLevel()));
+}
+
+void TestTailLevel()
+{
+    // First level no larger than tailSize on its larger side
+    CHECK(TextureLod(TextureFileFormat::A8R8G8B8, 1024, 1024, 11).GetTailLevel() == 4);
+    CHECK(TextureLod(TextureFileFormat::A8R8G8B8, 1024, 256, 11, 64).GetTailLevel() == 4);
+    CHECK(TextureLod(TextureFileFormat::A8R8G8B8, 1024, 1024, 11, 1024).GetTailLevel() == 0);
+    CHECK(TextureLod(TextureFileFormat::A8R8G8B8, 1024, 1024, 11, 0).GetTailLevel() == 10);
+    CHECK(TextureLod(TextureFileFormat::A8R8G8B8, 1024, 1024, 3).GetTailLevel() == 2);
+
+    TextureLod lod(TextureFileFormat::A8R8G8B8, 1024, 1024, 11);
+    CHECK(lod.GetResidentLevel() == 4);
+    CHECK(!lod.HasRequest());
+
+    // Nothing requested: stays on the tail
+    CHECK(lod.Update() == 4);
+
+    // Coarser than the tail still keeps the tail
+    lod.Request(8);
+    CHECK(lod.HasRequest());
+    CHECK(lod.Update() == 4);
+    CHECK(!lod.HasRequest());
+
+    // Resident levels are clamped to the tail and the chain
+    lod.SetResidentLevel(9);
+    CHECK(lod.GetResidentLevel() == 4);
+    lod.SetResidentLevel(-1);
+    CHECK(lod.GetResidentLevel() == 0);
+}
+
+void TestDropDelay()
+{
+    const int dropDelay = 5;
+    TextureLod lod(TextureFileFormat::A8R8G8B8, 1024, 1024, 11, 64, dropDelay);
+
+    // Finer levels at once; the finest request of the frame wins
+    lod.RequestSize(300.0f);
+    lod.RequestSize(700.0f);
+    lod.Request(3);
+    CHECK(lod.Update() == 0);
+    lod.SetResidentLevel(0);
+
+    // Coarser only after dropDelay frames in a row without needing level 0
+    for (int frame = 1; frame < dropDelay; frame++)
+    {
+        lod.Request(2);
+        CHECK(lod.Update() == 0);
+    }
+    lod.Request(2);
+    CHECK(lod.Update() == 2);
+    lod.SetResidentLevel(2);
+
+    // A frame needing the resident level or finer restarts the count
+    for (int frame = 1; frame < dropDelay; frame++)
+    {
+        lod.Request(3);
+        CHECK(lod.Update() == 2);
+    }
+    lod.Request(2);
+    CHECK(lod.Update() == 2);
+    for (int frame = 1; frame < dropDelay; frame++)
+    {
+        lod.Request(3);
+        CHECK(lod.Update() == 2);
+    }
+    lod.Request(3);
+    CHECK(lod.Update() == 3);
+
+    // Making the level resident starts the count again
+    lod.SetResidentLevel(3);
+    lod.Request(4);
+    CHECK(lod.Update() == 3);
+
+    // Oscillating at a boundary never drops
+    lod.SetResidentLevel(1);
+    for (int frame = 0; frame <= dropDelay * 4; frame++)
+    {
+        lod.Request(frame % 2 == 0 ? 1 : 2);
+        CHECK(lod.Update() == 1);
+    }
+
+    // Unrequested textures fall back to the tail after the delay too
+    for (int frame = 1; frame < dropDelay; frame++)
+        CHECK(lod.Update() == 1);
+    CHECK(lod.Update() == lod.GetTailLevel());
+
+    // No delay: drops on the first frame
+    TextureLod immediate(TextureFileFormat::A8R8G8B8, 1024, 1024, 11, 64, 0);
+    immediate.SetResidentLevel(0);
+    immediate.Request(2);
+    CHECK(immediate.Update() == 2);
+}
+
+} // namespace
+
+int main()
+{
+    TestProjectedSize();
+    TestSelectMipLevel();
+    TestLevelRangeBytes();
+    TestTailLevel();
+    TestDropDelay();
+    return Test::Finish("TextureLodTests");
+}